@@ -348,6 +348,19 @@ checkandset_dependency(Libdc1394)
 find_package(JPEG QUIET)
 checkandset_dependency(JPEG)
 
+# libjpeg-turbo does not install a CMake module for the TurboJPEG API
+find_path(TurboJPEG_INCLUDE_DIR NAMES turbojpeg.h)
+find_library(TurboJPEG_LIBRARY NAMES turbojpeg)
+mark_as_advanced(TurboJPEG_INCLUDE_DIR TurboJPEG_LIBRARY)
+if(TurboJPEG_INCLUDE_DIR AND TurboJPEG_LIBRARY)
+  set(TurboJPEG_FOUND TRUE)
+  set(TurboJPEG_INCLUDE_DIRS ${TurboJPEG_INCLUDE_DIR})
+  set(TurboJPEG_LIBRARIES ${TurboJPEG_LIBRARY})
+else()
+  set(TurboJPEG_FOUND FALSE)
+endif()
+checkandset_dependency(TurboJPEG)
+
 find_package(PNG QUIET)
 checkandset_dependency(PNG)
 
@@ -608,6 +621,7 @@ print_dependency(GLEW)
 print_dependency(OpenGL)
 print_dependency(Libdc1394)
 print_dependency(JPEG)
+print_dependency(TurboJPEG)
 print_dependency(PNG)
 print_dependency(MPI)
 print_dependency(FTDI)
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <yarp/os/Property.h>
+#include <yarp/os/SystemClock.h>
+#include <yarp/sig/Vector.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+using yarp::os::Property;
+using yarp::os::SystemClock;
+using yarp::sig::Vector;
+using yarp::sig::VectorBase;
+
+// Vector allocations test.
+// Counts the calls to operator new in each cycle of a loop reading the
+// state of the devices, as the clients do:
+//  - AnalogSensorClient::read() copies the last received vector (e.g. the 6
+//    channels of a force/torque sensor) into the vector given by the caller;
+//  - the RemoteControlBoard state (one vector for each field, with one
+//    element for each joint) is copied into the vectors of the control loop.
+// The vectors are created in the loop, as a control loop usually does.
+
+// Parameters:
+// --cycles: the number of cycles
+// --channels: the number of channels of the analog sensor
+// --joints: the number of joints of the control board
+
+namespace {
+std::atomic<long> allocations{0};
+}
+
+void* operator new(std::size_t size)
+{
+    allocations++;
+    void* p = std::malloc(size > 0 ? size : 1);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+static void run(const char* name, int cycles, size_t channels, size_t joints)
+{
+    Vector analog(channels, 1.0);
+    Vector encoders(joints, 2.0);
+    Vector speeds(joints, 3.0);
+    Vector torques(joints, 4.0);
+
+    double sum = 0.0;
+    long before = allocations;
+    double start = SystemClock::nowSystem();
+    for (int i = 0; i < cycles; i++) {
+        // AnalogSensorClient::read()
+        Vector ft;
+        ft = analog;
+
+        // RemoteControlBoard getEncoders(), getEncoderSpeeds(), getTorques()
+        Vector q(joints);
+        Vector dq(joints);
+        Vector tau(joints);
+        q = encoders;
+        dq = speeds;
+        tau = torques;
+
+        sum += ft[0] + q[0] + dq[0] + tau[0];
+    }
+    double elapsed = SystemClock::nowSystem() - start;
+    long count = allocations - before;
+
+    printf("%-16s allocations/cycle: %6.2f   time/cycle: %8.1f ns   (%g)\n",
+           name,
+           static_cast<double>(count) / cycles,
+           1e9 * elapsed / cycles,
+           sum);
+}
+
+int main(int argc, char** argv)
+{
+    Property p;
+    p.fromCommand(argc, argv);
+
+    int cycles = p.check("cycles") ? p.find("cycles").asInt32() : 100000;
+    size_t channels = p.check("channels") ? p.find("channels").asInt32() : 6;
+    size_t joints = p.check("joints") ? p.find("joints").asInt32() : 16;
+
+    printf("%d cycles, %zu analog channels, %zu joints\n", cycles, channels, joints);
+
+    VectorBase::setPoolEnabled(false);
+    run("pool disabled", cycles, channels, joints);
+
+    VectorBase::setPoolEnabled(true);
+    run("pool enabled", cycles, channels, joints);
+
+    return 0;
+}
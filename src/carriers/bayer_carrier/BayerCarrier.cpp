@@ -7,10 +7,12 @@
  */
 
 #include "BayerCarrier.h"
+#include "BayerKernels.h"
 
 #include <yarp/os/LogComponent.h>
 #include <yarp/os/Route.h>
 #include <yarp/sig/ImageDraw.h>
+#include <algorithm>
 #include <cstring>
 #include <cstdlib>
 
@@ -89,10 +91,15 @@ yarp::os::ConnectionReader& BayerCarrier::modifyIncomingData(yarp::os::Connectio
 
     local->setParentConnectionReader(&reader);
 
-    // libdc1394 seems to need this.
+    // libdc1394 seems to need this (the built in methods do not).
     // note that this can slow things down if input has padding.
-    in.setQuantum(1);
-    out.setQuantum(1);
+    if (usesLibdc1394(reader.getConnectionModifiers())) {
+        in.setQuantum(1);
+        out.setQuantum(1);
+    } else {
+        // keep the rows as they are sent
+        in.setQuantum(0);
+    }
 
     Route r;
     bool ok = in.read(reader);
@@ -110,6 +117,10 @@ yarp::os::ConnectionReader& BayerCarrier::modifyIncomingData(yarp::os::Connectio
         int m = DC1394_BAYER_METHOD_BILINEAR;
         const Searchable& config = reader.getConnectionModifiers();
         half = false;
+        threads = 1;
+        if (config.check("threads")) {
+            threads = static_cast<size_t>(std::max(config.find("threads").asInt32(), 0));
+        }
         if (config.check("size")) {
             if (config.find("size").asString() == "half") {
                 half = true;
@@ -157,51 +168,36 @@ yarp::os::ConnectionReader& BayerCarrier::modifyIncomingData(yarp::os::Connectio
 }
 
 
-bool BayerCarrier::debayerHalf(yarp::sig::ImageOf<PixelMono>& src,
-                               yarp::sig::ImageOf<PixelRgb>& dest) {
-    // dc1394 doesn't seem safe for arbitrary data widths
-    if (src.width()%8==0) {
-        dc1394video_frame_t dc_src;
-        dc1394video_frame_t dc_dest;
-        setDcImage(src,&dc_src,dcformat);
-        setDcImage(dest,&dc_dest,dcformat);
-        dc1394_debayer_frames(&dc_src,&dc_dest,DC1394_BAYER_METHOD_DOWNSAMPLE);
-        return true;
+bool BayerCarrier::usesLibdc1394(const yarp::os::Searchable& config) {
+    if (config.check("size") && config.find("size").asString() == "half") {
+        return false;
     }
-
-    if (bayer_method_set) {
-        yCWarning/*Once*/(BAYERCARRIER, "Not using dc1394 debayer methods (image width not a multiple of 8)");
+    if (!config.check("method")) {
+        return false;
     }
+    std::string method = config.find("method").asString();
+    return method != "bilinear" && method != "edgesense" && method != "downsample";
+}
 
-    // a safer implementation that doesn't use dc1394
-    int w = src.width();
-    int h = src.height();
-    int wo = dest.width();
-    int ho = dest.height();
-    int goff1 = 1-goff;
-    int roffx = roff?goff:goff1;
-    int boff = 1-roff;
-    int boffx = boff?goff:goff1;
-    for (int yo=0; yo<ho; yo++) {
-        for (int xo=0; xo<wo; xo++) {
-            PixelRgb& po = dest.pixel(xo,yo);
-            int x = xo*2;
-            int y = yo*2;
-            if (x+1>=w-1 || y+1>=h-1) {
-                po = PixelRgb(0,0,0);
-                continue;
-            }
-            po.r = src.pixel(x+roffx,y+roff);
-            po.b = src.pixel(x+boffx,y+boff);
-            po.g = (PixelMono)(0.5*(src.pixel(x+goff,y)+src.pixel(x+goff1,y+1)));
-        }
-    }
+bool BayerCarrier::debayerHalf(yarp::sig::ImageOf<PixelMono>& src,
+                               yarp::sig::ImageOf<PixelRgb>& dest) {
+    BayerKernels::debayerHalf(src, dest, goff, roff, threads);
     return true;
 }
 
 bool BayerCarrier::debayerFull(yarp::sig::ImageOf<PixelMono>& src,
                                yarp::sig::ImageOf<PixelRgb>& dest) {
-    // dc1394 doesn't seem safe for arbitrary data widths
+    if (bayer_method == DC1394_BAYER_METHOD_EDGESENSE) {
+        BayerKernels::debayerFull(src, dest, goff, roff, BayerKernels::EDGESENSE, threads);
+        return true;
+    }
+    if (bayer_method == DC1394_BAYER_METHOD_BILINEAR) {
+        BayerKernels::debayerFull(src, dest, goff, roff, BayerKernels::BILINEAR, threads);
+        return true;
+    }
+
+    // the other methods are available only in libdc1394, that
+    // doesn't seem safe for arbitrary data widths
     if (src.width()%8==0) {
         dc1394video_frame_t dc_src;
         dc1394video_frame_t dc_dest;
@@ -212,90 +208,8 @@ bool BayerCarrier::debayerFull(yarp::sig::ImageOf<PixelMono>& src,
         return true;
     }
 
-    if (bayer_method_set) {
-        yCWarning/*Once*/(BAYERCARRIER, "Not using dc1394 debayer methods (image width not a multiple of 8)");
-    }
-    int w = dest.width();
-    int h = dest.height();
-    int goff1 = 1-goff;
-    int roffx = roff?goff:goff1;
-    int boff = 1-roff;
-    int boffx = boff?goff:goff1;
-    for (int y=0; y<h; y++) {
-        for (int x=0; x<w; x++) {
-            PixelRgb& po = dest.pixel(x,y);
-
-            // G
-            if ((x+y)%2==goff) {
-                po.g = src.pixel(x,y);
-            } else {
-                float g = 0;
-                int ct = 0;
-                if (x>0) { g += src.pixel(x-1,y); ct++; }
-                if (x<w-1) { g += src.pixel(x+1,y); ct++; }
-                if (y>0) { g += src.pixel(x,y-1); ct++; }
-                if (y<h-1) { g += src.pixel(x,y+1); ct++; }
-                if (ct>0) g /= ct;
-                po.g = (int)g;
-            }
-
-            // B
-            if (y%2==boff && x%2==boffx) {
-                po.b = src.pixel(x,y);
-            } else if (y%2==boff) {
-                float b = 0;
-                int ct = 0;
-                if (x>0) { b += src.pixel(x-1,y); ct++; }
-                if (x<w-1) { b += src.pixel(x+1,y); ct++; }
-                if (ct>0) b /= ct;
-                po.b = (int)b;
-            } else if (x%2==boffx) {
-                float b = 0;
-                int ct = 0;
-                if (y>0) { b += src.pixel(x,y-1); ct++; }
-                if (y<h-1) { b += src.pixel(x,y+1); ct++; }
-                if (ct>0) b /= ct;
-                po.b = (int)b;
-            } else {
-                float b = 0;
-                int ct = 0;
-                if (x>0&&y>0) { b += src.pixel(x-1,y-1); ct++; }
-                if (x>0&&y<h-1) { b += src.pixel(x-1,y+1); ct++; }
-                if (x<w-1&&y>0) { b += src.pixel(x+1,y-1); ct++; }
-                if (x<w-1&&y<h-1) { b += src.pixel(x+1,y+1); ct++; }
-                if (ct>0) b /= ct;
-                po.b = (int)b;
-            }
-
-            // R
-            if (y%2==roff && x%2==roffx) {
-                po.r = src.pixel(x,y);
-            } else if (y%2==roff) {
-                float r = 0;
-                int ct = 0;
-                if (x>0) { r += src.pixel(x-1,y); ct++; }
-                if (x<w-1) { r += src.pixel(x+1,y); ct++; }
-                if (ct>0) r /= ct;
-                po.r = (int)r;
-            } else if (x%2==roffx) {
-                float r = 0;
-                int ct = 0;
-                if (y>0) { r += src.pixel(x,y-1); ct++; }
-                if (y<h-1) { r += src.pixel(x,y+1); ct++; }
-                if (ct>0) r /= ct;
-                po.r = (int)r;
-            } else {
-                float r = 0;
-                int ct = 0;
-                if (x>0&&y>0) { r += src.pixel(x-1,y-1); ct++; }
-                if (x>0&&y<h-1) { r += src.pixel(x-1,y+1); ct++; }
-                if (x<w-1&&y>0) { r += src.pixel(x+1,y-1); ct++; }
-                if (x<w-1&&y<h-1) { r += src.pixel(x+1,y+1); ct++; }
-                if (ct>0) r /= ct;
-                po.r = (int)r;
-            }
-        }
-    }
+    yCWarning/*Once*/(BAYERCARRIER, "Using the bilinear method (image width not a multiple of 8)");
+    BayerKernels::debayerFull(src, dest, goff, roff, BayerKernels::BILINEAR, threads);
     return true;
 }
 
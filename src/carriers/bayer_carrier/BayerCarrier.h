@@ -22,6 +22,13 @@
  *   tcp+recv.bayer
  *   tcp+recv.bayer+size.half
  *   tcp+recv.bayer+size.half+order.bggr
+ *   tcp+recv.bayer+method.edgesense+threads.4
+ *
+ * The bilinear (default), edgesense and half size (downsample) methods
+ * are built in, and work with images of any width and row padding.  The
+ * other methods use libdc1394.  The built in methods can split the image
+ * among some threads (threads.N, 0 for one for each core, default 1), that
+ * are started for each image, so they pay off only with large images.
  *
  */
 class BayerCarrier :
@@ -47,6 +54,7 @@ private:
     bool bayer_method_set;
 
     int bayer_method;
+    size_t threads;
 
     // format offsets
     int goff; // x offset to green on even rows
@@ -54,6 +62,9 @@ private:
     int dcformat;
 
     bool setFormat(const char *fmt);
+
+    // do the modifiers ask for a method of libdc1394
+    static bool usesLibdc1394(const yarp::os::Searchable& config);
 public:
 
     ////////////////////////////////////////////////////////////////////////
@@ -71,6 +82,7 @@ public:
         half(false),
         bayer_method_set(false),
         bayer_method(-1),
+        threads(1),
         goff(0),
         roff(1),
         dcformat(-1)
@@ -0,0 +1,474 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include "BayerKernels.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#    define BAYERKERNELS_SSE2
+#    include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#    define BAYERKERNELS_NEON
+#    include <arm_neon.h>
+#endif
+
+using namespace yarp::sig;
+
+namespace {
+
+/*
+ * Each pixel of a row is made of the channel sampled on the row (red on
+ * the rows with red samples, blue on the other ones), of green, and of the
+ * other channel, that are computed in three planes and then interleaved in
+ * the destination row.
+ *
+ * On a green pixel, the channel of the row is the average of the samples
+ * on the left and on the right, and the other one the average of the
+ * samples above and below.  On a red or blue pixel, green is the average
+ * of the four nearest samples (or of the two along the smaller gradient,
+ * for EDGESENSE), and the other channel the average of the four diagonal
+ * samples.  All the averages are rounded to the nearest integer, so the
+ * vectorized and the scalar code give the same result.
+ *
+ * The rows above, at and below the one debayered have a mirrored sample
+ * before the first and after the last one, so that row[-1] and row[width]
+ * can always be read.
+ */
+struct Planes
+{
+    unsigned char* own;
+    unsigned char* green;
+    unsigned char* other;
+};
+
+void planesScalar(const unsigned char* u,
+                  const unsigned char* c,
+                  const unsigned char* d,
+                  size_t begin,
+                  size_t width,
+                  bool greenEven,
+                  bool edge,
+                  Planes planes)
+{
+    for (size_t x = begin; x < width; x++) {
+        unsigned int h = (c[x - 1] + c[x + 1] + 1) >> 1;
+        unsigned int v = (u[x] + d[x] + 1) >> 1;
+        bool green = ((x & 1) == 0) == greenEven;
+        if (green) {
+            planes.own[x] = static_cast<unsigned char>(h);
+            planes.green[x] = c[x];
+            planes.other[x] = static_cast<unsigned char>(v);
+            continue;
+        }
+        unsigned int cross = (c[x - 1] + c[x + 1] + u[x] + d[x] + 2) >> 2;
+        if (edge) {
+            int dh = std::abs(c[x - 1] - c[x + 1]);
+            int dv = std::abs(u[x] - d[x]);
+            if (dh < dv) {
+                cross = h;
+            } else if (dv < dh) {
+                cross = v;
+            }
+        }
+        planes.own[x] = c[x];
+        planes.green[x] = static_cast<unsigned char>(cross);
+        planes.other[x] = static_cast<unsigned char>((u[x - 1] + u[x + 1] + d[x - 1] + d[x + 1] + 2) >> 2);
+    }
+}
+
+// half size: the two samples of a row of 2x2 blocks, and the two of the
+// following row
+void halfScalar(const unsigned char* row0,
+                const unsigned char* row1,
+                size_t begin,
+                size_t width,
+                int goff,
+                Planes planes)
+{
+    for (size_t x = begin; x < width; x++) {
+        const unsigned char* p0 = row0 + 2 * x;
+        const unsigned char* p1 = row1 + 2 * x;
+        planes.own[x] = p0[1 - goff];
+        planes.green[x] = static_cast<unsigned char>((p0[goff] + p1[1 - goff] + 1) >> 1);
+        planes.other[x] = p1[goff];
+    }
+}
+
+#if defined(BAYERKERNELS_SSE2)
+
+inline __m128i select(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+inline __m128i average4(__m128i a, __m128i b, __m128i c, __m128i d)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i two = _mm_set1_epi16(2);
+    __m128i lo = _mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero)),
+                               _mm_add_epi16(_mm_unpacklo_epi8(c, zero), _mm_unpacklo_epi8(d, zero)));
+    __m128i hi = _mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero)),
+                               _mm_add_epi16(_mm_unpackhi_epi8(c, zero), _mm_unpackhi_epi8(d, zero)));
+    return _mm_packus_epi16(_mm_srli_epi16(_mm_add_epi16(lo, two), 2),
+                            _mm_srli_epi16(_mm_add_epi16(hi, two), 2));
+}
+
+inline __m128i absDiff(__m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+}
+
+inline __m128i load(const unsigned char* p)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+inline void store(unsigned char* p, __m128i v)
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+}
+
+size_t planesSimd(const unsigned char* u,
+                  const unsigned char* c,
+                  const unsigned char* d,
+                  size_t width,
+                  bool greenEven,
+                  bool edge,
+                  Planes planes)
+{
+    // the even bytes, as the pixels of a block start at an even x
+    const __m128i even = _mm_set1_epi16(0x00FF);
+    const __m128i greenMask = greenEven ? even : _mm_xor_si128(even, _mm_set1_epi8(-1));
+    size_t x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i left = load(c + x - 1);
+        __m128i right = load(c + x + 1);
+        __m128i center = load(c + x);
+        __m128i up = load(u + x);
+        __m128i down = load(d + x);
+        __m128i h = _mm_avg_epu8(left, right);
+        __m128i v = _mm_avg_epu8(up, down);
+        __m128i cross = average4(left, right, up, down);
+        if (edge) {
+            __m128i dh = absDiff(left, right);
+            __m128i dv = absDiff(up, down);
+            __m128i same = _mm_cmpeq_epi8(dh, dv);
+            __m128i smaller = _mm_min_epu8(dh, dv);
+            __m128i hSmaller = _mm_andnot_si128(same, _mm_cmpeq_epi8(smaller, dh));
+            __m128i vSmaller = _mm_andnot_si128(same, _mm_cmpeq_epi8(smaller, dv));
+            cross = select(hSmaller, h, select(vSmaller, v, cross));
+        }
+        __m128i diagonal = average4(load(u + x - 1), load(u + x + 1), load(d + x - 1), load(d + x + 1));
+        store(planes.own + x, select(greenMask, h, center));
+        store(planes.green + x, select(greenMask, center, cross));
+        store(planes.other + x, select(greenMask, v, diagonal));
+    }
+    return x;
+}
+
+size_t halfSimd(const unsigned char* row0,
+                const unsigned char* row1,
+                size_t width,
+                int goff,
+                Planes planes)
+{
+    const __m128i even = _mm_set1_epi16(0x00FF);
+    size_t x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i a0 = load(row0 + 2 * x);
+        __m128i a1 = load(row0 + 2 * x + 16);
+        __m128i b0 = load(row1 + 2 * x);
+        __m128i b1 = load(row1 + 2 * x + 16);
+        __m128i row0Even = _mm_packus_epi16(_mm_and_si128(a0, even), _mm_and_si128(a1, even));
+        __m128i row0Odd = _mm_packus_epi16(_mm_srli_epi16(a0, 8), _mm_srli_epi16(a1, 8));
+        __m128i row1Even = _mm_packus_epi16(_mm_and_si128(b0, even), _mm_and_si128(b1, even));
+        __m128i row1Odd = _mm_packus_epi16(_mm_srli_epi16(b0, 8), _mm_srli_epi16(b1, 8));
+        if (goff == 0) {
+            store(planes.own + x, row0Odd);
+            store(planes.green + x, _mm_avg_epu8(row0Even, row1Odd));
+            store(planes.other + x, row1Even);
+        } else {
+            store(planes.own + x, row0Even);
+            store(planes.green + x, _mm_avg_epu8(row0Odd, row1Even));
+            store(planes.other + x, row1Odd);
+        }
+    }
+    return x;
+}
+
+#elif defined(BAYERKERNELS_NEON)
+
+inline uint8x16_t average4(uint8x16_t a, uint8x16_t b, uint8x16_t c, uint8x16_t d)
+{
+    uint16x8_t lo = vaddq_u16(vaddl_u8(vget_low_u8(a), vget_low_u8(b)), vaddl_u8(vget_low_u8(c), vget_low_u8(d)));
+    uint16x8_t hi = vaddq_u16(vaddl_u8(vget_high_u8(a), vget_high_u8(b)), vaddl_u8(vget_high_u8(c), vget_high_u8(d)));
+    return vcombine_u8(vrshrn_n_u16(lo, 2), vrshrn_n_u16(hi, 2));
+}
+
+size_t planesSimd(const unsigned char* u,
+                  const unsigned char* c,
+                  const unsigned char* d,
+                  size_t width,
+                  bool greenEven,
+                  bool edge,
+                  Planes planes)
+{
+    const uint8x16_t even = vreinterpretq_u8_u16(vdupq_n_u16(0x00FF));
+    const uint8x16_t greenMask = greenEven ? even : vmvnq_u8(even);
+    size_t x = 0;
+    for (; x + 16 <= width; x += 16) {
+        uint8x16_t left = vld1q_u8(c + x - 1);
+        uint8x16_t right = vld1q_u8(c + x + 1);
+        uint8x16_t center = vld1q_u8(c + x);
+        uint8x16_t up = vld1q_u8(u + x);
+        uint8x16_t down = vld1q_u8(d + x);
+        uint8x16_t h = vrhaddq_u8(left, right);
+        uint8x16_t v = vrhaddq_u8(up, down);
+        uint8x16_t cross = average4(left, right, up, down);
+        if (edge) {
+            uint8x16_t dh = vabdq_u8(left, right);
+            uint8x16_t dv = vabdq_u8(up, down);
+            cross = vbslq_u8(vcltq_u8(dh, dv), h, vbslq_u8(vcltq_u8(dv, dh), v, cross));
+        }
+        uint8x16_t diagonal = average4(vld1q_u8(u + x - 1), vld1q_u8(u + x + 1), vld1q_u8(d + x - 1), vld1q_u8(d + x + 1));
+        vst1q_u8(planes.own + x, vbslq_u8(greenMask, h, center));
+        vst1q_u8(planes.green + x, vbslq_u8(greenMask, center, cross));
+        vst1q_u8(planes.other + x, vbslq_u8(greenMask, v, diagonal));
+    }
+    return x;
+}
+
+size_t halfSimd(const unsigned char* row0,
+                const unsigned char* row1,
+                size_t width,
+                int goff,
+                Planes planes)
+{
+    size_t x = 0;
+    for (; x + 16 <= width; x += 16) {
+        // val[0] has the even samples, val[1] the odd ones
+        uint8x16x2_t a = vld2q_u8(row0 + 2 * x);
+        uint8x16x2_t b = vld2q_u8(row1 + 2 * x);
+        vst1q_u8(planes.own + x, a.val[1 - goff]);
+        vst1q_u8(planes.green + x, vrhaddq_u8(a.val[goff], b.val[1 - goff]));
+        vst1q_u8(planes.other + x, b.val[goff]);
+    }
+    return x;
+}
+
+#else
+
+size_t planesSimd(const unsigned char*, const unsigned char*, const unsigned char*, size_t, bool, bool, Planes)
+{
+    return 0;
+}
+
+size_t halfSimd(const unsigned char*, const unsigned char*, size_t, int, Planes)
+{
+    return 0;
+}
+
+#endif
+
+// Writes the pixels from the three planes
+void interleave(const unsigned char* r, const unsigned char* g, const unsigned char* b, unsigned char* out, size_t width)
+{
+    size_t x = 0;
+#if defined(BAYERKERNELS_SSE2)
+    // the pixels are made as 32 bits words, then their first three bytes
+    // are written, two pixels at a time.  Each write is 8 bytes long, and
+    // its last two bytes are overwritten by the following one, so a block
+    // is written only if it is followed by at least another pixel.
+    const __m128i zero = _mm_setzero_si128();
+    for (; x + 16 < width; x += 16) {
+        __m128i red = load(r + x);
+        __m128i green = load(g + x);
+        __m128i blue = load(b + x);
+        __m128i rg0 = _mm_unpacklo_epi8(red, green);
+        __m128i rg1 = _mm_unpackhi_epi8(red, green);
+        __m128i b0 = _mm_unpacklo_epi8(blue, zero);
+        __m128i b1 = _mm_unpackhi_epi8(blue, zero);
+        alignas(16) std::uint32_t pixels[16];
+        _mm_store_si128(reinterpret_cast<__m128i*>(pixels), _mm_unpacklo_epi16(rg0, b0));
+        _mm_store_si128(reinterpret_cast<__m128i*>(pixels + 4), _mm_unpackhi_epi16(rg0, b0));
+        _mm_store_si128(reinterpret_cast<__m128i*>(pixels + 8), _mm_unpacklo_epi16(rg1, b1));
+        _mm_store_si128(reinterpret_cast<__m128i*>(pixels + 12), _mm_unpackhi_epi16(rg1, b1));
+        unsigned char* o = out + 3 * x;
+        for (size_t i = 0; i < 16; i += 2) {
+            std::uint64_t pair = pixels[i] | (static_cast<std::uint64_t>(pixels[i + 1]) << 24);
+            memcpy(o + 3 * i, &pair, sizeof(pair));
+        }
+    }
+#elif defined(BAYERKERNELS_NEON)
+    for (; x + 16 <= width; x += 16) {
+        uint8x16x3_t pixels;
+        pixels.val[0] = vld1q_u8(r + x);
+        pixels.val[1] = vld1q_u8(g + x);
+        pixels.val[2] = vld1q_u8(b + x);
+        vst3q_u8(out + 3 * x, pixels);
+    }
+#endif
+    for (; x < width; x++) {
+        out[3 * x] = r[x];
+        out[3 * x + 1] = g[x];
+        out[3 * x + 2] = b[x];
+    }
+}
+
+// The planes of a row, and their storage
+struct RowPlanes
+{
+    std::vector<unsigned char> storage;
+    Planes planes;
+
+    explicit RowPlanes(size_t width) :
+            storage(3 * width)
+    {
+        planes.own = storage.data();
+        planes.green = storage.data() + width;
+        planes.other = storage.data() + 2 * width;
+    }
+
+    void writeTo(unsigned char* out, bool redRow, size_t width) const
+    {
+        if (redRow) {
+            interleave(planes.own, planes.green, planes.other, out, width);
+        } else {
+            interleave(planes.other, planes.green, planes.own, out, width);
+        }
+    }
+};
+
+// The rows of the source with the mirrored samples, the last three used
+class PaddedRows
+{
+    const Image& src;
+    size_t width;
+    long height;
+    std::vector<unsigned char> storage[3];
+    long cached[3] = {-1, -1, -1};
+
+public:
+    PaddedRows(const Image& src) :
+            src(src),
+            width(src.width()),
+            height(static_cast<long>(src.height()))
+    {
+        for (auto& row : storage) {
+            row.resize(width + 2);
+        }
+    }
+
+    // the sample x of the row y is at [x], y can be -1 and height
+    const unsigned char* get(long y)
+    {
+        if (y < 0) {
+            y = std::min(1L, height - 1);
+        } else if (y >= height) {
+            y = std::max(height - 2, 0L);
+        }
+        std::vector<unsigned char>& row = storage[y % 3];
+        if (cached[y % 3] != y) {
+            const unsigned char* in = src.getRow(static_cast<size_t>(y));
+            memcpy(row.data() + 1, in, width);
+            row[0] = in[std::min<size_t>(1, width - 1)];
+            row[width + 1] = in[width - std::min<size_t>(2, width)];
+            cached[y % 3] = y;
+        }
+        return row.data() + 1;
+    }
+};
+
+void fullRows(const Image& src, ImageOf<PixelRgb>& dest, int goff, int roff, bool edge, size_t begin, size_t end)
+{
+    const size_t width = src.width();
+    PaddedRows rows(src);
+    RowPlanes planes(width);
+    for (size_t y = begin; y < end; y++) {
+        const auto row = static_cast<long>(y);
+        const unsigned char* u = rows.get(row - 1);
+        const unsigned char* c = rows.get(row);
+        const unsigned char* d = rows.get(row + 1);
+        bool greenEven = static_cast<int>(y % 2) == goff;
+        size_t done = planesSimd(u, c, d, width, greenEven, edge, planes.planes);
+        planesScalar(u, c, d, done, width, greenEven, edge, planes.planes);
+        planes.writeTo(dest.getRow(y), static_cast<int>(y % 2) == roff, width);
+    }
+}
+
+void halfRows(const Image& src, ImageOf<PixelRgb>& dest, int goff, int roff, size_t begin, size_t end)
+{
+    const size_t width = dest.width();
+    RowPlanes planes(width);
+    for (size_t y = begin; y < end; y++) {
+        const unsigned char* row0 = src.getRow(2 * y);
+        const unsigned char* row1 = src.getRow(2 * y + 1);
+        size_t done = halfSimd(row0, row1, width, goff, planes.planes);
+        halfScalar(row0, row1, done, width, goff, planes.planes);
+        // the samples of the even rows are red when roff is 0
+        planes.writeTo(dest.getRow(y), roff == 0, width);
+    }
+}
+
+// Runs run(begin, end) on bands of the rows, each one in its thread
+template <typename Run>
+void splitRows(size_t rows, size_t threads, Run run)
+{
+    // smaller bands are not worth a thread
+    constexpr size_t minRows = 32;
+    if (threads == 0) {
+        threads = std::max(std::thread::hardware_concurrency(), 1U);
+    }
+    threads = std::max<size_t>(std::min(threads, rows / minRows), 1);
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < threads; t++) {
+        workers.emplace_back(run, rows * t / threads, rows * (t + 1) / threads);
+    }
+    run(0, rows / threads);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+} // namespace
+
+
+void BayerKernels::debayerFull(const Image& src,
+                               ImageOf<PixelRgb>& dest,
+                               int goff,
+                               int roff,
+                               Method method,
+                               size_t threads)
+{
+    if (src.width() == 0 || src.height() == 0) {
+        return;
+    }
+    splitRows(src.height(), threads, [&](size_t begin, size_t end) {
+        fullRows(src, dest, goff, roff, method == EDGESENSE, begin, end);
+    });
+}
+
+void BayerKernels::debayerHalf(const Image& src,
+                               ImageOf<PixelRgb>& dest,
+                               int goff,
+                               int roff,
+                               size_t threads)
+{
+    if (dest.width() == 0 || dest.height() == 0) {
+        return;
+    }
+    splitRows(dest.height(), threads, [&](size_t begin, size_t end) {
+        halfRows(src, dest, goff, roff, begin, end);
+    });
+}
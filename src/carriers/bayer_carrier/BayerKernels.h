@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#ifndef BAYERKERNELS_INC
+#define BAYERKERNELS_INC
+
+#include <yarp/sig/Image.h>
+
+#include <cstddef>
+
+/**
+ * Debayering written directly into the destination image, for any width
+ * and any padding of the rows of the images, without libdc1394.
+ *
+ * The rows are processed 16 pixels at a time with SSE2 on x86-64 and with
+ * NEON on ARM, and the image is split in bands of rows, each one debayered
+ * by its own thread.
+ *
+ * The pattern is described as in BayerCarrier: goff is the x offset of
+ * green on the even rows (the pixels where (x + y) % 2 == goff are green),
+ * and roff is the y offset of the rows with red pixels.
+ */
+namespace BayerKernels {
+
+enum Method
+{
+    // each missing channel is the average of its nearest samples
+    BILINEAR,
+    // as BILINEAR, but the green of the red and blue pixels is interpolated
+    // along the direction with the smaller gradient
+    EDGESENSE
+};
+
+/**
+ * Debayers an image to an image of the same size, that must already have
+ * the size of the source.
+ * The pixels on the borders use the samples mirrored inside the image.
+ *
+ * @param threads the number of threads, started for this image, 0 for
+ *        one for each core
+ */
+void debayerFull(const yarp::sig::Image& src,
+                 yarp::sig::ImageOf<yarp::sig::PixelRgb>& dest,
+                 int goff,
+                 int roff,
+                 Method method,
+                 size_t threads);
+
+/**
+ * Debayers an image to an image of half its size, that must already have
+ * that size, making each pixel of a 2x2 block of samples, with the average
+ * of its two green samples.
+ *
+ * @param threads the number of threads, started for this image, 0 for
+ *        one for each core
+ */
+void debayerHalf(const yarp::sig::Image& src,
+                 yarp::sig::ImageOf<yarp::sig::PixelRgb>& dest,
+                 int goff,
+                 int roff,
+                 size_t threads);
+
+} // namespace BayerKernels
+
+#endif
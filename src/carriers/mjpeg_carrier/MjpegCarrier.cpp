@@ -11,81 +11,23 @@
 #include "MjpegLogComponent.h"
 
 #include <cstdio>
-
-/*
-  On Windows, libjpeg does some slightly odd-ball stuff, including
-  unconditionally defining INT32 to be "long".  This needs to
-  be worked around.  Work around begins...
- */
-#if defined(_WIN32)
-#define INT32 long  // jpeg's definition
-#define QGLOBAL_H 1
-#endif
-
-#ifdef _MSC_VER
-#pragma warning (push)
-#pragma warning (disable : 4091)
-#endif
-
-extern "C" {
-#include <jpeglib.h>
-}
-
-#ifdef _MSC_VER
-#pragma warning (pop)
-#endif
-
-#if defined(_WIN32)
-#undef INT32
-#undef QGLOBAL_H
-#endif
-/*
-  work around ends.
- */
+#include <memory>
+#include <vector>
 
 #include <yarp/sig/Image.h>
-#include <yarp/sig/ImageNetworkHeader.h>
 #include <yarp/os/Name.h>
 #include <yarp/os/Bytes.h>
 #include <yarp/os/Route.h>
+#include <yarp/os/Vocab.h>
 
 #include <yarp/wire_rep_utils/WireImage.h>
 
-#include <map>
-
 using namespace yarp::os;
 using namespace yarp::sig;
 using namespace yarp::wire_rep_utils;
 
-static const std::map<int, J_COLOR_SPACE> yarpCode2Mjpeg { {VOCAB_PIXEL_MONO, JCS_GRAYSCALE},
-                                                           {VOCAB_PIXEL_MONO16, JCS_GRAYSCALE},
-                                                           {VOCAB_PIXEL_RGB , JCS_RGB},
-                                                           {VOCAB_PIXEL_RGBA , JCS_EXT_RGBA},
-                                                           {VOCAB_PIXEL_BGRA , JCS_EXT_BGRA},
-                                                           {VOCAB_PIXEL_BGR , JCS_EXT_BGR} };
-
-static const std::map<int, int> yarpCode2Channels { {VOCAB_PIXEL_MONO, 1},
-                                                    {VOCAB_PIXEL_MONO16, 2},
-                                                    {VOCAB_PIXEL_RGB , 3},
-                                                    {VOCAB_PIXEL_RGBA , 4},
-                                                    {VOCAB_PIXEL_BGRA , 4},
-                                                    {VOCAB_PIXEL_BGR , 3} };
-
-
-struct net_destination_mgr
-{
-    struct jpeg_destination_mgr pub;
-
-    JOCTET *buffer;
-    int bufsize;
-    JOCTET cache[1000000];  // need to make this variable...
-};
-
-using net_destination_ptr = net_destination_mgr*;
-
-void send_net_data(JOCTET *data, int len, void *client) {
-    yCTrace(MJPEGCARRIER, "Send %d bytes", len);
-    auto* p = (ConnectionState *)client;
+void send_net_data(const unsigned char *data, size_t len, ConnectionState& proto) {
+    yCTrace(MJPEGCARRIER, "Send %zu bytes", len);
     constexpr size_t hdr_size = 1000;
     char hdr[hdr_size];
     std::snprintf(hdr, hdr_size, "\n");
@@ -95,71 +37,14 @@ void send_net_data(JOCTET *data, int len, void *client) {
     }
     yCTrace(MJPEGCARRIER, "Using terminator %s",(hdr[1]=='\0')?"\\r\\n":"\\n");
     std::snprintf(hdr, hdr_size, "Content-Type: image/jpeg%s\
-Content-Length: %d%s%s", brk, len, brk, brk);
+Content-Length: %zu%s%s", brk, len, brk, brk);
     Bytes hbuf(hdr,strlen(hdr));
-    p->os().write(hbuf);
+    proto.os().write(hbuf);
     Bytes buf((char *)data,len);
-    /*
-      // add corruption now and then, for testing.
-    static int ct = 0;
-    ct++;
-    if (ct==50) {
-        yCTrace(MJPEGCARRIER, "Adding corruption");
-        buf.get()[0] = 'z';
-        ct = 0;
-    }
-    */
-    p->os().write(buf);
+    proto.os().write(buf);
     std::snprintf(hdr, hdr_size, "%s--boundarydonotcross%s", brk, brk);
     Bytes hbuf2(hdr,strlen(hdr));
-    p->os().write(hbuf2);
-
-}
-
-static void init_net_destination(j_compress_ptr cinfo) {
-    yCTrace(MJPEGCARRIER, "Initializing destination");
-    auto dest = (net_destination_ptr)cinfo->dest;
-    dest->buffer = &(dest->cache[0]);
-    dest->bufsize = sizeof(dest->cache);
-    dest->pub.next_output_byte = dest->buffer;
-    dest->pub.free_in_buffer = dest->bufsize;
-}
-
-static boolean empty_net_output_buffer(j_compress_ptr cinfo) {
-    auto dest = (net_destination_ptr)cinfo->dest;
-    yCWarning(MJPEGCARRIER, "Empty buffer - PROBLEM");
-    send_net_data(dest->buffer,dest->bufsize-dest->pub.free_in_buffer,
-                  cinfo->client_data);
-    dest->pub.next_output_byte = dest->buffer;
-    dest->pub.free_in_buffer = dest->bufsize;
-    return TRUE;
-}
-
-static void term_net_destination(j_compress_ptr cinfo) {
-    auto dest = (net_destination_ptr)cinfo->dest;
-    yCTrace(MJPEGCARRIER, "Terminating net %d %zd", dest->bufsize,dest->pub.free_in_buffer);
-    send_net_data(dest->buffer,dest->bufsize-dest->pub.free_in_buffer,
-                  cinfo->client_data);
-}
-
-void jpeg_net_dest(j_compress_ptr cinfo) {
-    net_destination_ptr dest;
-
-      //ERREXIT(cinfo, JERR_BUFFER_SIZE);
-
-    /* The destination object is made permanent so that multiple JPEG images
-     * can be written to the same buffer without re-executing jpeg_net_dest.
-     */
-    if (cinfo->dest == nullptr) {    /* first time for this JPEG object? */
-        cinfo->dest = (struct jpeg_destination_mgr *)
-            (*cinfo->mem->alloc_large) ((j_common_ptr) cinfo, JPOOL_PERMANENT,
-                                        sizeof(net_destination_mgr));
-    }
-
-    dest = (net_destination_ptr) cinfo->dest;
-    dest->pub.init_destination = init_net_destination;
-    dest->pub.empty_output_buffer = empty_net_output_buffer;
-    dest->pub.term_destination = term_net_destination;
+    proto.os().write(hbuf2);
 }
 
 bool MjpegCarrier::write(ConnectionState& proto, SizedWriter& writer) {
@@ -167,39 +52,25 @@ bool MjpegCarrier::write(ConnectionState& proto, SizedWriter& writer) {
     FlexImage *img = rep.checkForImage(writer);
 
     if (img==nullptr) return false;
-    int w = img->width();
-    int h = img->height();
-    int row_stride = img->getRowSize();
-    auto* data = (JOCTET*)img->getRawImage();
-
-    JSAMPROW row_pointer[1];
-
-    struct jpeg_compress_struct cinfo;
-    struct jpeg_error_mgr jerr;
-    cinfo.err = jpeg_std_error(&jerr);
-    cinfo.client_data = &proto;
-    jpeg_create_compress(&cinfo);
-    jpeg_net_dest(&cinfo);
-    cinfo.image_width = w;
-    cinfo.image_height = h;
-    cinfo.in_color_space = yarpCode2Mjpeg.at(img->getPixelCode());
-    cinfo.input_components = yarpCode2Channels.at(img->getPixelCode());
-    jpeg_set_defaults(&cinfo);
-    //jpeg_set_quality(&cinfo, 85, TRUE);
-    yCTrace(MJPEGCARRIER, "Starting to compress...");
-    jpeg_start_compress(&cinfo, TRUE);
-    if(!envelope.empty()) {
-        jpeg_write_marker(&cinfo, JPEG_COM, reinterpret_cast<const JOCTET*>(envelope.c_str()), envelope.length() + 1);
+
+    if (!MjpegCompression::canCompress(img->getPixelCode())) {
+        yCError(MJPEGCARRIER, "Cannot compress images of type %s", Vocab::decode(img->getPixelCode()).c_str());
         envelope.clear();
+        return false;
     }
-    yCTrace(MJPEGCARRIER, "Done compressing (height %d)", cinfo.image_height);
-    while (cinfo.next_scanline < cinfo.image_height) {
-        yCTrace(MJPEGCARRIER, "Writing row %d...", cinfo.next_scanline);
-        row_pointer[0] = data + cinfo.next_scanline * row_stride;
-        jpeg_write_scanlines(&cinfo, row_pointer, 1);
+
+    // the compressed image is shared by the other connections sending
+    // this message with the same settings
+    std::string key = "mjpeg" + settings.toQuery() + "\n" + envelope;
+    std::shared_ptr<const std::vector<unsigned char>> jpeg = writer.getEncoding(key, [&](std::vector<unsigned char>& out) {
+        return compression.compress(*img, settings, envelope, out);
+    });
+    envelope.clear();
+    if (jpeg == nullptr) {
+        yCError(MJPEGCARRIER, "Failed to compress the image");
+        return false;
     }
-    jpeg_finish_compress(&cinfo);
-    jpeg_destroy_compress(&cinfo);
+    send_net_data(jpeg->data(), jpeg->size(), proto);
 
     return true;
 }
@@ -212,7 +83,11 @@ bool MjpegCarrier::reply(ConnectionState& proto, SizedWriter& writer) {
 bool MjpegCarrier::sendHeader(ConnectionState& proto) {
     Name n(proto.getRoute().getCarrierName() + "://test");
     std::string pathValue = n.getCarrierModifier("path");
-    std::string target = "GET /?action=stream\n\n";
+    // the settings are passed to the sender in the query
+    MjpegSettings request;
+    request.set("quality", n.getCarrierModifier("quality"));
+    request.set("subsampling", n.getCarrierModifier("subsampling"));
+    std::string target = "GET /?action=stream" + request.toQuery() + "\n\n";
     if (pathValue!="") {
         target = "GET /";
         target += pathValue;
@@ -230,6 +105,34 @@ bool MjpegCarrier::sendHeader(ConnectionState& proto) {
     return true;
 }
 
+bool MjpegCarrier::expectExtraHeader(ConnectionState& proto) {
+    // the rest of the request line, after "GET /?ac", e.g.
+    // "tion=stream&quality=90 HTTP/1.1"
+    std::string txt = proto.is().readLine();
+    std::string query = txt.substr(0, txt.find(' '));
+    size_t at = 0;
+    while (at < query.length()) {
+        size_t end = query.find('&', at);
+        if (end == std::string::npos) {
+            end = query.length();
+        }
+        std::string param = query.substr(at, end - at);
+        size_t eq = param.find('=');
+        if (eq != std::string::npos) {
+            std::string key = param.substr(0, eq);
+            std::string value = param.substr(eq + 1);
+            if ((key == "quality" || key == "subsampling") && !settings.set(key, value)) {
+                yCWarning(MJPEGCARRIER, "Invalid value for %s: %s", key.c_str(), value.c_str());
+            }
+        }
+        at = end + 1;
+    }
+    while (txt!="") {
+        txt = proto.is().readLine();
+    }
+    return true;
+}
+
 bool MjpegCarrier::autoCompression() const {
 #ifdef MJPEG_AUTOCOMPRESS
     return true;
@@ -14,6 +14,7 @@
 #include <yarp/os/NetType.h>
 #include <yarp/os/ConnectionState.h>
 #include "MjpegStream.h"
+#include "MjpegCompression.h"
 #include "MjpegLogComponent.h"
 
 #include <cstring>
@@ -35,6 +36,16 @@
  * You can also view yarp image ports from a browser.  Do a "yarp name query /portname" to find their port number NNN, then go to:
  *   http://localhost:NNN/?output=stream
  *
+ * The quality (1-100, default 75) and the chroma subsampling (444, 422 or
+ * 420, the default) of the images sent can be chosen in the query:
+ *   http://localhost:NNN/?output=stream&quality=90&subsampling=444
+ * or with the carrier modifiers of a connection:
+ *   yarp connect /images /view mjpeg+quality.90+subsampling.444
+ *
+ * Each image is compressed only once for all the mjpeg connections of the
+ * port that send it with the same settings, and each connection reuses its
+ * compressor for the following images.
+ *
  */
 class MjpegCarrier :
         public yarp::os::Carrier
@@ -43,6 +54,8 @@ private:
     bool firstRound;
     bool sender;
     std::string envelope;
+    MjpegSettings settings;
+    MjpegCompression compression;
 public:
     MjpegCarrier() {
         firstRound = true;
@@ -142,13 +155,7 @@ public:
         return true;
     }
 
-    bool expectExtraHeader(yarp::os::ConnectionState& proto) override {
-        std::string txt;
-        do {
-            txt = proto.is().readLine();
-        } while (txt!="");
-        return true;
-    }
+    bool expectExtraHeader(yarp::os::ConnectionState& proto) override;
 
     bool respondToHeader(yarp::os::ConnectionState& proto) override {
         std::string target = "HTTP/1.0 200 OK\r\n\
@@ -0,0 +1,348 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include "MjpegCompression.h"
+#include "MjpegLogComponent.h"
+
+#include <yarp/os/Log.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef MJPEG_HAS_TURBOJPEG
+
+#include <turbojpeg.h>
+
+#else // MJPEG_HAS_TURBOJPEG
+
+#include <csetjmp>
+#include <cstdio>
+
+#if defined(_WIN32)
+#define INT32 long  // jpeg's definition
+#define QGLOBAL_H 1
+#endif
+
+#ifdef _MSC_VER
+#pragma warning (push)
+#pragma warning (disable : 4091)
+#endif
+
+extern "C" {
+#include <jpeglib.h>
+}
+
+#ifdef _MSC_VER
+#pragma warning (pop)
+#endif
+
+#if defined(_WIN32)
+#undef INT32
+#undef QGLOBAL_H
+#endif
+
+#endif // MJPEG_HAS_TURBOJPEG
+
+
+using namespace yarp::os;
+using namespace yarp::sig;
+
+bool MjpegSettings::set(const std::string& key, const std::string& value)
+{
+    char* end = nullptr;
+    long number = std::strtol(value.c_str(), &end, 10);
+    bool isNumber = !value.empty() && *end == '\0';
+    if (key == "quality") {
+        if (!isNumber || number < 1 || number > 100) {
+            return false;
+        }
+        quality = static_cast<int>(number);
+        return true;
+    }
+    if (key == "subsampling") {
+        if (!isNumber || (number != 444 && number != 422 && number != 420)) {
+            return false;
+        }
+        subsampling = static_cast<int>(number);
+        return true;
+    }
+    return false;
+}
+
+std::string MjpegSettings::toQuery() const
+{
+    MjpegSettings defaults;
+    std::string query;
+    if (quality != defaults.quality) {
+        query += "&quality=" + std::to_string(quality);
+    }
+    if (subsampling != defaults.subsampling) {
+        query += "&subsampling=" + std::to_string(subsampling);
+    }
+    return query;
+}
+
+
+// The comment marker holds the comment and a null terminator, and its
+// length (two bytes) includes itself
+static const size_t max_comment_length = 0xFFFF - 3;
+
+#ifdef MJPEG_HAS_TURBOJPEG
+
+static void insert_comment(std::vector<unsigned char>& jpeg, const std::string& comment)
+{
+    // after the SOI marker, and after the JFIF APP0 marker if present
+    size_t at = 2;
+    if (jpeg.size() > 6 && jpeg[2] == 0xFF && jpeg[3] == 0xE0) {
+        at = 4 + ((jpeg[4] << 8) | jpeg[5]);
+    }
+    size_t length = comment.length() + 3;
+    std::vector<unsigned char> marker(length + 2);
+    marker[0] = 0xFF;
+    marker[1] = 0xFE;
+    marker[2] = static_cast<unsigned char>(length >> 8);
+    marker[3] = static_cast<unsigned char>(length & 0xFF);
+    memcpy(marker.data() + 4, comment.c_str(), comment.length() + 1);
+    jpeg.insert(jpeg.begin() + at, marker.begin(), marker.end());
+}
+
+class MjpegCompressionHelper
+{
+public:
+    tjhandle handle {nullptr};
+
+    bool compress(const Image& img, const MjpegSettings& settings, const std::string& comment, std::vector<unsigned char>& jpeg)
+    {
+        if (handle == nullptr) {
+            handle = tjInitCompress();
+            if (handle == nullptr) {
+                yCError(MJPEGCARRIER, "Cannot create the JPEG compressor: %s", tjGetErrorStr());
+                return false;
+            }
+        }
+
+        int format;
+        switch (img.getPixelCode()) {
+        case VOCAB_PIXEL_MONO: format = TJPF_GRAY; break;
+        case VOCAB_PIXEL_RGB:  format = TJPF_RGB;  break;
+        case VOCAB_PIXEL_BGR:  format = TJPF_BGR;  break;
+        case VOCAB_PIXEL_RGBA: format = TJPF_RGBA; break;
+        case VOCAB_PIXEL_BGRA: format = TJPF_BGRA; break;
+        default: return false;
+        }
+
+        int subsampling = TJSAMP_420;
+        if (format == TJPF_GRAY) {
+            subsampling = TJSAMP_GRAY;
+        } else if (settings.subsampling == 444) {
+            subsampling = TJSAMP_444;
+        } else if (settings.subsampling == 422) {
+            subsampling = TJSAMP_422;
+        }
+
+        int width = static_cast<int>(img.width());
+        int height = static_cast<int>(img.height());
+        unsigned long size = tjBufSize(width, height, subsampling);
+        jpeg.resize(size);
+        unsigned char* buf = jpeg.data();
+        if (tjCompress2(handle, img.getRawImage(), width, static_cast<int>(img.getRowSize()), height, format,
+                        &buf, &size, subsampling, settings.quality, TJFLAG_NOREALLOC) != 0) {
+            yCError(MJPEGCARRIER, "JPEG compression failed: %s", tjGetErrorStr());
+            return false;
+        }
+        jpeg.resize(size);
+        if (!comment.empty()) {
+            insert_comment(jpeg, comment);
+        }
+        return true;
+    }
+
+    ~MjpegCompressionHelper()
+    {
+        if (handle != nullptr) {
+            tjDestroy(handle);
+        }
+    }
+};
+
+#else // MJPEG_HAS_TURBOJPEG
+
+struct compress_error_mgr {
+    struct jpeg_error_mgr pub;
+    jmp_buf setjmp_buffer;
+};
+
+static void compress_error_exit(j_common_ptr cinfo)
+{
+    auto* err = reinterpret_cast<compress_error_mgr*>(cinfo->err);
+    (*cinfo->err->output_message)(cinfo);
+    longjmp(err->setjmp_buffer, 1);
+}
+
+// A destination growing a vector as needed
+struct vector_destination_mgr {
+    struct jpeg_destination_mgr pub;
+    std::vector<unsigned char>* jpeg;
+};
+
+static void init_vector_destination(j_compress_ptr cinfo)
+{
+    auto* dest = reinterpret_cast<vector_destination_mgr*>(cinfo->dest);
+    dest->jpeg->resize(std::max(dest->jpeg->capacity(), static_cast<size_t>(65536)));
+    dest->pub.next_output_byte = dest->jpeg->data();
+    dest->pub.free_in_buffer = dest->jpeg->size();
+}
+
+static boolean empty_vector_output_buffer(j_compress_ptr cinfo)
+{
+    auto* dest = reinterpret_cast<vector_destination_mgr*>(cinfo->dest);
+    size_t used = dest->jpeg->size();
+    dest->jpeg->resize(2 * used);
+    dest->pub.next_output_byte = dest->jpeg->data() + used;
+    dest->pub.free_in_buffer = dest->jpeg->size() - used;
+    return TRUE;
+}
+
+static void term_vector_destination(j_compress_ptr cinfo)
+{
+    auto* dest = reinterpret_cast<vector_destination_mgr*>(cinfo->dest);
+    dest->jpeg->resize(dest->jpeg->size() - dest->pub.free_in_buffer);
+}
+
+class MjpegCompressionHelper
+{
+public:
+    bool active {false};
+    struct jpeg_compress_struct cinfo;
+    struct compress_error_mgr jerr;
+    struct vector_destination_mgr dest;
+    std::vector<JSAMPROW> rows;
+
+    MjpegCompressionHelper()
+    {
+        memset(&cinfo, 0, sizeof(jpeg_compress_struct));
+        memset(&jerr, 0, sizeof(compress_error_mgr));
+        memset(&dest, 0, sizeof(vector_destination_mgr));
+    }
+
+    void init()
+    {
+        cinfo.err = jpeg_std_error(&jerr.pub);
+        jerr.pub.error_exit = compress_error_exit;
+        jpeg_create_compress(&cinfo);
+        dest.pub.init_destination = init_vector_destination;
+        dest.pub.empty_output_buffer = empty_vector_output_buffer;
+        dest.pub.term_destination = term_vector_destination;
+        cinfo.dest = &dest.pub;
+    }
+
+    bool compress(const Image& img, const MjpegSettings& settings, const std::string& comment, std::vector<unsigned char>& jpeg)
+    {
+        J_COLOR_SPACE space;
+        int components;
+        switch (img.getPixelCode()) {
+        case VOCAB_PIXEL_MONO: space = JCS_GRAYSCALE; components = 1; break;
+        case VOCAB_PIXEL_RGB:  space = JCS_RGB;       components = 3; break;
+        case VOCAB_PIXEL_BGR:  space = JCS_EXT_BGR;   components = 3; break;
+        case VOCAB_PIXEL_RGBA: space = JCS_EXT_RGBA;  components = 4; break;
+        case VOCAB_PIXEL_BGRA: space = JCS_EXT_BGRA;  components = 4; break;
+        default: return false;
+        }
+
+        if (!active) {
+            init();
+            active = true;
+        }
+
+        rows.resize(img.height());
+        for (size_t r = 0; r < img.height(); r++) {
+            rows[r] = img.getRawImage() + r * img.getRowSize();
+        }
+        dest.jpeg = &jpeg;
+
+        if (setjmp(jerr.setjmp_buffer)) {
+            jpeg_abort_compress(&cinfo);
+            return false;
+        }
+
+        cinfo.image_width = static_cast<JDIMENSION>(img.width());
+        cinfo.image_height = static_cast<JDIMENSION>(img.height());
+        cinfo.in_color_space = space;
+        cinfo.input_components = components;
+        jpeg_set_defaults(&cinfo);
+        jpeg_set_quality(&cinfo, settings.quality, TRUE);
+        if (components > 1) {
+            cinfo.comp_info[0].h_samp_factor = (settings.subsampling == 444) ? 1 : 2;
+            cinfo.comp_info[0].v_samp_factor = (settings.subsampling == 420) ? 2 : 1;
+        }
+        jpeg_start_compress(&cinfo, TRUE);
+        if (!comment.empty()) {
+            jpeg_write_marker(&cinfo, JPEG_COM, reinterpret_cast<const JOCTET*>(comment.c_str()), comment.length() + 1);
+        }
+        while (cinfo.next_scanline < cinfo.image_height) {
+            jpeg_write_scanlines(&cinfo, rows.data() + cinfo.next_scanline, cinfo.image_height - cinfo.next_scanline);
+        }
+        jpeg_finish_compress(&cinfo);
+        return true;
+    }
+
+    ~MjpegCompressionHelper()
+    {
+        if (active) {
+            jpeg_destroy_compress(&cinfo);
+        }
+    }
+};
+
+#endif // MJPEG_HAS_TURBOJPEG
+
+#define HELPER(x) (*((MjpegCompressionHelper*)(x)))
+
+MjpegCompression::MjpegCompression()
+{
+    system_resource = new MjpegCompressionHelper;
+    yCAssert(MJPEGCARRIER, system_resource != nullptr);
+}
+
+MjpegCompression::~MjpegCompression()
+{
+    if (system_resource != nullptr) {
+        delete &HELPER(system_resource);
+        system_resource = nullptr;
+    }
+}
+
+bool MjpegCompression::canCompress(int pixelCode)
+{
+    switch (pixelCode) {
+    case VOCAB_PIXEL_MONO:
+    case VOCAB_PIXEL_RGB:
+    case VOCAB_PIXEL_BGR:
+    case VOCAB_PIXEL_RGBA:
+    case VOCAB_PIXEL_BGRA:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool MjpegCompression::compress(const Image& image,
+                                const MjpegSettings& settings,
+                                const std::string& comment,
+                                std::vector<unsigned char>& jpeg)
+{
+    if (!canCompress(image.getPixelCode())) {
+        return false;
+    }
+    if (comment.length() > max_comment_length) {
+        yCWarning(MJPEGCARRIER, "Envelope too long, it will not be sent");
+        return HELPER(system_resource).compress(image, settings, {}, jpeg);
+    }
+    return HELPER(system_resource).compress(image, settings, comment, jpeg);
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#ifndef YARP2_MJPEGCOMPRESSION_INC
+#define YARP2_MJPEGCOMPRESSION_INC
+
+#include <yarp/sig/Image.h>
+
+#include <string>
+#include <vector>
+
+/**
+ * The parameters of the JPEG compression of a connection, that can be set
+ * as carrier modifiers (e.g. mjpeg+quality.60+subsampling.444) or in the
+ * query of the request of a browser (e.g. /?action=stream&quality=60).
+ */
+struct MjpegSettings
+{
+    // from 1 (worst) to 100 (best)
+    int quality {75};
+    // chroma subsampling, 444 (none), 422 (horizontal) or 420 (both)
+    int subsampling {420};
+
+    /**
+     * Sets a parameter from its textual value.
+     * @return false if the parameter or its value are not valid
+     */
+    bool set(const std::string& key, const std::string& value);
+
+    /**
+     * @return the parameters that differ from the default ones, as a
+     * query string (e.g. "&quality=60")
+     */
+    std::string toQuery() const;
+
+    bool operator==(const MjpegSettings& rhs) const
+    {
+        return quality == rhs.quality && subsampling == rhs.subsampling;
+    }
+};
+
+/**
+ * Compresses images to JPEG, reusing the same compressor for all the
+ * images.  The TurboJPEG API is used when it is available.
+ */
+class MjpegCompression
+{
+private:
+    void *system_resource;
+public:
+    MjpegCompression();
+
+    virtual ~MjpegCompression();
+
+    MjpegCompression(const MjpegCompression&) = delete;
+    MjpegCompression& operator=(const MjpegCompression&) = delete;
+
+    /**
+     * Check if images with this pixel code can be compressed.
+     */
+    static bool canCompress(int pixelCode);
+
+    /**
+     * Compress an image.
+     * @param image the image, of a type accepted by canCompress()
+     * @param settings the parameters of the compression
+     * @param comment text stored in a comment marker, if not empty
+     * @param[out] jpeg the compressed image
+     * @return true on success
+     */
+    bool compress(const yarp::sig::Image& image,
+                  const MjpegSettings& settings,
+                  const std::string& comment,
+                  std::vector<unsigned char>& jpeg);
+};
+
+#endif
@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include "Shmem2Carrier.h"
+#include "Shmem2LogComponent.h"
+#include "Shmem2Stream.h"
+
+#include <yarp/os/ConnectionState.h>
+#include <yarp/os/LogStream.h>
+#include <yarp/os/ManagedBytes.h>
+#include <yarp/os/Name.h>
+#include <yarp/os/NetType.h>
+#include <yarp/os/Route.h>
+#include <yarp/os/Value.h>
+
+#include <cstring>
+#include <string>
+
+using yarp::os::Bytes;
+using yarp::os::ConnectionState;
+using yarp::os::ManagedBytes;
+using yarp::os::NetInt32;
+using yarp::os::NetType;
+
+namespace {
+
+constexpr char shmem2Header[] = "SHMEM_V2";
+constexpr int maxNameLength = 255;
+
+std::uint32_t getSizeParam(yarp::os::Name& n, const char* param, std::uint32_t defaultValue, std::uint32_t minValue)
+{
+    bool hasField = false;
+    std::string strValue = n.getCarrierModifier(param, &hasField);
+    if (!hasField) {
+        return defaultValue;
+    }
+    yarp::os::Value* v = yarp::os::Value::makeValue(strValue);
+    std::uint32_t value = defaultValue;
+    if (v->isInt32() && v->asInt32() >= static_cast<std::int32_t>(minValue)) {
+        value = static_cast<std::uint32_t>(v->asInt32());
+    } else {
+        yCWarning(SHMEM2CARRIER, "Ignoring invalid value \"%s\" for %s", strValue.c_str(), param);
+    }
+    delete v;
+    return value;
+}
+
+} // namespace
+
+
+Shmem2Carrier::Shmem2Carrier() :
+        pending(nullptr)
+{
+}
+
+Shmem2Carrier::~Shmem2Carrier()
+{
+    delete pending;
+}
+
+yarp::os::Carrier* Shmem2Carrier::create() const
+{
+    return new Shmem2Carrier();
+}
+
+std::string Shmem2Carrier::getName() const
+{
+    return "shmem2";
+}
+
+bool Shmem2Carrier::requireAck() const
+{
+    // The rings are reliable and ordered, and the writer blocks when the
+    // reader does not keep up, there is nothing an ack would add.
+    return false;
+}
+
+bool Shmem2Carrier::isConnectionless() const
+{
+    return false;
+}
+
+bool Shmem2Carrier::checkHeader(const Bytes& header)
+{
+    if (header.length() != 8) {
+        return false;
+    }
+    return memcmp(header.get(), shmem2Header, 8) == 0;
+}
+
+void Shmem2Carrier::getHeader(Bytes& header) const
+{
+    if (header.length() == 8) {
+        memcpy(header.get(), shmem2Header, 8);
+    }
+}
+
+void Shmem2Carrier::setParameters(const Bytes& header)
+{
+    YARP_UNUSED(header);
+}
+
+bool Shmem2Carrier::sendHeader(ConnectionState& proto)
+{
+    // i am the sender
+    if (!defaultSendHeader(proto)) {
+        return false;
+    }
+
+    yarp::os::Name n(proto.getRoute().getCarrierName() + "://test");
+    std::uint32_t slots = getSizeParam(n, "slots", Shmem2Stream::defaultSlotCount, 2);
+    std::uint32_t slotSize = getSizeParam(n, "slot_size", Shmem2Stream::defaultSlotSize, 64);
+
+    delete pending;
+    pending = new Shmem2Stream();
+    if (!pending->create(slots, slotSize)) {
+        delete pending;
+        pending = nullptr;
+        return false;
+    }
+
+    const std::string& name = pending->getName();
+    NetInt32 numberSrc;
+    Bytes number(reinterpret_cast<char*>(&numberSrc), sizeof(NetInt32));
+    NetType::netInt(static_cast<int>(name.length()), number);
+    proto.os().write(number);
+    proto.os().write(Bytes(const_cast<char*>(name.c_str()), name.length()));
+    proto.os().flush();
+    return proto.os().isOk();
+}
+
+bool Shmem2Carrier::respondToHeader(ConnectionState& proto)
+{
+    // i am the receiver
+    NetInt32 numberSrc;
+    Bytes number(reinterpret_cast<char*>(&numberSrc), sizeof(NetInt32));
+    if (proto.is().readFull(number) != static_cast<yarp::conf::ssize_t>(number.length())) {
+        yCError(SHMEM2CARRIER, "Did not get segment name length");
+        return false;
+    }
+    int len = NetType::netInt(number);
+    if (len < 1 || len > maxNameLength) {
+        yCError(SHMEM2CARRIER, "Invalid segment name length %d", len);
+        return false;
+    }
+    ManagedBytes b(static_cast<size_t>(len));
+    if (proto.is().readFull(b.bytes()) != len) {
+        yCError(SHMEM2CARRIER, "Did not get segment name");
+        return false;
+    }
+    std::string name(b.get(), static_cast<size_t>(len));
+
+    auto* stream = new Shmem2Stream();
+    bool ok = stream->attach(name);
+    writeYarpInt(ok ? 1 : 0, proto);
+    proto.os().flush();
+    if (!ok || !proto.os().isOk()) {
+        delete stream;
+        return false;
+    }
+    become(proto, stream);
+    return true;
+}
+
+bool Shmem2Carrier::expectReplyToHeader(ConnectionState& proto)
+{
+    // i am the sender
+    if (pending == nullptr) {
+        return false;
+    }
+    int attached = readYarpInt(proto);
+    // The receiver holds a mapping by now (or will never hold one), so the
+    // name is not needed anymore.
+    pending->unlink();
+    if (attached != 1) {
+        yCError(SHMEM2CARRIER, "Receiver could not attach to segment %s", pending->getName().c_str());
+        delete pending;
+        pending = nullptr;
+        return false;
+    }
+    Shmem2Stream* stream = pending;
+    pending = nullptr;
+    become(proto, stream);
+    return true;
+}
+
+void Shmem2Carrier::become(ConnectionState& proto, Shmem2Stream* stream)
+{
+    stream->setAddresses(proto.getStreams().getLocalAddress(),
+                         proto.getStreams().getRemoteAddress());
+    // The tcp stream is not needed anymore, from now on all the traffic,
+    // including replies, goes through the segment.
+    proto.takeStreams(nullptr);
+    proto.takeStreams(stream);
+}
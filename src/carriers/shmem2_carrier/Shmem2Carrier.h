@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#ifndef YARP_SHMEM2_SHMEM2CARRIER_H
+#define YARP_SHMEM2_SHMEM2CARRIER_H
+
+#include <yarp/os/AbstractCarrier.h>
+
+#include <cstdint>
+
+class Shmem2Stream;
+
+/**
+ * Communicating between two ports on the same machine via a POSIX shared
+ * memory segment.
+ *
+ * The connection starts on tcp.  The sender then creates a segment with
+ * one ring of slots per direction and sends its name to the receiver,
+ * that attaches to it.  From then on no socket is involved: data is
+ * copied into the slots of the ring, and the two sides wake each other
+ * up using futexes only when one of them is waiting.
+ *
+ * The geometry of the rings can be set from the carrier name, for
+ * example "shmem2+slots.16+slot_size.262144".
+ */
+class Shmem2Carrier : public yarp::os::AbstractCarrier
+{
+public:
+    Shmem2Carrier();
+    virtual ~Shmem2Carrier();
+
+    Carrier* create() const override;
+
+    std::string getName() const override;
+
+    bool requireAck() const override;
+    bool isConnectionless() const override;
+    bool checkHeader(const yarp::os::Bytes& header) override;
+    void getHeader(yarp::os::Bytes& header) const override;
+    void setParameters(const yarp::os::Bytes& header) override;
+    bool sendHeader(yarp::os::ConnectionState& proto) override;
+    bool respondToHeader(yarp::os::ConnectionState& proto) override;
+    bool expectReplyToHeader(yarp::os::ConnectionState& proto) override;
+
+private:
+    void become(yarp::os::ConnectionState& proto, Shmem2Stream* stream);
+
+    Shmem2Stream* pending;
+};
+
+#endif // YARP_SHMEM2_SHMEM2CARRIER_H
@@ -0,0 +1,437 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include "Shmem2Stream.h"
+#include "Shmem2LogComponent.h"
+
+#include <yarp/os/Bytes.h>
+#include <yarp/os/LogStream.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <ctime>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#  include <linux/futex.h>
+#  include <sys/syscall.h>
+#endif
+
+using yarp::os::Bytes;
+using yarp::os::Contact;
+
+namespace {
+
+constexpr std::uint32_t SHMEM2_MAGIC = 0x32534d59; // "YMS2"
+constexpr std::uint32_t SHMEM2_VERSION = 1;
+
+// Space reserved in front of the data of every slot, holding its length.
+constexpr size_t SHMEM2_SLOT_HEADER = 64;
+
+// How long to sleep before checking again that the peer is alive.
+constexpr long SHMEM2_WAIT_NSEC = 100 * 1000 * 1000;
+
+std::atomic<unsigned int> segmentCounter{0};
+
+size_t align64(size_t x)
+{
+    return (x + 63) & ~static_cast<size_t>(63);
+}
+
+size_t slotStride(std::uint32_t slotSize)
+{
+    return SHMEM2_SLOT_HEADER + align64(slotSize);
+}
+
+size_t segmentSize(std::uint32_t slotCount, std::uint32_t slotSize)
+{
+    return align64(sizeof(Shmem2Segment)) + 2 * static_cast<size_t>(slotCount) * slotStride(slotSize);
+}
+
+#if defined(__linux__)
+void futexWait(std::atomic<std::uint32_t>& word, std::uint32_t expected)
+{
+    struct timespec ts;
+    ts.tv_sec = 0;
+    ts.tv_nsec = SHMEM2_WAIT_NSEC;
+    // Not FUTEX_PRIVATE_FLAG: the word lives in memory shared with
+    // another process.
+    syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT, expected, &ts, nullptr, 0);
+}
+
+void futexWake(std::atomic<std::uint32_t>& word)
+{
+    syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+#else
+// No futexes available, poll the word.
+void futexWait(std::atomic<std::uint32_t>& word, std::uint32_t expected)
+{
+    struct timespec ts;
+    ts.tv_sec = 0;
+    ts.tv_nsec = 50 * 1000;
+    for (long slept = 0; slept < SHMEM2_WAIT_NSEC && word.load() == expected; slept += ts.tv_nsec) {
+        nanosleep(&ts, nullptr);
+    }
+}
+
+void futexWake(std::atomic<std::uint32_t>& word)
+{
+    YARP_UNUSED(word);
+}
+#endif
+
+void wakeAll(Shmem2Ring& ring)
+{
+    ring.dataSeq.fetch_add(1);
+    ring.spaceSeq.fetch_add(1);
+    futexWake(ring.dataSeq);
+    futexWake(ring.spaceSeq);
+}
+
+} // namespace
+
+
+Shmem2Stream::Shmem2Stream() :
+        base(nullptr),
+        size(0),
+        segment(nullptr),
+        slotCount(0),
+        slotSize(0),
+        self(0),
+        linked(false),
+        happy(false),
+        readIndex(0),
+        readOffset(0),
+        writeOffset(0),
+        writeAcquired(false)
+{
+}
+
+Shmem2Stream::~Shmem2Stream()
+{
+    close();
+    if (base != nullptr) {
+        munmap(base, size);
+        base = nullptr;
+        segment = nullptr;
+    }
+}
+
+bool Shmem2Stream::map(int fd, size_t len)
+{
+    void* addr = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        yCError(SHMEM2CARRIER, "Cannot map segment %s: %s", name.c_str(), strerror(errno));
+        return false;
+    }
+    base = static_cast<char*>(addr);
+    size = len;
+    segment = reinterpret_cast<Shmem2Segment*>(base);
+    return true;
+}
+
+bool Shmem2Stream::create(std::uint32_t slotCount, std::uint32_t slotSize)
+{
+    name = "/yarp-shmem2-" + std::to_string(getpid()) + "-" + std::to_string(segmentCounter++);
+    size_t len = segmentSize(slotCount, slotSize);
+
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        yCError(SHMEM2CARRIER, "Cannot create segment %s: %s", name.c_str(), strerror(errno));
+        return false;
+    }
+    linked = true;
+    if (ftruncate(fd, static_cast<off_t>(len)) != 0) {
+        yCError(SHMEM2CARRIER, "Cannot resize segment %s: %s", name.c_str(), strerror(errno));
+        ::close(fd);
+        unlink();
+        return false;
+    }
+    if (!map(fd, len)) {
+        unlink();
+        return false;
+    }
+
+    // A fresh segment is zero filled, only the geometry needs to be set.
+    segment->slotCount = slotCount;
+    segment->slotSize = slotSize;
+    segment->version = SHMEM2_VERSION;
+    segment->pid[0].store(getpid());
+    std::atomic_thread_fence(std::memory_order_release);
+    segment->magic = SHMEM2_MAGIC;
+    this->slotCount = slotCount;
+    this->slotSize = slotSize;
+
+    self = 0;
+    happy = true;
+    yCDebug(SHMEM2CARRIER, "Created segment %s (%u slots of %u bytes)", name.c_str(), slotCount, slotSize);
+    return true;
+}
+
+bool Shmem2Stream::attach(const std::string& segmentName)
+{
+    name = segmentName;
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        yCError(SHMEM2CARRIER, "Cannot open segment %s: %s", name.c_str(), strerror(errno));
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Shmem2Segment)) {
+        yCError(SHMEM2CARRIER, "Segment %s is too small", name.c_str());
+        ::close(fd);
+        return false;
+    }
+    if (!map(fd, static_cast<size_t>(st.st_size))) {
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // The geometry is read once: the peer cannot change it afterwards to
+    // make this side access memory out of the segment.
+    slotCount = segment->slotCount;
+    slotSize = segment->slotSize;
+    if (segment->magic != SHMEM2_MAGIC || segment->version != SHMEM2_VERSION || slotCount == 0 || slotSize == 0 || segmentSize(slotCount, slotSize) > size) {
+        yCError(SHMEM2CARRIER, "Segment %s has an unexpected layout", name.c_str());
+        return false;
+    }
+    segment->pid[1].store(getpid());
+
+    self = 1;
+    happy = true;
+    return true;
+}
+
+void Shmem2Stream::unlink()
+{
+    if (linked) {
+        shm_unlink(name.c_str());
+        linked = false;
+    }
+}
+
+const std::string& Shmem2Stream::getName() const
+{
+    return name;
+}
+
+void Shmem2Stream::setAddresses(const Contact& local, const Contact& remote)
+{
+    localAddress = local;
+    remoteAddress = remote;
+}
+
+char* Shmem2Stream::slot(int dir, std::uint64_t index) const
+{
+    size_t stride = slotStride(slotSize);
+    size_t first = align64(sizeof(Shmem2Segment)) + dir * static_cast<size_t>(slotCount) * stride;
+    return base + first + static_cast<size_t>(index % slotCount) * stride;
+}
+
+bool Shmem2Stream::peerAlive() const
+{
+    std::int32_t pid = segment->pid[1 - self].load();
+    if (pid <= 0) {
+        return true;
+    }
+    return kill(pid, 0) == 0 || errno == EPERM;
+}
+
+bool Shmem2Stream::waitData(Shmem2Ring& ring)
+{
+    while (ring.tail.load(std::memory_order_acquire) <= readIndex) {
+        if (!happy || segment->closed.load() != 0) {
+            return false;
+        }
+        std::uint32_t seq = ring.dataSeq.load();
+        ring.readerWaiting.store(1);
+        if (ring.tail.load() > readIndex) {
+            ring.readerWaiting.store(0);
+            break;
+        }
+        futexWait(ring.dataSeq, seq);
+        ring.readerWaiting.store(0);
+        if (!peerAlive()) {
+            yCDebug(SHMEM2CARRIER, "Peer of segment %s is gone", name.c_str());
+            happy = false;
+        }
+    }
+    return true;
+}
+
+bool Shmem2Stream::waitSpace(Shmem2Ring& ring)
+{
+    std::uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+    while (tail - ring.head.load(std::memory_order_acquire) >= slotCount) {
+        if (!happy || segment->closed.load() != 0) {
+            return false;
+        }
+        std::uint32_t seq = ring.spaceSeq.load();
+        ring.writerWaiting.store(1);
+        if (tail - ring.head.load() < slotCount) {
+            ring.writerWaiting.store(0);
+            break;
+        }
+        futexWait(ring.spaceSeq, seq);
+        ring.writerWaiting.store(0);
+        if (!peerAlive()) {
+            yCDebug(SHMEM2CARRIER, "Peer of segment %s is gone", name.c_str());
+            happy = false;
+        }
+    }
+    return happy && segment->closed.load() == 0;
+}
+
+void Shmem2Stream::publish()
+{
+    Shmem2Ring& ring = segment->ring[self];
+    std::uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+    char* s = slot(self, tail);
+    *reinterpret_cast<std::uint32_t*>(s) = writeOffset;
+    ring.tail.store(tail + 1);
+    ring.dataSeq.fetch_add(1);
+    if (ring.readerWaiting.load() != 0) {
+        futexWake(ring.dataSeq);
+    }
+    writeAcquired = false;
+    writeOffset = 0;
+}
+
+yarp::conf::ssize_t Shmem2Stream::read(Bytes& b)
+{
+    if (segment == nullptr) {
+        return -1;
+    }
+    if (b.length() == 0) {
+        return 0;
+    }
+    Shmem2Ring& ring = segment->ring[1 - self];
+    if (!waitData(ring)) {
+        return -1;
+    }
+
+    const char* s = slot(1 - self, readIndex);
+    std::uint32_t len = *reinterpret_cast<const std::uint32_t*>(s);
+    if (len > slotSize || len <= readOffset) {
+        yCError(SHMEM2CARRIER, "Segment %s has a corrupted slot (%u bytes of %u)", name.c_str(), len, slotSize);
+        happy = false;
+        return -1;
+    }
+    size_t n = std::min(b.length(), static_cast<size_t>(len - readOffset));
+    memcpy(b.get(), s + SHMEM2_SLOT_HEADER + readOffset, n);
+    readOffset += static_cast<std::uint32_t>(n);
+
+    if (readOffset >= len) {
+        readOffset = 0;
+        readIndex++;
+        ring.head.store(readIndex);
+        ring.spaceSeq.fetch_add(1);
+        if (ring.writerWaiting.load() != 0) {
+            futexWake(ring.spaceSeq);
+        }
+    }
+    return static_cast<yarp::conf::ssize_t>(n);
+}
+
+void Shmem2Stream::write(const Bytes& b)
+{
+    if (segment == nullptr) {
+        happy = false;
+        return;
+    }
+    Shmem2Ring& ring = segment->ring[self];
+    const char* data = b.get();
+    size_t remaining = b.length();
+    while (remaining > 0) {
+        if (!writeAcquired) {
+            if (!waitSpace(ring)) {
+                happy = false;
+                return;
+            }
+            writeAcquired = true;
+            writeOffset = 0;
+        }
+        char* s = slot(self, ring.tail.load(std::memory_order_relaxed));
+        size_t n = std::min(remaining, static_cast<size_t>(slotSize - writeOffset));
+        memcpy(s + SHMEM2_SLOT_HEADER + writeOffset, data, n);
+        writeOffset += static_cast<std::uint32_t>(n);
+        data += n;
+        remaining -= n;
+        if (writeOffset == slotSize) {
+            publish();
+        }
+    }
+}
+
+void Shmem2Stream::flush()
+{
+    if (segment != nullptr && writeAcquired && writeOffset > 0) {
+        publish();
+    }
+}
+
+yarp::os::InputStream& Shmem2Stream::getInputStream()
+{
+    return *this;
+}
+
+yarp::os::OutputStream& Shmem2Stream::getOutputStream()
+{
+    return *this;
+}
+
+const Contact& Shmem2Stream::getLocalAddress() const
+{
+    return localAddress;
+}
+
+const Contact& Shmem2Stream::getRemoteAddress() const
+{
+    return remoteAddress;
+}
+
+bool Shmem2Stream::isOk() const
+{
+    return happy && segment != nullptr && segment->closed.load() == 0;
+}
+
+void Shmem2Stream::reset()
+{
+}
+
+void Shmem2Stream::interrupt()
+{
+    if (segment != nullptr) {
+        segment->closed.store(1);
+        wakeAll(segment->ring[0]);
+        wakeAll(segment->ring[1]);
+    }
+}
+
+void Shmem2Stream::close()
+{
+    unlink();
+    interrupt();
+    happy = false;
+}
+
+void Shmem2Stream::beginPacket()
+{
+}
+
+void Shmem2Stream::endPacket()
+{
+}
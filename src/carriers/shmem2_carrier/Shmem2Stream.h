@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#ifndef YARP_SHMEM2_SHMEM2STREAM_H
+#define YARP_SHMEM2_SHMEM2STREAM_H
+
+#include <yarp/os/Contact.h>
+#include <yarp/os/InputStream.h>
+#include <yarp/os/OutputStream.h>
+#include <yarp/os/TwoWayStream.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+
+/**
+ * Control block of one direction of a shmem2 connection.
+ *
+ * The ring is single-producer/single-consumer: the writer owns `tail`
+ * and the reader owns `head`.  Both counters grow monotonically, the
+ * slot in use is `counter % slotCount`.  The `dataSeq` and `spaceSeq`
+ * words are the futex words the reader and the writer sleep on when
+ * the ring is empty or full; the `*Waiting` flags let the other side
+ * skip the wake-up syscall when nobody is sleeping.
+ */
+struct Shmem2Ring
+{
+    alignas(64) std::atomic<std::uint64_t> head;
+    alignas(64) std::atomic<std::uint64_t> tail;
+    alignas(64) std::atomic<std::uint32_t> dataSeq;
+    std::atomic<std::uint32_t> readerWaiting;
+    std::atomic<std::uint32_t> spaceSeq;
+    std::atomic<std::uint32_t> writerWaiting;
+};
+
+/**
+ * Header at the beginning of the shared memory segment.
+ */
+struct Shmem2Segment
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t slotCount;
+    std::uint32_t slotSize;
+    std::atomic<std::int32_t> pid[2];
+    std::atomic<std::uint32_t> closed;
+    Shmem2Ring ring[2];
+};
+
+
+/**
+ * A stream over a shared memory segment holding two lock-free rings of
+ * fixed size slots, one for each direction.
+ *
+ * Data written to the stream is copied straight into the current slot
+ * of the outgoing ring, and the slot is published when it is full or
+ * when the stream is flushed.  The messages are still serialized by the
+ * generic connection writer first: only the large blocks it references
+ * without copying them (e.g. image pixels) go into the slots in one
+ * copy.  The reader copies the data out of the slots of the incoming
+ * ring.  Waiting for data or space uses futexes on the shared segment,
+ * so that no system call is needed while both sides keep up with each
+ * other.
+ */
+class Shmem2Stream :
+        public yarp::os::TwoWayStream,
+        public yarp::os::InputStream,
+        public yarp::os::OutputStream
+{
+public:
+    static constexpr std::uint32_t defaultSlotCount = 8;
+    static constexpr std::uint32_t defaultSlotSize = 128 * 1024;
+
+    Shmem2Stream();
+    virtual ~Shmem2Stream();
+
+    /**
+     * Create a new segment.  The creator of the segment is the sender of
+     * the connection.
+     */
+    bool create(std::uint32_t slotCount, std::uint32_t slotSize);
+
+    /**
+     * Attach to a segment created by the other side of the connection.
+     */
+    bool attach(const std::string& name);
+
+    /**
+     * Remove the name of the segment from the system.  The segment stays
+     * alive until both sides unmap it.
+     */
+    void unlink();
+
+    const std::string& getName() const;
+
+    void setAddresses(const yarp::os::Contact& local, const yarp::os::Contact& remote);
+
+    // TwoWayStream
+    yarp::os::InputStream& getInputStream() override;
+    yarp::os::OutputStream& getOutputStream() override;
+    const yarp::os::Contact& getLocalAddress() const override;
+    const yarp::os::Contact& getRemoteAddress() const override;
+    bool isOk() const override;
+    void reset() override;
+    void close() override;
+    void interrupt() override;
+    void beginPacket() override;
+    void endPacket() override;
+
+    // InputStream
+    using yarp::os::InputStream::read;
+    yarp::conf::ssize_t read(yarp::os::Bytes& b) override;
+
+    // OutputStream
+    using yarp::os::OutputStream::write;
+    void write(const yarp::os::Bytes& b) override;
+    void flush() override;
+
+private:
+    bool map(int fd, size_t size);
+    char* slot(int dir, std::uint64_t index) const;
+    bool peerAlive() const;
+    bool waitData(Shmem2Ring& ring);
+    bool waitSpace(Shmem2Ring& ring);
+    void publish();
+
+    std::string name;
+    char* base;
+    size_t size;
+    Shmem2Segment* segment;
+    std::uint32_t slotCount;
+    std::uint32_t slotSize;
+    int self;
+    bool linked;
+    bool happy;
+
+    // reader state, on ring[1 - self]
+    std::uint64_t readIndex;
+    std::uint32_t readOffset;
+
+    // writer state, on ring[self]
+    std::uint32_t writeOffset;
+    bool writeAcquired;
+
+    yarp::os::Contact localAddress;
+    yarp::os::Contact remoteAddress;
+};
+
+#endif // YARP_SHMEM2_SHMEM2STREAM_H
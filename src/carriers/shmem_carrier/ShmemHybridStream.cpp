@@ -173,6 +173,13 @@ void ShmemHybridStream::write(const yarp::os::Bytes& b)
     }
 }
 
+void ShmemHybridStream::writev(const yarp::os::Bytes* blocks, size_t count)
+{
+    if (!out.write(blocks, count)) {
+        close();
+    }
+}
+
 yarp::conf::ssize_t ShmemHybridStream::read(yarp::os::Bytes& b)
 {
     yarp::conf::ssize_t ret = in.read(b);
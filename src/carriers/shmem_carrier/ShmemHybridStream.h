@@ -38,6 +38,7 @@ public:
 
     using yarp::os::OutputStream::write;
     void write(const yarp::os::Bytes& b) override;
+    void writev(const yarp::os::Bytes* blocks, size_t count) override;
 
     using yarp::os::InputStream::read;
     yarp::conf::ssize_t read(yarp::os::Bytes& b) override;
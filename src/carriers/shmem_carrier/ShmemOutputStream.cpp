@@ -185,6 +185,11 @@ bool ShmemOutputStreamImpl::Resize(int newsize)
 }
 
 bool ShmemOutputStreamImpl::write(const yarp::os::Bytes& b)
+{
+    return write(&b, 1);
+}
+
+bool ShmemOutputStreamImpl::write(const yarp::os::Bytes* blocks, size_t count)
 {
     if (!m_bOpen) {
         return false;
@@ -202,22 +207,30 @@ bool ShmemOutputStreamImpl::write(const yarp::os::Bytes& b)
         return false;
     }
 
-    if ((int)m_pHeader->size - (int)m_pHeader->avail < (int)b.length()) {
-        yarp::conf::ssize_t required = m_pHeader->size + 2 * b.length();
-        Resize((int)required);
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        total += blocks[i].length();
     }
 
-    if ((int)m_pHeader->head + (int)b.length() <= (int)m_pHeader->size) {
-        memcpy(m_pData + m_pHeader->head, b.get(), b.length());
-    } else {
-        int first_block_size = m_pHeader->size - m_pHeader->head;
-        memcpy(m_pData + m_pHeader->head, b.get(), first_block_size);
-        memcpy(m_pData, b.get() + first_block_size, b.length() - first_block_size);
+    if ((int)m_pHeader->size - (int)m_pHeader->avail < (int)total) {
+        yarp::conf::ssize_t required = m_pHeader->size + 2 * total;
+        Resize((int)required);
     }
 
-    m_pHeader->avail += (int)b.length();
-    m_pHeader->head += (int)b.length();
-    m_pHeader->head %= m_pHeader->size;
+    for (size_t i = 0; i < count; ++i) {
+        const yarp::os::Bytes& b = blocks[i];
+        if ((int)m_pHeader->head + (int)b.length() <= (int)m_pHeader->size) {
+            memcpy(m_pData + m_pHeader->head, b.get(), b.length());
+        } else {
+            int first_block_size = m_pHeader->size - m_pHeader->head;
+            memcpy(m_pData + m_pHeader->head, b.get(), first_block_size);
+            memcpy(m_pData, b.get() + first_block_size, b.length() - first_block_size);
+        }
+
+        m_pHeader->avail += (int)b.length();
+        m_pHeader->head += (int)b.length();
+        m_pHeader->head %= m_pHeader->size;
+    }
 
     while (m_pHeader->waiting > 0) {
         --m_pHeader->waiting;
@@ -45,6 +45,7 @@ public:
     bool isOk() const;
     bool open(int port, int size = SHMEM_DEFAULT_SIZE);
     bool write(const yarp::os::Bytes& b);
+    bool write(const yarp::os::Bytes* blocks, size_t count);
     void close();
 
 protected:
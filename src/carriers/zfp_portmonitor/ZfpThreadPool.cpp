@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include "ZfpThreadPool.h"
+
+ZfpThreadPool::ZfpThreadPool(size_t threads)
+{
+    for (size_t i = 1; i < threads; i++) {
+        workers.emplace_back(&ZfpThreadPool::work, this);
+    }
+}
+
+ZfpThreadPool::~ZfpThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    started.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+size_t ZfpThreadPool::size() const
+{
+    return workers.size() + 1;
+}
+
+void ZfpThreadPool::run(size_t count, const std::function<void(size_t)>& task)
+{
+    if (count == 0) {
+        return;
+    }
+    if (workers.empty() || count == 1) {
+        for (size_t i = 0; i < count; i++) {
+            task(i);
+        }
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    this->task = &task;
+    this->count = count;
+    next = 0;
+    pending = count;
+    generation++;
+    started.notify_all();
+    runTasks(lock);
+    finished.wait(lock, [this]() { return pending == 0; });
+    this->task = nullptr;
+}
+
+void ZfpThreadPool::runTasks(std::unique_lock<std::mutex>& lock)
+{
+    while (next < count) {
+        size_t i = next++;
+        lock.unlock();
+        (*task)(i);
+        lock.lock();
+        if (--pending == 0) {
+            finished.notify_all();
+        }
+    }
+}
+
+void ZfpThreadPool::work()
+{
+    size_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        started.wait(lock, [&]() { return stopping || generation != seen; });
+        if (stopping) {
+            return;
+        }
+        seen = generation;
+        runTasks(lock);
+    }
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#ifndef YARP_ZFP_CARRIER_ZFPTHREADPOOL_H
+#define YARP_ZFP_CARRIER_ZFPTHREADPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A few threads, kept for all the frames of a connection, that compress or
+ * decompress the tiles of an image at the same time.
+ */
+class ZfpThreadPool
+{
+public:
+    /**
+     * @param threads the number of threads running the tasks, including
+     *        the one calling run()
+     */
+    explicit ZfpThreadPool(size_t threads);
+    ~ZfpThreadPool();
+
+    ZfpThreadPool(const ZfpThreadPool&) = delete;
+    ZfpThreadPool& operator=(const ZfpThreadPool&) = delete;
+
+    size_t size() const;
+
+    /**
+     * Calls task(i) for each i from 0 to count - 1, on the threads of the
+     * pool and on the calling one, and returns when all the calls are done.
+     */
+    void run(size_t count, const std::function<void(size_t)>& task);
+
+private:
+    void work();
+    // runs the tasks not started yet, with the mutex locked
+    void runTasks(std::unique_lock<std::mutex>& lock);
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable started;
+    std::condition_variable finished;
+    const std::function<void(size_t)>* task {nullptr};
+    size_t count {0};
+    size_t next {0};
+    size_t pending {0};
+    size_t generation {0};
+    bool stopping {false};
+};
+
+#endif
@@ -8,17 +8,28 @@
 
 #include "zfpPortmonitor.h"
 
+#include <yarp/os/Bottle.h>
+#include <yarp/os/ConnectionReader.h>
+#include <yarp/os/ConnectionWriter.h>
 #include <yarp/os/LogComponent.h>
+#include <yarp/os/Name.h>
 #include <yarp/sig/Image.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
 #include <cstring>
 #include <cmath>
-#include <algorithm>
 
 extern "C" {
     #include "zfp.h"
 }
 
+// the reversible mode is available since zfp 0.5.5
+#if defined(ZFP_VERSION) && ZFP_VERSION >= 0x0055
+#define ZFP_HAS_REVERSIBLE 1
+#endif
+
 using namespace yarp::os;
 using namespace yarp::sig;
 
@@ -29,46 +40,357 @@ YARP_LOG_COMPONENT(ZFPMONITOR,
                    yarp::os::Log::LogTypeReserved,
                    yarp::os::Log::printCallback(),
                    nullptr)
+
+const char* const parameterNames[] = {"mode", "accuracy", "precision", "rate", "threads"};
+
+bool setMode(zfp_stream* zfp, yarp::conf::vocab32_t mode, double parameter)
+{
+    switch (mode) {
+    case VOCAB_ZFP_ACCURACY:
+        zfp_stream_set_accuracy(zfp, parameter);
+        return true;
+    case VOCAB_ZFP_PRECISION:
+        zfp_stream_set_precision(zfp, static_cast<unsigned int>(parameter));
+        return true;
+    case VOCAB_ZFP_RATE:
+        zfp_stream_set_rate(zfp, parameter, zfp_type_float, 2, 0);
+        return true;
+#ifdef ZFP_HAS_REVERSIBLE
+    case VOCAB_ZFP_LOSSLESS:
+        zfp_stream_set_reversible(zfp);
+        return true;
+#endif
+    default:
+        return false;
+    }
 }
 
+// The rows of a tile, that can be in a larger image
+zfp_field* tileField(const float* data, size_t width, size_t rows, size_t rowSize)
+{
+    zfp_field* field = zfp_field_2d(const_cast<float*>(data), zfp_type_float,
+                                    static_cast<unsigned int>(width),
+                                    static_cast<unsigned int>(rows));
+    zfp_field_set_stride_2d(field, 1, static_cast<int>(rowSize / sizeof(float)));
+    return field;
+}
 
-bool ZfpMonitorObject::create(const yarp::os::Property& options)
+size_t tileRowsAt(size_t height, size_t tileRows, size_t tile)
 {
-    shouldCompress = (options.find("sender_side").asBool());
-    compressed = nullptr;
-    decompressed = nullptr;
-    buffer = nullptr;
-    sizeToAllocate = 0;
-    sizeToAllocateB = 0;
-    return true;
+    return std::min(tileRows, height - tile * tileRows);
 }
 
-void ZfpMonitorObject::destroy(void)
+} // namespace
+
+
+bool ZfpSettings::set(const std::string& key, const std::string& value)
 {
-    if(compressed){
-        free(compressed);
-        compressed = nullptr;
+    char* end = nullptr;
+    double number = std::strtod(value.c_str(), &end);
+    bool isNumber = !value.empty() && *end == '\0';
+    if (key == "mode") {
+        if (value == "accuracy") {
+            mode = VOCAB_ZFP_ACCURACY;
+        } else if (value == "precision") {
+            mode = VOCAB_ZFP_PRECISION;
+        } else if (value == "rate") {
+            mode = VOCAB_ZFP_RATE;
+#ifdef ZFP_HAS_REVERSIBLE
+        } else if (value == "lossless") {
+            mode = VOCAB_ZFP_LOSSLESS;
+#endif
+        } else {
+            return false;
+        }
+        return true;
     }
+    if (key == "accuracy") {
+        if (!isNumber || !(number > 0)) {
+            return false;
+        }
+        accuracy = number;
+        return true;
+    }
+    if (key == "precision") {
+        if (!isNumber || number < 1 || number > 32 || number != std::floor(number)) {
+            return false;
+        }
+        precision = static_cast<int>(number);
+        return true;
+    }
+    if (key == "rate") {
+        if (!isNumber || !(number > 0) || number > 32) {
+            return false;
+        }
+        rate = number;
+        return true;
+    }
+    if (key == "threads") {
+        if (!isNumber || number < 0 || number > 256 || number != std::floor(number)) {
+            return false;
+        }
+        threads = static_cast<int>(number);
+        return true;
+    }
+    return false;
+}
 
-    if(buffer){
-        free(buffer);
-        buffer = nullptr;
+void ZfpSettings::toProperty(Property& params) const
+{
+    switch (mode) {
+    case VOCAB_ZFP_PRECISION: params.put("mode", "precision"); break;
+    case VOCAB_ZFP_RATE: params.put("mode", "rate"); break;
+    case VOCAB_ZFP_LOSSLESS: params.put("mode", "lossless"); break;
+    case VOCAB_ZFP_ACCURACY:
+    default: params.put("mode", "accuracy"); break;
     }
+    params.put("accuracy", accuracy);
+    params.put("precision", precision);
+    params.put("rate", rate);
+    params.put("threads", threads);
+}
 
-    if(decompressed){
-        free(decompressed);
-        decompressed = nullptr;
+double ZfpSettings::parameter() const
+{
+    switch (mode) {
+    case VOCAB_ZFP_ACCURACY: return accuracy;
+    case VOCAB_ZFP_PRECISION: return precision;
+    case VOCAB_ZFP_RATE: return rate;
+    default: return 0.0;
     }
 }
 
+
+bool ZfpFrame::isLegacy() const
+{
+    return tiles() == 1 && mode == VOCAB_ZFP_ACCURACY && parameter == 1e-3;
+}
+
+bool ZfpFrame::write(ConnectionWriter& connection) const
+{
+    size_t size = 0;
+    for (size_t tileSize : sizes) {
+        size += tileSize;
+    }
+
+    if (connection.isTextMode()) {
+        Bottle b;
+        b.addInt32(static_cast<std::int32_t>(width));
+        b.addInt32(static_cast<std::int32_t>(height));
+        b.addInt32(static_cast<std::int32_t>(size));
+        std::string blob;
+        for (size_t t = 0; t < tiles(); t++) {
+            blob.append(buffer.data() + offsets[t], sizes[t]);
+        }
+        b.add(Value(blob.data(), blob.size()));
+        if (isLegacy()) {
+            return b.write(connection);
+        }
+        Bottle& tiling = b.addList();
+        tiling.addVocab(mode);
+        tiling.addFloat64(parameter);
+        tiling.addInt32(static_cast<std::int32_t>(tileRows));
+        for (size_t tileSize : sizes) {
+            tiling.addInt32(static_cast<std::int32_t>(tileSize));
+        }
+        return b.write(connection);
+    }
+
+    // the same data of the Bottle written above, without copying the tiles
+    connection.appendInt32(BOTTLE_TAG_LIST);
+    connection.appendInt32(isLegacy() ? 4 : 5);
+    connection.appendInt32(BOTTLE_TAG_INT32);
+    connection.appendInt32(static_cast<std::int32_t>(width));
+    connection.appendInt32(BOTTLE_TAG_INT32);
+    connection.appendInt32(static_cast<std::int32_t>(height));
+    connection.appendInt32(BOTTLE_TAG_INT32);
+    connection.appendInt32(static_cast<std::int32_t>(size));
+    connection.appendInt32(BOTTLE_TAG_BLOB);
+    connection.appendInt32(static_cast<std::int32_t>(size));
+    for (size_t t = 0; t < tiles(); t++) {
+        connection.appendExternalBlock(buffer.data() + offsets[t], sizes[t]);
+    }
+    if (isLegacy()) {
+        return !connection.isError();
+    }
+    connection.appendInt32(BOTTLE_TAG_LIST);
+    connection.appendInt32(static_cast<std::int32_t>(3 + tiles()));
+    connection.appendInt32(BOTTLE_TAG_VOCAB);
+    connection.appendInt32(mode);
+    connection.appendInt32(BOTTLE_TAG_FLOAT64);
+    connection.appendFloat64(parameter);
+    connection.appendInt32(BOTTLE_TAG_INT32);
+    connection.appendInt32(static_cast<std::int32_t>(tileRows));
+    for (size_t tileSize : sizes) {
+        connection.appendInt32(BOTTLE_TAG_INT32);
+        connection.appendInt32(static_cast<std::int32_t>(tileSize));
+    }
+    return !connection.isError();
+}
+
+bool ZfpFrame::read(ConnectionReader& connection)
+{
+    std::int32_t w = 0;
+    std::int32_t h = 0;
+    std::int32_t size = 0;
+    std::vector<std::int32_t> tileSizes;
+
+    if (connection.isTextMode()) {
+        Bottle b;
+        if (!b.read(connection) || b.size() < 4 || !b.get(3).isBlob()) {
+            return false;
+        }
+        w = b.get(0).asInt32();
+        h = b.get(1).asInt32();
+        size = static_cast<std::int32_t>(b.get(3).asBlobLength());
+        buffer.assign(b.get(3).asBlob(), b.get(3).asBlob() + size);
+        Bottle* tiling = b.get(4).asList();
+        if (tiling != nullptr && tiling->size() >= 4) {
+            mode = tiling->get(0).asVocab();
+            parameter = tiling->get(1).asFloat64();
+            tileRows = static_cast<size_t>(tiling->get(2).asInt32());
+            for (size_t t = 3; t < tiling->size(); t++) {
+                tileSizes.push_back(tiling->get(t).asInt32());
+            }
+        }
+    } else {
+        auto expect = [&](std::int32_t tag) {
+            return connection.expectInt32() == tag && !connection.isError();
+        };
+        if (!expect(BOTTLE_TAG_LIST)) {
+            return false;
+        }
+        std::int32_t items = connection.expectInt32();
+        if (items != 4 && items != 5) {
+            return false;
+        }
+        if (!expect(BOTTLE_TAG_INT32)) {
+            return false;
+        }
+        w = connection.expectInt32();
+        if (!expect(BOTTLE_TAG_INT32)) {
+            return false;
+        }
+        h = connection.expectInt32();
+        if (!expect(BOTTLE_TAG_INT32)) {
+            return false;
+        }
+        connection.expectInt32();
+        if (!expect(BOTTLE_TAG_BLOB)) {
+            return false;
+        }
+        size = connection.expectInt32();
+        if (size < 0 || static_cast<size_t>(size) > connection.getSize()) {
+            return false;
+        }
+        buffer.resize(static_cast<size_t>(size));
+        if (!connection.expectBlock(buffer.data(), buffer.size())) {
+            return false;
+        }
+        if (items == 5) {
+            if (!expect(BOTTLE_TAG_LIST)) {
+                return false;
+            }
+            std::int32_t count = connection.expectInt32();
+            if (count < 4 || !expect(BOTTLE_TAG_VOCAB)) {
+                return false;
+            }
+            mode = connection.expectInt32();
+            if (!expect(BOTTLE_TAG_FLOAT64)) {
+                return false;
+            }
+            parameter = connection.expectFloat64();
+            if (!expect(BOTTLE_TAG_INT32)) {
+                return false;
+            }
+            tileRows = static_cast<size_t>(connection.expectInt32());
+            for (std::int32_t t = 3; t < count; t++) {
+                if (!expect(BOTTLE_TAG_INT32)) {
+                    return false;
+                }
+                tileSizes.push_back(connection.expectInt32());
+            }
+        }
+    }
+
+    if (w < 0 || h < 0) {
+        return false;
+    }
+    width = static_cast<size_t>(w);
+    height = static_cast<size_t>(h);
+
+    // the images of the older senders are a single tile
+    if (tileSizes.empty()) {
+        mode = VOCAB_ZFP_ACCURACY;
+        parameter = 1e-3;
+        tileRows = height;
+        tileSizes.push_back(size);
+    }
+    if (tileRows == 0 || (tileSizes.size() - 1) * tileRows >= std::max<size_t>(height, 1) ||
+        tileSizes.size() * tileRows < height) {
+        return false;
+    }
+
+    offsets.resize(tileSizes.size());
+    sizes.resize(tileSizes.size());
+    size_t offset = 0;
+    for (size_t t = 0; t < tileSizes.size(); t++) {
+        if (tileSizes[t] < 0 || offset + tileSizes[t] > buffer.size()) {
+            return false;
+        }
+        offsets[t] = offset;
+        sizes[t] = static_cast<size_t>(tileSizes[t]);
+        offset += sizes[t];
+    }
+    return true;
+}
+
+
+bool ZfpMonitorObject::create(const yarp::os::Property& options)
+{
+    shouldCompress = (options.find("sender_side").asBool());
+
+    // the parameters can be modifiers of the carrier, i.e. +mode.precision
+    Name name(options.find("carrier").asString() + "://test");
+    for (const char* key : parameterNames) {
+        bool found = false;
+        std::string value = name.getCarrierModifier(key, &found);
+        if (found && !settings.set(key, value)) {
+            yCError(ZFPMONITOR, "Invalid value '%s' for the parameter '%s'", value.c_str(), key);
+            return false;
+        }
+    }
+    return true;
+}
+
+void ZfpMonitorObject::destroy(void)
+{
+    pool.reset();
+}
+
 bool ZfpMonitorObject::setparam(const yarp::os::Property& params)
 {
-    return false;
+    std::lock_guard<std::mutex> lock(settingsMutex);
+    ZfpSettings changed = settings;
+    bool found = false;
+    for (const char* key : parameterNames) {
+        if (params.check(key)) {
+            found = true;
+            if (!changed.set(key, params.find(key).toString())) {
+                yCError(ZFPMONITOR, "Invalid value '%s' for the parameter '%s'", params.find(key).toString().c_str(), key);
+                return false;
+            }
+        }
+    }
+    settings = changed;
+    return found;
 }
 
 bool ZfpMonitorObject::getparam(yarp::os::Property& params)
 {
-    return false;
+    std::lock_guard<std::mutex> lock(settingsMutex);
+    settings.toProperty(params);
+    return true;
 }
 
 bool ZfpMonitorObject::accept(yarp::os::Things& thing)
@@ -81,9 +403,9 @@ bool ZfpMonitorObject::accept(yarp::os::Things& thing)
         }
     }
     else{
-        Bottle* bt= thing.cast_as<Bottle>();
-        if(bt == nullptr){
-            yCError(ZFPMONITOR, "Expected type Bottle in receiver side, but got wrong data type!");
+        ZfpFrame* frame = thing.cast_as<ZfpFrame>();
+        if(frame == nullptr){
+            yCError(ZFPMONITOR, "Expected a compressed image in receiver side, but got wrong data type!");
             return false;
         }
 
@@ -95,41 +417,28 @@ bool ZfpMonitorObject::accept(yarp::os::Things& thing)
 
 yarp::os::Things& ZfpMonitorObject::update(yarp::os::Things& thing)
 {
+    ZfpSettings current;
+    {
+        std::lock_guard<std::mutex> lock(settingsMutex);
+        current = settings;
+    }
 
    if(shouldCompress) {
         ImageOf<PixelFloat>* img = thing.cast_as< ImageOf<PixelFloat> >();
-        // .... buffer, len
-        int sizeCompressed;
-        compress((float*)img->getRawImage(), compressed, sizeCompressed, img->width(),img->height(),1e-3);
-        if(!compressed){
+        if(!compress(*img, frameOut, current)){
             yCError(ZFPMONITOR, "Failed to compress, exiting...");
             return thing;
         }
-        data.clear();
-        data.addInt32(img->width());
-        data.addInt32(img->height());
-        data.addInt32(sizeCompressed);
-        Value v(compressed, sizeCompressed);
-        data.add(v);
-        th.setPortWriter(&data);
+        th.setPortWriter(&frameOut);
    }
    else
    {
-
-       Bottle* compressedbt= thing.cast_as<Bottle>();
-
-       int width=compressedbt->get(0).asInt32();
-       int height=compressedbt->get(1).asInt32();
-       int sizeCompressed=compressedbt->get(2).asInt32();
-       // cast thing to compressed.
-       decompress((float*)compressedbt->get(3).asBlob(), decompressed, sizeCompressed, width, height,1e-3);
-
-       if(!decompressed){
+       ZfpFrame* frame = thing.cast_as<ZfpFrame>();
+       threadPool(current.threads);
+       if(!decompress(*frame, imageOut)){
            yCError(ZFPMONITOR, "Failed to decompress, exiting...");
            return thing;
        }
-       imageOut.resize(width,height);
-       memcpy(imageOut.getRawImage(),decompressed,width*height*4);
        th.setPortWriter(&imageOut);
 
    }
@@ -137,114 +446,119 @@ yarp::os::Things& ZfpMonitorObject::update(yarp::os::Things& thing)
     return th;
 }
 
-void ZfpMonitorObject::resizeF(float *&array, int newSize){
-    if(newSize>sizeToAllocate){
-        sizeToAllocate=newSize;
-        free(array);
-        array=(float*) malloc(sizeToAllocate);
-    }
-
-
-}
-void ZfpMonitorObject::resizeV(void *&array, int newSize){
-    if(newSize>sizeToAllocateB){
-        sizeToAllocateB=newSize;
-        free(array);
-        array=(void*) malloc(sizeToAllocateB);
+ZfpThreadPool& ZfpMonitorObject::threadPool(int threads)
+{
+    size_t count = (threads > 0) ? static_cast<size_t>(threads) : std::max(std::thread::hardware_concurrency(), 1U);
+    if (!pool || pool->size() != count) {
+        pool = std::make_unique<ZfpThreadPool>(count);
     }
-
-
+    return *pool;
 }
 
-int ZfpMonitorObject::compress(float* array, float* &compressed, int &zfpsize, int nx, int ny, float tolerance){
-    int status = 0;    /* return value: 0 = success */
-    zfp_type type;     /* array scalar type */
-    zfp_field* field;  /* array meta data */
-    zfp_stream* zfp;   /* compressed stream */
-    size_t bufsize;    /* byte size of compressed buffer */
-    bitstream* stream; /* bit stream to write to or read from */
-
-    type = zfp_type_float;
-    field = zfp_field_2d(array, type, nx, ny);
-
-    /* allocate meta data for a compressed stream */
-    zfp = zfp_stream_open(nullptr);
-
-    /* set compression mode and parameters via one of three functions */
-    /*  zfp_stream_set_rate(zfp, rate, type, 3, 0); */
-    /*  zfp_stream_set_precision(zfp, precision); */
-    zfp_stream_set_accuracy(zfp, tolerance);
-
-    /* allocate buffer for compressed data */
-    bufsize = zfp_stream_maximum_size(zfp, field);
-
-    resizeV(buffer,bufsize);
-
-    /* associate bit stream with allocated buffer */
-    stream = stream_open(buffer, bufsize);
-    zfp_stream_set_bit_stream(zfp, stream);
-    zfp_stream_rewind(zfp);
-
-    /* compress entire array */
-    /* compress array and output compressed stream */
-    zfpsize = zfp_compress(zfp, field);
-    if (!zfpsize) {
-      yCError(ZFPMONITOR, "compression failed");
-      status = 1;
+bool ZfpMonitorObject::compress(const ImageOf<PixelFloat>& image, ZfpFrame& frame, const ZfpSettings& settings)
+{
+    const size_t width = image.width();
+    const size_t height = image.height();
+    if (width == 0 || height == 0 || image.getRowSize() % sizeof(float) != 0) {
+        yCError(ZFPMONITOR, "Cannot compress an image of %zux%zu pixels with rows of %zu bytes", width, height, image.getRowSize());
+        return false;
     }
 
-    resizeF(compressed,zfpsize);
-    memcpy(compressed,(float*) stream_data(zfp->stream),zfpsize);
-
-    /* clean up */
-    zfp_field_free(field);
+    // zfp compresses blocks of 4x4 values, the tiles are made of whole
+    // blocks, one for each thread
+    ZfpThreadPool& workers = threadPool(settings.threads);
+    size_t tiles = std::max<size_t>(1, std::min(workers.size(), (height + 3) / 4));
+    size_t tileRows = ((height + tiles - 1) / tiles + 3) / 4 * 4;
+    tiles = (height + tileRows - 1) / tileRows;
+
+    frame.width = width;
+    frame.height = height;
+    frame.mode = settings.mode;
+    frame.parameter = settings.parameter();
+    frame.tileRows = tileRows;
+    frame.offsets.resize(tiles);
+    frame.sizes.resize(tiles);
+
+    // each tile is compressed in its part of the buffer, that is large
+    // enough for the worst case, and is kept for the following images
+    zfp_stream* zfp = zfp_stream_open(nullptr);
+    if (!setMode(zfp, frame.mode, frame.parameter)) {
+        zfp_stream_close(zfp);
+        yCError(ZFPMONITOR, "The compression mode %s is not supported", Vocab::decode(frame.mode).c_str());
+        return false;
+    }
+    size_t size = 0;
+    for (size_t t = 0; t < tiles; t++) {
+        zfp_field* field = tileField(nullptr, width, tileRowsAt(height, tileRows, t), image.getRowSize());
+        frame.offsets[t] = size;
+        // aligned to the words of the bit streams
+        size += (zfp_stream_maximum_size(zfp, field) + 7) / 8 * 8;
+        zfp_field_free(field);
+    }
     zfp_stream_close(zfp);
-    stream_close(stream);
+    if (frame.buffer.size() < size) {
+        frame.buffer.resize(size);
+    }
 
-    return status;
+    std::atomic<bool> failed {false};
+    workers.run(tiles, [&](size_t t) {
+        size_t capacity = ((t + 1 < tiles) ? frame.offsets[t + 1] : size) - frame.offsets[t];
+        const auto* pixels = reinterpret_cast<const float*>(image.getRow(t * tileRows));
+        zfp_field* field = tileField(pixels, width, tileRowsAt(height, tileRows, t), image.getRowSize());
+        bitstream* stream = stream_open(frame.buffer.data() + frame.offsets[t], capacity);
+        zfp_stream* tileZfp = zfp_stream_open(stream);
+        setMode(tileZfp, frame.mode, frame.parameter);
+        zfp_stream_rewind(tileZfp);
+        frame.sizes[t] = zfp_compress(tileZfp, field);
+        if (frame.sizes[t] == 0) {
+            failed = true;
+        }
+        zfp_field_free(field);
+        zfp_stream_close(tileZfp);
+        stream_close(stream);
+    });
+    if (failed) {
+        yCError(ZFPMONITOR, "compression failed");
+        return false;
+    }
+    if (!frame.isLegacy()) {
+        yCInfoOnce(ZFPMONITOR, "Sending the images in %zu tiles with the mode %s, the receivers need the same version of the zfp portmonitor to read them", tiles, Vocab::decode(frame.mode).c_str());
+    }
+    return true;
 }
 
-int ZfpMonitorObject::decompress(float* array, float* &decompressed, int zfpsize, int nx, int ny, float tolerance){
-    int status = 0;    /* return value: 0 = success */
-    zfp_type type;     /* array scalar type */
-    zfp_field* field;  /* array meta data */
-    zfp_stream* zfp;   /* compressed stream */
-    size_t bufsize;    /* byte size of compressed buffer */
-    bitstream* stream; /* bit stream to write to or read from */
-
-    type = zfp_type_float;
-    resizeF(decompressed,nx*ny*sizeof(float));
-    field = zfp_field_2d(decompressed, type, nx, ny);
-
-    /* allocate meta data for a compressed stream */
-    zfp = zfp_stream_open(nullptr);
-
-    /* set compression mode and parameters via one of three functions */
-    /*  zfp_stream_set_rate(zfp, rate, type, 3, 0); */
-    /*  zfp_stream_set_precision(zfp, precision, type); */
-    zfp_stream_set_accuracy(zfp, tolerance);
-
-    /* allocate buffer for compressed data */
-    bufsize = zfp_stream_maximum_size(zfp, field);
-    resizeV(buffer,bufsize);
-    memcpy(buffer,array,zfpsize);
-
-    /* associate bit stream with allocated buffer */
-    stream = stream_open(buffer, zfpsize);
-    zfp_stream_set_bit_stream(zfp, stream);
-    zfp_stream_rewind(zfp);
-
-    /* read compressed stream and decompress array */
-    if (!zfp_decompress(zfp, field)) {
-      yCError(ZFPMONITOR, "decompression failed");
-      status = 1;
+bool ZfpMonitorObject::decompress(const ZfpFrame& frame, ImageOf<PixelFloat>& image)
+{
+    image.resize(frame.width, frame.height);
+    if (image.getRowSize() % sizeof(float) != 0) {
+        return false;
+    }
+    if (frame.width == 0 || frame.height == 0) {
+        return true;
     }
 
-    /* clean up */
-    zfp_field_free(field);
-    zfp_stream_close(zfp);
-    stream_close(stream);
-
-    return status;
-
+    // the tiles are decompressed in the rows of the image
+    std::atomic<bool> failed {false};
+    pool->run(frame.tiles(), [&](size_t t) {
+        auto* pixels = reinterpret_cast<float*>(image.getRow(t * frame.tileRows));
+        zfp_field* field = tileField(pixels, frame.width, tileRowsAt(frame.height, frame.tileRows, t), image.getRowSize());
+        bitstream* stream = stream_open(const_cast<char*>(frame.buffer.data() + frame.offsets[t]), frame.sizes[t]);
+        zfp_stream* zfp = zfp_stream_open(stream);
+        zfp_stream_rewind(zfp);
+        if (!setMode(zfp, frame.mode, frame.parameter) || !zfp_decompress(zfp, field)) {
+            failed = true;
+        } else if (zfp_stream_compressed_size(zfp) > (frame.sizes[t] + 7) / 8 * 8) {
+            // read past the end of the tile, the tiles were not compressed
+            // with these settings
+            failed = true;
+        }
+        zfp_field_free(field);
+        zfp_stream_close(zfp);
+        stream_close(stream);
+    });
+    if (failed) {
+        yCError(ZFPMONITOR, "decompression failed");
+        return false;
+    }
+    return true;
 }
@@ -9,11 +9,90 @@
 #ifndef YARP_ZFP_CARRIER_ZFPPORTMONITOR_H
 #define YARP_ZFP_CARRIER_ZFPPORTMONITOR_H
 
-#include <yarp/os/Bottle.h>
+#include "ZfpThreadPool.h"
+
+#include <yarp/os/Portable.h>
+#include <yarp/os/Property.h>
 #include <yarp/os/Things.h>
+#include <yarp/os/Vocab.h>
 #include <yarp/sig/Image.h>
 #include <yarp/os/MonitorObject.h>
 
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+constexpr yarp::conf::vocab32_t VOCAB_ZFP_ACCURACY  = yarp::os::createVocab('a','c','c','u');
+constexpr yarp::conf::vocab32_t VOCAB_ZFP_PRECISION = yarp::os::createVocab('p','r','e','c');
+constexpr yarp::conf::vocab32_t VOCAB_ZFP_RATE      = yarp::os::createVocab('r','a','t','e');
+constexpr yarp::conf::vocab32_t VOCAB_ZFP_LOSSLESS  = yarp::os::createVocab('l','o','s','s');
+
+/**
+ * The parameters of the compression of a connection, that can be set as
+ * carrier modifiers (e.g. +mode.precision+precision.20+threads.4) or with
+ * the parameters of the portmonitor.
+ */
+struct ZfpSettings
+{
+    // accuracy, precision, rate or lossless
+    yarp::conf::vocab32_t mode {VOCAB_ZFP_ACCURACY};
+    // the largest error allowed in the accuracy mode
+    double accuracy {1e-3};
+    // the bits kept for each value in the precision mode
+    int precision {16};
+    // the bits used for each value in the rate mode
+    double rate {8.0};
+    // the threads compressing or decompressing an image, 0 for one for
+    // each core; with more than one thread the images are sent in tiles,
+    // that only this version of the receiver can read
+    int threads {1};
+
+    /**
+     * Sets a parameter from its textual value.
+     * @return false if the parameter or its value are not valid
+     */
+    bool set(const std::string& key, const std::string& value);
+
+    void toProperty(yarp::os::Property& params) const;
+
+    // the parameter of the current mode
+    double parameter() const;
+};
+
+/**
+ * An image compressed by tiles of rows, that can be compressed and
+ * decompressed at the same time.
+ *
+ * It is sent as a Bottle of the width, the height and the size of the
+ * image, the compressed tiles in a blob, and a list of the mode, its
+ * parameter, the rows of a tile and the size of each tile.  The images
+ * with a single tile compressed with an accuracy of 1e-3 are sent without
+ * the list, as the older senders did, so that the older receivers can
+ * read them.
+ */
+class ZfpFrame : public yarp::os::Portable
+{
+public:
+    size_t width {0};
+    size_t height {0};
+    yarp::conf::vocab32_t mode {VOCAB_ZFP_ACCURACY};
+    double parameter {1e-3};
+    size_t tileRows {0};
+
+    // the tiles, each one at an offset of the buffer
+    std::vector<char> buffer;
+    std::vector<size_t> offsets;
+    std::vector<size_t> sizes;
+
+    size_t tiles() const { return sizes.size(); }
+
+    // can the older receivers read this image
+    bool isLegacy() const;
+
+    bool read(yarp::os::ConnectionReader& connection) override;
+    bool write(yarp::os::ConnectionWriter& connection) const override;
+};
 
 class ZfpMonitorObject : public yarp::os::MonitorObject
 {
@@ -27,20 +106,17 @@ public:
     bool accept(yarp::os::Things& thing) override;
     yarp::os::Things& update(yarp::os::Things& thing) override;
 protected:
-    int compress(float* array, float* &compressed, int &zfpsize, int nx, int ny, float tolerance);
-    int decompress(float* array, float* &decompressed, int zfpsize, int nx, int ny, float tolerance);
-    void resizeF(float* &array, int newSize);
-    void resizeV(void* &array, int newSize);
+    bool compress(const yarp::sig::ImageOf<yarp::sig::PixelFloat>& image, ZfpFrame& frame, const ZfpSettings& settings);
+    bool decompress(const ZfpFrame& frame, yarp::sig::ImageOf<yarp::sig::PixelFloat>& image);
+    ZfpThreadPool& threadPool(int threads);
 private:
     yarp::os::Things th;
-    yarp::os::Bottle data;
+    ZfpFrame frameOut;
     yarp::sig::ImageOf<yarp::sig::PixelFloat> imageOut;
-    bool shouldCompress;
-    void  *buffer;
-    float *compressed;
-    float *decompressed;
-    int sizeToAllocate;
-    int sizeToAllocateB;
+    bool shouldCompress {false};
+    std::mutex settingsMutex;
+    ZfpSettings settings;
+    std::unique_ptr<ZfpThreadPool> pool;
 };
 
 #endif
@@ -93,6 +93,16 @@ bool LaserFromDepth::open(yarp::os::Searchable& config)
     m_laser_data.resize(m_sensorsNum, 0.0);
     m_max_angle = +hfov / 2;
     m_min_angle = -hfov / 2;
+
+    //the 1 / cos(blabla) distortion simulate the way RGBD devices calculate the distance..
+    //it depends only on the column, so it is computed once here instead of at each frame
+    double angleShift = m_sensorsNum * m_resolution / 2;
+    m_range_factors.resize(m_sensorsNum);
+    for (size_t elem = 0; elem < m_sensorsNum; elem++)
+    {
+        double angle = elem * m_resolution; //deg
+        m_range_factors[elem] = 1.0 / cos((angle - angleShift) * DEG2RAD);
+    }
     PeriodicThread::start();
 
     yCInfo(LASER_FROM_DEPTH) << "Sensor ready";
@@ -171,18 +181,13 @@ void LaserFromDepth::run()
     }
 
 
-    auto* pointer = (float*)m_depth_image.getPixelAddress(0, m_depth_height / 2);
-    double angle, distance, angleShift;
-
-    angleShift = m_sensorsNum * m_resolution / 2;
+    const auto* pointer = reinterpret_cast<const float*>(m_depth_image.getPixelAddress(0, m_depth_height / 2));
+    const double* factors = m_range_factors.data();
+    double* laser_data = m_laser_data.data();
 
     for (size_t elem = 0; elem < m_sensorsNum; elem++)
     {
-        angle    = elem * m_resolution;    //deg
-        //the 1 / cos(blabla) distortion simulate the way RGBD devices calculate the distance..
-        distance = *(pointer + elem);
-        distance /= cos((angle - angleShift) * DEG2RAD); //m
-        m_laser_data[m_sensorsNum - 1 - elem] = distance;
+        laser_data[m_sensorsNum - 1 - elem] = pointer[elem] * factors[elem]; //m
     }
     applyLimitsOnLaserData();
 
@@ -48,6 +48,7 @@ protected:
     size_t m_depth_width = 0;
     size_t m_depth_height = 0;
     yarp::sig::ImageOf<float> m_depth_image;
+    yarp::sig::Vector m_range_factors;
 
 public:
     LaserFromDepth(double period = 0.01) : PeriodicThread(period),
@@ -30,12 +30,14 @@
 #include <yarp/os/Node.h>
 #include <yarp/os/Publisher.h>
 
+#include <algorithm>
 #include <cmath>
 #include <cstring>
 #include <cstdlib>
 #include <iostream>
 #include <limits>
 #include <mutex>
+#include <thread>
 
 using namespace std;
 
@@ -194,7 +196,15 @@ bool LaserFromPointCloud::open(yarp::os::Searchable& config)
         yarp::os::Searchable& pointcloud_quality_config = config.findGroup("POINTCLOUD_QUALITY");
         if (pointcloud_quality_config.check("x_step")) { m_pc_stepx = pointcloud_quality_config.find("x_step").asFloat64(); }
         if (pointcloud_quality_config.check("y_step")) { m_pc_stepy = pointcloud_quality_config.find("y_step").asFloat64(); }
+        if (pointcloud_quality_config.check("threads"))
+        {
+            // at least one thread, and no more than the hardware can run
+            size_t max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+            int threads = std::max(pointcloud_quality_config.find("threads").asInt32(), 1);
+            m_pc_threads = std::min(static_cast<size_t>(threads), max_threads);
+        }
         yCInfo(LASER_FROM_POINTCLOUD) << "Pointcloud decimation step set to:" << m_pc_stepx << m_pc_stepy;
+        yCInfo(LASER_FROM_POINTCLOUD) << "Pointcloud threads set to:" << m_pc_threads;
     }
 
     bool bpc = config.check("Z_CLIPPING_PLANES");
@@ -338,18 +348,6 @@ bool LaserFromPointCloud::threadInit()
     return true;
 }
 
-void rotate_pc (yarp::sig::PointCloud<yarp::sig::DataXYZ>& pc, const yarp::sig::Matrix& m)
-{
-    for (size_t i=0; i<pc.size(); i++)
-    {
-        auto v1 = pc(i).toVector4();
-        auto v2 = m*v1;
-        pc(i).x=v2(0);
-        pc(i).y=v2(1);
-        pc(i).z=v2(2);
-    }
-}
-
 void LaserFromPointCloud::run()
 {
 #ifdef DEBUG_TIMING
@@ -385,27 +383,28 @@ void LaserFromPointCloud::run()
         *it= myinf;
     }
 
-    //compute the point cloud
-    yarp::sig::PointCloud<yarp::sig::DataXYZ> pc = yarp::sig::utils::depthToPC(m_depth_image, m_intrinsics,m_pc_roi,m_pc_stepx,m_pc_stepy);
+    //compute the point cloud (the memory of m_pc is reused from one frame to the next one)
+    yarp::sig::utils::depthToPC(m_depth_image, m_intrinsics, m_pc_roi, m_pc_stepx, m_pc_stepy, m_pc, m_pc_threads);
 
-    //if (m_publish_ros_pc) {ros_compute_and_send_pc(pc,m_camera_frame_id);}//<-------------------------
+    //if (m_publish_ros_pc) {ros_compute_and_send_pc(m_pc,m_camera_frame_id);}//<-------------------------
 
 #ifdef TEST_M
-    //yCDebug(LASER_FROM_POINTCLOUD) << "pc size:" << pc.size();
+    //yCDebug(LASER_FROM_POINTCLOUD) << "pc size:" << m_pc.size();
 #endif
 
     //we compute the transformation matrix from the camera to the laser reference frame
-    yarp::sig::Matrix m(4,4); m.eye();
+    m_transform_mtrx.resize(4,4);
+    m_transform_mtrx.eye();
 
 #ifdef TEST_M
     yarp::sig::Vector vvv(3);
     vvv(0)=-1.57;
     vvv(1)=0;
     vvv(2)=-1.57;
-    m = yarp::math::rpy2dcm(vvv);
-    m(2,3)=1.2; //z translation
+    m_transform_mtrx = yarp::math::rpy2dcm(vvv);
+    m_transform_mtrx(2,3)=1.2; //z translation
 #else
-    bool frame_exists = m_iTc->getTransform(m_camera_frame_id,m_ground_frame_id,m);
+    bool frame_exists = m_iTc->getTransform(m_camera_frame_id,m_ground_frame_id,m_transform_mtrx);
     if (frame_exists==false)
     {
         yCWarning(LASER_FROM_POINTCLOUD) << "Unable to found m matrix";
@@ -413,63 +412,14 @@ void LaserFromPointCloud::run()
 #endif
 
     //we rototranslate the full pointcloud
-    rotate_pc(pc, m);
-
-    if (m_publish_ros_pc) {ros_compute_and_send_pc(pc,m_ground_frame_id);}//<-------------------------
-
-    for (size_t i=0; i<pc.size(); i++)
-    {
-
-#ifdef TEST_M
-     //yCDebug(LASER_FROM_POINTCLOUD) << pc(i).toString(5,5);
-#endif
+    yarp::sig::utils::transformPC(m_pc, m_transform_mtrx, m_pc_threads);
 
-        //we obtain a point from the point cloud
-        yarp::sig::Vector vec= pc(i).toVector4();
+    if (m_publish_ros_pc) {ros_compute_and_send_pc(m_pc,m_ground_frame_id);}//<-------------------------
 
-        //we check if the point is in the volume that we want to consider as possibile obstacle
-        if (vec[2]>m_floor_height && vec[2]<m_ceiling_height)
-        {
-#ifdef TEST_M
-    //        yCDebug(LASER_FROM_POINTCLOUD) << "This point is ok:" << i <<"its z is:" << tvec[2];
-#endif
-            //by removing z, we project the 3d point on the 2D plane on which the laser works.
-            //we use LaserMeasurementData struct to easily obtain a polar representation from a cartesian representation
-            LaserMeasurementData data;
-            data.set_cartesian(vec[0],vec[1]);
-
-            //get the polar representation
-            double distance;
-            double theta;
-            data.get_polar(distance, theta);
-
-            //compute the right element of the vector where to put distance data. This is done by clusterizing angles, depending on the laser resolution.
-            theta=theta*180/M_PI;
-            if      (theta<0)   theta+=360;
-            else if (theta>360) theta-=360;
-            size_t elem= theta/m_resolution;
-            if (elem>=m_laser_data.size())
-            {
-                yCError(LASER_FROM_POINTCLOUD) << "Error in computing elem" << i << ">" << m_laser_data.size();
-                continue;
-            }
+    //we keep the points in the volume that we want to consider as possible obstacles and, by removing z, we project them
+    //on the 2D plane on which the laser works, putting the NEAREST obstacle in each element of the scan.
+    yarp::sig::utils::pcToScan(m_pc, m_floor_height, m_ceiling_height, m_resolution, m_laser_data, m_pc_threads);
 
-#ifdef TEST_M
-            // yCDebug(LASER_FROM_POINTCLOUD) <<theta << elem <<distance;
-#endif
-            //update the vector of measurements, putting the NEAREST obstacle in right element of the vector.
-            if (distance<m_laser_data[elem])
-            {
-                m_laser_data[elem]=distance;
-            }
-        }
-        else
-        {
-#ifdef TEST_M
-            //yCDebug(LASER_FROM_POINTCLOUD) << "this point is out of considered volume:" <<i << " z:" << vec[2];
-#endif
-        }
-    }
     applyLimitsOnLaserData();
 
 #ifdef DEBUG_TIMING
@@ -63,6 +63,9 @@ protected:
     size_t m_pc_stepx = 0;
     size_t m_pc_stepy = 0;
     yarp::sig::utils::PCL_ROI m_pc_roi;
+    size_t m_pc_threads = 1;
+    yarp::sig::PointCloud<yarp::sig::DataXYZ> m_pc;
+    yarp::sig::Matrix m_transform_mtrx;
 
     //frames and point cloud clipping planes
     bool   m_publish_ros_pc;
@@ -20,6 +20,10 @@
 #include <yarp/os/Log.h>
 #include <yarp/os/LogStream.h>
 #include <yarp/math/Math.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <mutex>
 
 /*! \file FrameTransformClient.cpp */
@@ -32,6 +36,95 @@ using namespace yarp::sig;
 using namespace yarp::math;
 
 
+void Transform4x4::setIdentity()
+{
+    for (size_t r = 0; r < 4; r++)
+    {
+        for (size_t c = 0; c < 4; c++)
+        {
+            m[r][c] = (r == c) ? 1.0 : 0.0;
+        }
+    }
+}
+
+void Transform4x4::fromFrameTransform(const yarp::math::FrameTransform& t)
+{
+    // Same as FrameTransform::toMatrix()
+    double w = t.rotation.w();
+    double x = t.rotation.x();
+    double y = t.rotation.y();
+    double z = t.rotation.z();
+    double n = 1.0 / std::sqrt(w * w + x * x + y * y + z * z);
+    w *= n;
+    x *= n;
+    y *= n;
+    z *= n;
+
+    m[0][0] = w * w + x * x - y * y - z * z;
+    m[1][0] = 2.0 * (x * y + w * z);
+    m[2][0] = 2.0 * (x * z - w * y);
+    m[0][1] = 2.0 * (x * y - w * z);
+    m[1][1] = w * w - x * x + y * y - z * z;
+    m[2][1] = 2.0 * (y * z + w * x);
+    m[0][2] = 2.0 * (x * z + w * y);
+    m[1][2] = 2.0 * (y * z - w * x);
+    m[2][2] = w * w - x * x - y * y + z * z;
+    m[0][3] = t.translation.tX;
+    m[1][3] = t.translation.tY;
+    m[2][3] = t.translation.tZ;
+    m[3][0] = 0.0;
+    m[3][1] = 0.0;
+    m[3][2] = 0.0;
+    m[3][3] = 1.0;
+}
+
+void Transform4x4::multiply(const Transform4x4& a, const Transform4x4& b)
+{
+    for (size_t r = 0; r < 4; r++)
+    {
+        for (size_t c = 0; c < 4; c++)
+        {
+            m[r][c] = a.m[r][0] * b.m[0][c] + a.m[r][1] * b.m[1][c] + a.m[r][2] * b.m[2][c] + a.m[r][3] * b.m[3][c];
+        }
+    }
+}
+
+void Transform4x4::invertSE3(const Transform4x4& a)
+{
+    // Same as yarp::math::SE3inv()
+    for (size_t r = 0; r < 3; r++)
+    {
+        for (size_t c = 0; c < 3; c++)
+        {
+            m[r][c] = a.m[c][r];
+        }
+        m[r][3] = -(a.m[0][r] * a.m[0][3] + a.m[1][r] * a.m[1][3] + a.m[2][r] * a.m[2][3]);
+    }
+    m[3][0] = 0.0;
+    m[3][1] = 0.0;
+    m[3][2] = 0.0;
+    m[3][3] = 1.0;
+}
+
+void Transform4x4::toMatrix(yarp::sig::Matrix& out) const
+{
+    // does not allocate if out is already 4x4
+    out.resize(4, 4);
+    for (size_t r = 0; r < 4; r++)
+    {
+        for (size_t c = 0; c < 4; c++)
+        {
+            out(r, c) = m[r][c];
+        }
+    }
+}
+
+bool Transform4x4::operator==(const Transform4x4& other) const
+{
+    return std::memcmp(m, other.m, sizeof(m)) == 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------
 inline void Transforms_client_storage::resetStat()
 {
     std::lock_guard<std::recursive_mutex> l(m_mutex);
@@ -103,6 +196,7 @@ void Transforms_client_storage::onRead(yarp::os::Bottle &b)
                 m_transforms.push_back(t);
             }
         }
+        update_index();
     }
     else
     {
@@ -154,11 +248,391 @@ void Transforms_client_storage::clear()
 {
     std::lock_guard<std::recursive_mutex> l(m_mutex);
     m_transforms.clear();
+    update_index();
+}
+
+int Transforms_client_storage::intern(const std::string& frame_id)
+{
+    auto it = m_frame_ids.find(frame_id);
+    if (it != m_frame_ids.end())
+    {
+        return it->second;
+    }
+    int id = static_cast<int>(m_frames.size());
+    m_frame_ids.emplace(frame_id, id);
+    m_frame_names.push_back(frame_id);
+    m_frames.emplace_back();
+    return id;
+}
+
+int Transforms_client_storage::find_frame(const std::string& frame_id) const
+{
+    auto it = m_frame_ids.find(frame_id);
+    if (it == m_frame_ids.end() || !m_frames[it->second].present)
+    {
+        return -1;
+    }
+    return it->second;
+}
+
+void Transforms_client_storage::update_index()
+{
+    size_t known = m_frames.size();
+    bool reshaped = false;
+
+    for (auto& frame : m_frames)
+    {
+        frame.was_present = frame.present;
+        frame.present = false;
+        frame.linked = false;
+    }
+
+    Transform4x4 local;
+    for (const auto& t : m_transforms)
+    {
+        int src = intern(t.src_frame_id);
+        int dst = intern(t.dst_frame_id);
+        m_frames[src].present = true;
+        frame_t& frame = m_frames[dst];
+        frame.present = true;
+        if (frame.linked)
+        {
+            continue;
+        }
+        frame.linked = true;
+        if (!frame.history)
+        {
+            frame.history = std::make_shared<yarp::math::FrameTransformHistory>(m_history_size);
+        }
+        if (frame.parent != src)
+        {
+            frame.parent = src;
+            frame.history->clear();
+            reshaped = true;
+        }
+        local.fromFrameTransform(t);
+        bool changed = !(local == frame.local) || frame.version == 0;
+        if (changed)
+        {
+            frame.local = local;
+            frame.version = ++m_version;
+        }
+        if (changed || t.timestamp != frame.timestamp)
+        {
+            frame.timestamp = t.timestamp;
+            frame.history->add(t);
+        }
+    }
+
+    bool presence_changed = (m_frames.size() != known);
+    for (auto& frame : m_frames)
+    {
+        if (!frame.linked && frame.parent != -1)
+        {
+            frame.parent = -1;
+            reshaped = true;
+        }
+        if (!frame.linked && frame.history)
+        {
+            frame.history->clear();
+        }
+        presence_changed |= (frame.present != frame.was_present);
+    }
+
+    if (reshaped)
+    {
+        m_chains.clear();
+    }
+    if (reshaped || presence_changed || !m_snapshot)
+    {
+        publish_snapshot();
+    }
+}
+
+void Transforms_client_storage::publish_snapshot()
+{
+    auto snapshot = std::make_shared<snapshot_t>();
+    snapshot->frame_ids = m_frame_ids;
+    snapshot->parents.reserve(m_frames.size());
+    snapshot->present.reserve(m_frames.size());
+    snapshot->histories.reserve(m_frames.size());
+    for (const auto& frame : m_frames)
+    {
+        snapshot->parents.push_back(frame.parent);
+        snapshot->present.push_back(frame.present);
+        snapshot->histories.push_back(frame.history);
+    }
+    std::atomic_store(&m_snapshot, std::shared_ptr<const snapshot_t>(std::move(snapshot)));
+}
+
+bool Transforms_client_storage::find_common_ancestor(int target, int source, int& ancestor, std::uint64_t& version) const
+{
+    // depth of the frames, with a guard against loops in the received data
+    auto depth = [this](int frame, int& d)
+    {
+        d = 0;
+        for (int f = m_frames[frame].parent; f != -1; f = m_frames[f].parent)
+        {
+            if (++d > static_cast<int>(m_frames.size()))
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    int target_depth;
+    int source_depth;
+    if (!depth(target, target_depth) || !depth(source, source_depth))
+    {
+        return false;
+    }
+
+    version = 0;
+    int t = target;
+    int s = source;
+    for (; target_depth > source_depth; target_depth--)
+    {
+        version = std::max(version, m_frames[t].version);
+        t = m_frames[t].parent;
+    }
+    for (; source_depth > target_depth; source_depth--)
+    {
+        version = std::max(version, m_frames[s].version);
+        s = m_frames[s].parent;
+    }
+    while (t != s)
+    {
+        version = std::max(version, std::max(m_frames[t].version, m_frames[s].version));
+        t = m_frames[t].parent;
+        s = m_frames[s].parent;
+    }
+    if (t == -1)
+    {
+        return false;
+    }
+    // a root frame is not connected with itself
+    if (target == source && m_frames[target].parent == -1)
+    {
+        return false;
+    }
+    ancestor = t;
+    return true;
+}
+
+void Transforms_client_storage::compose_to_ancestor(int frame, int ancestor, Transform4x4& transform) const
+{
+    // transform = local(child of ancestor) * ... * local(frame)
+    Transform4x4 tmp;
+    transform.setIdentity();
+    for (int f = frame; f != ancestor; f = m_frames[f].parent)
+    {
+        tmp.multiply(m_frames[f].local, transform);
+        transform = tmp;
+    }
+}
+
+bool Transforms_client_storage::frame_exists(const std::string& frame_id)
+{
+    std::lock_guard<std::recursive_mutex> l(m_mutex);
+    return find_frame(frame_id) != -1;
+}
+
+bool Transforms_client_storage::get_parent(const std::string& frame_id, std::string& parent_frame_id)
+{
+    std::lock_guard<std::recursive_mutex> l(m_mutex);
+    int frame = find_frame(frame_id);
+    if (frame == -1 || m_frames[frame].parent == -1)
+    {
+        return false;
+    }
+    parent_frame_id = m_frame_names[m_frames[frame].parent];
+    return true;
+}
+
+bool Transforms_client_storage::has_link(const std::string& target_frame_id, const std::string& source_frame_id)
+{
+    std::lock_guard<std::recursive_mutex> l(m_mutex);
+    for (const auto& t : m_transforms)
+    {
+        if (t.dst_frame_id == target_frame_id && t.src_frame_id == source_frame_id)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Transforms_client_storage::can_transform(const std::string& target_frame_id, const std::string& source_frame_id)
+{
+    std::lock_guard<std::recursive_mutex> l(m_mutex);
+    int target = find_frame(target_frame_id);
+    int source = find_frame(source_frame_id);
+    int ancestor;
+    std::uint64_t version;
+    return target != -1 && source != -1 && find_common_ancestor(target, source, ancestor, version);
 }
 
-Transforms_client_storage::Transforms_client_storage(std::string local_streaming_name)
+bool Transforms_client_storage::get_transform(const std::string& target_frame_id, const std::string& source_frame_id, Transform4x4& transform)
+{
+    std::lock_guard<std::recursive_mutex> l(m_mutex);
+    int target = find_frame(target_frame_id);
+    int source = find_frame(source_frame_id);
+    int ancestor;
+    std::uint64_t version;
+    if (target == -1 || source == -1 || !find_common_ancestor(target, source, ancestor, version))
+    {
+        return false;
+    }
+
+    auto key = (static_cast<std::uint64_t>(target) << 32) | static_cast<std::uint32_t>(source);
+    auto it = m_chains.find(key);
+    if (it != m_chains.end() && it->second.version >= version)
+    {
+        transform = it->second.transform;
+        return true;
+    }
+
+    Transform4x4 root2tar;
+    Transform4x4 root2src;
+    Transform4x4 src2root;
+    if (ancestor == source)
+    {
+        compose_to_ancestor(target, ancestor, transform);
+    }
+    else if (ancestor == target)
+    {
+        compose_to_ancestor(source, ancestor, root2src);
+        transform.invertSE3(root2src);
+    }
+    else
+    {
+        compose_to_ancestor(target, ancestor, root2tar);
+        compose_to_ancestor(source, ancestor, root2src);
+        src2root.invertSE3(root2src);
+        transform.multiply(src2root, root2tar);
+    }
+
+    chain_t& chain = m_chains[key];
+    chain.transform = transform;
+    chain.version = m_version;
+    return true;
+}
+
+bool Transforms_client_storage::get_transform_at(const std::string& target_frame_id, const std::string& source_frame_id, double time, Transform4x4& transform) const
+{
+    // This does not lock the mutex: the tree is a snapshot, and the past
+    // values of each link are read with FrameTransformHistory
+    std::shared_ptr<const snapshot_t> snapshot = std::atomic_load(&m_snapshot);
+    if (!snapshot)
+    {
+        return false;
+    }
+
+    auto find = [&snapshot](const std::string& frame_id)
+    {
+        auto it = snapshot->frame_ids.find(frame_id);
+        return (it != snapshot->frame_ids.end() && snapshot->present[it->second]) ? it->second : -1;
+    };
+    int target = find(target_frame_id);
+    int source = find(source_frame_id);
+    if (target == -1 || source == -1)
+    {
+        return false;
+    }
+
+    // nearest common ancestor, as in find_common_ancestor()
+    const std::vector<int>& parents = snapshot->parents;
+    auto depth = [&parents](int frame, int& d)
+    {
+        d = 0;
+        for (int f = parents[frame]; f != -1; f = parents[f])
+        {
+            if (++d > static_cast<int>(parents.size()))
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+    int target_depth;
+    int source_depth;
+    if (!depth(target, target_depth) || !depth(source, source_depth))
+    {
+        return false;
+    }
+    int t = target;
+    int s = source;
+    for (; target_depth > source_depth; target_depth--)
+    {
+        t = parents[t];
+    }
+    for (; source_depth > target_depth; source_depth--)
+    {
+        s = parents[s];
+    }
+    while (t != s)
+    {
+        t = parents[t];
+        s = parents[s];
+    }
+    if (t == -1 || (target == source && parents[target] == -1))
+    {
+        return false;
+    }
+    int ancestor = t;
+
+    // transform = local(child of ancestor, time) * ... * local(frame, time)
+    auto compose = [this, &snapshot, &parents, time](int frame, int until, Transform4x4& chain)
+    {
+        yarp::math::FrameTransform ft;
+        Transform4x4 local;
+        Transform4x4 tmp;
+        chain.setIdentity();
+        for (int f = frame; f != until; f = parents[f])
+        {
+            if (!snapshot->histories[f] || !snapshot->histories[f]->getAt(time, ft, m_history_tolerance))
+            {
+                return false;
+            }
+            local.fromFrameTransform(ft);
+            tmp.multiply(local, chain);
+            chain = tmp;
+        }
+        return true;
+    };
+
+    Transform4x4 root2tar;
+    Transform4x4 root2src;
+    Transform4x4 src2root;
+    if (ancestor == source)
+    {
+        return compose(target, ancestor, transform);
+    }
+    if (ancestor == target)
+    {
+        if (!compose(source, ancestor, root2src))
+        {
+            return false;
+        }
+        transform.invertSE3(root2src);
+        return true;
+    }
+    if (!compose(target, ancestor, root2tar) || !compose(source, ancestor, root2src))
+    {
+        return false;
+    }
+    src2root.invertSE3(root2src);
+    transform.multiply(src2root, root2tar);
+    return true;
+}
+
+Transforms_client_storage::Transforms_client_storage(std::string local_streaming_name, size_t history_size, double history_tolerance)
 {
     m_count = 0;
+    m_version = 0;
+    m_history_size = history_size;
+    m_history_tolerance = history_tolerance;
     m_deltaT = 0;
     m_deltaTMax = 0;
     m_deltaTMin = 1e22;
@@ -436,7 +910,19 @@ bool FrameTransformClient::open(yarp::os::Searchable &config)
         return false;
     }
 
-    m_transform_storage = new Transforms_client_storage(m_local_streaming_name);
+    size_t history_size = DEFAULT_HISTORY_SIZE;
+    if (config.check("history_size"))
+    {
+        history_size = static_cast<size_t>(std::max(config.find("history_size").asInt32(), 1));
+    }
+
+    double history_tolerance = DEFAULT_HISTORY_TOLERANCE;
+    if (config.check("history_tolerance"))
+    {
+        history_tolerance = std::max(config.find("history_tolerance").asFloat64(), 0.0);
+    }
+
+    m_transform_storage = new Transforms_client_storage(m_local_streaming_name, history_size, history_tolerance);
     bool ok = Network::connect(m_remote_streaming_name.c_str(), m_local_streaming_name.c_str(), m_streaming_connection_type.c_str());
     if (!ok)
     {
@@ -477,60 +963,9 @@ bool FrameTransformClient::allFramesAsString(std::string &all_frames)
     return true;
 }
 
-FrameTransformClient::ConnectionType FrameTransformClient::getConnectionType(const std::string &target_frame, const std::string &source_frame, std::string* commonAncestor = nullptr)
-{
-    Transforms_client_storage& tfVec = *m_transform_storage;
-    size_t                     i, j;
-    std::vector<std::string>   tar2root_vec;
-    std::vector<std::string>   src2root_vec;
-    std::string                ancestor, child;
-    child = target_frame;
-    std::lock_guard<std::recursive_mutex> l(tfVec.m_mutex);
-    while(getParent(child, ancestor))
-    {
-        if(ancestor == source_frame)
-        {
-            return DIRECT;
-        }
-
-        tar2root_vec.push_back(ancestor);
-        child = ancestor;
-    }
-    child = source_frame;
-    while(getParent(child, ancestor))
-    {
-        if(ancestor == target_frame)
-        {
-            return INVERSE;
-        }
-
-        src2root_vec.push_back(ancestor);
-        child = ancestor;
-    }
-
-    for(i = 0; i < tar2root_vec.size(); i++)
-    {
-        std::string a;
-        a = tar2root_vec[i];
-        for(j = 0; j < src2root_vec.size(); j++)
-        {
-            if(a == src2root_vec[j])
-            {
-                if(commonAncestor)
-                {
-                    *commonAncestor = a;
-                }
-                return UNDIRECT;
-            }
-        }
-    }
-
-    return DISCONNECTED;
-}
-
 bool FrameTransformClient::canTransform(const std::string &target_frame, const std::string &source_frame)
 {
-    return getConnectionType(target_frame, source_frame) != DISCONNECTED;
+    return m_transform_storage->can_transform(target_frame, source_frame);
 }
 
 bool FrameTransformClient::clear()
@@ -560,12 +995,7 @@ bool FrameTransformClient::clear()
 
 bool FrameTransformClient::frameExists(const std::string &frame_id)
 {
-    for (size_t i = 0; i < m_transform_storage->size(); i++)
-    {
-        if (((*m_transform_storage)[i].src_frame_id) == frame_id) { return true; }
-        if (((*m_transform_storage)[i].dst_frame_id) == frame_id) { return true; }
-    }
-    return false;
+    return m_transform_storage->frame_exists(frame_id);
 }
 
 bool FrameTransformClient::getAllFrameIds(std::vector< std::string > &ids)
@@ -595,92 +1025,37 @@ bool FrameTransformClient::getAllFrameIds(std::vector< std::string > &ids)
 
 bool FrameTransformClient::getParent(const std::string &frame_id, std::string &parent_frame_id)
 {
-    for (size_t i = 0; i < m_transform_storage->size(); i++)
-    {
-        std::string par((*m_transform_storage)[i].dst_frame_id);
-        if (((*m_transform_storage)[i].dst_frame_id == frame_id))
-        {
-
-            parent_frame_id = (*m_transform_storage)[i].src_frame_id;
-            return true;
-        }
-    }
-    return false;
+    return m_transform_storage->get_parent(frame_id, parent_frame_id);
 }
 
 bool FrameTransformClient::canExplicitTransform(const std::string& target_frame_id, const std::string& source_frame_id) const
 {
-    Transforms_client_storage& tfVec = *m_transform_storage;
-    size_t                     i, tfVec_size;
-    std::lock_guard<std::recursive_mutex>         l(tfVec.m_mutex);
-
-    tfVec_size = tfVec.size();
-    for (i = 0; i < tfVec_size; i++)
-    {
-        if (tfVec[i].dst_frame_id == target_frame_id && tfVec[i].src_frame_id == source_frame_id)
-        {
-            return true;
-        }
-    }
-    return false;
+    return m_transform_storage->has_link(target_frame_id, source_frame_id);
 }
 
-bool FrameTransformClient::getChainedTransform(const std::string& target_frame_id, const std::string& source_frame_id, yarp::sig::Matrix& transform) const
+bool FrameTransformClient::getTransform(const std::string& target_frame_id, const std::string& source_frame_id, yarp::sig::Matrix& transform)
 {
-    Transforms_client_storage& tfVec = *m_transform_storage;
-    size_t                     i, tfVec_size;
-    std::lock_guard<std::recursive_mutex>         l(tfVec.m_mutex);
-
-    tfVec_size = tfVec.size();
-    for (i = 0; i < tfVec_size; i++)
+    Transform4x4 t;
+    if (m_transform_storage->get_transform(target_frame_id, source_frame_id, t))
     {
-        if (tfVec[i].dst_frame_id == target_frame_id)
-        {
-            if (tfVec[i].src_frame_id == source_frame_id)
-            {
-                transform = tfVec[i].toMatrix();
-                return true;
-            }
-            else
-            {
-                yarp::sig::Matrix m;
-                if (getChainedTransform(tfVec[i].src_frame_id, source_frame_id, m))
-                {
-                    transform = m * tfVec[i].toMatrix();
-                    return true;
-                }
-            }
-        }
+        t.toMatrix(transform);
+        return true;
     }
+
+    yError() << "FrameTransformClient::getTransform() frames " << source_frame_id << " and " << target_frame_id << " are not connected";
     return false;
 }
 
-bool FrameTransformClient::getTransform(const std::string& target_frame_id, const std::string& source_frame_id, yarp::sig::Matrix& transform)
+bool FrameTransformClient::getTransformAt(const std::string& target_frame_id, const std::string& source_frame_id, double time, yarp::sig::Matrix& transform)
 {
-    ConnectionType ct;
-    std::string    ancestor;
-    ct = getConnectionType(target_frame_id, source_frame_id, &ancestor);
-    if (ct == DIRECT)
-    {
-        return getChainedTransform(target_frame_id, source_frame_id, transform);
-    }
-    else if (ct == INVERSE)
+    Transform4x4 t;
+    if (m_transform_storage->get_transform_at(target_frame_id, source_frame_id, time, t))
     {
-        yarp::sig::Matrix m(4, 4);
-        getChainedTransform(source_frame_id, target_frame_id, m);
-        transform = yarp::math::SE3inv(m);
-        return true;
-    }
-    else if(ct == UNDIRECT)
-    {
-        yarp::sig::Matrix root2tar(4, 4), root2src(4, 4);
-        getChainedTransform(source_frame_id, ancestor, root2src);
-        getChainedTransform(target_frame_id, ancestor, root2tar);
-        transform = yarp::math::SE3inv(root2src) * root2tar;
+        t.toMatrix(transform);
         return true;
     }
 
-    yError() << "FrameTransformClient::getTransform() frames " << source_frame_id << " and " << target_frame_id << " are not connected";
+    yError() << "FrameTransformClient::getTransformAt() no transform between frames " << source_frame_id << " and " << target_frame_id << " at time " << time;
     return false;
 }
 
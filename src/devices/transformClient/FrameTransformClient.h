@@ -32,13 +32,38 @@
 #include <yarp/os/Time.h>
 #include <yarp/dev/PolyDriver.h>
 #include <yarp/math/FrameTransform.h>
+#include <yarp/math/FrameTransformHistory.h>
 #include <yarp/os/PeriodicThread.h>
+#include <cstdint>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
 
 
 #define DEFAULT_THREAD_PERIOD 20 //ms
 const int TRANSFORM_TIMEOUT_MS = 100; //ms
 const int MAX_PORTS = 5;
+const size_t DEFAULT_HISTORY_SIZE = 100;
+const double DEFAULT_HISTORY_TOLERANCE = 0.2; //s
+
+
+/**
+ * A 4x4 homogeneous transform with fixed size storage, used to compose the
+ * chains of transforms without allocating.
+ */
+struct Transform4x4
+{
+    double m[4][4];
+
+    void setIdentity();
+    void fromFrameTransform(const yarp::math::FrameTransform& t);
+    // this = a * b (this must be neither a nor b)
+    void multiply(const Transform4x4& a, const Transform4x4& b);
+    // this = a^-1, a being a rototranslation (this must not be a)
+    void invertSE3(const Transform4x4& a);
+    void toMatrix(yarp::sig::Matrix& out) const;
+    bool operator==(const Transform4x4& other) const;
+};
 
 
 class Transforms_client_storage :
@@ -57,14 +82,71 @@ private:
 
     std::vector <yarp::math::FrameTransform> m_transforms;
 
+    // Index of the frames received, as a tree: the frame ids are interned,
+    // and each frame knows its parent and the transform from the parent.
+    // Like getParent(), the first transform received for a frame wins.
+    struct frame_t
+    {
+        int           parent = -1;
+        bool          present = false;
+        bool          linked = false;
+        bool          was_present = false;
+        Transform4x4  local;
+        double        timestamp = 0.0;
+        std::uint64_t version = 0; // when the link to the parent last changed
+        std::shared_ptr<yarp::math::FrameTransformHistory> history;
+    };
+    std::unordered_map<std::string, int> m_frame_ids;
+    std::vector<std::string>             m_frame_names;
+    std::vector<frame_t>                 m_frames;
+    std::uint64_t                        m_version;
+    size_t                               m_history_size;
+    double                               m_history_tolerance;
+
+    // The tree as seen by get_transform_at(), that reads the past values of
+    // the links without locking the mutex.  It is replaced, never modified,
+    // when the tree changes.
+    struct snapshot_t
+    {
+        std::unordered_map<std::string, int> frame_ids;
+        std::vector<int>                     parents;
+        std::vector<bool>                    present;
+        std::vector<std::shared_ptr<const yarp::math::FrameTransformHistory>> histories;
+    };
+    std::shared_ptr<const snapshot_t> m_snapshot;
+
+    // The chains composed so far, by (target, source) pair.  An entry is
+    // valid while no link of its chain changed after it was computed, and
+    // the cache is dropped when the shape of the tree changes.
+    struct chain_t
+    {
+        Transform4x4  transform;
+        std::uint64_t version;
+    };
+    std::unordered_map<std::uint64_t, chain_t> m_chains;
+
+    int  intern(const std::string& frame_id);
+    int  find_frame(const std::string& frame_id) const;
+    void update_index();
+    void publish_snapshot();
+    bool find_common_ancestor(int target, int source, int& ancestor, std::uint64_t& version) const;
+    void compose_to_ancestor(int frame, int ancestor, Transform4x4& transform) const;
+
 public:
     std::recursive_mutex  m_mutex;
     size_t   size();
     yarp::math::FrameTransform& operator[]   (std::size_t idx);
     void clear();
 
+    bool frame_exists(const std::string& frame_id);
+    bool get_parent(const std::string& frame_id, std::string& parent_frame_id);
+    bool has_link(const std::string& target_frame_id, const std::string& source_frame_id);
+    bool can_transform(const std::string& target_frame_id, const std::string& source_frame_id);
+    bool get_transform(const std::string& target_frame_id, const std::string& source_frame_id, Transform4x4& transform);
+    bool get_transform_at(const std::string& target_frame_id, const std::string& source_frame_id, double time, Transform4x4& transform) const;
+
 public:
-    Transforms_client_storage (std::string port_name);
+    Transforms_client_storage (std::string port_name, size_t history_size = DEFAULT_HISTORY_SIZE, double history_tolerance = DEFAULT_HISTORY_TOLERANCE);
     ~Transforms_client_storage ( );
     bool     set_transform(yarp::math::FrameTransform t);
     bool     delete_transform(std::string t1, std::string t2);
@@ -93,12 +175,7 @@ class FrameTransformClient :
         public yarp::os::PeriodicThread
 {
 private:
-    enum ConnectionType {DISCONNECTED = 0, DIRECT, INVERSE, UNDIRECT};
-
-    FrameTransformClient::ConnectionType getConnectionType(const std::string &target_frame, const std::string &source_frame, std::string* commonAncestor);
-
     bool canExplicitTransform(const std::string& target_frame_id, const std::string& source_frame_id) const;
-    bool getChainedTransform(const std::string &target_frame_id, const std::string &source_frame_id, yarp::sig::Matrix &transform) const;
 
 protected:
 
@@ -147,6 +224,7 @@ public:
      bool     getAllFrameIds(std::vector< std::string > &ids) override;
      bool     getParent(const std::string &frame_id, std::string &parent_frame_id) override;
      bool     getTransform(const std::string &target_frame_id, const std::string &source_frame_id, yarp::sig::Matrix &transform) override;
+     bool     getTransformAt(const std::string &target_frame_id, const std::string &source_frame_id, double time, yarp::sig::Matrix &transform) override;
      bool     setTransform(const std::string &target_frame_id, const std::string &source_frame_id, const yarp::sig::Matrix &transform) override;
      bool     setTransformStatic(const std::string &target_frame_id, const std::string &source_frame_id, const yarp::sig::Matrix &transform) override;
      bool     deleteTransform(const std::string &target_frame_id, const std::string &source_frame_id) override;
@@ -26,6 +26,7 @@
 #include <yarp/os/LogStream.h>
 #include <mutex>
 #include <cstdlib>
+#include <algorithm>
 
 using namespace yarp::sig;
 using namespace yarp::math;
@@ -52,6 +53,13 @@ bool Transforms_server_storage::delete_transform(int id)
 bool Transforms_server_storage::set_transform(const FrameTransform& t)
 {
     std::lock_guard<std::mutex> lock(m_mutex);
+    std::shared_ptr<FrameTransformHistory>& history = m_histories[frames_t(t.src_frame_id, t.dst_frame_id)];
+    if (!history)
+    {
+        history = std::make_shared<FrameTransformHistory>(m_history_size);
+    }
+    history->add(t);
+
     for (auto& m_transform : m_transforms)
     {
        //@@@ this linear search requires optimization!
@@ -74,6 +82,7 @@ bool Transforms_server_storage::delete_transform(string t1, string t2)
     if (t1=="*" && t2=="*")
     {
         m_transforms.clear();
+        m_histories.clear();
         return true;
     }
     else
@@ -84,6 +93,7 @@ bool Transforms_server_storage::delete_transform(string t1, string t2)
             //source frame is jolly, thus delete all frames with destination == t2
             if (m_transforms[i].dst_frame_id == t2)
             {
+                delete_history(m_transforms[i].src_frame_id, m_transforms[i].dst_frame_id);
                 m_transforms.erase(m_transforms.begin() + i);
                 i=0; //the erase operation invalidates the iteration, loop restart is required
             }
@@ -102,6 +112,7 @@ bool Transforms_server_storage::delete_transform(string t1, string t2)
             //destination frame is jolly, thus delete all frames with source == t1
             if (m_transforms[i].src_frame_id == t1)
             {
+                delete_history(m_transforms[i].src_frame_id, m_transforms[i].dst_frame_id);
                 m_transforms.erase(m_transforms.begin() + i);
                 i=0; //the erase operation invalidates the iteration, loop restart is required
             }
@@ -119,6 +130,7 @@ bool Transforms_server_storage::delete_transform(string t1, string t2)
             if ((m_transforms[i].dst_frame_id == t1 && m_transforms[i].src_frame_id == t2) ||
                 (m_transforms[i].dst_frame_id == t2 && m_transforms[i].src_frame_id == t1) )
             {
+                delete_history(m_transforms[i].src_frame_id, m_transforms[i].dst_frame_id);
                 m_transforms.erase(m_transforms.begin() + i);
                 return true;
             }
@@ -131,6 +143,36 @@ void Transforms_server_storage::clear()
 {
     std::lock_guard<std::mutex> lock(m_mutex);
     m_transforms.clear();
+    m_histories.clear();
+}
+
+void Transforms_server_storage::delete_history(const std::string& src, const std::string& dst)
+{
+    // called with the mutex locked
+    m_histories.erase(frames_t(src, dst));
+}
+
+bool Transforms_server_storage::get_transform_at(const std::string& src, const std::string& dst, double time, double tolerance, FrameTransform& t)
+{
+    std::shared_ptr<FrameTransformHistory> history;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_histories.find(frames_t(src, dst));
+        if (it == m_histories.end())
+        {
+            return false;
+        }
+        history = it->second;
+    }
+
+    // the history is read without the lock, and it is not deleted while it is used
+    if (!history->getAt(time, t, tolerance))
+    {
+        return false;
+    }
+    t.src_frame_id = src;
+    t.dst_frame_id = dst;
+    return true;
 }
 
 /**
@@ -148,6 +190,7 @@ FrameTransformServer::FrameTransformServer() : PeriodicThread(DEFAULT_THREAD_PER
     m_ros_timed_transform_storage = nullptr;
     m_rosNode = nullptr;
     m_FrameTransformTimeout = 0.200; //ms
+    m_history_size = DEFAULT_HISTORY_SIZE;
 }
 
 FrameTransformServer::~FrameTransformServer()
@@ -323,6 +366,7 @@ bool FrameTransformServer::read(yarp::os::ConnectionReader& connection)
         out.addString("'delete_all': delete all transforms");
         out.addString("'set_static_transform <src> <dst> <x> <y> <z> <roll> <pitch> <yaw>': create a static transform");
         out.addString("'delete_static_transform <src> <dst>': delete a static transform");
+        out.addString("'get_transform_at <src> <dst> <time>': get a transform at a past time, interpolating its last values");
     }
     else if (request == "set_static_transform")
     {
@@ -367,6 +411,26 @@ bool FrameTransformServer::read(yarp::os::ConnectionReader& connection)
         m_ros_static_transform_storage->delete_transform(src,dst);
         out.addString("delete_static_transform done");
     }
+    else if (request == "get_transform_at")
+    {
+        std::string src = in.get(1).asString();
+        std::string dst = in.get(2).asString();
+        double time = in.get(3).asFloat64();
+        FrameTransform t;
+        // a timed transform is given until it expires, a static one forever
+        const double forever = std::numeric_limits<double>::infinity();
+        if (m_yarp_timed_transform_storage->get_transform_at(src, dst, time, m_FrameTransformTimeout, t) ||
+            m_yarp_static_transform_storage->get_transform_at(src, dst, time, forever, t) ||
+            m_ros_timed_transform_storage->get_transform_at(src, dst, time, m_FrameTransformTimeout, t) ||
+            m_ros_static_transform_storage->get_transform_at(src, dst, time, forever, t))
+        {
+            out.addString(t.toString());
+        }
+        else
+        {
+            out.addString("no value of the transform " + src + " -> " + dst + " at the requested time");
+        }
+    }
     else
     {
         yError("Invalid vocab received in FrameTransformServer");
@@ -443,11 +507,11 @@ bool FrameTransformServer::threadInit()
         m_rosSubscriberPort_tf_static.setStrict();
     }
 
-    m_yarp_static_transform_storage = new Transforms_server_storage();
-    m_yarp_timed_transform_storage = new Transforms_server_storage();
+    m_yarp_static_transform_storage = new Transforms_server_storage(m_history_size);
+    m_yarp_timed_transform_storage = new Transforms_server_storage(m_history_size);
 
-    m_ros_static_transform_storage = new Transforms_server_storage();
-    m_ros_timed_transform_storage = new Transforms_server_storage();
+    m_ros_static_transform_storage = new Transforms_server_storage(m_history_size);
+    m_ros_timed_transform_storage = new Transforms_server_storage(m_history_size);
 
     yInfo() << "Transform server started";
     return true;
@@ -567,6 +631,12 @@ bool FrameTransformServer::open(yarp::os::Searchable &config)
         yInfo() << "FrameTransformServer: transforms_lifetime set to:" << m_FrameTransformTimeout;
     }
 
+    if (config.check("history_size"))
+    {
+        m_history_size = static_cast<size_t>(std::max(config.find("history_size").asInt32(), 1));
+        yInfo() << "FrameTransformServer: history_size set to:" << m_history_size;
+    }
+
     std::string name;
     if (!config.check("name"))
     {
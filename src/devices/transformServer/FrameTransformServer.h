@@ -24,6 +24,9 @@
 #include <string>
 #include <sstream>
 #include <mutex>
+#include <map>
+#include <memory>
+#include <utility>
 
 #include <yarp/os/Network.h>
 #include <yarp/os/Port.h>
@@ -47,6 +50,7 @@
 #include <yarp/dev/IFrameTransform.h>
 
 #include <yarp/math/FrameTransform.h>
+#include <yarp/math/FrameTransformHistory.h>
 
 #include <yarp/rosmsg/geometry_msgs/TransformStamped.h>
 #include <yarp/rosmsg/tf2_msgs/TFMessage.h>
@@ -56,19 +60,28 @@
 #define ROSTOPICNAME_TF "/tf"
 #define ROSTOPICNAME_TF_STATIC "/tf_static"
 #define DEFAULT_THREAD_PERIOD 0.02 //s
+#define DEFAULT_HISTORY_SIZE 100
 
 class Transforms_server_storage
 {
 private:
+    typedef std::pair<std::string, std::string> frames_t;
+
     std::vector <yarp::math::FrameTransform> m_transforms;
+    // the past values of each transform, by (src, dst). They are kept when a transform expires
+    std::map <frames_t, std::shared_ptr<yarp::math::FrameTransformHistory>> m_histories;
+    size_t      m_history_size;
     std::mutex  m_mutex;
 
+    void     delete_history           (const std::string& src, const std::string& dst);
+
 public:
-     Transforms_server_storage()      {}
+     Transforms_server_storage(size_t history_size = DEFAULT_HISTORY_SIZE) : m_history_size(history_size) {}
      ~Transforms_server_storage()     {}
      bool     set_transform           (const yarp::math::FrameTransform& t);
      bool     delete_transform        (int id);
      bool     delete_transform        (std::string t1, std::string t2);
+     bool     get_transform_at        (const std::string& src, const std::string& dst, double time, double tolerance, yarp::math::FrameTransform& t);
      inline size_t   size()                                             { return m_transforms.size(); }
      inline yarp::math::FrameTransform& operator[]   (std::size_t idx)  { return m_transforms[idx]; }
      void clear                       ();
@@ -105,6 +118,7 @@ private:
     Transforms_server_storage*   m_yarp_timed_transform_storage;
     Transforms_server_storage*   m_yarp_static_transform_storage;
     double                       m_FrameTransformTimeout;
+    size_t                       m_history_size;
 
     yarp::os::RpcServer                      m_rpcPort;
     yarp::os::BufferedPort<yarp::os::Bottle> m_streamingPort;
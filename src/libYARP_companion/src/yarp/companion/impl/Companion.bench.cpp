@@ -0,0 +1,515 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <yarp/companion/impl/Companion.h>
+
+#include <yarp/os/Bottle.h>
+#include <yarp/os/BufferedPort.h>
+#include <yarp/os/Carriers.h>
+#include <yarp/os/ConnectionReader.h>
+#include <yarp/os/ConnectionWriter.h>
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Network.h>
+#include <yarp/os/Port.h>
+#include <yarp/os/Portable.h>
+#include <yarp/os/Property.h>
+#include <yarp/os/SystemClock.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using yarp::companion::impl::Companion;
+using namespace yarp::os;
+
+namespace {
+
+/*
+ * The message sent by the benchmark: a sequence number, the time it was
+ * sent, and a payload of the requested size.
+ * In text mode the payload is a string, so that the text carriers can
+ * carry it.
+ */
+class BenchMessage :
+        public Portable
+{
+public:
+    std::int32_t seq {0};
+    double stamp {0.0};
+    std::vector<char> payload;
+
+    bool write(ConnectionWriter& connection) const override
+    {
+        if (connection.isTextMode()) {
+            Bottle msg;
+            msg.addInt32(seq);
+            msg.addFloat64(stamp);
+            msg.addInt32(static_cast<std::int32_t>(payload.size()));
+            msg.addString(std::string(payload.size(), 'x'));
+            return msg.write(connection);
+        }
+        connection.appendInt32(seq);
+        connection.appendFloat64(stamp);
+        connection.appendInt32(static_cast<std::int32_t>(payload.size()));
+        connection.appendExternalBlock(payload.data(), payload.size());
+        return !connection.isError();
+    }
+
+    bool read(ConnectionReader& connection) override
+    {
+        if (connection.isTextMode()) {
+            Bottle msg;
+            if (!msg.read(connection) || msg.size() != 4) {
+                return false;
+            }
+            seq = msg.get(0).asInt32();
+            stamp = msg.get(1).asFloat64();
+            payload.resize(static_cast<size_t>(msg.get(2).asInt32()));
+            return true;
+        }
+        seq = connection.expectInt32();
+        stamp = connection.expectFloat64();
+        std::int32_t size = connection.expectInt32();
+        if (connection.isError() || size < 0) {
+            return false;
+        }
+        payload.resize(static_cast<size_t>(size));
+        return connection.expectBlock(payload.data(), payload.size());
+    }
+};
+
+
+// The settings of a single run of the benchmark
+struct BenchCase
+{
+    std::string carrier;
+    size_t size {0};
+    int fanout {1};
+    bool callback {false};
+    bool strict {true};
+    int count {0};
+};
+
+// The results of a single run of the benchmark
+struct BenchResult
+{
+    BenchCase settings;
+    int sent {0};
+    size_t received {0};
+    double duration {0.0};
+    // one-way latencies, in seconds, sorted
+    std::vector<double> latencies;
+
+    double percentile(double fraction) const
+    {
+        if (latencies.empty()) {
+            return 0.0;
+        }
+        auto index = static_cast<size_t>(fraction * static_cast<double>(latencies.size() - 1) + 0.5);
+        return latencies[std::min(index, latencies.size() - 1)];
+    }
+
+    double mean() const
+    {
+        double sum = 0.0;
+        for (double latency : latencies) {
+            sum += latency;
+        }
+        return latencies.empty() ? 0.0 : sum / static_cast<double>(latencies.size());
+    }
+
+    double messageRate() const
+    {
+        return (duration > 0) ? static_cast<double>(received) / duration : 0.0;
+    }
+
+    double byteRate() const
+    {
+        return messageRate() * static_cast<double>(settings.size);
+    }
+};
+
+
+// A reader of the messages, by callback or by polling from its own thread
+class BenchReader :
+        public TypedReaderCallback<BenchMessage>
+{
+public:
+    BufferedPort<BenchMessage> port;
+
+    BenchReader(int count) :
+            m_count(count)
+    {
+        m_latencies.reserve(static_cast<size_t>(count));
+    }
+
+    bool open(const std::string& name, bool callback, bool strict)
+    {
+        port.setStrict(strict);
+        if (!port.open(name)) {
+            return false;
+        }
+        if (callback) {
+            port.useCallback(*this);
+        } else {
+            m_thread = std::thread([this]() {
+                BenchMessage* msg = nullptr;
+                while ((msg = port.read(true)) != nullptr) {
+                    onRead(*msg);
+                }
+            });
+        }
+        return true;
+    }
+
+    void close()
+    {
+        port.interrupt();
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+        port.close();
+    }
+
+    using TypedReaderCallback<BenchMessage>::onRead;
+    void onRead(BenchMessage& msg) override
+    {
+        double now = SystemClock::nowSystem();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_last = now;
+        m_lastSeq = msg.seq;
+        // the messages before 0 warm up the connection
+        if (msg.seq >= 0) {
+            m_latencies.push_back(now - msg.stamp);
+        }
+    }
+
+    bool done()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_lastSeq == m_count - 1;
+    }
+
+    double last()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_last;
+    }
+
+    size_t received(std::vector<double>& latencies)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        latencies.insert(latencies.end(), m_latencies.begin(), m_latencies.end());
+        return m_latencies.size();
+    }
+
+private:
+    int m_count;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::vector<double> m_latencies;
+    std::int32_t m_lastSeq {-1000000};
+    double m_last {0.0};
+};
+
+
+bool runBench(const BenchCase& settings, int warmup, double period, BenchResult& result)
+{
+    result.settings = settings;
+
+    Port writer;
+    writer.setWriteOnly();
+    if (!writer.open("/yarp/bench/out")) {
+        return false;
+    }
+    std::vector<std::unique_ptr<BenchReader>> readers;
+    bool ok = true;
+    for (int i = 0; i < settings.fanout && ok; i++) {
+        readers.emplace_back(new BenchReader(settings.count));
+        std::string name = "/yarp/bench/in/" + std::to_string(i);
+        ok = readers.back()->open(name, settings.callback, settings.strict);
+        ok = ok && NetworkBase::connect(writer.getName(), name, settings.carrier, true);
+        ok = ok && NetworkBase::sync(name, true);
+    }
+    NetworkBase::sync(writer.getName(), true);
+
+    if (ok) {
+        BenchMessage msg;
+        msg.payload.assign(settings.size, 0);
+        for (int i = -warmup; i < 0; i++) {
+            msg.seq = i;
+            msg.stamp = SystemClock::nowSystem();
+            writer.write(msg);
+            SystemClock::delaySystem(0.001);
+        }
+        // wait for the warm up messages to be handled
+        SystemClock::delaySystem(0.1);
+
+        double start = SystemClock::nowSystem();
+        for (int i = 0; i < settings.count; i++) {
+            msg.seq = i;
+            msg.stamp = SystemClock::nowSystem();
+            writer.write(msg);
+            result.sent++;
+            if (period > 0) {
+                SystemClock::delaySystem(period);
+            }
+        }
+
+        // wait for the last message, unless it was lost
+        const double patience = 1.0;
+        double waitStart = SystemClock::nowSystem();
+        for (auto& reader : readers) {
+            while (!reader->done() &&
+                   SystemClock::nowSystem() - std::max(waitStart, reader->last()) < patience) {
+                SystemClock::delaySystem(0.001);
+            }
+        }
+
+        double end = start;
+        for (auto& reader : readers) {
+            result.received += reader->received(result.latencies);
+            end = std::max(end, reader->last());
+        }
+        result.duration = end - start;
+        std::sort(result.latencies.begin(), result.latencies.end());
+    }
+
+    writer.close();
+    for (auto& reader : readers) {
+        reader->close();
+    }
+    return ok;
+}
+
+
+std::vector<std::string> splitList(const Value& value)
+{
+    std::vector<std::string> items;
+    std::stringstream ss(value.toString());
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+std::string sizeName(size_t size)
+{
+    if (size >= 1024 * 1024 && size % (1024 * 1024) == 0) {
+        return std::to_string(size / (1024 * 1024)) + "MB";
+    }
+    if (size >= 1024 && size % 1024 == 0) {
+        return std::to_string(size / 1024) + "kB";
+    }
+    return std::to_string(size) + "B";
+}
+
+std::string formatResult(const BenchResult& r, const std::string& format)
+{
+    // latencies in microseconds, throughput in messages/s and MB/s
+    char buf[1024];
+    const char* reader = r.settings.callback ? "callback" : "poll";
+    const char* buffer = r.settings.strict ? "strict" : "latest";
+    size_t expected = static_cast<size_t>(r.sent) * static_cast<size_t>(r.settings.fanout);
+    size_t lost = (expected > r.received) ? expected - r.received : 0;
+    if (format == "json") {
+        snprintf(buf,
+                 sizeof(buf),
+                 R"({"carrier": "%s", "size": %zu, "fanout": %d, "reader": "%s", "buffer": "%s", )"
+                 R"("sent": %d, "received": %zu, "lost": %zu, )"
+                 R"("latency_us": {"min": %.3f, "mean": %.3f, "p50": %.3f, "p90": %.3f, "p99": %.3f, "p999": %.3f, "max": %.3f}, )"
+                 R"("messages_per_s": %.1f, "mb_per_s": %.3f})",
+                 r.settings.carrier.c_str(), r.settings.size, r.settings.fanout, reader, buffer,
+                 r.sent, r.received, lost,
+                 r.percentile(0) * 1e6, r.mean() * 1e6, r.percentile(0.5) * 1e6, r.percentile(0.9) * 1e6,
+                 r.percentile(0.99) * 1e6, r.percentile(0.999) * 1e6, r.percentile(1) * 1e6,
+                 r.messageRate(), r.byteRate() / 1e6);
+    } else if (format == "csv") {
+        snprintf(buf,
+                 sizeof(buf),
+                 "%s,%zu,%d,%s,%s,%d,%zu,%zu,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.1f,%.3f",
+                 r.settings.carrier.c_str(), r.settings.size, r.settings.fanout, reader, buffer,
+                 r.sent, r.received, lost,
+                 r.percentile(0) * 1e6, r.mean() * 1e6, r.percentile(0.5) * 1e6, r.percentile(0.9) * 1e6,
+                 r.percentile(0.99) * 1e6, r.percentile(0.999) * 1e6, r.percentile(1) * 1e6,
+                 r.messageRate(), r.byteRate() / 1e6);
+    } else {
+        snprintf(buf,
+                 sizeof(buf),
+                 "%-9s %6s x%-3d %-8s %-6s  %7zu/%-7zu  p50 %10.1f us  p99 %10.1f us  max %10.1f us  %10.1f msg/s  %9.2f MB/s",
+                 r.settings.carrier.c_str(), sizeName(r.settings.size).c_str(), r.settings.fanout, reader, buffer,
+                 r.received, expected,
+                 r.percentile(0.5) * 1e6, r.percentile(0.99) * 1e6, r.percentile(1) * 1e6,
+                 r.messageRate(), r.byteRate() / 1e6);
+    }
+    return buf;
+}
+
+const char* csvHeader = "carrier,size,fanout,reader,buffer,sent,received,lost,"
+                        "latency_min_us,latency_mean_us,latency_p50_us,latency_p90_us,"
+                        "latency_p99_us,latency_p999_us,latency_max_us,messages_per_s,mb_per_s";
+
+} // namespace
+
+
+int Companion::cmdBench(int argc, char* argv[])
+{
+    Property options;
+    options.fromCommand(argc, argv, false);
+    if (options.check("help")) {
+        yCInfo(COMPANION, "Measure the one-way latency and the throughput of the connections between ports.");
+        yCInfo(COMPANION);
+        yCInfo(COMPANION, "Usage:");
+        yCInfo(COMPANION, "  yarp bench [options]");
+        yCInfo(COMPANION);
+        yCInfo(COMPANION, "Options (the lists are separated by commas):");
+        yCInfo(COMPANION, "  --carrier tcp,fast_tcp,...  carriers to test (default: tcp,fast_tcp,udp,mcast,shmem,local,text)");
+        yCInfo(COMPANION, "  --size 8,64,...             sizes of the messages, in bytes (default: 8 B to 8 MB)");
+        yCInfo(COMPANION, "  --fanout 1,2,...            numbers of readers of each message (default: 1)");
+        yCInfo(COMPANION, "  --reader poll,callback      how the messages are read (default: poll)");
+        yCInfo(COMPANION, "  --buffer strict,latest      whether the readers keep all the messages or only the latest (default: strict)");
+        yCInfo(COMPANION, "  --count N                   messages sent for each test (default: 1000)");
+        yCInfo(COMPANION, "  --max-bytes N               at most N bytes sent for each test, but at least 10 messages (default: 256 MB)");
+        yCInfo(COMPANION, "  --warmup N                  messages sent before each test (default: 10)");
+        yCInfo(COMPANION, "  --period T                  seconds between the messages (default: 0, as fast as possible)");
+        yCInfo(COMPANION, "  --format text|json|csv      format of the results (default: text)");
+        yCInfo(COMPANION, "  --output FILE               write the results to FILE rather than to standard output");
+        yCInfo(COMPANION, "  --network                   register the ports on the name server, instead of in this process");
+        return EXIT_SUCCESS;
+    }
+
+    std::vector<std::string> carriers {"tcp", "fast_tcp", "udp", "mcast", "shmem", "local", "text"};
+    if (options.check("carrier")) {
+        carriers = splitList(options.find("carrier"));
+    }
+    std::vector<size_t> sizes {8, 64, 512, 4096, 32768, 262144, 2097152, 8388608};
+    if (options.check("size")) {
+        sizes.clear();
+        for (const auto& size : splitList(options.find("size"))) {
+            sizes.push_back(static_cast<size_t>(std::strtoull(size.c_str(), nullptr, 10)));
+        }
+    }
+    std::vector<int> fanouts {1};
+    if (options.check("fanout")) {
+        fanouts.clear();
+        for (const auto& fanout : splitList(options.find("fanout"))) {
+            fanouts.push_back(std::max(1, std::atoi(fanout.c_str())));
+        }
+    }
+    std::vector<bool> callbacks;
+    for (const auto& reader : splitList(options.check("reader", Value("poll")))) {
+        if (reader != "poll" && reader != "callback") {
+            yCError(COMPANION, "Unknown reader '%s', it must be poll or callback", reader.c_str());
+            return EXIT_FAILURE;
+        }
+        callbacks.push_back(reader == "callback");
+    }
+    std::vector<bool> stricts;
+    for (const auto& buffer : splitList(options.check("buffer", Value("strict")))) {
+        if (buffer != "strict" && buffer != "latest") {
+            yCError(COMPANION, "Unknown buffer '%s', it must be strict or latest", buffer.c_str());
+            return EXIT_FAILURE;
+        }
+        stricts.push_back(buffer == "strict");
+    }
+    int count = std::max(1, options.check("count", Value(1000)).asInt32());
+    double maxBytes = options.check("max-bytes", Value(256.0 * 1024 * 1024)).asFloat64();
+    int warmup = std::max(0, options.check("warmup", Value(10)).asInt32());
+    double period = options.check("period", Value(0.0)).asFloat64();
+    std::string format = options.check("format", Value("text")).asString();
+    if (format != "text" && format != "json" && format != "csv") {
+        yCError(COMPANION, "Unknown format '%s', it must be text, json or csv", format.c_str());
+        return EXIT_FAILURE;
+    }
+
+    FILE* out = stdout;
+    if (options.check("output")) {
+        out = fopen(options.find("output").asString().c_str(), "w");
+        if (out == nullptr) {
+            yCError(COMPANION, "Cannot write to %s", options.find("output").asString().c_str());
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Without a name server, the results depend only on this machine
+    bool local = !options.check("network");
+    if (local) {
+        NetworkBase::setLocalMode(true);
+    }
+
+    // The text results are printed as soon as they are ready, the json and
+    // csv ones at the end, so that they are not mixed with the messages of
+    // the ports
+    std::vector<std::string> results;
+    int failures = 0;
+    for (const auto& carrier : carriers) {
+        if (Carriers::getCarrierTemplate(carrier) == nullptr) {
+            yCWarning(COMPANION, "Carrier %s is not available, skipping it", carrier.c_str());
+            continue;
+        }
+        for (size_t size : sizes) {
+            for (int fanout : fanouts) {
+                for (bool callback : callbacks) {
+                    for (bool strict : stricts) {
+                        BenchCase settings;
+                        settings.carrier = carrier;
+                        settings.size = size;
+                        settings.fanout = fanout;
+                        settings.callback = callback;
+                        settings.strict = strict;
+                        settings.count = count;
+                        if (size > 0 && count * static_cast<double>(size) > maxBytes) {
+                            settings.count = std::max(10, static_cast<int>(maxBytes / static_cast<double>(size)));
+                        }
+                        BenchResult result;
+                        if (!runBench(settings, warmup, period, result)) {
+                            yCError(COMPANION, "Cannot connect with carrier %s", carrier.c_str());
+                            failures++;
+                            continue;
+                        }
+                        if (format == "text") {
+                            fprintf(out, "%s\n", formatResult(result, format).c_str());
+                            fflush(out);
+                        } else {
+                            results.push_back(formatResult(result, format));
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    if (format == "json") {
+        fprintf(out, "{\"yarp\": \"%s\", \"results\": [", version().c_str());
+        for (size_t i = 0; i < results.size(); i++) {
+            fprintf(out, "%s\n  %s", (i == 0) ? "" : ",", results[i].c_str());
+        }
+        fprintf(out, "\n]}\n");
+    } else if (format == "csv") {
+        fprintf(out, "%s\n", csvHeader);
+        for (const auto& result : results) {
+            fprintf(out, "%s\n", result.c_str());
+        }
+    }
+    if (out != stdout) {
+        fclose(out);
+    }
+    if (local) {
+        NetworkBase::setLocalMode(false);
+    }
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
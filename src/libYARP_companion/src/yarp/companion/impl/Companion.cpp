@@ -278,6 +278,7 @@ Companion::Companion() :
     adminMode(false),
     waitConnect(false)
 {
+    add("bench",           &Companion::cmdBench,          "measure the latency and the throughput of the connections between ports");
     add("check",           &Companion::cmdCheck,          "run a simple sanity check to see if yarp is working");
     add("clean",           &Companion::cmdClean,          "try to remove inactive entries from the name server");
     add("clock",           &Companion::cmdClock,          "creates a server publishing the system time");
@@ -303,6 +304,7 @@ Companion::Companion() :
     add("rpcserver",       &Companion::cmdRpcServer,      "make a test RPC server to receive and reply to Bottle-format messages");
     add("sample",          &Companion::cmdSample,         "drop or duplicate messages to achieve a constant frame-rate");
     add("priority-sched",  &Companion::cmdPrioritySched,  "set/get the thread policy and priority for a given connection");
+    add("stats",           &Companion::cmdStats,          "get the counters of the messages sent and received by a port");
     add("terminate",       &Companion::cmdTerminate,      "terminate a yarp-terminate-aware process by name");
     add("time",            &Companion::cmdTime,           "show the time");
     add("topic",           &Companion::cmdTopic,          "set a topic name");
@@ -552,6 +554,108 @@ int Companion::ping(const char *port, bool quiet) {
 }
 
 
+static std::string stats_bytes(double bytes)
+{
+    const char* units[] = {"B", "kB", "MB", "GB", "TB"};
+    size_t unit = 0;
+    while (bytes >= 1000 && unit < 4) {
+        bytes /= 1000;
+        unit++;
+    }
+    char buf[64];
+    snprintf(buf, sizeof(buf), (unit == 0) ? "%.0f %s" : "%.1f %s", bytes, units[unit]);
+    return buf;
+}
+
+static std::string stats_time(const Searchable& time)
+{
+    // durations in microseconds
+    char buf[256];
+    snprintf(buf,
+             sizeof(buf),
+             "mean %.1f us, p50 %.1f us, p90 %.1f us, p99 %.1f us, p999 %.1f us, max %.1f us",
+             time.find("mean").asFloat64() * 1e6,
+             time.find("p50").asFloat64() * 1e6,
+             time.find("p90").asFloat64() * 1e6,
+             time.find("p99").asFloat64() * 1e6,
+             time.find("p999").asFloat64() * 1e6,
+             time.find("max").asFloat64() * 1e6);
+    return buf;
+}
+
+static void stats_connections(const Bottle& connections, const char* direction, const char* time)
+{
+    for (size_t i = 1; i < connections.size(); i++) {
+        Bottle* connection = connections.get(i).asList();
+        if (connection == nullptr) {
+            continue;
+        }
+        Searchable& stats = connection->get(1);
+        double messages = static_cast<double>(stats.find("messages").asInt64());
+        double uptime = stats.find("uptime").asFloat64();
+        yCInfo(COMPANION,
+               "  %s %s (%s): %.0f messages, %s, %.1f messages/s, %lld errors, %lld skipped",
+               direction,
+               connection->get(0).asString().c_str(),
+               stats.find("carrier").asString().c_str(),
+               messages,
+               stats_bytes(static_cast<double>(stats.find("bytes").asInt64())).c_str(),
+               (uptime > 0) ? messages / uptime : 0.0,
+               static_cast<long long>(stats.find("errors").asInt64()),
+               static_cast<long long>(stats.find("skipped").asInt64()));
+        Bottle& timeGroup = stats.findGroup("time");
+        if (timeGroup.find("count").asInt64() > 0) {
+            yCInfo(COMPANION, "    %s: %s", time, stats_time(timeGroup).c_str());
+        }
+    }
+}
+
+int Companion::cmdStats(int argc, char *argv[])
+{
+    if (argc != 1) {
+        yCError(COMPANION, "Usage:");
+        yCError(COMPANION, "  yarp stats /port");
+        return 1;
+    }
+
+    Bottle cmd;
+    Bottle reply;
+    cmd.addString("prop");
+    cmd.addString("get");
+    cmd.addString("stats");
+    if (!NetworkBase::write(Contact::fromString(argv[0]), cmd, reply, true, true, 2.0)) {
+        yCError(COMPANION, "Cannot write to %s", argv[0]);
+        return 1;
+    }
+    Bottle& port = reply.findGroup("port");
+    if (port.isNull()) {
+        yCError(COMPANION, "%s did not report its counters: %s", argv[0], reply.toString().c_str());
+        return 1;
+    }
+
+    yCInfo(COMPANION, "%s: %d messages being sent",
+           argv[0],
+           port.get(1).find("in_flight").asInt32());
+    Bottle& buffer = reply.findGroup("buffer");
+    if (!buffer.isNull()) {
+        Searchable& stats = buffer.get(1);
+        yCInfo(COMPANION,
+               "  buffer: %lld received, %lld dropped, %d waiting to be read (at most %d)",
+               static_cast<long long>(stats.find("received").asInt64()),
+               static_cast<long long>(stats.find("dropped").asInt64()),
+               stats.find("depth").asInt32(),
+               stats.find("max_depth").asInt32());
+        Bottle& wait = stats.findGroup("wait");
+        if (wait.find("count").asInt64() > 0) {
+            yCInfo(COMPANION, "    waiting for space: %s", stats_time(wait).c_str());
+        }
+    }
+    stats_connections(reply.findGroup("out"), "out", "write time");
+    stats_connections(reply.findGroup("in"), "in", "read time");
+    return 0;
+}
+
+
 int Companion::cmdExists(int argc, char *argv[]) {
     if (argc == 1) {
         bool ok = NetworkBase::exists(argv[0], true);
@@ -158,6 +158,10 @@ public:
 
     int cmdPrioritySched(int argc, char *argv[]);
 
+    int cmdStats(int argc, char *argv[]);
+
+    int cmdBench(int argc, char *argv[]);
+
     int subscribe(const char *src,
                   const char *dest,
                   const char *mode = nullptr);
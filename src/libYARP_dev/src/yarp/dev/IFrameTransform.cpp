@@ -9,3 +9,12 @@
 #include <yarp/dev/IFrameTransform.h>
 
 yarp::dev::IFrameTransform::~IFrameTransform() = default;
+
+bool yarp::dev::IFrameTransform::getTransformAt(const std::string& target_frame_id, const std::string& source_frame_id, double time, yarp::sig::Matrix& transform)
+{
+    YARP_UNUSED(target_frame_id);
+    YARP_UNUSED(source_frame_id);
+    YARP_UNUSED(time);
+    YARP_UNUSED(transform);
+    return false;
+}
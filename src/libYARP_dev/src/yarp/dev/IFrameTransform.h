@@ -97,6 +97,17 @@ public:
     */
     virtual bool     getTransform (const std::string &target_frame_id, const std::string &source_frame_id, yarp::sig::Matrix &transform) = 0;
 
+    /**
+     Get the transform between two frames at a given time, interpolated from
+     the past values of the transforms.
+    * @param target_frame_id the name of target reference frame
+    * @param source_frame_id the name of source reference frame
+    * @param time the time of the transform
+    * @param transform the transformation matrix from source_frame_id to target_frame_id
+    * @return true/false (false also if the implementation does not keep the past values)
+    */
+    virtual bool     getTransformAt (const std::string &target_frame_id, const std::string &source_frame_id, double time, yarp::sig::Matrix &transform);
+
     /**
      Register a transform between two frames.
      * @param target_frame_id the name of target reference frame
@@ -57,6 +57,67 @@ inline Eigen::Map<const Eigen::Matrix<double,Eigen::Dynamic,Eigen::Dynamic,Eigen
     return Eigen::Map<const Eigen::Matrix<double,Eigen::Dynamic,Eigen::Dynamic,Eigen::RowMajor> >(yarpMatrix.data(),yarpMatrix.rows(),yarpMatrix.cols());
 }
 
+/**
+ * Fixed size Eigen::Matrix type with the storage order of yarp::sig::Matrix
+ * (a single column is column major, as required by Eigen)
+ */
+template <int Rows, int Cols>
+using FixedMatrix = Eigen::Matrix<double, Rows, Cols, (Cols == 1 ? Eigen::ColMajor : Eigen::RowMajor)>;
+
+/**
+ * Convert a yarp::sig::Vector of size N to a Eigen::Map<Eigen::Matrix<double,N,1> > object
+ *
+ * The size is known at compile time, so that the expressions using it are
+ * unrolled, and their temporaries are allocated on the stack.
+ * @param yarpVector yarp::sig::Vector input, of size N
+ * @return a Eigen::Map vector that points to the data contained in the yarp vector
+ */
+template <int N>
+inline Eigen::Map<FixedMatrix<N, 1>> toEigen(yarp::sig::Vector & yarpVector)
+{
+    eigen_assert(yarpVector.size() == N);
+    return Eigen::Map<FixedMatrix<N, 1>>(yarpVector.data());
+}
+
+/**
+ * Convert a const yarp::sig::Vector of size N to a Eigen::Map<const Eigen::Matrix<double,N,1> > object
+ * @param yarpVector yarp::sig::Vector input, of size N
+ * @return a Eigen::Map vector that points to the data contained in the yarp vector
+ */
+template <int N>
+inline Eigen::Map<const FixedMatrix<N, 1>> toEigen(const yarp::sig::Vector & yarpVector)
+{
+    eigen_assert(yarpVector.size() == N);
+    return Eigen::Map<const FixedMatrix<N, 1>>(yarpVector.data());
+}
+
+/**
+ * Convert a yarp::sig::Matrix of size RowsxCols to a Eigen::Map< Eigen::Matrix<double,Rows,Cols,Eigen::RowMajor> > object
+ *
+ * The size is known at compile time, so that the expressions using it are
+ * unrolled, and their temporaries are allocated on the stack.
+ * @param yarpMatrix yarp::sig::Matrix input, of size RowsxCols
+ * @return a Eigen::Map matrix that points to the data contained in the yarp matrix
+ */
+template <int Rows, int Cols>
+inline Eigen::Map<FixedMatrix<Rows, Cols>> toEigen(yarp::sig::Matrix & yarpMatrix)
+{
+    eigen_assert(yarpMatrix.rows() == Rows && yarpMatrix.cols() == Cols);
+    return Eigen::Map<FixedMatrix<Rows, Cols>>(yarpMatrix.data());
+}
+
+/**
+ * Convert a const yarp::sig::Matrix of size RowsxCols to a Eigen::Map< const Eigen::Matrix<double,Rows,Cols,Eigen::RowMajor> > object
+ * @param yarpMatrix yarp::sig::Matrix input, of size RowsxCols
+ * @return a Eigen::Map matrix that points to the data contained in the yarp matrix
+ */
+template <int Rows, int Cols>
+inline Eigen::Map<const FixedMatrix<Rows, Cols>> toEigen(const yarp::sig::Matrix & yarpMatrix)
+{
+    eigen_assert(yarpMatrix.rows() == Rows && yarpMatrix.cols() == Cols);
+    return Eigen::Map<const FixedMatrix<Rows, Cols>>(yarpMatrix.data());
+}
+
 } // namespace eigen
 } // namespace yarp
 
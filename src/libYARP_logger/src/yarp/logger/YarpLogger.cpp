@@ -16,6 +16,7 @@
 #include <yarp/os/RpcClient.h>
 #include <yarp/os/SystemClock.h>
 #include <yarp/logger/YarpLogger.h>
+#include <yarp/os/impl/LogRecord.h>
 
 using namespace yarp::os;
 using namespace yarp::yarpLogger;
@@ -218,6 +219,74 @@ LoggerEngine::logger_thread::logger_thread (std::string _portname, double _perio
         unknown_format_received      = 0;
 }
 
+void LoggerEngine::logger_thread::append_message(const std::string& header, const MessageEntry& body, std::time_t machine_current_time)
+{
+    if (body.level == LOGLEVEL_UNDEFINED && listen_to_LOGLEVEL_UNDEFINED == false) {return;}
+    if (body.level == LOGLEVEL_TRACE     && listen_to_LOGLEVEL_TRACE     == false) {return;}
+    if (body.level == LOGLEVEL_DEBUG     && listen_to_LOGLEVEL_DEBUG     == false) {return;}
+    if (body.level == LOGLEVEL_INFO      && listen_to_LOGLEVEL_INFO      == false) {return;}
+    if (body.level == LOGLEVEL_WARNING   && listen_to_LOGLEVEL_WARNING   == false) {return;}
+    if (body.level == LOGLEVEL_ERROR     && listen_to_LOGLEVEL_ERROR     == false) {return;}
+    if (body.level == LOGLEVEL_FATAL     && listen_to_LOGLEVEL_FATAL     == false) {return;}
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    LogEntry entry;
+    entry.logInfo.port_complete = header;
+    entry.logInfo.port_complete.erase(0,1);
+    entry.logInfo.port_complete.erase(entry.logInfo.port_complete.size()-1);
+    std::istringstream iss(header);
+    std::string token;
+    getline(iss, token, '/');
+    getline(iss, token, '/'); entry.logInfo.port_system  = token;
+    getline(iss, token, '/'); entry.logInfo.port_prefix  = "/"+ token;
+    getline(iss, token, '/'); entry.logInfo.process_name = token;
+    getline(iss, token, '/'); entry.logInfo.process_pid  = token.erase(token.size()-1);
+    if (entry.logInfo.port_system == "log" && listen_to_YARP_MESSAGES==false)    return;
+    if (entry.logInfo.port_system == "yarprunlog" && listen_to_YARPRUN_MESSAGES==false) return;
+
+    std::list<LogEntry>::iterator it;
+    for (it = log_list.begin(); it != log_list.end(); it++)
+    {
+        if (it->logInfo.port_complete==entry.logInfo.port_complete)
+        {
+            if (it->logging_enabled)
+            {
+                it->logInfo.setNewError(body.level);
+                it->logInfo.last_update=machine_current_time;
+                it->append_logEntry(body);
+            }
+            else
+            {
+                //just skipping this message
+            }
+            break;
+        }
+    }
+    if (it == log_list.end())
+    {
+        if (log_list.size() < log_list_max_size || log_list_max_size_enabled==false )
+        {
+            yarp::os::Contact contact = yarp::os::Network::queryName(entry.logInfo.port_complete);
+            if (contact.isValid())
+            {
+                entry.logInfo.setNewError(body.level);
+                entry.logInfo.ip_address = contact.getHost();
+            }
+            else
+            {
+                printf("ERROR: invalid contact: %s\n", entry.logInfo.port_complete.c_str());
+            };
+            entry.append_logEntry(body);
+            entry.logInfo.last_update=machine_current_time;
+            log_list.push_back(entry);
+        }
+        //else
+        //{
+        //    printf("WARNING: exceeded log_list_max_size=%d\n",log_list_max_size);
+        //}
+    }
+}
+
 void LoggerEngine::logger_thread::run()
 {
     //if (is_discovering()==true)
@@ -249,7 +318,7 @@ void LoggerEngine::logger_thread::run()
                 return;
             }
 
-            if (b->size()!=2)
+            if (b->size()<2)
             {
                 fprintf (stderr, "ERROR: unknown log format!\n");
                 unknown_format_received++;
@@ -278,6 +347,45 @@ void LoggerEngine::logger_thread::run()
             body.yarprun_timestamp = string(ttstr);
             body.local_timestamp   = machine_current_time_s;
 
+            if (b->get(1).isBlob())
+            {
+                // Binary records (yarp::os::impl::LogRecord), possibly more than one
+                for (size_t i = 1; i < b->size(); i++)
+                {
+                    yarp::os::impl::LogRecord record;
+                    if (!b->get(i).isBlob() || !record.decode(b->get(i).asBlob(), b->get(i).asBlobLength()))
+                    {
+                        fprintf(stderr, "ERROR: unknown log format!\n");
+                        unknown_format_received++;
+                        continue;
+                    }
+                    // yarp::os::Log::LogType and LogLevelEnum have the same values
+                    body.level       = static_cast<int>(record.type);
+                    body.text        = record.message;
+                    body.filename    = record.filename;
+                    body.line        = record.line;
+                    body.function    = record.function;
+                    body.hostname    = record.hostname;
+                    body.pid         = record.pid;
+                    body.cmd         = record.cmd;
+                    body.args        = record.args;
+                    body.thread_id   = record.thread_id;
+                    body.component   = record.component;
+                    body.systemtime  = record.systemtime;
+                    body.networktime = record.networktime;
+                    body.backtrace   = record.backtrace;
+                    append_message(header, body, machine_current_time);
+                }
+                continue;
+            }
+
+            if (b->size()!=2)
+            {
+                fprintf (stderr, "ERROR: unknown log format!\n");
+                unknown_format_received++;
+                continue;
+            }
+
             std::string s;
 
             if (b->get(1).isString())
@@ -416,72 +524,7 @@ void LoggerEngine::logger_thread::run()
                 }
             }
 
-            if (body.level == LOGLEVEL_UNDEFINED && listen_to_LOGLEVEL_UNDEFINED == false) {continue;}
-            if (body.level == LOGLEVEL_TRACE     && listen_to_LOGLEVEL_TRACE     == false) {continue;}
-            if (body.level == LOGLEVEL_DEBUG     && listen_to_LOGLEVEL_DEBUG     == false) {continue;}
-            if (body.level == LOGLEVEL_INFO      && listen_to_LOGLEVEL_INFO      == false) {continue;}
-            if (body.level == LOGLEVEL_WARNING   && listen_to_LOGLEVEL_WARNING   == false) {continue;}
-            if (body.level == LOGLEVEL_ERROR     && listen_to_LOGLEVEL_ERROR     == false) {continue;}
-            if (body.level == LOGLEVEL_FATAL     && listen_to_LOGLEVEL_FATAL     == false) {continue;}
-
-            this->mutex.lock();
-            LogEntry entry;
-            entry.logInfo.port_complete = header;
-            entry.logInfo.port_complete.erase(0,1);
-            entry.logInfo.port_complete.erase(entry.logInfo.port_complete.size()-1);
-            std::istringstream iss(header);
-            std::string token;
-            getline(iss, token, '/');
-            getline(iss, token, '/'); entry.logInfo.port_system  = token;
-            getline(iss, token, '/'); entry.logInfo.port_prefix  = "/"+ token;
-            getline(iss, token, '/'); entry.logInfo.process_name = token;
-            getline(iss, token, '/'); entry.logInfo.process_pid  = token.erase(token.size()-1);
-            if (entry.logInfo.port_system == "log" && listen_to_YARP_MESSAGES==false)    continue;
-            if (entry.logInfo.port_system == "yarprunlog" && listen_to_YARPRUN_MESSAGES==false) continue;
-
-            std::list<LogEntry>::iterator it;
-            for (it = log_list.begin(); it != log_list.end(); it++)
-            {
-                if (it->logInfo.port_complete==entry.logInfo.port_complete)
-                {
-                    if (it->logging_enabled)
-                    {
-                        it->logInfo.setNewError(body.level);
-                        it->logInfo.last_update=machine_current_time;
-                        it->append_logEntry(body);
-                    }
-                    else
-                    {
-                        //just skipping this message
-                    }
-                    break;
-                }
-            }
-            if (it == log_list.end())
-            {
-                if (log_list.size() < log_list_max_size || log_list_max_size_enabled==false )
-                {
-                    yarp::os::Contact contact = yarp::os::Network::queryName(entry.logInfo.port_complete);
-                    if (contact.isValid())
-                    {
-                        entry.logInfo.setNewError(body.level);
-                        entry.logInfo.ip_address = contact.getHost();
-                    }
-                    else
-                    {
-                        printf("ERROR: invalid contact: %s\n", entry.logInfo.port_complete.c_str());
-                    };
-                    entry.append_logEntry(body);
-                    entry.logInfo.last_update=machine_current_time;
-                    log_list.push_back(entry);
-                }
-                //else
-                //{
-                //    printf("WARNING: exceeded log_list_max_size=%d\n",log_list_max_size);
-                //}
-            }
-
-            this->mutex.unlock();
+            append_message(header, body, machine_current_time);
         }
     }
 
@@ -224,6 +224,7 @@ class yarp::yarpLogger::LoggerEngine
         std::string getPortName();
         void        run() override;
         void        threadRelease() override;
+        void        append_message(const std::string& header, const MessageEntry& body, std::time_t machine_current_time);
         bool        listen_to_LOGLEVEL_UNDEFINED;
         bool        listen_to_LOGLEVEL_TRACE;
         bool        listen_to_LOGLEVEL_DEBUG;
@@ -0,0 +1,321 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <yarp/math/FrameTransformHistory.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+using yarp::math::FrameTransform;
+using yarp::math::FrameTransformHistory;
+
+namespace {
+
+enum Field
+{
+    TIMESTAMP = 0,
+    TX,
+    TY,
+    TZ,
+    QW,
+    QX,
+    QY,
+    QZ,
+    FIELDS
+};
+
+// The fields are atomic, so that reading a sample while it is written is
+// not a data race: the readers detect it using the sequence number.
+struct Sample
+{
+    std::atomic<double> v[FIELDS];
+};
+
+void toFrameTransform(const double (&v)[FIELDS], FrameTransform& t)
+{
+    t.timestamp = v[TIMESTAMP];
+    t.translation.set(v[TX], v[TY], v[TZ]);
+    t.rotation.w() = v[QW];
+    t.rotation.x() = v[QX];
+    t.rotation.y() = v[QY];
+    t.rotation.z() = v[QZ];
+}
+
+} // namespace
+
+
+class FrameTransformHistory::Private
+{
+public:
+    explicit Private(size_t capacity) :
+            capacity(std::max<size_t>(capacity, 1)),
+            ring(new Sample[this->capacity])
+    {
+    }
+
+    const size_t capacity;
+    std::unique_ptr<Sample[]> ring;
+
+    // Odd while a writer is modifying the ring
+    std::atomic<std::uint32_t> seq {0};
+    // The oldest sample, and the number of samples
+    std::atomic<size_t> first {0};
+    std::atomic<size_t> count {0};
+
+    double timestampAt(size_t first, size_t i) const
+    {
+        return ring[(first + i) % capacity].v[TIMESTAMP].load(std::memory_order_relaxed);
+    }
+
+    void load(size_t first, size_t i, double (&v)[FIELDS]) const
+    {
+        const Sample& s = ring[(first + i) % capacity];
+        for (size_t f = 0; f < FIELDS; f++) {
+            v[f] = s.v[f].load(std::memory_order_relaxed);
+        }
+    }
+
+    void beginWrite()
+    {
+        seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void endWrite()
+    {
+        seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Calls read() until it was not disturbed by a writer
+    template <typename F>
+    void consistentRead(F read) const
+    {
+        while (true) {
+            std::uint32_t before = seq.load(std::memory_order_acquire);
+            if ((before & 1) != 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            read();
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq.load(std::memory_order_relaxed) == before) {
+                return;
+            }
+        }
+    }
+};
+
+
+FrameTransformHistory::FrameTransformHistory(size_t capacity) :
+        mPriv(new Private(capacity))
+{
+}
+
+FrameTransformHistory::~FrameTransformHistory()
+{
+    delete mPriv;
+}
+
+bool FrameTransformHistory::add(const FrameTransform& t)
+{
+    // Only the writer modifies first and count
+    size_t first = mPriv->first.load(std::memory_order_relaxed);
+    size_t count = mPriv->count.load(std::memory_order_relaxed);
+
+    size_t slot;
+    if (count > 0) {
+        double newest = mPriv->timestampAt(first, count - 1);
+        if (t.timestamp < newest) {
+            return false;
+        }
+        if (t.timestamp == newest) {
+            slot = (first + count - 1) % mPriv->capacity;
+        } else {
+            slot = (first + count) % mPriv->capacity;
+            if (count == mPriv->capacity) {
+                first = (first + 1) % mPriv->capacity;
+            } else {
+                count++;
+            }
+        }
+    } else {
+        slot = first;
+        count = 1;
+    }
+
+    mPriv->beginWrite();
+    Sample& s = mPriv->ring[slot];
+    s.v[TIMESTAMP].store(t.timestamp, std::memory_order_relaxed);
+    s.v[TX].store(t.translation.tX, std::memory_order_relaxed);
+    s.v[TY].store(t.translation.tY, std::memory_order_relaxed);
+    s.v[TZ].store(t.translation.tZ, std::memory_order_relaxed);
+    s.v[QW].store(t.rotation.w(), std::memory_order_relaxed);
+    s.v[QX].store(t.rotation.x(), std::memory_order_relaxed);
+    s.v[QY].store(t.rotation.y(), std::memory_order_relaxed);
+    s.v[QZ].store(t.rotation.z(), std::memory_order_relaxed);
+    mPriv->first.store(first, std::memory_order_relaxed);
+    mPriv->count.store(count, std::memory_order_relaxed);
+    mPriv->endWrite();
+    return true;
+}
+
+void FrameTransformHistory::clear()
+{
+    mPriv->beginWrite();
+    mPriv->first.store(0, std::memory_order_relaxed);
+    mPriv->count.store(0, std::memory_order_relaxed);
+    mPriv->endWrite();
+}
+
+size_t FrameTransformHistory::size() const
+{
+    return mPriv->count.load(std::memory_order_acquire);
+}
+
+size_t FrameTransformHistory::capacity() const
+{
+    return mPriv->capacity;
+}
+
+bool FrameTransformHistory::getLatest(FrameTransform& t) const
+{
+    bool found;
+    double v[FIELDS];
+    mPriv->consistentRead([&]() {
+        size_t first = mPriv->first.load(std::memory_order_relaxed);
+        size_t count = mPriv->count.load(std::memory_order_relaxed);
+        found = (count > 0);
+        if (found) {
+            mPriv->load(first, count - 1, v);
+        }
+    });
+    if (found) {
+        toFrameTransform(v, t);
+    }
+    return found;
+}
+
+bool FrameTransformHistory::getAt(double time, FrameTransform& t, double tolerance) const
+{
+    bool found;
+    double a[FIELDS];
+    double b[FIELDS];
+    double alpha;
+    mPriv->consistentRead([&]() {
+        size_t first = mPriv->first.load(std::memory_order_relaxed);
+        size_t count = std::min(mPriv->count.load(std::memory_order_relaxed), mPriv->capacity);
+        found = false;
+        alpha = 0.0;
+        if (count == 0) {
+            return;
+        }
+        double newest = mPriv->timestampAt(first, count - 1);
+        if (count == 1 || time >= newest) {
+            // past the newest value only within the tolerance
+            if (count == 1 || time <= newest + tolerance) {
+                mPriv->load(first, count - 1, a);
+                found = true;
+            }
+            return;
+        }
+        if (time < mPriv->timestampAt(first, 0)) {
+            return;
+        }
+        // timestamp(lo) <= time < timestamp(hi)
+        size_t lo = 0;
+        size_t hi = count - 1;
+        while (hi - lo > 1) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (mPriv->timestampAt(first, mid) <= time) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+        mPriv->load(first, lo, a);
+        mPriv->load(first, hi, b);
+        if (b[TIMESTAMP] > a[TIMESTAMP]) {
+            alpha = (time - a[TIMESTAMP]) / (b[TIMESTAMP] - a[TIMESTAMP]);
+        }
+        found = true;
+    });
+
+    if (!found) {
+        return false;
+    }
+    if (alpha == 0.0) {
+        toFrameTransform(a, t);
+    } else {
+        FrameTransform ta;
+        FrameTransform tb;
+        toFrameTransform(a, ta);
+        toFrameTransform(b, tb);
+        interpolate(ta, tb, alpha, t);
+    }
+    t.timestamp = time;
+    return true;
+}
+
+void FrameTransformHistory::interpolate(const FrameTransform& a,
+                                        const FrameTransform& b,
+                                        double alpha,
+                                        FrameTransform& t)
+{
+    t.translation.set(a.translation.tX + alpha * (b.translation.tX - a.translation.tX),
+                      a.translation.tY + alpha * (b.translation.tY - a.translation.tY),
+                      a.translation.tZ + alpha * (b.translation.tZ - a.translation.tZ));
+    t.timestamp = a.timestamp + alpha * (b.timestamp - a.timestamp);
+
+    double qa[4] = {a.rotation.w(), a.rotation.x(), a.rotation.y(), a.rotation.z()};
+    double qb[4] = {b.rotation.w(), b.rotation.x(), b.rotation.y(), b.rotation.z()};
+    double na = std::sqrt(qa[0] * qa[0] + qa[1] * qa[1] + qa[2] * qa[2] + qa[3] * qa[3]);
+    double nb = std::sqrt(qb[0] * qb[0] + qb[1] * qb[1] + qb[2] * qb[2] + qb[3] * qb[3]);
+    double dot = 0.0;
+    for (size_t i = 0; i < 4; i++) {
+        qa[i] /= na;
+        qb[i] /= nb;
+        dot += qa[i] * qb[i];
+    }
+
+    // q and -q are the same rotation, take the shortest path
+    if (dot < 0.0) {
+        dot = -dot;
+        for (auto& q : qb) {
+            q = -q;
+        }
+    }
+
+    double wa;
+    double wb;
+    if (dot > 0.9995) {
+        // the rotations are too close for the sine, interpolate linearly
+        wa = 1.0 - alpha;
+        wb = alpha;
+    } else {
+        double theta = std::acos(dot);
+        double sinTheta = std::sin(theta);
+        wa = std::sin((1.0 - alpha) * theta) / sinTheta;
+        wb = std::sin(alpha * theta) / sinTheta;
+    }
+
+    double q[4];
+    double n = 0.0;
+    for (size_t i = 0; i < 4; i++) {
+        q[i] = wa * qa[i] + wb * qb[i];
+        n += q[i] * q[i];
+    }
+    n = std::sqrt(n);
+    t.rotation.w() = q[0] / n;
+    t.rotation.x() = q[1] / n;
+    t.rotation.y() = q[2] / n;
+    t.rotation.z() = q[3] / n;
+}
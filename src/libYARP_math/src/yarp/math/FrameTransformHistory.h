@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#ifndef YARP_MATH_FRAMETRANSFORMHISTORY_H
+#define YARP_MATH_FRAMETRANSFORMHISTORY_H
+
+#include <yarp/math/api.h>
+#include <yarp/math/FrameTransform.h>
+
+#include <cstddef>
+
+namespace yarp {
+namespace math {
+
+/**
+ * The last values of a transform between two frames, with their timestamps.
+ *
+ * The values are kept in a ring of fixed size, that is allocated once.
+ * The value at a given time is interpolated between the two values around it:
+ * linearly for the translation, and with a spherical linear interpolation
+ * (SLERP) for the rotation.
+ *
+ * The values are added by one thread at a time.  The readers never lock: they
+ * retry when the ring was modified while they were reading it (seqlock), so
+ * that they never block the thread adding the values.
+ */
+class YARP_math_API FrameTransformHistory
+{
+public:
+    /**
+     * @param capacity the number of values kept
+     */
+    explicit FrameTransformHistory(size_t capacity = 100);
+    FrameTransformHistory(const FrameTransformHistory&) = delete;
+    FrameTransformHistory& operator=(const FrameTransformHistory&) = delete;
+    ~FrameTransformHistory();
+
+    /**
+     * Add a value, using its timestamp.
+     *
+     * A value with the same timestamp as the newest one replaces it, a value
+     * older than the newest one is ignored.
+     *
+     * @return true if the value was added
+     */
+    bool add(const FrameTransform& t);
+
+    /**
+     * Remove all the values.
+     */
+    void clear();
+
+    /**
+     * @return the number of values kept
+     */
+    size_t size() const;
+
+    /**
+     * @return the maximum number of values kept
+     */
+    size_t capacity() const;
+
+    /**
+     * Get the newest value.
+     *
+     * The frame ids of \p t are not modified.
+     *
+     * @return false if there are no values
+     */
+    bool getLatest(FrameTransform& t) const;
+
+    /**
+     * Get the value at a given time.
+     *
+     * The values are not extrapolated: a time after the newest value gives
+     * the newest value, up to \p tolerance after it.  If there is one value
+     * only (e.g.\ a static transform), it is given for any time.
+     * The frame ids of \p t are not modified, and its timestamp is \p time.
+     *
+     * @param time the time of the value
+     * @param t the value at that time
+     * @param tolerance how long the newest value is still given after its
+     *        timestamp
+     * @return false if there are no values, or if \p time is before the
+     *         oldest one or more than \p tolerance after the newest one
+     */
+    bool getAt(double time, FrameTransform& t, double tolerance = 0.0) const;
+
+    /**
+     * Interpolate two transforms.
+     *
+     * @param a the first transform
+     * @param b the second transform
+     * @param alpha the position between the two, 0 for \p a and 1 for \p b
+     * @param t the interpolated transform (the frame ids are not modified)
+     */
+    static void interpolate(const FrameTransform& a,
+                            const FrameTransform& b,
+                            double alpha,
+                            FrameTransform& t);
+
+private:
+    class Private;
+    Private* mPriv;
+};
+
+} // namespace math
+} // namespace yarp
+
+#endif // YARP_MATH_FRAMETRANSFORMHISTORY_H
@@ -629,6 +629,144 @@ namespace yarp
         * @return the inverse of the adjoint matrix
         */
         YARP_math_API yarp::sig::Matrix adjointInv(const yarp::sig::Matrix &H);
+
+        /**
+        * \name Allocation-free variants
+        *
+        * The following functions write their result into an existing vector or
+        * matrix instead of returning a new one. The output is resized only when
+        * its size is different, so that reusing the same output (e.g. in a
+        * control loop) does not allocate memory.
+        * The products of vectors and matrices with 3, 4 or 6 rows and columns
+        * are computed with fixed size code, whose temporaries are on the stack.
+        *
+        * Longer expressions can be evaluated lazily, directly into the output,
+        * using yarp::eigen::toEigen() (or its fixed size version
+        * toEigen<N>()) from the YARP_eigen library, e.g.
+        * \code
+        * toEigen(out).noalias() = toEigen(J) * toEigen(qdot) + toEigen(bias);
+        * \endcode
+        */
+        ///@{
+
+        /**
+        * Addition between vectors, out=a+b (defined in Math.h).
+        * \p out can be \p a or \p b.
+        */
+        YARP_math_API void add_into(yarp::sig::Vector &out, const yarp::sig::Vector &a, const yarp::sig::Vector &b);
+
+        /**
+        * Addition between matrices, out=a+b (defined in Math.h).
+        * \p out can be \p a or \p b.
+        */
+        YARP_math_API void add_into(yarp::sig::Matrix &out, const yarp::sig::Matrix &a, const yarp::sig::Matrix &b);
+
+        /**
+        * Subtraction between vectors, out=a-b (defined in Math.h).
+        * \p out can be \p a or \p b.
+        */
+        YARP_math_API void sub_into(yarp::sig::Vector &out, const yarp::sig::Vector &a, const yarp::sig::Vector &b);
+
+        /**
+        * Subtraction between matrices, out=a-b (defined in Math.h).
+        * \p out can be \p a or \p b.
+        */
+        YARP_math_API void sub_into(yarp::sig::Matrix &out, const yarp::sig::Matrix &a, const yarp::sig::Matrix &b);
+
+        /**
+        * Vector-scalar product, out=a*k (defined in Math.h).
+        * \p out can be \p a.
+        */
+        YARP_math_API void mul_into(yarp::sig::Vector &out, const yarp::sig::Vector &a, double k);
+
+        /**
+        * Matrix-scalar product, out=M*k (defined in Math.h).
+        * \p out can be \p M.
+        */
+        YARP_math_API void mul_into(yarp::sig::Matrix &out, const yarp::sig::Matrix &M, double k);
+
+        /**
+        * Matrix-vector product, out=m*a (defined in Math.h).
+        * \p out must not be \p a.
+        */
+        YARP_math_API void mul_into(yarp::sig::Vector &out, const yarp::sig::Matrix &m, const yarp::sig::Vector &a);
+
+        /**
+        * Vector-matrix product, out=a*m (defined in Math.h).
+        * \p out must not be \p a.
+        */
+        YARP_math_API void mul_into(yarp::sig::Vector &out, const yarp::sig::Vector &a, const yarp::sig::Matrix &m);
+
+        /**
+        * Matrix-matrix product, out=a*b (defined in Math.h).
+        * \p out must not be \p a or \p b.
+        */
+        YARP_math_API void mul_into(yarp::sig::Matrix &out, const yarp::sig::Matrix &a, const yarp::sig::Matrix &b);
+
+        /**
+        * Vector-Vector concatenation (defined in Math.h), see cat().
+        * \p out must not be \p v1 or \p v2.
+        */
+        YARP_math_API void cat_into(yarp::sig::Vector &out, const yarp::sig::Vector &v1, const yarp::sig::Vector &v2);
+
+        /**
+        * Matrix-Matrix concatenation by row (defined in Math.h), see cat().
+        * \p out must not be \p m1 or \p m2.
+        */
+        YARP_math_API void cat_into(yarp::sig::Matrix &out, const yarp::sig::Matrix &m1, const yarp::sig::Matrix &m2);
+
+        /**
+        * Matrix-Matrix concatenation by column (defined in Math.h), see pile().
+        * \p out must not be \p m1 or \p m2.
+        */
+        YARP_math_API void pile_into(yarp::sig::Matrix &out, const yarp::sig::Matrix &m1, const yarp::sig::Matrix &m2);
+
+        /**
+        * Cross product between vectors of size 3 (defined in Math.h), see cross().
+        * \p out must not be \p a or \p b.
+        */
+        YARP_math_API void cross_into(yarp::sig::Vector &out, const yarp::sig::Vector &a, const yarp::sig::Vector &b);
+
+        /**
+        * Rotation matrix to axis/angle (defined in Math.h), see dcm2axis().
+        * @note memory is allocated only for a rotation of 0 or 180 degrees.
+        */
+        YARP_math_API void dcm2axis_into(yarp::sig::Vector &out, const yarp::sig::Matrix &R);
+
+        /**
+        * Axis/angle to 4 by 4 rotation matrix (defined in Math.h), see axis2dcm().
+        */
+        YARP_math_API void axis2dcm_into(yarp::sig::Matrix &out, const yarp::sig::Vector &v);
+
+        /**
+        * Roll-pitch-yaw angles to 4 by 4 rotation matrix (defined in Math.h), see rpy2dcm().
+        */
+        YARP_math_API void rpy2dcm_into(yarp::sig::Matrix &out, const yarp::sig::Vector &rpy);
+
+        /**
+        * Yaw-pitch-roll angles to 4 by 4 rotation matrix (defined in Math.h), see ypr2dcm().
+        */
+        YARP_math_API void ypr2dcm_into(yarp::sig::Matrix &out, const yarp::sig::Vector &ypr);
+
+        /**
+        * Inverse of a 4 by 4 rototranslational matrix (defined in Math.h), see SE3inv().
+        * \p out must not be \p H.
+        */
+        YARP_math_API void SE3inv_into(yarp::sig::Matrix &out, const yarp::sig::Matrix &H);
+
+        /**
+        * Adjoint matrix of a roto-translational matrix (defined in Math.h), see adjoint().
+        * \p out must not be \p H.
+        */
+        YARP_math_API void adjoint_into(yarp::sig::Matrix &out, const yarp::sig::Matrix &H);
+
+        /**
+        * Inverse of the adjoint matrix of a roto-translational matrix (defined in Math.h), see adjointInv().
+        * \p out must not be \p H.
+        */
+        YARP_math_API void adjointInv_into(yarp::sig::Matrix &out, const yarp::sig::Matrix &H);
+
+        ///@}
     }
 }
 
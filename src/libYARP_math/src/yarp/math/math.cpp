@@ -25,8 +25,63 @@ using namespace yarp::math;
 
 namespace {
 YARP_LOG_COMPONENT(MATH, "yarp.math")
+
+// The products of the common sizes use fixed size maps, so that Eigen unrolls
+// them and keeps its temporaries on the stack.
+template <int N>
+bool mulFixed(Matrix& out, const Matrix& a, const Matrix& b)
+{
+    if (a.rows() != N || a.cols() != N || b.cols() != N) {
+        return false;
+    }
+    toEigen<N, N>(out).noalias() = toEigen<N, N>(a) * toEigen<N, N>(b);
+    return true;
+}
+
+template <int N>
+bool mulFixed(Vector& out, const Matrix& m, const Vector& a)
+{
+    if (m.rows() != N || m.cols() != N) {
+        return false;
+    }
+    toEigen<N>(out).noalias() = toEigen<N, N>(m) * toEigen<N>(a);
+    return true;
+}
+
+template <int N>
+bool mulFixed(Vector& out, const Vector& a, const Matrix& m)
+{
+    if (m.rows() != N || m.cols() != N) {
+        return false;
+    }
+    toEigen<N>(out).noalias() = toEigen<N, N>(m).transpose() * toEigen<N>(a);
+    return true;
+}
+
+template <int N>
+bool mulInPlaceFixed(Matrix& a, const Matrix& b)
+{
+    if (a.rows() != N || a.cols() != N || b.rows() != N || b.cols() != N) {
+        return false;
+    }
+    FixedMatrix<N, N> tmp = toEigen<N, N>(a) * toEigen<N, N>(b);
+    toEigen<N, N>(a) = tmp;
+    return true;
+}
+
+template <int N>
+bool mulInPlaceFixed(Vector& a, const Matrix& m)
+{
+    if (m.rows() != N || m.cols() != N) {
+        return false;
+    }
+    FixedMatrix<N, 1> tmp = toEigen<N, N>(m).transpose() * toEigen<N>(a);
+    toEigen<N>(a) = tmp;
+    return true;
 }
 
+} // namespace
+
 Vector operator+(const Vector &a, const double &s)
 {
     Vector ret(a);
@@ -155,17 +210,17 @@ Vector& operator*=(Vector &a, double k)
 
 Vector operator*(const Vector &a, const Matrix &m)
 {
-    yCAssert(MATH, a.size()==(size_t)m.rows());
-    Vector ret((size_t)m.cols());
-
-    toEigen(ret) = toEigen(m).transpose()*toEigen(a);
-
+    Vector ret;
+    mul_into(ret, a, m);
     return ret;
 }
 
 Vector& operator*=(Vector &a, const Matrix &m)
 {
     yCAssert(MATH, a.size()==(size_t)m.rows());
+    if (mulInPlaceFixed<3>(a, m) || mulInPlaceFixed<4>(a, m) || mulInPlaceFixed<6>(a, m))
+        return a;
+
     Vector a2(a);
     a.resize(m.cols());
 
@@ -176,27 +231,24 @@ Vector& operator*=(Vector &a, const Matrix &m)
 
 Vector operator*(const Matrix &m, const Vector &a)
 {
-    yCAssert(MATH, (size_t)m.cols()==a.size());
-    Vector ret((size_t)m.rows(),0.0);
-
-    toEigen(ret) = toEigen(m)*toEigen(a);
-
+    Vector ret;
+    mul_into(ret, m, a);
     return ret;
 }
 
 Matrix operator*(const Matrix &a, const Matrix &b)
 {
-    yCAssert(MATH, a.cols()==b.rows());
-    Matrix c(a.rows(), b.cols());
-
-    toEigen(c) = toEigen(a)*toEigen(b);
-
+    Matrix c;
+    mul_into(c, a, b);
     return c;
 }
 
 Matrix& operator*=(Matrix &a, const Matrix &b)
 {
     yCAssert(MATH, a.cols()==b.rows());
+    if (mulInPlaceFixed<3>(a, b) || mulInPlaceFixed<4>(a, b) || mulInPlaceFixed<6>(a, b))
+        return a;
+
     Matrix a2(a);   // a copy of a
     a.resize(a.rows(), b.cols());
 
@@ -296,15 +348,8 @@ Matrix& operator/=(Matrix &M, const double k)
 
 Matrix yarp::math::pile(const Matrix &m1, const Matrix &m2)
 {
-    size_t c = m1.cols();
-    yCAssert(MATH, c==m2.cols());
-    size_t r1 = m1.rows();
-    size_t r2 = m2.rows();
-    Matrix res(r1+r2, c);
-
-    toEigen(res).block(0,0,r1,c) = toEigen(m1);
-    toEigen(res).block(r1,0,r2,c) = toEigen(m2);
-
+    Matrix res;
+    pile_into(res, m1, m2);
     return res;
 }
 
@@ -348,15 +393,8 @@ Matrix yarp::math::pile(const Vector &v1, const Vector &v2)
 
 Matrix yarp::math::cat(const Matrix &m1, const Matrix &m2)
 {
-    size_t r = m1.rows();
-    yCAssert(MATH, r==m2.rows());
-    size_t c1 = m1.cols();
-    size_t c2 = m2.cols();
-    Matrix res(r, c1+c2);
-
-    toEigen(res).block(0,0,r,c1)  = toEigen(m1);
-    toEigen(res).block(0,c1,r,c2) = toEigen(m2);
-
+    Matrix res;
+    cat_into(res, m1, m2);
     return res;
 }
 
@@ -388,13 +426,8 @@ Matrix yarp::math::cat(const Vector &v, const Matrix &m)
 
 Vector yarp::math::cat(const Vector &v1, const Vector &v2)
 {
-    size_t n1 = v1.size();
-    size_t n2 = v2.size();
-    Vector res(n1+n2);
-
-    toEigen(res).segment(0,n1) = toEigen(v1);
-    toEigen(res).segment(n1,n2) = toEigen(v2);
-
+    Vector res;
+    cat_into(res, v1, v2);
     return res;
 }
 
@@ -479,12 +512,8 @@ Matrix yarp::math::outerProduct(const Vector &a, const Vector &b)
 
 Vector yarp::math::cross(const Vector &a, const Vector &b)
 {
-    yCAssert(MATH, a.size()==3);
-    yCAssert(MATH, b.size()==3);
-    Vector v(3);
-    v[0]=a[1]*b[2]-a[2]*b[1];
-    v[1]=a[2]*b[0]-a[0]*b[2];
-    v[2]=a[0]*b[1]-a[1]*b[0];
+    Vector v;
+    cross_into(v, a, b);
     return v;
 }
 
@@ -646,80 +675,15 @@ Vector yarp::math::sign(const Vector &v)
 
 Vector yarp::math::dcm2axis(const Matrix &R)
 {
-    yCAssert(MATH, (R.rows()>=3) && (R.cols()>=3));
-
-    Vector v(4);
-    v[0]=R(2,1)-R(1,2);
-    v[1]=R(0,2)-R(2,0);
-    v[2]=R(1,0)-R(0,1);
-    v[3]=0.0;
-    double r=yarp::math::norm(v);
-    double theta=atan2(0.5*r,0.5*(R(0,0)+R(1,1)+R(2,2)-1));
-
-    if (r<1e-9)
-    {
-        // if we enter here, then
-        // R is symmetric; this can
-        // happen only if the rotation
-        // angle is 0 (R=I) or 180 degrees
-        Matrix A=R.submatrix(0,2,0,2);
-        Matrix U(3,3), V(3,3);
-        Vector S(3);
-
-        // A=I+sin(theta)*S+(1-cos(theta))*S^2
-        // where S is the skew matrix.
-        // Given a point x, A*x is the rotated one,
-        // hence if Ax=x then x belongs to the rotation
-        // axis. We have therefore to find the kernel of
-        // the linear application (A-I).
-        SVD(A-eye(3,3),U,S,V);
-
-        v[0]=V(0,2);
-        v[1]=V(1,2);
-        v[2]=V(2,2);
-        r=yarp::math::norm(v);
-    }
-
-    v=(1.0/r)*v;
-    v[3]=theta;
-
+    Vector v;
+    dcm2axis_into(v, R);
     return v;
 }
 
 Matrix yarp::math::axis2dcm(const Vector &v)
 {
-    yCAssert(MATH, v.length()>=4);
-
-    Matrix R=eye(4,4);
-
-    double theta=v[3];
-    if (theta==0.0)
-        return R;
-
-    double c=cos(theta);
-    double s=sin(theta);
-    double C=1.0-c;
-
-    double xs =v[0]*s;
-    double ys =v[1]*s;
-    double zs =v[2]*s;
-    double xC =v[0]*C;
-    double yC =v[1]*C;
-    double zC =v[2]*C;
-    double xyC=v[0]*yC;
-    double yzC=v[1]*zC;
-    double zxC=v[2]*xC;
-
-    R(0,0)=v[0]*xC+c;
-    R(0,1)=xyC-zs;
-    R(0,2)=zxC+ys;
-    R(1,0)=xyC+zs;
-    R(1,1)=v[1]*yC+c;
-    R(1,2)=yzC-xs;
-    R(2,0)=zxC-ys;
-    R(2,1)=yzC+xs;
-    R(2,2)=v[2]*zC+c;
-
+    Matrix R;
+    axis2dcm_into(R, v);
     return R;
 }
 
@@ -817,18 +781,9 @@ Vector yarp::math::dcm2rpy(const Matrix &R)
 
 Matrix yarp::math::rpy2dcm(const Vector &v)
 {
-    yCAssert(MATH, v.length()>=3);
-
-    Matrix Rz=eye(4,4); Matrix Ry=eye(4,4);   Matrix Rx=eye(4,4);
-    double roll=v[0];   double cr=cos(roll);  double sr=sin(roll);
-    double pitch=v[1];  double cp=cos(pitch); double sp=sin(pitch);
-    double yaw=v[2];    double cy=cos(yaw);   double sy=sin(yaw);
-
-    Rz(0,0)=cy; Rz(1,1)=cy; Rz(0,1)=-sy; Rz(1,0)= sy;   // z-rotation with yaw
-    Ry(0,0)=cp; Ry(2,2)=cp; Ry(0,2)= sp; Ry(2,0)=-sp;   // y-rotation with pitch
-    Rx(1,1)=cr; Rx(2,2)=cr; Rx(1,2)=-sr; Rx(2,1)= sr;   // x-rotation with roll
-
-    return Rz*Ry*Rx;
+    Matrix R;
+    rpy2dcm_into(R, v);
+    return R;
 }
 
 Vector yarp::math::dcm2ypr(const yarp::sig::Matrix &R)
@@ -866,93 +821,326 @@ Vector yarp::math::dcm2ypr(const yarp::sig::Matrix &R)
 
 Matrix yarp::math::ypr2dcm(const Vector &v)
 {
-    yCAssert(MATH, v.length() >= 3);
+    Matrix R;
+    ypr2dcm_into(R, v);
+    return R;
+}
 
-    Matrix Rz = eye(4, 4); Matrix Ry = eye(4, 4);   Matrix Rx = eye(4, 4);
-    double roll = v[2];   double cr = cos(roll);  double sr = sin(roll);
-    double pitch = v[1];  double cp = cos(pitch); double sp = sin(pitch);
-    double yaw = v[0];    double cy = cos(yaw);   double sy = sin(yaw);
+Matrix yarp::math::SE3inv(const Matrix &H)
+{
+    Matrix invH;
+    SE3inv_into(invH, H);
+    return invH;
+}
 
-    Rz(0, 0) = cy; Rz(1, 1) = cy; Rz(0, 1) = -sy; Rz(1, 0) = sy;   // z-rotation with yaw
-    Ry(0, 0) = cp; Ry(2, 2) = cp; Ry(0, 2) = sp; Ry(2, 0) = -sp;   // y-rotation with pitch
-    Rx(1, 1) = cr; Rx(2, 2) = cr; Rx(1, 2) = -sr; Rx(2, 1) = sr;   // x-rotation with roll
+Matrix yarp::math::adjoint(const Matrix &H)
+{
+    Matrix A;
+    adjoint_into(A, H);
+    return A;
+}
 
-    return Rx*Ry*Rz;
+Matrix yarp::math::adjointInv(const Matrix &H)
+{
+    Matrix A;
+    adjointInv_into(A, H);
+    return A;
 }
 
-Matrix yarp::math::SE3inv(const Matrix &H)
+void yarp::math::add_into(Vector &out, const Vector &a, const Vector &b)
 {
-    yCAssert(MATH, (H.rows()==4) && (H.cols()==4));
+    size_t n=a.size();
+    yCAssert(MATH, n==b.size());
+    out.resize(n);
+    for (size_t k=0; k<n; k++)
+        out[k]=a[k]+b[k];
+}
 
-    Vector p(4);
-    p[0]=H(0,3);
-    p[1]=H(1,3);
-    p[2]=H(2,3);
-    p[3]=1.0;
+void yarp::math::add_into(Matrix &out, const Matrix &a, const Matrix &b)
+{
+    yCAssert(MATH, a.rows()==b.rows() && a.cols()==b.cols());
+    out.resize(a.rows(), a.cols());
+    toEigen(out) = toEigen(a)+toEigen(b);
+}
 
-    Matrix invH=H.transposed();
-    p=invH*p;
+void yarp::math::sub_into(Vector &out, const Vector &a, const Vector &b)
+{
+    size_t n=a.size();
+    yCAssert(MATH, n==b.size());
+    out.resize(n);
+    for (size_t k=0; k<n; k++)
+        out[k]=a[k]-b[k];
+}
 
-    invH(0,3)=-p[0];
-    invH(1,3)=-p[1];
-    invH(2,3)=-p[2];
-    invH(3,0)=invH(3,1)=invH(3,2)=0.0;
+void yarp::math::sub_into(Matrix &out, const Matrix &a, const Matrix &b)
+{
+    yCAssert(MATH, a.rows()==b.rows() && a.cols()==b.cols());
+    out.resize(a.rows(), a.cols());
+    toEigen(out) = toEigen(a)-toEigen(b);
+}
 
-    return invH;
+void yarp::math::mul_into(Vector &out, const Vector &a, double k)
+{
+    size_t n=a.size();
+    out.resize(n);
+    for (size_t i=0; i<n; i++)
+        out[i]=a[i]*k;
 }
 
-Matrix yarp::math::adjoint(const Matrix &H)
+void yarp::math::mul_into(Matrix &out, const Matrix &M, double k)
 {
-    yCAssert(MATH, (H.rows()==4) && (H.cols()==4));
+    out.resize(M.rows(), M.cols());
+    toEigen(out) = toEigen(M)*k;
+}
 
-    // the skew matrix coming from the translational part of H: S(r)
-    Matrix S(3,3);
-    S(0,0)= 0.0;    S(0,1)=-H(2,3); S(0,2)= H(1,3);
-    S(1,0)= H(2,3); S(1,1)= 0.0;    S(1,2)=-H(0,3);
-    S(2,0)=-H(1,3); S(2,1)= H(0,3); S(2,2)= 0.0;
+void yarp::math::mul_into(Vector &out, const Matrix &m, const Vector &a)
+{
+    yCAssert(MATH, (size_t)m.cols()==a.size());
+    yCAssert(MATH, &out!=&a);
+    out.resize(m.rows());
+    if (mulFixed<3>(out, m, a) || mulFixed<4>(out, m, a) || mulFixed<6>(out, m, a))
+        return;
+
+    toEigen(out).noalias() = toEigen(m)*toEigen(a);
+}
+
+void yarp::math::mul_into(Vector &out, const Vector &a, const Matrix &m)
+{
+    yCAssert(MATH, a.size()==(size_t)m.rows());
+    yCAssert(MATH, &out!=&a);
+    out.resize(m.cols());
+    if (mulFixed<3>(out, a, m) || mulFixed<4>(out, a, m) || mulFixed<6>(out, a, m))
+        return;
+
+    toEigen(out).noalias() = toEigen(m).transpose()*toEigen(a);
+}
+
+void yarp::math::mul_into(Matrix &out, const Matrix &a, const Matrix &b)
+{
+    yCAssert(MATH, a.cols()==b.rows());
+    yCAssert(MATH, &out!=&a && &out!=&b);
+    out.resize(a.rows(), b.cols());
+    if (mulFixed<3>(out, a, b) || mulFixed<4>(out, a, b) || mulFixed<6>(out, a, b))
+        return;
+
+    toEigen(out).noalias() = toEigen(a)*toEigen(b);
+}
+
+void yarp::math::cat_into(Vector &out, const Vector &v1, const Vector &v2)
+{
+    yCAssert(MATH, &out!=&v1 && &out!=&v2);
+    size_t n1 = v1.size();
+    size_t n2 = v2.size();
+    out.resize(n1+n2);
+
+    toEigen(out).segment(0,n1) = toEigen(v1);
+    toEigen(out).segment(n1,n2) = toEigen(v2);
+}
+
+void yarp::math::cat_into(Matrix &out, const Matrix &m1, const Matrix &m2)
+{
+    yCAssert(MATH, &out!=&m1 && &out!=&m2);
+    size_t r = m1.rows();
+    yCAssert(MATH, r==m2.rows());
+    size_t c1 = m1.cols();
+    size_t c2 = m2.cols();
+    out.resize(r, c1+c2);
 
-    S = S*H.submatrix(0,2,0,2);
+    toEigen(out).block(0,0,r,c1)  = toEigen(m1);
+    toEigen(out).block(0,c1,r,c2) = toEigen(m2);
+}
+
+void yarp::math::pile_into(Matrix &out, const Matrix &m1, const Matrix &m2)
+{
+    yCAssert(MATH, &out!=&m1 && &out!=&m2);
+    size_t c = m1.cols();
+    yCAssert(MATH, c==m2.cols());
+    size_t r1 = m1.rows();
+    size_t r2 = m2.rows();
+    out.resize(r1+r2, c);
+
+    toEigen(out).block(0,0,r1,c) = toEigen(m1);
+    toEigen(out).block(r1,0,r2,c) = toEigen(m2);
+}
+
+void yarp::math::cross_into(Vector &out, const Vector &a, const Vector &b)
+{
+    yCAssert(MATH, a.size()==3);
+    yCAssert(MATH, b.size()==3);
+    yCAssert(MATH, &out!=&a && &out!=&b);
+    out.resize(3);
+    out[0]=a[1]*b[2]-a[2]*b[1];
+    out[1]=a[2]*b[0]-a[0]*b[2];
+    out[2]=a[0]*b[1]-a[1]*b[0];
+}
+
+void yarp::math::dcm2axis_into(Vector &out, const Matrix &R)
+{
+    yCAssert(MATH, (R.rows()>=3) && (R.cols()>=3));
+
+    double v[3];
+    v[0]=R(2,1)-R(1,2);
+    v[1]=R(0,2)-R(2,0);
+    v[2]=R(1,0)-R(0,1);
+    double r=sqrt(v[0]*v[0]+v[1]*v[1]+v[2]*v[2]);
+    double theta=atan2(0.5*r,0.5*(R(0,0)+R(1,1)+R(2,2)-1));
 
-    Matrix A(6,6); A.zero();
-    for (int i=0; i<3; i++)
+    if (r<1e-9)
     {
-        for (int j=0; j<3; j++)
-        {
-            A(i,j)     = H(i,j);
-            A(i+3,j+3) = H(i,j);
-            A(i,j+3)   = S(i,j);
-        }
+        // if we enter here, then
+        // R is symmetric; this can
+        // happen only if the rotation
+        // angle is 0 (R=I) or 180 degrees
+        Matrix A=R.submatrix(0,2,0,2);
+        Matrix U(3,3), V(3,3);
+        Vector S(3);
+
+        // A=I+sin(theta)*S+(1-cos(theta))*S^2
+        // where S is the skew matrix.
+        // Given a point x, A*x is the rotated one,
+        // hence if Ax=x then x belongs to the rotation
+        // axis. We have therefore to find the kernel of
+        // the linear application (A-I).
+        SVD(A-eye(3,3),U,S,V);
+
+        v[0]=V(0,2);
+        v[1]=V(1,2);
+        v[2]=V(2,2);
+        r=sqrt(v[0]*v[0]+v[1]*v[1]+v[2]*v[2]);
     }
 
-    return A;
+    out.resize(4);
+    out[0]=(1.0/r)*v[0];
+    out[1]=(1.0/r)*v[1];
+    out[2]=(1.0/r)*v[2];
+    out[3]=theta;
 }
 
-Matrix yarp::math::adjointInv(const Matrix &H)
+void yarp::math::axis2dcm_into(Matrix &out, const Vector &v)
+{
+    yCAssert(MATH, v.length()>=4);
+
+    out.resize(4,4);
+    out.eye();
+
+    double theta=v[3];
+    if (theta==0.0)
+        return;
+
+    double c=cos(theta);
+    double s=sin(theta);
+    double C=1.0-c;
+
+    double xs =v[0]*s;
+    double ys =v[1]*s;
+    double zs =v[2]*s;
+    double xC =v[0]*C;
+    double yC =v[1]*C;
+    double zC =v[2]*C;
+    double xyC=v[0]*yC;
+    double yzC=v[1]*zC;
+    double zxC=v[2]*xC;
+
+    out(0,0)=v[0]*xC+c;
+    out(0,1)=xyC-zs;
+    out(0,2)=zxC+ys;
+    out(1,0)=xyC+zs;
+    out(1,1)=v[1]*yC+c;
+    out(1,2)=yzC-xs;
+    out(2,0)=zxC-ys;
+    out(2,1)=yzC+xs;
+    out(2,2)=v[2]*zC+c;
+}
+
+void yarp::math::rpy2dcm_into(Matrix &out, const Vector &v)
+{
+    yCAssert(MATH, v.length()>=3);
+
+    double roll=v[0];   double cr=cos(roll);  double sr=sin(roll);
+    double pitch=v[1];  double cp=cos(pitch); double sp=sin(pitch);
+    double yaw=v[2];    double cy=cos(yaw);   double sy=sin(yaw);
+
+    // Rz(yaw)*Ry(pitch)*Rx(roll)
+    out.resize(4,4);
+    out.eye();
+    out(0,0)=cy*cp; out(0,1)=cy*sp*sr-sy*cr; out(0,2)=cy*sp*cr+sy*sr;
+    out(1,0)=sy*cp; out(1,1)=sy*sp*sr+cy*cr; out(1,2)=sy*sp*cr-cy*sr;
+    out(2,0)=-sp;   out(2,1)=cp*sr;          out(2,2)=cp*cr;
+}
+
+void yarp::math::ypr2dcm_into(Matrix &out, const Vector &v)
+{
+    yCAssert(MATH, v.length() >= 3);
+
+    double roll = v[2];   double cr = cos(roll);  double sr = sin(roll);
+    double pitch = v[1];  double cp = cos(pitch); double sp = sin(pitch);
+    double yaw = v[0];    double cy = cos(yaw);   double sy = sin(yaw);
+
+    // Rx(roll)*Ry(pitch)*Rz(yaw)
+    out.resize(4, 4);
+    out.eye();
+    out(0, 0) = cp*cy;            out(0, 1) = -cp*sy;           out(0, 2) = sp;
+    out(1, 0) = sr*sp*cy + cr*sy; out(1, 1) = cr*cy - sr*sp*sy; out(1, 2) = -sr*cp;
+    out(2, 0) = sr*sy - cr*sp*cy; out(2, 1) = cr*sp*sy + sr*cy; out(2, 2) = cr*cp;
+}
+
+void yarp::math::SE3inv_into(Matrix &out, const Matrix &H)
 {
     yCAssert(MATH, (H.rows()==4) && (H.cols()==4));
+    yCAssert(MATH, &out!=&H);
 
-    // R^T
-    Matrix Rt = H.submatrix(0,2,0,2).transposed();
-    // R^T * r
-    Vector Rtp = Rt*H.getCol(3).subVector(0,2);
+    out.resize(4,4);
+    auto h=toEigen<4,4>(H);
+    auto invH=toEigen<4,4>(out);
 
-    Matrix S(3,3);
-    S(0,0)= 0.0;    S(0,1)=-Rtp(2); S(0,2)= Rtp(1);
-    S(1,0)= Rtp(2); S(1,1)= 0.0;    S(1,2)=-Rtp(0);
-    S(2,0)=-Rtp(1); S(2,1)= Rtp(0); S(2,2)= 0.0;
+    // [R^T, -R^T*p; 0, 1]
+    invH=h.transpose();
+    invH.topRightCorner<3,1>().noalias()=-(h.topLeftCorner<3,3>().transpose()*h.topRightCorner<3,1>()+h.bottomLeftCorner<1,3>().transpose());
+    invH(3,0)=invH(3,1)=invH(3,2)=0.0;
+}
 
-    S = S*Rt;
+void yarp::math::adjoint_into(Matrix &out, const Matrix &H)
+{
+    yCAssert(MATH, (H.rows()==4) && (H.cols()==4));
+    yCAssert(MATH, &out!=&H);
 
-    Matrix A(6,6); A.zero();
-    for (int i=0; i<3; i++)
-    {
-        for (int j=0; j<3; j++)
-        {
-            A(i,j)     = Rt(i,j);
-            A(i+3,j+3) = Rt(i,j);
-            A(i,j+3)   = -S(i,j);
-        }
-    }
+    auto h=toEigen<4,4>(H);
+    auto R=h.topLeftCorner<3,3>();
 
-    return A;
+    // the skew matrix coming from the translational part of H: S(r)
+    FixedMatrix<3,3> S;
+    S << 0.0,    -H(2,3),  H(1,3),
+         H(2,3),  0.0,    -H(0,3),
+        -H(1,3),  H(0,3),  0.0;
+
+    out.resize(6,6);
+    auto A=toEigen<6,6>(out);
+    A.setZero();
+    A.topLeftCorner<3,3>()=R;
+    A.bottomRightCorner<3,3>()=R;
+    A.topRightCorner<3,3>().noalias()=S*R;
+}
+
+void yarp::math::adjointInv_into(Matrix &out, const Matrix &H)
+{
+    yCAssert(MATH, (H.rows()==4) && (H.cols()==4));
+    yCAssert(MATH, &out!=&H);
+
+    auto h=toEigen<4,4>(H);
+    // R^T
+    FixedMatrix<3,3> Rt=h.topLeftCorner<3,3>().transpose();
+    // R^T * r
+    FixedMatrix<3,1> Rtp=Rt*h.topRightCorner<3,1>();
+
+    FixedMatrix<3,3> S;
+    S << 0.0,    -Rtp(2),  Rtp(1),
+         Rtp(2),  0.0,    -Rtp(0),
+        -Rtp(1),  Rtp(0),  0.0;
+
+    out.resize(6,6);
+    auto A=toEigen<6,6>(out);
+    A.setZero();
+    A.topLeftCorner<3,3>()=Rt;
+    A.bottomRightCorner<3,3>()=Rt;
+    A.topRightCorner<3,3>().noalias()=-S*Rt;
 }
@@ -0,0 +1,673 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <yarp/os/BottleView.h>
+
+#include <yarp/os/ConnectionReader.h>
+#include <yarp/os/ConnectionWriter.h>
+#include <yarp/os/NetFloat32.h>
+#include <yarp/os/NetFloat64.h>
+#include <yarp/os/NetInt16.h>
+#include <yarp/os/NetInt32.h>
+#include <yarp/os/NetInt64.h>
+#include <yarp/os/NetInt8.h>
+#include <yarp/os/Property.h>
+#include <yarp/os/impl/Storable.h>
+
+#include <cstring>
+#include <utility>
+
+using yarp::os::BottleView;
+using yarp::os::Bottle;
+using yarp::os::ConnectionReader;
+using yarp::os::ConnectionWriter;
+using namespace yarp::os::impl;
+
+namespace {
+
+template <typename T, typename NetT>
+T load(const char* p)
+{
+    NetT x;
+    std::memcpy(&x, p, sizeof(NetT));
+    return static_cast<T>(x);
+}
+
+std::int32_t loadInt32(const char* p)
+{
+    return load<std::int32_t, yarp::os::NetInt32>(p);
+}
+
+size_t listSize(const char* p, std::int32_t subCode);
+
+/*
+ * The size of an item in the buffer of a view, not including its type
+ * code.  The buffer is checked when the view is loaded.
+ */
+size_t itemSize(const char* p, std::int32_t code)
+{
+    switch (code) {
+    case BOTTLE_TAG_INT8:
+        return sizeof(yarp::os::NetInt8);
+    case BOTTLE_TAG_INT16:
+        return sizeof(yarp::os::NetInt16);
+    case BOTTLE_TAG_INT32:
+    case BOTTLE_TAG_VOCAB:
+        return sizeof(yarp::os::NetInt32);
+    case BOTTLE_TAG_INT64:
+        return sizeof(yarp::os::NetInt64);
+    case BOTTLE_TAG_FLOAT32:
+        return sizeof(yarp::os::NetFloat32);
+    case BOTTLE_TAG_FLOAT64:
+        return sizeof(yarp::os::NetFloat64);
+    case BOTTLE_TAG_STRING:
+    case BOTTLE_TAG_BLOB:
+        return sizeof(yarp::os::NetInt32) + loadInt32(p);
+    default:
+        if ((code & BOTTLE_TAG_DICT) != 0) {
+            // dictionaries are written as top level bottles
+            return sizeof(yarp::os::NetInt32) + listSize(p + sizeof(yarp::os::NetInt32), loadInt32(p) & UNIT_MASK);
+        }
+        if ((code & BOTTLE_TAG_LIST) != 0) {
+            return listSize(p, code & UNIT_MASK);
+        }
+        return 0;
+    }
+}
+
+size_t listSize(const char* p, std::int32_t subCode)
+{
+    std::int32_t len = loadInt32(p);
+    const char* cursor = p + sizeof(yarp::os::NetInt32);
+    for (std::int32_t i = 0; i < len; i++) {
+        std::int32_t code = subCode;
+        if (code == 0) {
+            code = loadInt32(cursor);
+            cursor += sizeof(yarp::os::NetInt32);
+        }
+        cursor += itemSize(cursor, code);
+    }
+    return cursor - p;
+}
+
+
+class ReaderSource
+{
+public:
+    explicit ReaderSource(ConnectionReader& reader) :
+            reader(reader)
+    {
+    }
+
+    bool read(char* data, size_t len)
+    {
+        return reader.expectBlock(data, len) && !reader.isError();
+    }
+
+private:
+    ConnectionReader& reader;
+};
+
+class MemorySource
+{
+public:
+    MemorySource(const char* data, size_t len) :
+            cursor(data),
+            end(data + len)
+    {
+    }
+
+    bool read(char* data, size_t len)
+    {
+        if (static_cast<size_t>(end - cursor) < len) {
+            return false;
+        }
+        std::memcpy(data, cursor, len);
+        cursor += len;
+        return true;
+    }
+
+    bool done() const
+    {
+        return cursor == end;
+    }
+
+private:
+    const char* cursor;
+    const char* end;
+};
+
+/*
+ * Copies a bottle in binary form at the end of a buffer, checking its
+ * structure on the way.  Nothing is decoded apart from the type codes and
+ * the lengths.
+ */
+template <typename Source>
+class Loader
+{
+public:
+    Loader(Source& source, std::vector<char>& data) :
+            source(source),
+            data(data)
+    {
+    }
+
+    bool bottle()
+    {
+        std::int32_t code = 0;
+        return int32(code) && list(code & UNIT_MASK);
+    }
+
+private:
+    bool copy(size_t len)
+    {
+        if (len == 0) {
+            return true;
+        }
+        size_t at = data.size();
+        data.resize(at + len);
+        return source.read(&data[at], len);
+    }
+
+    bool int32(std::int32_t& x)
+    {
+        size_t at = data.size();
+        if (!copy(sizeof(yarp::os::NetInt32))) {
+            return false;
+        }
+        x = loadInt32(&data[at]);
+        return true;
+    }
+
+    bool list(std::int32_t subCode)
+    {
+        std::int32_t len = 0;
+        if (!int32(len) || len < 0) {
+            return false;
+        }
+        for (std::int32_t i = 0; i < len; i++) {
+            std::int32_t code = subCode;
+            if (code == 0 && !int32(code)) {
+                return false;
+            }
+            if (!item(code)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool item(std::int32_t code)
+    {
+        switch (code) {
+        case BOTTLE_TAG_INT8:
+        case BOTTLE_TAG_INT16:
+        case BOTTLE_TAG_INT32:
+        case BOTTLE_TAG_VOCAB:
+        case BOTTLE_TAG_INT64:
+        case BOTTLE_TAG_FLOAT32:
+        case BOTTLE_TAG_FLOAT64:
+            return copy(itemSize(nullptr, code));
+        case BOTTLE_TAG_STRING:
+        case BOTTLE_TAG_BLOB: {
+            std::int32_t len = 0;
+            return int32(len) && len >= 0 && copy(len);
+        }
+        default:
+            if ((code & BOTTLE_TAG_DICT) != 0) {
+                return bottle();
+            }
+            if ((code & BOTTLE_TAG_LIST) != 0) {
+                return list(code & UNIT_MASK);
+            }
+            return false;
+        }
+    }
+
+    Source& source;
+    std::vector<char>& data;
+};
+
+std::string toStringNested(const BottleView::Item& item)
+{
+    if (item.isString()) {
+        return StoreString(item.asString()).toStringNested();
+    }
+    if (item.isVocab()) {
+        return StoreVocab(item.asVocab()).toStringNested();
+    }
+    if (item.isBlob()) {
+        return StoreBlob(std::string(item.asBlob(), item.asBlobLength())).toStringNested();
+    }
+    if (item.isList() || item.isDict()) {
+        return std::string("(") + item.toString() + ")";
+    }
+    return item.toString();
+}
+
+} // namespace
+
+
+////////////////////////////////////////////////////////////////////////////
+// BottleView::Item
+
+BottleView::Item::Item() :
+        data(nullptr),
+        code(-1)
+{
+}
+
+BottleView::Item::Item(const char* data, std::int32_t code) :
+        data(data),
+        code(code)
+{
+}
+
+std::int32_t BottleView::Item::getCode() const
+{
+    return code;
+}
+
+bool BottleView::Item::isNull() const
+{
+    return data == nullptr;
+}
+
+bool BottleView::Item::isInt8() const
+{
+    return code == BOTTLE_TAG_INT8;
+}
+
+bool BottleView::Item::isInt16() const
+{
+    return code == BOTTLE_TAG_INT16;
+}
+
+bool BottleView::Item::isInt32() const
+{
+    return code == BOTTLE_TAG_INT32;
+}
+
+bool BottleView::Item::isInt64() const
+{
+    return code == BOTTLE_TAG_INT64;
+}
+
+bool BottleView::Item::isFloat32() const
+{
+    return code == BOTTLE_TAG_FLOAT32;
+}
+
+bool BottleView::Item::isFloat64() const
+{
+    return code == BOTTLE_TAG_FLOAT64;
+}
+
+bool BottleView::Item::isVocab() const
+{
+    return code == BOTTLE_TAG_VOCAB;
+}
+
+bool BottleView::Item::isString() const
+{
+    return code == BOTTLE_TAG_STRING;
+}
+
+bool BottleView::Item::isBlob() const
+{
+    return code == BOTTLE_TAG_BLOB;
+}
+
+bool BottleView::Item::isList() const
+{
+    return data != nullptr && (code & BOTTLE_TAG_LIST) != 0 && (code & BOTTLE_TAG_DICT) == 0;
+}
+
+bool BottleView::Item::isDict() const
+{
+    return data != nullptr && (code & BOTTLE_TAG_DICT) != 0;
+}
+
+template <typename T>
+T BottleView::Item::asNumber() const
+{
+    switch (code) {
+    case BOTTLE_TAG_INT8:
+        return static_cast<T>(load<std::int8_t, NetInt8>(data));
+    case BOTTLE_TAG_INT16:
+        return static_cast<T>(load<std::int16_t, NetInt16>(data));
+    case BOTTLE_TAG_INT32:
+    case BOTTLE_TAG_VOCAB:
+        return static_cast<T>(load<std::int32_t, NetInt32>(data));
+    case BOTTLE_TAG_INT64:
+        return static_cast<T>(load<std::int64_t, NetInt64>(data));
+    case BOTTLE_TAG_FLOAT32:
+        return static_cast<T>(load<yarp::conf::float32_t, NetFloat32>(data));
+    case BOTTLE_TAG_FLOAT64:
+        return static_cast<T>(load<yarp::conf::float64_t, NetFloat64>(data));
+    default:
+        return 0;
+    }
+}
+
+std::int8_t BottleView::Item::asInt8() const
+{
+    return asNumber<std::int8_t>();
+}
+
+std::int16_t BottleView::Item::asInt16() const
+{
+    return asNumber<std::int16_t>();
+}
+
+std::int32_t BottleView::Item::asInt32() const
+{
+    return asNumber<std::int32_t>();
+}
+
+std::int64_t BottleView::Item::asInt64() const
+{
+    return asNumber<std::int64_t>();
+}
+
+yarp::conf::float32_t BottleView::Item::asFloat32() const
+{
+    return asNumber<yarp::conf::float32_t>();
+}
+
+yarp::conf::float64_t BottleView::Item::asFloat64() const
+{
+    return asNumber<yarp::conf::float64_t>();
+}
+
+std::int32_t BottleView::Item::asVocab() const
+{
+    if (isFloat32() || isFloat64()) {
+        return 0;
+    }
+    return asNumber<std::int32_t>();
+}
+
+std::string BottleView::Item::asString() const
+{
+    if (!isString()) {
+        return {};
+    }
+    return std::string(asBlob(), asBlobLength());
+}
+
+const char* BottleView::Item::asBlob() const
+{
+    if (!isString() && !isBlob()) {
+        return nullptr;
+    }
+    return data + sizeof(NetInt32);
+}
+
+size_t BottleView::Item::asBlobLength() const
+{
+    if (!isString() && !isBlob()) {
+        return 0;
+    }
+    return static_cast<size_t>(loadInt32(data));
+}
+
+BottleView BottleView::Item::asList() const
+{
+    if (isDict()) {
+        return BottleView(data + sizeof(NetInt32), loadInt32(data) & UNIT_MASK);
+    }
+    if (isList()) {
+        return BottleView(data, code & UNIT_MASK);
+    }
+    return BottleView();
+}
+
+std::string BottleView::Item::toString() const
+{
+    switch (code) {
+    case BOTTLE_TAG_INT8:
+        return StoreInt8(asInt8()).toString();
+    case BOTTLE_TAG_INT16:
+        return StoreInt16(asInt16()).toString();
+    case BOTTLE_TAG_INT32:
+        return StoreInt32(asInt32()).toString();
+    case BOTTLE_TAG_INT64:
+        return StoreInt64(asInt64()).toString();
+    case BOTTLE_TAG_FLOAT32:
+        return StoreFloat32(asFloat32()).toString();
+    case BOTTLE_TAG_FLOAT64:
+        return StoreFloat64(asFloat64()).toString();
+    case BOTTLE_TAG_VOCAB:
+        return StoreVocab(asVocab()).toString();
+    case BOTTLE_TAG_STRING:
+        return asString();
+    case BOTTLE_TAG_BLOB:
+        return StoreBlob(std::string(asBlob(), asBlobLength())).toString();
+    default:
+        break;
+    }
+    if (isDict()) {
+        Property dict;
+        dict.fromString(asList().toString());
+        return dict.toString();
+    }
+    if (isList()) {
+        return asList().toString();
+    }
+    return {};
+}
+
+
+////////////////////////////////////////////////////////////////////////////
+// BottleView
+
+BottleView::BottleView() :
+        body(nullptr),
+        subCode(0)
+{
+}
+
+BottleView::BottleView(const Bottle& bottle) :
+        BottleView()
+{
+    Portable::copyPortable(bottle, *this);
+}
+
+BottleView::BottleView(const char* body, std::int32_t subCode) :
+        body(body),
+        subCode(subCode)
+{
+}
+
+BottleView::BottleView(const BottleView& rhs) :
+        Portable(rhs),
+        storage(rhs.storage),
+        body(rhs.body),
+        subCode(rhs.subCode),
+        offsets(rhs.offsets)
+{
+    if (!storage.empty()) {
+        body = storage.data() + (rhs.body - rhs.storage.data());
+    }
+}
+
+BottleView::BottleView(BottleView&& rhs) noexcept :
+        Portable(std::move(rhs)),
+        storage(std::move(rhs.storage)),
+        body(rhs.body),
+        subCode(rhs.subCode),
+        offsets(std::move(rhs.offsets))
+{
+    // the buffer is moved together with the vector
+    rhs.clear();
+}
+
+BottleView& BottleView::operator=(const BottleView& rhs)
+{
+    if (&rhs != this) {
+        storage = rhs.storage;
+        body = rhs.body;
+        subCode = rhs.subCode;
+        offsets = rhs.offsets;
+        if (!storage.empty()) {
+            body = storage.data() + (rhs.body - rhs.storage.data());
+        }
+    }
+    return *this;
+}
+
+BottleView& BottleView::operator=(BottleView&& rhs) noexcept
+{
+    if (&rhs != this) {
+        storage = std::move(rhs.storage);
+        body = rhs.body;
+        subCode = rhs.subCode;
+        offsets = std::move(rhs.offsets);
+        rhs.clear();
+    }
+    return *this;
+}
+
+BottleView::~BottleView() = default;
+
+void BottleView::clear()
+{
+    // the capacity of the buffers is kept for the next message
+    storage.clear();
+    body = nullptr;
+    subCode = 0;
+    offsets.clear();
+}
+
+void BottleView::attach(std::int32_t code)
+{
+    body = storage.data() + sizeof(NetInt32);
+    subCode = code & UNIT_MASK;
+    offsets.clear();
+}
+
+bool BottleView::fromBinary(const char* buf, size_t len)
+{
+    clear();
+    MemorySource source(buf, len);
+    Loader<MemorySource> loader(source, storage);
+    if (!loader.bottle() || !source.done()) {
+        clear();
+        return false;
+    }
+    attach(loadInt32(storage.data()));
+    return true;
+}
+
+size_t BottleView::bodyLength() const
+{
+    if (body == nullptr) {
+        return 0;
+    }
+    return listSize(body, subCode);
+}
+
+size_t BottleView::size() const
+{
+    if (body == nullptr) {
+        return 0;
+    }
+    return static_cast<size_t>(loadInt32(body));
+}
+
+BottleView::Item BottleView::get(size_t index) const
+{
+    if (index >= size()) {
+        return {};
+    }
+    if (offsets.empty()) {
+        offsets.push_back(sizeof(NetInt32));
+    }
+    while (offsets.size() <= index) {
+        // skip the last item found
+        const char* cursor = body + offsets.back();
+        std::int32_t code = subCode;
+        if (code == 0) {
+            code = loadInt32(cursor);
+            cursor += sizeof(NetInt32);
+        }
+        cursor += itemSize(cursor, code);
+        offsets.push_back(cursor - body);
+    }
+    const char* cursor = body + offsets[index];
+    std::int32_t code = subCode;
+    if (code == 0) {
+        code = loadInt32(cursor);
+        cursor += sizeof(NetInt32);
+    }
+    return Item(cursor, code);
+}
+
+bool BottleView::toBottle(Bottle& bottle) const
+{
+    return Portable::copyPortable(*this, bottle);
+}
+
+Bottle BottleView::toBottle() const
+{
+    Bottle bottle;
+    toBottle(bottle);
+    return bottle;
+}
+
+std::string BottleView::toString() const
+{
+    std::string result;
+    for (size_t i = 0; i < size(); i++) {
+        if (i > 0) {
+            result += " ";
+        }
+        result += toStringNested(get(i));
+    }
+    return result;
+}
+
+bool BottleView::read(ConnectionReader& reader)
+{
+    clear();
+    if (reader.isTextMode()) {
+        Bottle bottle;
+        if (!bottle.read(reader)) {
+            return false;
+        }
+        size_t len = 0;
+        const char* buf = bottle.toBinary(&len);
+        return fromBinary(buf, len);
+    }
+    ReaderSource source(reader);
+    Loader<ReaderSource> loader(source, storage);
+    if (!loader.bottle()) {
+        clear();
+        return false;
+    }
+    attach(loadInt32(storage.data()));
+    return true;
+}
+
+bool BottleView::write(ConnectionWriter& writer) const
+{
+    if (writer.isTextMode()) {
+        writer.appendText(toString());
+    } else if (!storage.empty()) {
+        writer.appendBlock(storage.data(), storage.size());
+    } else {
+        writer.appendInt32(BOTTLE_TAG_LIST + subCode);
+        if (body == nullptr) {
+            writer.appendInt32(0);
+        } else {
+            writer.appendBlock(body, bodyLength());
+        }
+    }
+    return !writer.isError();
+}
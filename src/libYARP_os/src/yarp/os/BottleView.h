@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#ifndef YARP_OS_BOTTLEVIEW_H
+#define YARP_OS_BOTTLEVIEW_H
+
+#include <yarp/os/Bottle.h>
+#include <yarp/os/Portable.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace yarp {
+namespace os {
+
+/**
+ * \ingroup key_class
+ *
+ * A read-only view of a Bottle, that keeps the data in the form in which
+ * it was received and decodes the items only when they are accessed.
+ *
+ * Reading a Bottle from a port creates an object for each item and for
+ * each nested list, while a BottleView just copies the data, once, in a
+ * contiguous buffer.  The position of the items in the buffer is found the
+ * first time that they are accessed, and strings and blobs are returned as
+ * pointers into the buffer.  This is convenient to inspect a few items of
+ * large messages, e.g. in monitors and loggers:
+ *
+ * \code
+ * BufferedPort<BottleView> port;
+ * ...
+ * BottleView* view = port.read();
+ * if (view->get(0).asVocab() == yarp::os::createVocab('s', 'e', 't')) {
+ *     ...
+ * }
+ * \endcode
+ *
+ * The same data can be read into a Bottle with toBottle(), in order to
+ * modify it.
+ *
+ * The views returned by Item::asList() and the pointers returned by
+ * Item::asBlob() refer to the buffer of the BottleView they come from, and
+ * are valid as long as it is not modified or destroyed.
+ */
+class YARP_os_API BottleView : public Portable
+{
+public:
+    /**
+     * An item of a BottleView.
+     */
+    class YARP_os_API Item
+    {
+    public:
+        /**
+         * Constructs a null item.
+         */
+        Item();
+
+        /**
+         * @return the type code of the item, one of the BOTTLE_TAG_*
+         * values, or -1 for a null item
+         */
+        std::int32_t getCode() const;
+
+        bool isNull() const;
+        bool isInt8() const;
+        bool isInt16() const;
+        bool isInt32() const;
+        bool isInt64() const;
+        bool isFloat32() const;
+        bool isFloat64() const;
+        bool isVocab() const;
+        bool isString() const;
+        bool isBlob() const;
+        bool isList() const;
+        bool isDict() const;
+
+        /**
+         * The numeric values are converted to the type requested, as with
+         * Value.  Any other item is returned as 0.
+         */
+        std::int8_t asInt8() const;
+        std::int16_t asInt16() const;
+        std::int32_t asInt32() const;
+        std::int64_t asInt64() const;
+        yarp::conf::float32_t asFloat32() const;
+        yarp::conf::float64_t asFloat64() const;
+        std::int32_t asVocab() const;
+
+        /**
+         * @return a copy of the string, or an empty string if the item is
+         * not a string
+         */
+        std::string asString() const;
+
+        /**
+         * @return a pointer to the characters of a string or a blob, in the
+         * buffer of the BottleView, or nullptr for any other item.  The
+         * characters of a string are not null terminated.
+         */
+        const char* asBlob() const;
+
+        /**
+         * @return the length of a string or a blob, or 0 for any other
+         * item.
+         */
+        size_t asBlobLength() const;
+
+        /**
+         * @return a view of a list or of a dictionary, or an empty view for
+         * any other item.
+         */
+        BottleView asList() const;
+
+        /**
+         * @return a textual representation of the item, as in Value
+         */
+        std::string toString() const;
+
+    private:
+        friend class BottleView;
+
+        Item(const char* data, std::int32_t code);
+
+        template <typename T>
+        T asNumber() const;
+
+        const char* data;
+        std::int32_t code;
+    };
+
+    /**
+     * Constructs an empty view.
+     */
+    BottleView();
+
+    /**
+     * Constructs a view of a copy of the data of a Bottle.
+     *
+     * @param bottle the bottle to copy
+     */
+    explicit BottleView(const Bottle& bottle);
+
+    BottleView(const BottleView& rhs);
+    BottleView(BottleView&& rhs) noexcept;
+    BottleView& operator=(const BottleView& rhs);
+    BottleView& operator=(BottleView&& rhs) noexcept;
+    ~BottleView() override;
+
+    /**
+     * Copies the data of a Bottle in binary form, as returned by
+     * Bottle::toBinary().
+     *
+     * @param buf the data
+     * @param len the length of the data
+     * @return true if the data holds a valid Bottle, otherwise the view is
+     * left empty
+     */
+    bool fromBinary(const char* buf, size_t len);
+
+    /**
+     * @return the number of items
+     */
+    size_t size() const;
+
+    /**
+     * Access an item.  The items before the requested one are scanned the
+     * first time that they are reached, without decoding them.
+     *
+     * @param index the position of the item
+     * @return the item, or a null item if the index is out of range
+     */
+    Item get(size_t index) const;
+
+    /**
+     * Decode all the items in a Bottle.
+     *
+     * @param[out] bottle the bottle
+     * @return true on success
+     */
+    bool toBottle(Bottle& bottle) const;
+
+    /**
+     * @return a Bottle with all the items of the view
+     */
+    Bottle toBottle() const;
+
+    /**
+     * @return a textual representation of the view, as in Bottle
+     */
+    std::string toString() const;
+
+    // Documented in Portable
+    bool read(ConnectionReader& reader) override;
+
+    // Documented in Portable
+    bool write(ConnectionWriter& writer) const override;
+
+private:
+    BottleView(const char* body, std::int32_t subCode);
+
+    void clear();
+    void attach(std::int32_t subCode);
+    size_t bodyLength() const;
+
+    // the data of the view, when it is not part of another view
+    YARP_SUPPRESS_DLL_INTERFACE_WARNING_ARG(std::vector<char>) storage;
+    // the number of items, followed by the items
+    const char* body;
+    // the type of all the items, or 0 if each item is tagged
+    std::int32_t subCode;
+    // where the items found so far start, relative to body
+    mutable YARP_SUPPRESS_DLL_INTERFACE_WARNING_ARG(std::vector<size_t>) offsets;
+};
+
+} // namespace os
+} // namespace yarp
+
+#endif // YARP_OS_BOTTLEVIEW_H
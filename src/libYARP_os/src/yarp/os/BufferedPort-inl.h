@@ -89,6 +89,7 @@ template <typename T>
 void yarp::os::BufferedPort<T>::resume()
 {
     port.resume();
+    reader.resume();
     interrupted = false;
 }
 
@@ -143,6 +144,18 @@ void yarp::os::BufferedPort<T>::waitForWrite()
     writer.waitForWrite();
 }
 
+template <typename T>
+void yarp::os::BufferedPort<T>::setBatching(size_t messages, double delay)
+{
+    port.setBatching(messages, delay);
+}
+
+template <typename T>
+void yarp::os::BufferedPort<T>::flush()
+{
+    port.flush();
+}
+
 template <typename T>
 void yarp::os::BufferedPort<T>::setStrict(bool strict)
 {
@@ -150,6 +163,13 @@ void yarp::os::BufferedPort<T>::setStrict(bool strict)
     reader.setStrict(strict);
 }
 
+template <typename T>
+void yarp::os::BufferedPort<T>::setLockFree(bool lockFree, unsigned int size)
+{
+    attachIfNeeded();
+    reader.setLockFree(lockFree, size);
+}
+
 template <typename T>
 T* yarp::os::BufferedPort<T>::read(bool shouldWait)
 {
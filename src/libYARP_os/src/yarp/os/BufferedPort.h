@@ -178,12 +178,41 @@ public:
 
     /**
      * Wait for any pending writes to complete.
+     * The messages waiting in a batch are sent first.
      */
     void waitForWrite();
 
+    /**
+     * Send the objects written by BufferedPort::write in batches, see
+     * Port::setBatching.
+     * Each object keeps its envelope, and it is given back to
+     * BufferedPort::prepare when its whole batch has been sent.
+     *
+     * @param messages the most objects in a batch, 0 or 1 to stop batching
+     * @param delay the most time, in seconds, that an object waits for the
+     *              others in its batch, 0 to wait for a full batch
+     */
+    void setBatching(size_t messages, double delay = 0.001);
+
+    /**
+     * Send the objects waiting in the current batch, see setBatching.
+     */
+    void flush();
+
     // Documented in TypedReader
     void setStrict(bool strict = true) override;
 
+    /**
+     * Exchange received objects with the reader through a bounded lock-free
+     * ring of preallocated objects, instead of the default pool.
+     * See PortReaderBuffer::setLockFree.
+     * Call this before opening the port.
+     *
+     * @param lockFree true to use the lock-free ring
+     * @param size number of objects in the ring (0 for the default)
+     */
+    void setLockFree(bool lockFree = true, unsigned int size = 0);
+
     // Documented in TypedReader
     T* read(bool shouldWait = true) override;
 
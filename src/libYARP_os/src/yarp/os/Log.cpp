@@ -17,6 +17,7 @@
 #include <yarp/os/Time.h>
 
 #include <yarp/os/impl/LogForwarder.h>
+#include <yarp/os/impl/LogRecord.h>
 #include <yarp/os/impl/ThreadImpl.h>
 #include <yarp/os/impl/Storable.h>
 
@@ -598,9 +599,43 @@ void yarp::os::impl::LogPrivate::forward_callback(yarp::os::Log::LogType t,
         // And avoid creating the LogForwarder!
         return;
     }
-    std::stringstream stringstream_buffer;
-    forwardable_output(&stringstream_buffer, t, msg, file, line, func, systemtime, networktime, comp_name);
-    LogForwarder::getInstance().forward(stringstream_buffer.str());
+
+    // The message is encoded in a buffer of the thread, and queued to be sent
+    // in background.  Fatal messages, and messages with a backtrace, are sent
+    // right away instead, since the process is probably going to die.
+    static std::string hostname(yarp::os::gethostname());
+    static yarp::os::SystemInfo::ProcessInfo processInfo(yarp::os::SystemInfo::getProcessInfo());
+    static std::string cmd(processInfo.name.substr(processInfo.name.find_last_of("\\/") + 1));
+    thread_local long thread_id(yarp::os::impl::ThreadImpl::getKeyOfCaller());
+    thread_local std::string record;
+
+    const bool codeinfo = yarp::os::impl::LogPrivate::forward_codeinfo.load();
+    const bool processinfo = yarp::os::impl::LogPrivate::forward_processinfo.load();
+    const bool sync = (t == yarp::os::Log::FatalType || yarp::os::impl::LogPrivate::forward_backtrace.load());
+    std::string bt = (sync ? backtrace() : std::string());
+
+    record.clear();
+    LogRecord::encode(record,
+                      t,
+                      systemtime,
+                      networktime,
+                      codeinfo ? (file ? file : "") : nullptr,
+                      line,
+                      codeinfo ? (func ? func : "") : nullptr,
+                      yarp::os::impl::LogPrivate::forward_hostname.load() ? hostname.c_str() : nullptr,
+                      processInfo.pid,
+                      processinfo ? cmd.c_str() : nullptr,
+                      processInfo.arguments.c_str(),
+                      thread_id,
+                      comp_name,
+                      msg,
+                      sync ? bt.c_str() : nullptr);
+
+    if (sync) {
+        LogForwarder::getInstance().forward(record);
+    } else {
+        LogForwarder::getInstance().post(record);
+    }
 }
 
 void yarp::os::impl::LogPrivate::log(yarp::os::Log::LogType type,
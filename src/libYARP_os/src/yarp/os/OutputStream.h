@@ -12,6 +12,8 @@
 
 #include <yarp/os/api.h>
 
+#include <cstddef>
+
 namespace yarp {
 namespace os {
 
@@ -54,6 +56,17 @@ public:
      */
     virtual void write(const yarp::os::Bytes& b) = 0;
 
+    /**
+     * Write a list of blocks of bytes to the stream, in order.
+     * Streams that can send several blocks at once (e.g. with a single
+     * system call) should override this.  By default, this calls
+     * write(const Bytes& b) for each block.
+     *
+     * @param blocks the blocks to write
+     * @param count the number of blocks
+     */
+    virtual void writev(const yarp::os::Bytes* blocks, size_t count);
+
     /**
      * Terminate the stream.
      */
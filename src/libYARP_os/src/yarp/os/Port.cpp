@@ -530,6 +530,20 @@ void Port::enableBackgroundWrite(bool backgroundFlag)
 }
 
 
+void Port::setBatching(size_t messages, double delay)
+{
+    PortCoreAdapter& core = IMPL();
+    core.setBatching(messages, delay);
+}
+
+
+bool Port::flush()
+{
+    PortCoreAdapter& core = IMPL();
+    return core.flushBatch();
+}
+
+
 bool Port::isWriting()
 {
     PortCoreAdapter& core = IMPL();
@@ -149,6 +149,37 @@ public:
      */
     void enableBackgroundWrite(bool backgroundFlag);
 
+    /**
+     * Group the messages written in the background in batches, that are
+     * sent as a single message and unpacked by the ports that read them,
+     * with the envelope of each message.  This reduces the cost of sending
+     * many small messages at a high rate.
+     *
+     * Only the messages written with a completion callback (e.g. by a
+     * BufferedPort) are batched, the others are sent after the messages
+     * waiting in the current batch.  A batch is sent when it contains
+     * enough messages, when its first message has waited long enough,
+     * when flush() is called, or when the port is closed.
+     * A batch is not skipped by the connections still sending the previous
+     * one, it waits for it instead.
+     * Only the tcp connections to ports that tell, when connecting, that
+     * they can read batches carry them as they are.  The others (e.g. text
+     * mode, local, with a portmonitor, or to older ports) get the messages
+     * one by one.
+     *
+     * @param messages the most messages in a batch, 0 or 1 to stop batching
+     * @param delay the most time, in seconds, that a message waits for the
+     *              others in its batch, 0 to wait for a full batch
+     */
+    void setBatching(size_t messages, double delay = 0.001);
+
+    /**
+     * Send the messages waiting in the current batch, see setBatching().
+     *
+     * @return true on success
+     */
+    bool flush();
+
 
     // Documented in Contactable
     bool isWriting() override;
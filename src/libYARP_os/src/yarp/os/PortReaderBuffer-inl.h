@@ -55,6 +55,12 @@ void yarp::os::PortReaderBuffer<T>::setStrict(bool strict)
     implementation.setPrune(autoDiscard);
 }
 
+template <typename T>
+void yarp::os::PortReaderBuffer<T>::setLockFree(bool lockFree, unsigned int size)
+{
+    implementation.setLockFree(lockFree, size);
+}
+
 template <typename T>
 bool yarp::os::PortReaderBuffer<T>::check()
 {
@@ -109,6 +115,12 @@ void yarp::os::PortReaderBuffer<T>::interrupt()
     implementation.interrupt();
 }
 
+template <typename T>
+void yarp::os::PortReaderBuffer<T>::resume()
+{
+    implementation.resume();
+}
+
 template <typename T>
 T* yarp::os::PortReaderBuffer<T>::lastRead()
 {
@@ -155,6 +167,60 @@ yarp::os::PortReader* yarp::os::PortReaderBuffer<T>::create() const
     return new T;
 }
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace yarp {
+namespace os {
+namespace impl {
+
+template <typename T, bool = std::is_copy_assignable<T>::value>
+struct PortReaderBufferCopier
+{
+    static bool copy(PortReader& target, const PortWriter& source)
+    {
+        YARP_UNUSED(target);
+        YARP_UNUSED(source);
+        return false;
+    }
+};
+
+template <typename T>
+struct PortReaderBufferCopier<T, true>
+{
+    static bool copy(PortReader& target, const PortWriter& source)
+    {
+        // Only an exact match is safe, a derived type could carry more
+        // data than T.
+        const auto* src = dynamic_cast<const T*>(&source);
+        if (src == nullptr || typeid(*src) != typeid(T)) {
+            return false;
+        }
+        static_cast<T&>(target) = *src;
+        return true;
+    }
+};
+
+} // namespace impl
+} // namespace os
+} // namespace yarp
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+template <typename T>
+bool yarp::os::PortReaderBuffer<T>::copyReference(PortReader& target, const PortWriter& source) const
+{
+    return yarp::os::impl::PortReaderBufferCopier<T>::copy(target, source);
+}
+
+template <typename T>
+std::shared_ptr<yarp::os::PortReader> yarp::os::PortReaderBuffer<T>::shareReference(const std::shared_ptr<Portable>& source) const
+{
+    // Only an exact match is safe, see PortReaderBufferCopier
+    std::shared_ptr<T> object = std::dynamic_pointer_cast<T>(source);
+    if (object == nullptr || typeid(*object) != typeid(T)) {
+        return nullptr;
+    }
+    return object;
+}
+
 template <typename T>
 void yarp::os::PortReaderBuffer<T>::setReplier(PortReader& reader)
 {
@@ -22,7 +22,10 @@
 #include <yarp/os/TypedReaderThread.h>
 
 #include <cstdio>
+#include <memory>
 #include <string>
+#include <type_traits>
+#include <typeinfo>
 
 namespace yarp {
 namespace os {
@@ -59,6 +62,25 @@ public:
     // documented in TypedReader
     void setStrict(bool strict = true) override;
 
+    /**
+     * Use a bounded ring of preallocated buffers, that the thread receiving
+     * the data and the thread reading it exchange without locking, and wake
+     * up the reader only if it is waiting for data.
+     * This reduces contention for high rate streams.
+     * The strict and non-strict policies are preserved, but in strict mode
+     * the writer blocks when the ring is full instead of allocating more
+     * buffers.
+     * Objects taken with acquire() are replaced by a newly allocated buffer.
+     * This must be called before any data is received.
+     *
+     * @param lockFree true to use the ring, false to go back to the default
+     *                 buffer pool
+     * @param size number of buffers in the ring (0 uses the maximum number
+     *             of buffers set in the constructor, or a default value
+     *             if that is not limited)
+     */
+    void setLockFree(bool lockFree = true, unsigned int size = 0);
+
     /**
      * Check if data is available.
      *
@@ -76,6 +98,12 @@ public:
     // documented in TypedReader
     void interrupt() override;
 
+    /**
+     * Discard the interrupts that did not wake up a read yet, so that the
+     * reads after resuming the port wait for data again.
+     */
+    void resume();
+
     // documented in TypedReader
     T* lastRead() override;
 
@@ -113,6 +141,32 @@ public:
      */
     PortReader* create() const override;
 
+    /**
+     * Copy an object sent by a port in the same process (e.g. using the
+     * "local" carrier).  If the sender's object is exactly of type T, and
+     * T is copy assignable, it is assigned to the target without being
+     * serialized and deserialized.  Otherwise false is returned, and the
+     * object is serialized as usual.
+     *
+     * @param target an instance of T previously returned by create()
+     * @param source the object written by the sender
+     * @return true if the object was copied
+     */
+    bool copyReference(PortReader& target, const PortWriter& source) const override;
+
+    /**
+     * Share an object sent by a BufferedPort in the same process (e.g.
+     * using the "local" carrier).  If the sender's object is exactly of
+     * type T, it is returned to the user as it is, the sender will prepare
+     * its next messages in other objects.  Otherwise nullptr is returned,
+     * and the object is copied by copyReference().
+     *
+     * @param source a reference counted handle to the object written by the
+     *        sender
+     * @return the object, or nullptr
+     */
+    std::shared_ptr<PortReader> shareReference(const std::shared_ptr<Portable>& source) const override;
+
     // documented in TypedReader
     void setReplier(PortReader& reader) override;
 
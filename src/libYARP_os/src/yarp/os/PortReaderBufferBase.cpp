@@ -12,22 +12,34 @@
 #include <yarp/os/Os.h>
 #include <yarp/os/PortReaderBuffer.h>
 #include <yarp/os/Portable.h>
+#include <yarp/os/Property.h>
 #include <yarp/os/Semaphore.h>
 #include <yarp/os/StringInputStream.h>
 #include <yarp/os/Thread.h>
 #include <yarp/os/Time.h>
+#include <yarp/os/Value.h>
+#include <yarp/os/impl/LocalCarrier.h>
 #include <yarp/os/impl/LogComponent.h>
 #include <yarp/os/impl/PortCorePacket.h>
+#include <yarp/os/impl/PortStatistics.h>
 #include <yarp/os/impl/StreamConnectionReader.h>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <list>
+#include <memory>
 #include <mutex>
+#include <vector>
 
 using namespace yarp::os::impl;
 using namespace yarp::os;
 
 namespace {
 YARP_OS_LOG_COMPONENT(PORTREADERBUFFERBASE, "yarp.os.PortReaderBufferBase")
+
+// Number of packets in the lock-free ring, when not set by maxBuffer
+constexpr unsigned int PORTREADERBUFFER_DEFAULT_RING_SIZE = 16;
 } // namespace
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
@@ -46,6 +58,9 @@ public:
     PortReader* external;
     PortWriter* writer; // if a callback is needed
 
+    // if non-null, keeps the external buffer alive
+    std::shared_ptr<PortReader> shared;
+
     PortReaderPacket()
     {
         prev_ = next_ = nullptr;
@@ -95,6 +110,13 @@ public:
         this->writer = writer;
     }
 
+    void setShared(std::shared_ptr<PortReader> reader)
+    {
+        resetExternal();
+        this->external = reader.get();
+        this->shared = std::move(reader);
+    }
+
     void setEnvelope(const Bytes& bytes)
     {
         envelope = std::string(bytes.get(), bytes.length());
@@ -108,6 +130,7 @@ public:
             writer = nullptr;
         }
         external = nullptr;
+        shared = nullptr;
     }
 };
 
@@ -181,6 +204,223 @@ public:
 };
 
 
+/*
+ * Wake up threads waiting for a condition, without any system call when
+ * nobody is waiting.  Waiters announce themselves before sleeping, so that
+ * the notifying thread only needs to touch the mutex and the condition
+ * variable (and therefore the kernel) when somebody is actually blocked.
+ */
+class PortReaderRingSignal
+{
+private:
+    std::atomic<int> waiters {0};
+    std::mutex mutex;
+    std::condition_variable cond;
+
+public:
+    void notify()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            cond.notify_all();
+        }
+    }
+
+    // wait until pred() is true, or until timeout (if positive) expires
+    template <typename Pred>
+    bool wait(Pred pred, double timeout = -1)
+    {
+        if (pred()) {
+            return true;
+        }
+        waiters.fetch_add(1, std::memory_order_seq_cst);
+        bool ok = true;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (timeout < 0) {
+                cond.wait(lock, pred);
+            } else {
+                ok = cond.wait_for(lock, std::chrono::duration<double>(timeout), pred);
+            }
+        }
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+        return ok;
+    }
+};
+
+
+/*
+ * A bounded set of preallocated packets, moving between the thread
+ * receiving data (the producer) and the thread reading it (the consumer)
+ * through two single-producer/single-consumer rings of pointers:
+ *  - "full" carries packets with new content to the consumer.  The
+ *    producer is allowed to drop the oldest packet (when pruning), so
+ *    the head of this ring is advanced with a compare and swap.
+ *  - "empty" carries recycled packets back to the producer.
+ * Packets dropped by the producer are kept aside for its next use.
+ *
+ * Several input connections may deliver data at the same time, so the
+ * producer side is serialized by a mutex, that is never taken by the
+ * consumer.
+ */
+class PortReaderRing
+{
+private:
+    struct Ring
+    {
+        std::vector<PortReaderPacket*> slots;
+        std::atomic<size_t> head {0};
+        std::atomic<size_t> tail {0};
+
+        void init(size_t size)
+        {
+            slots.assign(size, nullptr);
+            head = 0;
+            tail = 0;
+        }
+
+        size_t count() const
+        {
+            return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+        }
+
+        // single writer
+        bool push(PortReaderPacket* packet)
+        {
+            size_t t = tail.load(std::memory_order_relaxed);
+            if (t - head.load(std::memory_order_acquire) >= slots.size()) {
+                return false;
+            }
+            slots[t % slots.size()] = packet;
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+
+        // safe with one writer and several readers
+        PortReaderPacket* pop()
+        {
+            size_t h = head.load(std::memory_order_acquire);
+            while (h != tail.load(std::memory_order_acquire)) {
+                PortReaderPacket* packet = slots[h % slots.size()];
+                if (head.compare_exchange_weak(h, h + 1, std::memory_order_acq_rel)) {
+                    return packet;
+                }
+            }
+            return nullptr;
+        }
+    };
+
+    Ring full;
+    Ring empty;
+    std::vector<PortReaderPacket*> spare; // producer only
+
+public:
+    std::mutex producerMutex;
+    PortReaderRingSignal contentSignal;
+    PortReaderRingSignal spaceSignal;
+    std::atomic<int> interrupts {0};
+    std::atomic<std::uint64_t> dropped {0}; // written by the producer only
+
+    void init(size_t size)
+    {
+        reset();
+        full.init(size);
+        empty.init(size);
+        for (size_t i = 0; i < size; i++) {
+            empty.push(new PortReaderPacket());
+        }
+    }
+
+    size_t getCount() const
+    {
+        return full.count();
+    }
+
+    size_t getFree() const
+    {
+        return empty.count();
+    }
+
+    // producer
+    PortReaderPacket* getInactivePacket(bool prune)
+    {
+        if (!spare.empty()) {
+            PortReaderPacket* packet = spare.back();
+            spare.pop_back();
+            return packet;
+        }
+        PortReaderPacket* packet = empty.pop();
+        if (packet == nullptr && prune) {
+            // drop the oldest message, there is no space for a new one
+            packet = full.pop();
+            if (packet != nullptr) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        return packet;
+    }
+
+    // producer
+    void addActivePacket(PortReaderPacket* packet, bool prune)
+    {
+        if (prune) {
+            // only the most recent message is kept
+            PortReaderPacket* old = nullptr;
+            while ((old = full.pop()) != nullptr) {
+                spare.push_back(old);
+                dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        bool ok = full.push(packet);
+        yCAssert(PORTREADERBUFFERBASE, ok);
+        contentSignal.notify();
+    }
+
+    // producer
+    void addSparePacket(PortReaderPacket* packet)
+    {
+        spare.push_back(packet);
+    }
+
+    // consumer
+    PortReaderPacket* getActivePacket()
+    {
+        return full.pop();
+    }
+
+    // consumer
+    void addInactivePacket(PortReaderPacket* packet)
+    {
+        bool ok = empty.push(packet);
+        yCAssert(PORTREADERBUFFERBASE, ok);
+        spaceSignal.notify();
+    }
+
+    // no producer or consumer must be active
+    void reset()
+    {
+        PortReaderPacket* packet = nullptr;
+        while ((packet = full.pop()) != nullptr) {
+            delete packet;
+        }
+        while ((packet = empty.pop()) != nullptr) {
+            delete packet;
+        }
+        for (auto* p : spare) {
+            delete p;
+        }
+        spare.clear();
+        interrupts = 0;
+    }
+
+    ~PortReaderRing()
+    {
+        reset();
+    }
+};
+
+
 class PortReaderBufferBase::Private
 {
 private:
@@ -197,12 +437,21 @@ public:
 
     PortReaderPool pool;
 
+    bool lockFree;
+    unsigned int ringSize;
+    PortReaderRing ring;
+
     int ct;
     Port* port;
     yarp::os::Semaphore contentSema;
     yarp::os::Semaphore consumeSema;
     std::mutex stateMutex;
 
+    std::atomic<std::uint64_t> received;
+    std::atomic<std::uint64_t> dropped;
+    std::atomic<int> maxDepth;
+    LatencyHistogram waitTime;
+
     Private(PortReaderBufferBase& owner, unsigned int maxBuffer) :
             owner(owner),
             prev(nullptr),
@@ -212,11 +461,16 @@ public:
             replier(nullptr),
             period(-1),
             last_recv(-1),
+            lockFree(false),
+            ringSize(0),
             ct(0),
             port(nullptr),
             contentSema(0),
             consumeSema(0),
-            stateMutex()
+            stateMutex(),
+            received(0),
+            dropped(0),
+            maxDepth(0)
     {
     }
 
@@ -236,8 +490,45 @@ public:
         stateMutex.unlock();
     }
 
+    bool readObject(PortReaderPacket& packet, ConnectionReader& connection)
+    {
+        // drop the object kept from the last message, if any
+        packet.resetExternal();
+        PortReader& target = *packet.getReader();
+        Portable* ref = connection.getReference();
+        if (ref == nullptr) {
+            return target.read(connection);
+        }
+        // The sender is in this process (see LocalCarrier), and waits for
+        // this to complete before reusing its object.  Keep the object if
+        // the sender handed over a reference counted handle to it, and it
+        // has the right type, otherwise take a copy of it, serializing it
+        // only when the types differ.
+        auto* local = dynamic_cast<LocalCarrierReference*>(ref);
+        if (local != nullptr) {
+            if (creator != nullptr) {
+                std::shared_ptr<PortReader> shared = creator->shareReference(local->get());
+                if (shared != nullptr) {
+                    packet.setShared(std::move(shared));
+                    return true;
+                }
+            }
+            ref = local->get().get();
+        }
+        if (creator != nullptr && creator->copyReference(target, *ref)) {
+            return true;
+        }
+        return Portable::copyPortable(*ref, target);
+    }
+
     void clear()
     {
+        if (lockFree) {
+            delete prev;
+            prev = nullptr;
+            ring.init(ringSize);
+            return;
+        }
         if (prev != nullptr) {
             pool.addInactivePacket(prev);
             prev = nullptr;
@@ -246,6 +537,90 @@ public:
         ct = 0;
     }
 
+    void setLockFree(bool flag, unsigned int size)
+    {
+        if (size == 0) {
+            size = (maxBuffer != 0) ? maxBuffer : PORTREADERBUFFER_DEFAULT_RING_SIZE;
+        }
+        // one packet may be held by the reader, one more is needed for
+        // receiving data
+        ringSize = (size < 2) ? 2 : size;
+        clear();
+        lockFree = flag;
+        if (lockFree) {
+            ring.init(ringSize);
+        } else {
+            ring.reset();
+        }
+    }
+
+    bool waitContent(double timeout)
+    {
+        if (!lockFree) {
+            if (timeout < 0) {
+                contentSema.wait();
+                return true;
+            }
+            if (timeout == 0) {
+                bool ok = contentSema.check();
+                if (ok) {
+                    contentSema.wait();
+                }
+                return ok;
+            }
+            return contentSema.waitWithTimeout(timeout);
+        }
+        bool ok = ring.contentSignal.wait([this]() {
+            return ring.getCount() > 0 || ring.interrupts.load() > 0;
+        }, timeout);
+        // An interrupt only wakes up the reader: once it is awake the pending
+        // interrupts are consumed, even when there are messages to read, so
+        // that they do not make a later read return nothing
+        ring.interrupts.exchange(0);
+        return ok;
+    }
+
+    PortReaderPacket* getRingPacket()
+    {
+        PortReaderPacket* result = ring.getInactivePacket(prune);
+        if (result == nullptr) {
+            auto start = std::chrono::steady_clock::now();
+            while (result == nullptr) {
+                ring.spaceSignal.wait([this]() {
+                    return ring.getFree() > 0 || (prune && ring.getCount() > 0);
+                });
+                result = ring.getInactivePacket(prune);
+            }
+            waitTime.record(std::chrono::steady_clock::now() - start);
+        }
+        return result;
+    }
+
+    // to be called after adding a packet with new content
+    void countContent()
+    {
+        received.fetch_add(1, std::memory_order_relaxed);
+        int depth = checkContent();
+        int deepest = maxDepth.load(std::memory_order_relaxed);
+        while (depth > deepest && !maxDepth.compare_exchange_weak(deepest, depth, std::memory_order_relaxed)) {
+        }
+    }
+
+    void getStatistics(Property& stats)
+    {
+        stats.put("received", Value::makeInt64(static_cast<std::int64_t>(received.load(std::memory_order_relaxed))));
+        std::uint64_t drops = dropped.load(std::memory_order_relaxed) + ring.dropped.load(std::memory_order_relaxed);
+        stats.put("dropped", Value::makeInt64(static_cast<std::int64_t>(drops)));
+        if (lockFree) {
+            stats.put("depth", checkContent());
+        } else {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            stats.put("depth", checkContent());
+        }
+        stats.put("max_depth", maxDepth.load(std::memory_order_relaxed));
+        waitTime.report(stats.addGroup("wait"));
+    }
+
 
     std::string getName()
     {
@@ -277,11 +652,21 @@ public:
 
     int checkContent()
     {
+        if (lockFree) {
+            return (int)ring.getCount();
+        }
         return (int)pool.getCount();
     }
 
     PortReaderPacket* getContent()
     {
+        if (lockFree) {
+            if (prev != nullptr) {
+                ring.addInactivePacket(prev);
+            }
+            prev = ring.getActivePacket();
+            return prev;
+        }
         if (prev != nullptr) {
             pool.addInactivePacket(prev);
             prev = nullptr;
@@ -317,6 +702,7 @@ public:
             drop = pool.getActivePacket();
             if (drop != nullptr) {
                 pool.addInactivePacket(drop);
+                dropped.fetch_add(1, std::memory_order_relaxed);
             }
             ct--;
         }
@@ -334,6 +720,10 @@ public:
         if (prev != nullptr) {
             void* result = prev;
             prev = nullptr;
+            if (lockFree) {
+                // keep the number of packets in the ring constant
+                ring.addInactivePacket(new PortReaderPacket());
+            }
             return result;
         }
         return nullptr;
@@ -341,6 +731,11 @@ public:
 
     void release(void* key)
     {
+        if (lockFree) {
+            // the packet was replaced when acquired
+            delete static_cast<PortReaderPacket*>(key);
+            return;
+        }
         if (key != nullptr) {
             pool.addInactivePacket((PortReaderPacket*)key);
         }
@@ -370,6 +765,9 @@ yarp::os::PortReader* PortReaderBufferBase::create()
 
 int PortReaderBufferBase::check()
 {
+    if (mPriv->lockFree) {
+        return mPriv->checkContent();
+    }
     mPriv->stateMutex.lock();
     int count = mPriv->checkContent();
     mPriv->stateMutex.unlock();
@@ -380,14 +778,26 @@ int PortReaderBufferBase::check()
 void PortReaderBufferBase::interrupt()
 {
     // give read a chance
+    if (mPriv->lockFree) {
+        mPriv->ring.interrupts++;
+        mPriv->ring.contentSignal.notify();
+        return;
+    }
     mPriv->contentSema.post();
 }
 
+void PortReaderBufferBase::resume()
+{
+    if (mPriv->lockFree) {
+        mPriv->ring.interrupts = 0;
+    }
+}
+
 PortReader* PortReaderBufferBase::readBase(bool& missed, bool cleanup)
 {
     missed = false;
     if (mPriv->period < 0 || cleanup) {
-        mPriv->contentSema.wait();
+        mPriv->waitContent(-1);
     } else {
         bool ok = false;
         double now = SystemClock::nowSystem();
@@ -397,12 +807,9 @@ PortReader* PortReaderBufferBase::readBase(bool& missed, bool cleanup)
         }
         double diff = target - now;
         if (diff > 0) {
-            ok = mPriv->contentSema.waitWithTimeout(diff);
+            ok = mPriv->waitContent(diff);
         } else {
-            ok = mPriv->contentSema.check();
-            if (ok) {
-                mPriv->contentSema.wait();
-            }
+            ok = mPriv->waitContent(0);
         }
         if (!ok) {
             missed = true;
@@ -422,6 +829,15 @@ PortReader* PortReaderBufferBase::readBase(bool& missed, bool cleanup)
             mPriv->last_recv = target;
         }
     }
+    if (mPriv->lockFree) {
+        // no lock needed, only this thread consumes from the ring
+        PortReaderPacket* readerPacket = mPriv->getContent();
+        if (readerPacket == nullptr) {
+            return nullptr;
+        }
+        PortReader* external = readerPacket->getExternal();
+        return (external != nullptr) ? external : readerPacket->getReader();
+    }
     mPriv->stateMutex.lock();
     PortReaderPacket* readerPacket = mPriv->getContent();
     PortReader* reader = nullptr;
@@ -443,17 +859,46 @@ PortReader* PortReaderBufferBase::readBase(bool& missed, bool cleanup)
 
 bool PortReaderBufferBase::read(ConnectionReader& connection)
 {
-    if (connection.getReference() != nullptr) {
-        //printf("REF %ld %d\n", (long int)connection.getReference(),
-        //     connection.isValid());
-        return acceptObjectBase(connection.getReference(), nullptr);
-    }
-
-    if (mPriv->replier != nullptr) {
+    if (mPriv->replier != nullptr && connection.getReference() == nullptr) {
         if (connection.getWriter() != nullptr) {
             return mPriv->replier->read(connection);
         }
     }
+
+    if (mPriv->lockFree) {
+        std::lock_guard<std::mutex> lock(mPriv->ring.producerMutex);
+        PortReaderPacket* reader = mPriv->getRingPacket();
+        if (reader->getReader() == nullptr) {
+            PortReader* next = create();
+            yCAssert(PORTREADERBUFFERBASE, next != nullptr);
+            reader->setReader(next);
+        } else {
+            reader->resetExternal();
+        }
+        bool ok = false;
+        if (connection.isValid()) {
+            ok = mPriv->readObject(*reader, connection);
+            reader->setEnvelope(connection.readEnvelope());
+        } else {
+            // this is a disconnection
+            // don't talk to this port ever again
+            mPriv->port = nullptr;
+        }
+        if (ok) {
+            mPriv->ring.addActivePacket(reader, mPriv->prune);
+            mPriv->countContent();
+            yCTrace(PORTREADERBUFFERBASE, ">>>>>>>>>>>>>>>>> adding data");
+        } else {
+            mPriv->ring.addSparePacket(reader);
+            yCTrace(PORTREADERBUFFERBASE, ">>>>>>>>>>>>>>>>> skipping data");
+
+            // important to give reader a shot anyway, allowing proper closing
+            yCDebug(PORTREADERBUFFERBASE, "giving PortReaderBuffer chance to close");
+            interrupt();
+        }
+        return ok;
+    }
+
     PortReaderPacket* reader = nullptr;
     while (reader == nullptr) {
         mPriv->stateMutex.lock();
@@ -466,13 +911,15 @@ bool PortReaderBufferBase::read(ConnectionReader& connection)
 
         mPriv->stateMutex.unlock();
         if (reader == nullptr) {
+            auto start = std::chrono::steady_clock::now();
             mPriv->consumeSema.wait();
+            mPriv->waitTime.record(std::chrono::steady_clock::now() - start);
         }
     }
     bool ok = false;
     if (connection.isValid()) {
         yCAssert(PORTREADERBUFFERBASE, reader->getReader() != nullptr);
-        ok = reader->getReader()->read(connection);
+        ok = mPriv->readObject(*reader, connection);
         reader->setEnvelope(connection.readEnvelope());
     } else {
         // this is a disconnection
@@ -489,6 +936,7 @@ bool PortReaderBufferBase::read(ConnectionReader& connection)
         //mPriv->configure(reader, false, true);
         mPriv->pool.addActivePacket(reader);
         mPriv->ct++;
+        mPriv->countContent();
         mPriv->stateMutex.unlock();
         if (!pruned) {
             mPriv->contentSema.post();
@@ -528,11 +976,34 @@ void PortReaderBufferBase::setTargetPeriod(double period)
     mPriv->period = period;
 }
 
+void PortReaderBufferBase::setLockFree(bool flag, unsigned int size)
+{
+    mPriv->stateMutex.lock();
+    mPriv->setLockFree(flag, size);
+    mPriv->stateMutex.unlock();
+}
+
+bool PortReaderBufferBase::isLockFree() const
+{
+    return mPriv->lockFree;
+}
+
 std::string PortReaderBufferBase::getName() const
 {
     return mPriv->getName();
 }
 
+bool PortReaderBufferBase::isNonBlocking() const
+{
+    if (mPriv->replier != nullptr) {
+        return false;
+    }
+    if (mPriv->lockFree) {
+        return mPriv->prune;
+    }
+    return mPriv->maxBuffer == 0;
+}
+
 unsigned int PortReaderBufferBase::getMaxBuffer()
 {
     return mPriv->maxBuffer;
@@ -561,13 +1032,25 @@ bool PortReaderBufferBase::acceptObjectBase(PortReader* obj,
     // receiving from a Port -- except no need to create/read
     // the object
 
+    if (mPriv->lockFree) {
+        std::lock_guard<std::mutex> lock(mPriv->ring.producerMutex);
+        PortReaderPacket* reader = mPriv->getRingPacket();
+        reader->setExternal(obj, wrapper);
+        mPriv->ring.addActivePacket(reader, mPriv->prune);
+        mPriv->countContent();
+        yCTrace(PORTREADERBUFFERBASE, ">>>>>>>>>>>>>>>>> adding data");
+        return true;
+    }
+
     PortReaderPacket* reader = nullptr;
     while (reader == nullptr) {
         mPriv->stateMutex.lock();
         reader = mPriv->get();
         mPriv->stateMutex.unlock();
         if (reader == nullptr) {
+            auto start = std::chrono::steady_clock::now();
             mPriv->consumeSema.wait();
+            mPriv->waitTime.record(std::chrono::steady_clock::now() - start);
         }
     }
 
@@ -582,6 +1065,7 @@ bool PortReaderBufferBase::acceptObjectBase(PortReader* obj,
     //mPriv->configure(reader, false, true);
     mPriv->pool.addActivePacket(reader);
     mPriv->ct++;
+    mPriv->countContent();
     mPriv->stateMutex.unlock();
     if (!pruned) {
         mPriv->contentSema.post();
@@ -602,6 +1086,12 @@ bool PortReaderBufferBase::forgetObjectBase(PortReader* obj,
 }
 
 
+void PortReaderBufferBase::getStatistics(Property& stats) const
+{
+    mPriv->getStatistics(stats);
+}
+
+
 void* PortReaderBufferBase::acquire()
 {
     return mPriv->acquire();
@@ -609,6 +1099,10 @@ void* PortReaderBufferBase::acquire()
 
 void PortReaderBufferBase::release(void* key)
 {
+    if (mPriv->lockFree) {
+        mPriv->release(key);
+        return;
+    }
     mPriv->stateMutex.lock();
     mPriv->release(key);
     mPriv->stateMutex.unlock();
@@ -20,6 +20,7 @@ namespace os {
 class Port;
 class PortReaderBufferBaseCreator;
 class PortWriter;
+class Property;
 
 class YARP_os_API PortReaderBufferBase :
         public yarp::os::PortReader
@@ -36,6 +37,17 @@ public:
 
     void setTargetPeriod(double period);
 
+    void setLockFree(bool flag = true, unsigned int size = 0);
+
+    bool isLockFree() const;
+
+    /**
+     * @return true if read() never waits for the user, i.e. the messages
+     * are never handed over to a replier, and the buffer is unbounded
+     * (or drops the oldest message when the lock-free ring is full)
+     */
+    bool isNonBlocking() const;
+
     std::string getName() const;
 
     unsigned int getMaxBuffer();
@@ -54,6 +66,8 @@ public:
 
     void interrupt();
 
+    void resume();
+
     void attachBase(yarp::os::Port& port);
 
     // direct writer-buffer to reader-buffer pointer sharing methods
@@ -72,6 +86,15 @@ public:
     // user gives back an object
     void release(void* key);
 
+    /**
+     * Add the counters of the buffer to a property: the messages received
+     * and dropped to keep only the most recent ones (received, dropped),
+     * the messages waiting to be read (depth) and the most there have
+     * been (max_depth), and how long the connections waited for a free
+     * packet, when the buffer was full (wait).
+     */
+    void getStatistics(yarp::os::Property& stats) const;
+
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 private:
     class Private;
@@ -9,3 +9,16 @@
 #include <yarp/os/PortReaderBufferBaseCreator.h>
 
 yarp::os::PortReaderBufferBaseCreator::~PortReaderBufferBaseCreator() = default;
+
+bool yarp::os::PortReaderBufferBaseCreator::copyReference(yarp::os::PortReader& target, const yarp::os::PortWriter& source) const
+{
+    YARP_UNUSED(target);
+    YARP_UNUSED(source);
+    return false;
+}
+
+std::shared_ptr<yarp::os::PortReader> yarp::os::PortReaderBufferBaseCreator::shareReference(const std::shared_ptr<yarp::os::Portable>& source) const
+{
+    YARP_UNUSED(source);
+    return nullptr;
+}
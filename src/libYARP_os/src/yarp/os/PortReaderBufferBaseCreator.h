@@ -12,10 +12,14 @@
 
 #include <yarp/os/api.h>
 
+#include <memory>
+
 namespace yarp {
 namespace os {
 
 class PortReader;
+class PortWriter;
+class Portable;
 
 class YARP_os_API PortReaderBufferBaseCreator
 {
@@ -23,6 +27,29 @@ public:
     virtual ~PortReaderBufferBaseCreator();
 
     virtual yarp::os::PortReader* create() const = 0;
+
+    /**
+     * Copy an object received from a connection within the same process
+     * into an object previously returned by create(), without serializing
+     * it.
+     *
+     * @param target an object previously returned by create()
+     * @param source the object written by the sender
+     * @return true if the object was copied, false if the type of the
+     *         source is not supported, and the object must be serialized
+     */
+    virtual bool copyReference(yarp::os::PortReader& target, const yarp::os::PortWriter& source) const;
+
+    /**
+     * Share an object received from a connection within the same process,
+     * instead of copying it.
+     *
+     * @param source a reference counted handle to the object written by
+     *        the sender
+     * @return the object, if it can be used in place of an object returned
+     *         by create(), nullptr otherwise
+     */
+    virtual std::shared_ptr<yarp::os::PortReader> shareReference(const std::shared_ptr<yarp::os::Portable>& source) const;
 };
 
 } // namespace os
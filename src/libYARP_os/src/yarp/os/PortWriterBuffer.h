@@ -13,6 +13,8 @@
 #include <yarp/os/Portable.h>
 #include <yarp/os/PortWriterBufferBase.h>
 
+#include <memory>
+
 namespace yarp {
 namespace os {
 
@@ -25,35 +27,46 @@ class PortWriterBufferAdaptor : public PortWriterWrapper
 {
 public:
     PortWriterBufferManager& creator;
-    T writer;
+    std::shared_ptr<T> writer;
     void* tracker;
 
     PortWriterBufferAdaptor(PortWriterBufferManager& creator,
                             void* tracker) :
             creator(creator),
+            writer(std::make_shared<T>()),
             tracker(tracker)
     {
     }
 
     bool write(ConnectionWriter& connection) const override
     {
-        return writer.write(connection);
+        return writer->write(connection);
     }
 
     void onCompletion() const override
     {
-        writer.onCompletion();
+        writer->onCompletion();
         creator.onCompletion(tracker);
     }
 
     void onCommencement() const override
     {
-        writer.onCommencement();
+        writer->onCommencement();
     }
 
     PortWriter* getInternal() override
     {
-        return &writer;
+        // Readers on local connections may still hold the last object
+        // written (see getShared()), leave it to them and start a new one.
+        if (writer.use_count() > 1) {
+            writer = std::make_shared<T>();
+        }
+        return writer.get();
+    }
+
+    std::shared_ptr<Portable> getShared() const override
+    {
+        return std::dynamic_pointer_cast<Portable>(writer);
     }
 };
 
@@ -102,7 +115,7 @@ public:
     T& get()
     {
         PortWriterBufferAdaptor<T>* content = (PortWriterBufferAdaptor<T>*)getContent(); // guaranteed to be non-NULL
-        return content->writer;
+        return *content->writer;
     }
 
     /**
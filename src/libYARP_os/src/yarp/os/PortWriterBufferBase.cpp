@@ -57,6 +57,10 @@ public:
     void finishWrites()
     {
         yCDebug(PORTWRITERBUFFERBASE, "finishing writes");
+        // the objects waiting in a batch would never be written otherwise
+        if (port != nullptr && port->isOpen()) {
+            port->flush();
+        }
         bool done = false;
         while (!done) {
             stateSema.wait();
@@ -95,6 +99,12 @@ public:
             yarp::os::PortWriterWrapper* wrapper = owner.create(*this, packet);
             //packet->setContent(wrapper, true);
             packet->setContent(wrapper->getInternal(), false, wrapper, true);
+        } else {
+            // The object may have been replaced, if the last one is still
+            // held by a local reader (see PortWriterWrapper::getShared())
+            auto* wrapper = dynamic_cast<yarp::os::PortWriterWrapper*>(const_cast<PortWriter*>(packet->getCallback()));
+            yCAssert(PORTWRITERBUFFERBASE, wrapper != nullptr);
+            packet->content = wrapper->getInternal();
         }
         stateSema.post();
 
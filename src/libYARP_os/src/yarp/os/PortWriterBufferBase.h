@@ -12,10 +12,13 @@
 
 #include <yarp/os/PortWriter.h>
 
+#include <memory>
+
 namespace yarp {
 namespace os {
 
 class Port;
+class Portable;
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
@@ -31,6 +34,13 @@ class PortWriterWrapper : public PortWriter
 {
 public:
     virtual PortWriter* getInternal() = 0;
+
+    // A handle to the internal object, that readers in the same process
+    // can keep instead of copying it, or nullptr if it cannot be shared.
+    virtual std::shared_ptr<Portable> getShared() const
+    {
+        return nullptr;
+    }
 };
 
 #endif // DOXYGEN_SHOULD_SKIP_THIS
@@ -35,3 +35,14 @@ bool yarp::os::SizedWriter::write(ConnectionWriter& connection) const
 void yarp::os::SizedWriter::clear()
 {
 }
+
+std::shared_ptr<const std::vector<unsigned char>> yarp::os::SizedWriter::getEncoding(const std::string& key,
+                                                                                     const std::function<bool(std::vector<unsigned char>&)>& encode)
+{
+    YARP_UNUSED(key);
+    auto encoding = std::make_shared<std::vector<unsigned char>>();
+    if (!encode(*encoding)) {
+        return nullptr;
+    }
+    return encoding;
+}
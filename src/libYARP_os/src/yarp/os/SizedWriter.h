@@ -16,6 +16,11 @@
 
 #include <yarp/os/PortWriter.h>
 
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
 namespace yarp {
 namespace os {
 
@@ -66,6 +71,20 @@ public:
     virtual void stopWrite() const = 0;
 
     virtual void clear();
+
+    /**
+     * Get an encoding of the message computed by a carrier (e.g. a
+     * compressed image).  When the same message is sent on several
+     * connections, the encoding is computed only once and shared by all
+     * the connections asking for the same key.
+     *
+     * @param key identifies the encoding and all the parameters it
+     *            depends on
+     * @param encode computes the encoding, returns false on failure
+     * @return the encoding, or nullptr if it could not be computed
+     */
+    virtual std::shared_ptr<const std::vector<unsigned char>> getEncoding(const std::string& key,
+                                                                          const std::function<bool(std::vector<unsigned char>&)>& encode);
 };
 
 } // namespace os
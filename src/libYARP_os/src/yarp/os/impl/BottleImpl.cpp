@@ -37,6 +37,7 @@ BottleImpl::BottleImpl() :
         parent(nullptr),
         invalid(false),
         ro(false),
+        spareNext(0),
         speciality(0),
         nested(false),
         dirty(true)
@@ -47,6 +48,7 @@ BottleImpl::BottleImpl(Searchable* parent) :
         parent(parent),
         invalid(false),
         ro(false),
+        spareNext(0),
         speciality(0),
         nested(false),
         dirty(true)
@@ -56,7 +58,12 @@ BottleImpl::BottleImpl(Searchable* parent) :
 
 BottleImpl::~BottleImpl()
 {
-    clear();
+    for (auto& i : content) {
+        delete i;
+    }
+    for (auto& i : spare) {
+        delete i;
+    }
 }
 
 
@@ -69,13 +76,41 @@ void BottleImpl::add(Storable* s)
 
 void BottleImpl::clear()
 {
-    for (auto& i : content) {
-        delete i;
+    if (!content.empty()) {
+        // The spare items that were not reused since the last clear() are
+        // released, the current ones are kept for the next items added.
+        for (size_type i = spareNext; i < spare.size(); ++i) {
+            delete spare[i];
+        }
+        spare.swap(content);
+        content.clear();
+        spareNext = 0;
     }
-    content.clear();
     dirty = true;
 }
 
+Storable* BottleImpl::reuse(std::int32_t code)
+{
+    if (spareNext >= spare.size()) {
+        return nullptr;
+    }
+    Storable* s = spare[spareNext];
+    if ((code & GROUP_MASK) != 0) {
+        // getCode() would change the specialization of a list, check the
+        // type only
+        if ((code & BOTTLE_TAG_DICT) != 0 || !s->isList()) {
+            return nullptr;
+        }
+        BottleImpl* impl = s->asList()->implementation;
+        impl->specialize(code & UNIT_MASK);
+        impl->setNested(false);
+    } else if (s->isList() || s->getCode() != code) {
+        return nullptr;
+    }
+    spare[spareNext++] = nullptr;
+    return s;
+}
+
 void BottleImpl::smartAdd(const std::string& str)
 {
     if (str.length() > 0) {
@@ -344,7 +379,14 @@ bool BottleImpl::fromBytes(ConnectionReader& reader)
     } else {
         yCTrace(BOTTLEIMPL, "READ skipped subcode %" PRId32, speciality);
     }
-    Storable* storable = Storable::createByCode(id);
+    Storable* storable = reuse(id);
+    if (storable != nullptr) {
+        if (storable->isList()) {
+            storable->asList()->implementation->setNested(true);
+        }
+    } else {
+        storable = Storable::createByCode(id);
+    }
     if (storable == nullptr) {
         yCError(BOTTLEIMPL, "Reader failed, unrecognized object code %" PRId32, id);
         return false;
@@ -646,6 +688,12 @@ Storable& BottleImpl::get(size_type index) const
 
 yarp::os::Bottle& BottleImpl::addList()
 {
+    Storable* s = reuse(StoreList::code);
+    if (s != nullptr) {
+        s->asList()->clear();
+        add(s);
+        return *(s->asList());
+    }
     auto* lst = new StoreList();
     add(lst);
     return lst->internal();
@@ -678,7 +726,14 @@ void BottleImpl::copyRange(const BottleImpl* alt, size_type first, size_type len
 
     const size_t last = src->size() - 1;
     for (size_t i = 0; (i < len) && (first + i <= last); ++i) {
-        add(src->get(first + i).cloneStorable());
+        const Storable& item = src->get(first + i);
+        Storable* s = reuse(item.isList() ? StoreList::code : item.getCode());
+        if (s != nullptr) {
+            s->copy(item);
+            add(s);
+        } else {
+            add(item.cloneStorable());
+        }
     }
 }
 
@@ -59,42 +59,49 @@ public:
 
     void addInt8(std::int8_t x)
     {
-        add(new StoreInt8(x));
+        addStorable<StoreInt8>(x);
     }
 
     void addInt16(std::int16_t x)
     {
-        add(new StoreInt16(x));
+        addStorable<StoreInt16>(x);
     }
 
     void addInt32(std::int32_t x)
     {
-        add(new StoreInt32(x));
+        addStorable<StoreInt32>(x);
     }
 
     void addInt64(std::int64_t x)
     {
-        add(new StoreInt64(x));
+        addStorable<StoreInt64>(x);
     }
 
     void addFloat32(yarp::conf::float32_t x)
     {
-        add(new StoreFloat32(x));
+        addStorable<StoreFloat32>(x);
     }
 
     void addFloat64(yarp::conf::float64_t x)
     {
-        add(new StoreFloat64(x));
+        addStorable<StoreFloat64>(x);
     }
 
     void addVocab(std::int32_t x)
     {
-        add(new StoreVocab(x));
+        addStorable<StoreVocab>(x);
     }
 
     void addString(const std::string& text)
     {
-        add(new StoreString(text));
+        Storable* s = reuse(StoreString::code);
+        if (s != nullptr) {
+            // keeps the capacity of the string
+            s->fromString(text);
+            add(s);
+        } else {
+            add(new StoreString(text));
+        }
     }
 
     yarp::os::Bottle& addList();
@@ -182,13 +189,35 @@ public:
 private:
     YARP_SUPPRESS_DLL_INTERFACE_WARNING_ARG(std::vector<Storable*>) content;
     YARP_SUPPRESS_DLL_INTERFACE_WARNING_ARG(std::vector<char>) data;
+    /*
+     * The items removed by the last clear().  They are handed out again,
+     * in the same order, to the items added afterwards, as long as their
+     * types match, so that refilling a Bottle with data of the same shape
+     * (e.g. reading the same kind of message over and over) does not
+     * allocate any memory.
+     */
+    YARP_SUPPRESS_DLL_INTERFACE_WARNING_ARG(std::vector<Storable*>) spare;
+    size_type spareNext;
     int speciality;
     bool nested;
     bool dirty;
 
     void add(Storable* s);
+    Storable* reuse(std::int32_t code);
     void smartAdd(const std::string& str);
 
+    template <typename T, typename V>
+    void addStorable(V x)
+    {
+        Storable* s = reuse(T::code);
+        if (s != nullptr) {
+            s->copy(T(x));
+            add(s);
+        } else {
+            add(new T(x));
+        }
+    }
+
     /*
      * Bottle is using a lazy synchronization method. Whenever some operation
      * is performed, a dirty flag is set, and when it is used, the synch()
@@ -9,6 +9,8 @@
 
 #include <yarp/os/impl/BufferedConnectionWriter.h>
 
+#include <yarp/os/impl/PortCorePacket.h>
+
 #include <yarp/os/Bottle.h>
 #include <yarp/os/DummyConnector.h>
 #include <yarp/os/ManagedBytes.h>
@@ -42,7 +44,8 @@ BufferedConnectionWriter::BufferedConnectionWriter(bool textMode,
         lst_used(0),
         header_used(0),
         target_used(&lst_used),
-        initialPoolSize(BUFFERED_CONNECTION_INITIAL_POOL_SIZE)
+        initialPoolSize(BUFFERED_CONNECTION_INITIAL_POOL_SIZE),
+        encodingCache(nullptr)
 {
     stopPool();
 }
@@ -61,6 +64,7 @@ void BufferedConnectionWriter::reset(bool textMode)
     reader = nullptr;
     ref = nullptr;
     convertTextModePending = false;
+    encodingCache = nullptr;
 }
 
 void BufferedConnectionWriter::restart()
@@ -70,6 +74,7 @@ void BufferedConnectionWriter::restart()
     reader = nullptr;
     ref = nullptr;
     convertTextModePending = false;
+    encodingCache = nullptr;
     target = &lst;
     target_used = &lst_used;
     stopPool();
@@ -359,13 +364,17 @@ bool BufferedConnectionWriter::write(ConnectionWriter& connection) const
 void BufferedConnectionWriter::write(OutputStream& os)
 {
     stopWrite();
+    blocks.clear();
     for (size_t i = 0; i < header_used; i++) {
         yarp::os::ManagedBytes& b = *(header[i]);
-        os.write(b.usedBytes());
+        blocks.push_back(b.usedBytes());
     }
     for (size_t i = 0; i < lst_used; i++) {
         yarp::os::ManagedBytes& b = *(lst[i]);
-        os.write(b.usedBytes());
+        blocks.push_back(b.usedBytes());
+    }
+    if (!blocks.empty()) {
+        os.writev(blocks.data(), blocks.size());
     }
     os.flush();
 }
@@ -425,6 +434,20 @@ void BufferedConnectionWriter::setReference(yarp::os::Portable* obj)
     ref = obj;
 }
 
+std::shared_ptr<const std::vector<unsigned char>> BufferedConnectionWriter::getEncoding(const std::string& key,
+                                                                                        const std::function<bool(std::vector<unsigned char>&)>& encode)
+{
+    if (encodingCache == nullptr) {
+        return SizedWriter::getEncoding(key, encode);
+    }
+    return encodingCache->getEncoding(key, encode);
+}
+
+void BufferedConnectionWriter::setEncodingCache(PortCorePacket* packet)
+{
+    encodingCache = packet;
+}
+
 bool BufferedConnectionWriter::isValid() const
 {
     return true;
@@ -10,6 +10,7 @@
 #ifndef YARP_OS_IMPL_BUFFEREDCONNECTIONWRITER_H
 #define YARP_OS_IMPL_BUFFEREDCONNECTIONWRITER_H
 
+#include <yarp/os/Bytes.h>
 #include <yarp/os/ConnectionWriter.h>
 #include <yarp/os/SizedWriter.h>
 
@@ -25,6 +26,8 @@ class ManagedBytes;
 
 namespace impl {
 
+class PortCorePacket;
+
 /*
  * When allocating space to store serialized data, we start off with
  * a block of this size.  It will be resized as necessary.
@@ -213,6 +216,16 @@ public:
     bool dropRequested() override;
     void startWrite() const override;
     void stopWrite() const override;
+    std::shared_ptr<const std::vector<unsigned char>> getEncoding(const std::string& key,
+                                                                  const std::function<bool(std::vector<unsigned char>&)>& encode) override;
+
+    /**
+     * Share the encodings computed by the carriers with the other
+     * connections sending the same message.
+     *
+     * @param packet the message being sent, or nullptr to stop sharing
+     */
+    void setEncodingCache(PortCorePacket* packet);
 
     // defined by yarp::os::ConnectionWriter
     SizedWriter* getBuffer() const override;
@@ -253,6 +266,7 @@ private:
     YARP_SUPPRESS_DLL_INTERFACE_WARNING_ARG(std::vector<yarp::os::ManagedBytes*>) lst;     ///< buffers in payload
     YARP_SUPPRESS_DLL_INTERFACE_WARNING_ARG(std::vector<yarp::os::ManagedBytes*>) header;  ///< buffers in header
     YARP_SUPPRESS_DLL_INTERFACE_WARNING_ARG(std::vector<yarp::os::ManagedBytes*>*) target; ///< points to header or payload
+    YARP_SUPPRESS_DLL_INTERFACE_WARNING_ARG(std::vector<yarp::os::Bytes>) blocks;          ///< scratch list of blocks for vectored writes
     yarp::os::ManagedBytes* pool; ///< the pool buffer (in lst or header)
     size_t poolIndex;             ///< current offset into pool buffer
     size_t poolCount;             ///< number of pool buffers allocated
@@ -267,6 +281,7 @@ private:
     size_t header_used;           ///< how many header buffers are in use for the current message
     size_t* target_used;          ///< points to lst_used of header_used
     size_t initialPoolSize;       ///< size of new pool buffers
+    PortCorePacket* encodingCache; ///< where encodings are shared, if any
 };
 
 
@@ -16,6 +16,8 @@
 
 #include <yarp/os/impl/LogComponent.h>
 
+#include <utility>
+
 using namespace yarp::os;
 
 namespace {
@@ -144,12 +146,34 @@ bool yarp::os::impl::LocalCarrierStream::isOk() const
 }
 
 
+yarp::os::impl::LocalCarrierReference::LocalCarrierReference(std::shared_ptr<yarp::os::Portable> object) :
+        object(std::move(object))
+{
+}
+
+bool yarp::os::impl::LocalCarrierReference::read(yarp::os::ConnectionReader& connection)
+{
+    return object->read(connection);
+}
+
+bool yarp::os::impl::LocalCarrierReference::write(yarp::os::ConnectionWriter& connection) const
+{
+    return object->write(connection);
+}
+
+const std::shared_ptr<yarp::os::Portable>& yarp::os::impl::LocalCarrierReference::get() const
+{
+    return object;
+}
+
+
 yarp::os::impl::LocalCarrier::LocalCarrier() :
         peerMutex(), sent(0), received(0)
 {
     ref = nullptr;
     peer = nullptr;
     doomed = false;
+    receiptPending = false;
 }
 
 yarp::os::impl::LocalCarrier::~LocalCarrier()
@@ -175,6 +199,11 @@ void yarp::os::impl::LocalCarrier::shutdown()
 {
     if (!doomed) {
         doomed = true;
+        // Do not leave a sender waiting for a message that will never be
+        // acknowledged, see sendAck().
+        if (receiptPending.exchange(false)) {
+            received.post();
+        }
         peerMutex.lock();
         if (peer != nullptr) {
             peer->accept(nullptr);
@@ -193,7 +222,9 @@ std::string yarp::os::impl::LocalCarrier::getName() const
 
 bool yarp::os::impl::LocalCarrier::requireAck() const
 {
-    return false;
+    // Used to tell the sender when the receiver is done with its object,
+    // see sendAck().
+    return true;
 }
 
 bool yarp::os::impl::LocalCarrier::isConnectionless() const
@@ -333,11 +364,14 @@ bool yarp::os::impl::LocalCarrier::expectIndex(ConnectionState& proto)
     sent.wait();
     yCDebug(LOCALCARRIER, "local recv: got send");
     proto.setReference(ref);
-    received.post();
     if (ref != nullptr) {
         yCDebug(LOCALCARRIER, "local recv: received");
+        // The sender keeps waiting until the reader has taken the object,
+        // see sendAck().
+        receiptPending = true;
     } else {
         yCDebug(LOCALCARRIER, "local recv: shutdown");
+        received.post();
         proto.is().interrupt();
         return false;
     }
@@ -345,6 +379,23 @@ bool yarp::os::impl::LocalCarrier::expectIndex(ConnectionState& proto)
     return true;
 }
 
+bool yarp::os::impl::LocalCarrier::sendAck(ConnectionState& proto)
+{
+    YARP_UNUSED(proto);
+    if (receiptPending.exchange(false)) {
+        yCDebug(LOCALCARRIER, "local recv: done with reference");
+        received.post();
+    }
+    return true;
+}
+
+bool yarp::os::impl::LocalCarrier::expectAck(ConnectionState& proto)
+{
+    YARP_UNUSED(proto);
+    // accept() already waited for the receiver
+    return true;
+}
+
 void yarp::os::impl::LocalCarrier::accept(yarp::os::Portable* ref)
 {
     this->ref = ref;
@@ -17,6 +17,8 @@
 #include <yarp/os/Semaphore.h>
 #include <yarp/os/TwoWayStream.h>
 
+#include <atomic>
+#include <memory>
 #include <mutex>
 
 namespace yarp {
@@ -83,6 +85,27 @@ private:
     bool done;
 };
 
+/**
+ * An object handed over by the local carrier together with a reference
+ * counted handle to it, so that the reader can keep it after the hand-off
+ * instead of copying it (see PortWriterWrapper::getShared()).  The handle
+ * is given only when the message is sent on a single connection.
+ * Serializing this serializes the object.
+ */
+class LocalCarrierReference : public yarp::os::Portable
+{
+public:
+    explicit LocalCarrierReference(std::shared_ptr<yarp::os::Portable> object = nullptr);
+
+    bool read(yarp::os::ConnectionReader& connection) override;
+    bool write(yarp::os::ConnectionWriter& connection) const override;
+
+    const std::shared_ptr<yarp::os::Portable>& get() const;
+
+private:
+    std::shared_ptr<yarp::os::Portable> object;
+};
+
 /**
  * A carrier for communicating locally within a process.
  */
@@ -113,6 +136,8 @@ public:
     bool respondToHeader(ConnectionState& proto) override;
     bool expectReplyToHeader(ConnectionState& proto) override;
     bool expectIndex(ConnectionState& proto) override;
+    bool sendAck(ConnectionState& proto) override;
+    bool expectAck(ConnectionState& proto) override;
 
     void removePeer();
     void shutdown();
@@ -120,6 +145,7 @@ public:
 
 protected:
     bool doomed;
+    std::atomic<bool> receiptPending;
     yarp::os::Portable* ref;
     LocalCarrier* peer;
     std::mutex peerMutex;
@@ -14,21 +14,148 @@
 #include <yarp/os/Os.h>
 #include <yarp/os/SystemInfo.h>
 #include <yarp/os/Time.h>
+#include <yarp/os/impl/LogRecord.h>
 #include <yarp/os/impl/PlatformLimits.h>
 
-#include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
 
 bool yarp::os::impl::LogForwarder::started{false};
 
+namespace {
+
+constexpr size_t defaultRingSize = 64 * 1024;
+constexpr size_t maxBatchSize = 64;
+constexpr std::chrono::milliseconds drainPeriod(50);
+
+size_t ringSizeFromEnvironment()
+{
+    std::string value = yarp::os::NetworkBase::getEnvironment("YARP_FORWARD_LOG_BUFFER_SIZE");
+    if (value.empty()) {
+        return defaultRingSize;
+    }
+    char* end = nullptr;
+    unsigned long long size = std::strtoull(value.c_str(), &end, 10);
+    if (end == value.c_str() || size == 0) {
+        return defaultRingSize;
+    }
+    return static_cast<size_t>(size);
+}
+
+bool binaryFromEnvironment()
+{
+    std::string value = yarp::os::NetworkBase::getEnvironment("YARP_FORWARD_LOG_BINARY");
+    return value == "1" || value == "true" || value == "True" || value == "TRUE" || value == "on" || value == "On" || value == "ON";
+}
+
+} // namespace
+
+
+/*
+ * A ring of records written by a single thread and read by the drainer.
+ *
+ * Each record is stored as its 32 bit length followed by its bytes, and can
+ * wrap around the end of the buffer.  The positions only grow, and the
+ * capacity is a power of 2, so that the used space is (head - tail).
+ */
+class yarp::os::impl::LogForwarder::Ring
+{
+public:
+    explicit Ring(size_t size) :
+            buffer(roundUp(size)),
+            mask(buffer.size() - 1)
+    {
+    }
+
+    // Called by the owner thread only
+    bool push(const std::string& record)
+    {
+        auto len = static_cast<std::uint32_t>(record.size());
+        size_t needed = sizeof(len) + len;
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t t = tail.load(std::memory_order_acquire);
+        if (needed > buffer.size() - (h - t)) {
+            return false;
+        }
+        copyIn(h, reinterpret_cast<const char*>(&len), sizeof(len));
+        copyIn(h + sizeof(len), record.data(), len);
+        head.store(h + needed, std::memory_order_release);
+        return true;
+    }
+
+    // Called by the drainer only
+    bool pop(std::string& record)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t h = head.load(std::memory_order_acquire);
+        if (t == h) {
+            return false;
+        }
+        std::uint32_t len;
+        copyOut(t, reinterpret_cast<char*>(&len), sizeof(len));
+        record.resize(len);
+        copyOut(t + sizeof(len), &record[0], len);
+        tail.store(t + sizeof(len) + len, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const
+    {
+        return tail.load(std::memory_order_acquire) == head.load(std::memory_order_acquire);
+    }
+
+private:
+    static size_t roundUp(size_t size)
+    {
+        size_t capacity = 1024;
+        while (capacity < size) {
+            capacity <<= 1;
+        }
+        return capacity;
+    }
+
+    void copyIn(size_t pos, const char* data, size_t len)
+    {
+        size_t offset = pos & mask;
+        size_t first = std::min(len, buffer.size() - offset);
+        std::memcpy(&buffer[offset], data, first);
+        std::memcpy(&buffer[0], data + first, len - first);
+    }
+
+    void copyOut(size_t pos, char* data, size_t len) const
+    {
+        size_t offset = pos & mask;
+        size_t first = std::min(len, buffer.size() - offset);
+        std::memcpy(data, &buffer[offset], first);
+        std::memcpy(data + first, &buffer[0], len - first);
+    }
+
+    std::vector<char> buffer;
+    const size_t mask;
+    alignas(64) std::atomic<size_t> head {0};
+    alignas(64) std::atomic<size_t> tail {0};
+};
+
+
 yarp::os::impl::LogForwarder& yarp::os::impl::LogForwarder::getInstance()
 {
     static LogForwarder instance;
     return instance;
 }
 
-yarp::os::impl::LogForwarder::~LogForwarder() = default;
+yarp::os::impl::LogForwarder::~LogForwarder()
+{
+    stop();
+}
 
-yarp::os::impl::LogForwarder::LogForwarder()
+yarp::os::impl::LogForwarder::LogForwarder() :
+        binary(binaryFromEnvironment()),
+        ringSize(ringSizeFromEnvironment()),
+        dropped(0),
+        pending(false),
+        closing(false)
 {
     char hostname[HOST_NAME_MAX];
     yarp::os::gethostname(hostname, HOST_NAME_MAX);
@@ -40,40 +167,175 @@ yarp::os::impl::LogForwarder::LogForwarder()
     if (!outputPort.open(logPortName)) {
         printf("LogForwarder error while opening port %s\n", logPortName.c_str());
     }
-    outputPort.enableBackgroundWrite(true);
     outputPort.addOutput("/yarplogger", "fast_tcp");
+    header = "[" + outputPort.getName() + "]";
+
+    drainer = std::thread(&LogForwarder::run, this);
 
     started = true;
 }
 
-void yarp::os::impl::LogForwarder::forward(const std::string& message)
+bool yarp::os::impl::LogForwarder::post(const std::string& record)
+{
+    thread_local std::shared_ptr<Ring> ring;
+    if (!ring) {
+        ring = std::make_shared<Ring>(ringSize);
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        rings.push_back(ring);
+    }
+    if (!ring->push(record)) {
+        dropped++;
+        return false;
+    }
+    // A wake up lost here is recovered by the periodic drain
+    if (!pending.exchange(true)) {
+        wake.notify_one();
+    }
+    return true;
+}
+
+void yarp::os::impl::LogForwarder::forward(const std::string& record)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    drain();
+    send(record);
+    sendBatch();
+}
+
+void yarp::os::impl::LogForwarder::flush()
 {
-    mutex.lock();
-    static Bottle b;
-    b.clear();
-    std::string port = "[" + outputPort.getName() + "]";
-    b.addString(port);
-    b.addString(message);
-    outputPort.write(b);
-    mutex.unlock();
+    std::lock_guard<std::mutex> lock(mutex);
+    drain();
+}
+
+void yarp::os::impl::LogForwarder::run()
+{
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wake.wait_for(lock, drainPeriod, [this]() { return closing || pending.load(); });
+            if (closing) {
+                break;
+            }
+        }
+        pending = false;
+        flush();
+    }
+}
+
+void yarp::os::impl::LogForwarder::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        closing = true;
+    }
+    wake.notify_one();
+    if (drainer.joinable()) {
+        drainer.join();
+    }
+}
+
+void yarp::os::impl::LogForwarder::drain()
+{
+    std::vector<std::shared_ptr<Ring>> current;
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        // The rings of the threads that exited are dropped once empty
+        rings.erase(std::remove_if(rings.begin(),
+                                   rings.end(),
+                                   [](const std::shared_ptr<Ring>& r) { return r.use_count() == 1 && r->empty(); }),
+                    rings.end());
+        current = rings;
+    }
+
+    for (auto& ring : current) {
+        while (ring->pop(buffer)) {
+            send(buffer);
+        }
+    }
+
+    size_t lost = dropped.exchange(0);
+    if (lost > 0) {
+        auto systemtime = yarp::os::SystemClock::nowSystem();
+        std::string message = std::to_string(lost) + " log messages were dropped";
+        buffer.clear();
+        LogRecord::encode(buffer,
+                          yarp::os::Log::WarningType,
+                          systemtime,
+                          systemtime,
+                          nullptr,
+                          0,
+                          nullptr,
+                          nullptr,
+                          0,
+                          nullptr,
+                          nullptr,
+                          0,
+                          "yarp.os.impl.LogForwarder",
+                          message.c_str(),
+                          nullptr);
+        send(buffer);
+    }
+
+    sendBatch();
+}
+
+void yarp::os::impl::LogForwarder::send(const std::string& record)
+{
+    if (batch.size() == 0) {
+        batch.addString(header);
+    }
+
+    if (binary) {
+        batch.add(yarp::os::Value::makeBlob(const_cast<char*>(record.data()), static_cast<int>(record.size())));
+        if (batch.size() > maxBatchSize) {
+            sendBatch();
+        }
+        return;
+    }
+
+    // The textual format is one message for each record
+    LogRecord decoded;
+    if (decoded.decode(record.data(), record.size())) {
+        batch.addString(decoded.toString());
+        sendBatch();
+    }
+}
+
+void yarp::os::impl::LogForwarder::sendBatch()
+{
+    if (batch.size() > 1) {
+        outputPort.write(batch);
+    }
+    batch.clear();
 }
 
 void yarp::os::impl::LogForwarder::shutdown()
 {
     if (started) {
-        std::ostringstream ost;
         auto systemtime = yarp::os::SystemClock::nowSystem();
         auto networktime = (!yarp::os::NetworkBase::isNetworkInitialized() ? 0.0 : (yarp::os::Time::isSystemClock() ? systemtime : yarp::os::Time::now()));
 
-        ost << "(level INFO)";
-        ost << " (systemtime " << yarp::os::NetType::toString(systemtime)  << ")";
-        ost << " (networktime " << yarp::os::NetType::toString(networktime)  << ")";
+        std::string record;
+        LogRecord::encode(record,
+                          yarp::os::Log::InfoType,
+                          systemtime,
+                          networktime,
+                          nullptr,
+                          0,
+                          nullptr,
+                          nullptr,
+                          0,
+                          nullptr,
+                          nullptr,
+                          0,
+                          nullptr,
+                          "",
+                          nullptr);
 
         yarp::os::impl::LogForwarder& fw = getInstance();
-        fw.forward(ost.str());
-        while (fw.outputPort.isWriting()) {
-            yarp::os::SystemClock::delaySystem(0.2);
-        }
+        fw.stop();
+        fw.forward(record);
         fw.outputPort.interrupt();
         fw.outputPort.close();
     }
@@ -11,31 +11,94 @@
 
 #include <yarp/os/api.h>
 
+#include <yarp/os/Bottle.h>
 #include <yarp/os/Port.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace yarp {
 namespace os {
 namespace impl {
 
+/**
+ * Forward the log messages to the logger (yarplogger).
+ *
+ * The messages are encoded as LogRecord by the threads that log them, and
+ * queued in a lock-free ring owned by each thread, so that logging does not
+ * wait for the network nor for the other threads.  A background thread
+ * drains the rings and writes the records to the port.  When the ring of a
+ * thread is full the messages are dropped, and the number of dropped messages
+ * is reported to the logger.
+ *
+ * The records are sent in the textual format understood by every yarplogger,
+ * unless YARP_FORWARD_LOG_BINARY is enabled: in this case they are sent as
+ * they are, several in the same message.
+ */
 class YARP_os_impl_API LogForwarder
 {
 public:
     ~LogForwarder();
     static LogForwarder& getInstance();
 
-    void forward(const std::string& message);
+    /**
+     * Queue a record (encoded as LogRecord) without blocking.
+     *
+     * @return false if the record was dropped
+     */
+    bool post(const std::string& record);
+
+    /**
+     * Send a record (encoded as LogRecord) right away, after the ones that
+     * are queued.
+     */
+    void forward(const std::string& record);
+
+    /**
+     * Send the records that are queued.
+     */
+    void flush();
+
     static void shutdown();
 
 private:
+    class Ring;
+
     LogForwarder();
     LogForwarder(LogForwarder const&) = delete;
     LogForwarder& operator=(LogForwarder const&) = delete;
 
+    void run();
+    void stop();
+
+    // These are called with the mutex locked
+    void drain();
+    void send(const std::string& record);
+    void sendBatch();
+
     std::mutex mutex;
     yarp::os::Port outputPort;
+    yarp::os::Bottle batch;
+    std::string header;
+    std::string buffer;
+    bool binary;
+    size_t ringSize;
+
+    std::mutex ringsMutex;
+    YARP_SUPPRESS_DLL_INTERFACE_WARNING_ARG(std::vector<std::shared_ptr<Ring>>) rings;
+    std::atomic<size_t> dropped;
+
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    std::atomic<bool> pending;
+    bool closing;
+    YARP_SUPPRESS_DLL_INTERFACE_WARNING_ARG(std::thread) drainer;
+
     static bool started;
 };
 
@@ -0,0 +1,293 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <yarp/os/impl/LogRecord.h>
+
+#include <yarp/os/NetType.h>
+#include <yarp/os/impl/Storable.h>
+
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+using yarp::os::impl::LogRecord;
+
+namespace {
+
+void putInt(std::string& buffer, std::uint64_t x, size_t bytes)
+{
+    for (size_t i = 0; i < bytes; i++) {
+        buffer.push_back(static_cast<char>((x >> (8 * i)) & 0xff));
+    }
+}
+
+void putFloat64(std::string& buffer, double x)
+{
+    std::uint64_t bits;
+    static_assert(sizeof(bits) == sizeof(x), "double is not 64 bits");
+    std::memcpy(&bits, &x, sizeof(bits));
+    putInt(buffer, bits, sizeof(bits));
+}
+
+void putString(std::string& buffer, const char* str)
+{
+    size_t len = (str != nullptr) ? strlen(str) : 0;
+    putInt(buffer, len, 4);
+    buffer.append(str != nullptr ? str : "", len);
+}
+
+class Reader
+{
+public:
+    Reader(const char* data, size_t size) :
+            data(data),
+            size(size)
+    {
+    }
+
+    bool getInt(std::uint64_t& x, size_t bytes)
+    {
+        if (size - offset < bytes) {
+            return false;
+        }
+        x = 0;
+        for (size_t i = 0; i < bytes; i++) {
+            x |= static_cast<std::uint64_t>(static_cast<unsigned char>(data[offset + i])) << (8 * i);
+        }
+        offset += bytes;
+        return true;
+    }
+
+    bool getFloat64(double& x)
+    {
+        std::uint64_t bits;
+        if (!getInt(bits, sizeof(bits))) {
+            return false;
+        }
+        std::memcpy(&x, &bits, sizeof(x));
+        return true;
+    }
+
+    bool getString(std::string& str)
+    {
+        std::uint64_t len;
+        if (!getInt(len, 4) || size - offset < len) {
+            return false;
+        }
+        str.assign(data + offset, static_cast<size_t>(len));
+        offset += static_cast<size_t>(len);
+        return true;
+    }
+
+private:
+    const char* data;
+    size_t size;
+    size_t offset {0};
+};
+
+const char* levelToString(yarp::os::Log::LogType t)
+{
+    switch (t) {
+    case yarp::os::Log::TraceType:
+        return "TRACE";
+    case yarp::os::Log::DebugType:
+        return "DEBUG";
+    case yarp::os::Log::InfoType:
+        return "INFO";
+    case yarp::os::Log::WarningType:
+        return "WARNING";
+    case yarp::os::Log::ErrorType:
+        return "ERROR";
+    case yarp::os::Log::FatalType:
+        return "FATAL";
+    default:
+        return "";
+    }
+}
+
+} // namespace
+
+void LogRecord::encode(std::string& buffer,
+                       yarp::os::Log::LogType type,
+                       double systemtime,
+                       double networktime,
+                       const char* filename,
+                       unsigned int line,
+                       const char* function,
+                       const char* hostname,
+                       int pid,
+                       const char* cmd,
+                       const char* args,
+                       long thread_id,
+                       const char* component,
+                       const char* message,
+                       const char* backtrace)
+{
+    std::uint16_t flags = 0;
+    if (filename != nullptr) {
+        flags |= CodeInfo;
+    }
+    if (hostname != nullptr) {
+        flags |= HostName;
+    }
+    if (cmd != nullptr) {
+        flags |= ProcessInfo;
+    }
+    if (component != nullptr) {
+        flags |= Component;
+    }
+    if (backtrace != nullptr) {
+        flags |= Backtrace;
+    }
+
+    putInt(buffer, version, 1);
+    putInt(buffer, type, 1);
+    putInt(buffer, flags, 2);
+    putFloat64(buffer, systemtime);
+    putFloat64(buffer, networktime);
+    if ((flags & CodeInfo) != 0) {
+        putString(buffer, filename);
+        putInt(buffer, line, 4);
+        putString(buffer, function);
+    }
+    if ((flags & HostName) != 0) {
+        putString(buffer, hostname);
+    }
+    if ((flags & ProcessInfo) != 0) {
+        putInt(buffer, static_cast<std::uint32_t>(pid), 4);
+        putString(buffer, cmd);
+        putString(buffer, args);
+        putInt(buffer, static_cast<std::uint64_t>(thread_id), 8);
+    }
+    if ((flags & Component) != 0) {
+        putString(buffer, component);
+    }
+    putString(buffer, message);
+    if ((flags & Backtrace) != 0) {
+        putString(buffer, backtrace);
+    }
+}
+
+void LogRecord::encode(std::string& buffer) const
+{
+    encode(buffer,
+           type,
+           systemtime,
+           networktime,
+           ((flags & CodeInfo) != 0) ? filename.c_str() : nullptr,
+           line,
+           function.c_str(),
+           ((flags & HostName) != 0) ? hostname.c_str() : nullptr,
+           pid,
+           ((flags & ProcessInfo) != 0) ? cmd.c_str() : nullptr,
+           args.c_str(),
+           thread_id,
+           ((flags & Component) != 0) ? component.c_str() : nullptr,
+           message.c_str(),
+           ((flags & Backtrace) != 0) ? backtrace.c_str() : nullptr);
+}
+
+bool LogRecord::decode(const char* data, size_t size)
+{
+    Reader reader(data, size);
+    std::uint64_t x;
+
+    if (!reader.getInt(x, 1) || x != version) {
+        return false;
+    }
+    if (!reader.getInt(x, 1) || x == 0 || x > yarp::os::Log::FatalType) {
+        return false;
+    }
+    type = static_cast<yarp::os::Log::LogType>(x);
+    if (!reader.getInt(x, 2)) {
+        return false;
+    }
+    flags = static_cast<std::uint16_t>(x);
+    if (!reader.getFloat64(systemtime) || !reader.getFloat64(networktime)) {
+        return false;
+    }
+
+    filename.clear();
+    line = 0;
+    function.clear();
+    if ((flags & CodeInfo) != 0) {
+        if (!reader.getString(filename) || !reader.getInt(x, 4) || !reader.getString(function)) {
+            return false;
+        }
+        line = static_cast<unsigned int>(x);
+    }
+
+    hostname.clear();
+    if ((flags & HostName) != 0 && !reader.getString(hostname)) {
+        return false;
+    }
+
+    pid = 0;
+    cmd.clear();
+    args.clear();
+    thread_id = 0;
+    if ((flags & ProcessInfo) != 0) {
+        if (!reader.getInt(x, 4)) {
+            return false;
+        }
+        pid = static_cast<int>(static_cast<std::uint32_t>(x));
+        if (!reader.getString(cmd) || !reader.getString(args) || !reader.getInt(x, 8)) {
+            return false;
+        }
+        thread_id = static_cast<long>(x);
+    }
+
+    component.clear();
+    if ((flags & Component) != 0 && !reader.getString(component)) {
+        return false;
+    }
+
+    if (!reader.getString(message)) {
+        return false;
+    }
+
+    backtrace.clear();
+    if ((flags & Backtrace) != 0 && !reader.getString(backtrace)) {
+        return false;
+    }
+
+    return true;
+}
+
+std::string LogRecord::toString() const
+{
+    // Same keys, in the same order, as the ones forwarded by yarp::os::Log
+    std::ostringstream ost;
+    ost << "(level " << StoreString::quotedString(levelToString(type)) << ")";
+    ost << " (systemtime " << yarp::os::NetType::toString(systemtime) << ")";
+    ost << " (networktime " << yarp::os::NetType::toString(networktime) << ")";
+    if ((flags & CodeInfo) != 0) {
+        ost << " (filename " << StoreString::quotedString(filename) << ")";
+        ost << " (line " << line << ")";
+        ost << " (function " << StoreString::quotedString(function) << ")";
+    }
+    if ((flags & HostName) != 0) {
+        ost << " (hostname " << StoreString::quotedString(hostname) << ")";
+    }
+    if ((flags & ProcessInfo) != 0) {
+        ost << " (pid " << pid << ")";
+        ost << " (cmd " << StoreString::quotedString(cmd) << ")";
+        ost << " (args " << StoreString::quotedString(args) << ")";
+        ost << " (thread_id 0x" << std::setfill('0') << std::setw(8) << yarp::os::NetType::toHexString(thread_id) << ")";
+    }
+    if ((flags & Component) != 0) {
+        ost << " (component " << StoreString::quotedString(component) << ")";
+    }
+    if (!message.empty()) {
+        ost << " (message " << StoreString::quotedString(message) << ")";
+    }
+    if ((flags & Backtrace) != 0) {
+        ost << " (backtrace " << StoreString::quotedString(backtrace) << ")";
+    }
+    return ost.str();
+}
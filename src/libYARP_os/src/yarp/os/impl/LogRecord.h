@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#ifndef YARP_OS_IMPL_LOGRECORD_H
+#define YARP_OS_IMPL_LOGRECORD_H
+
+#include <yarp/os/api.h>
+
+#include <yarp/os/Log.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace yarp {
+namespace os {
+namespace impl {
+
+/**
+ * A log message in the binary encoding used to forward it to the logger.
+ *
+ * The record starts with the version of the encoding, the level and a set of
+ * flags telling which of the optional fields follow.  Numbers are little
+ * endian, strings are prefixed by their 32 bit length:
+ *
+ *     u8 version, u8 level, u16 flags, f64 systemtime, f64 networktime,
+ *     [str filename, u32 line, str function]      (CodeInfo)
+ *     [str hostname]                              (HostName)
+ *     [i32 pid, str cmd, str args, i64 thread_id] (ProcessInfo)
+ *     [str component]                             (Component)
+ *     str message,
+ *     [str backtrace]                             (Backtrace)
+ */
+class YARP_os_impl_API LogRecord
+{
+public:
+    static constexpr std::uint8_t version = 1;
+
+    enum Flags : std::uint16_t
+    {
+        CodeInfo = 0x01,
+        HostName = 0x02,
+        ProcessInfo = 0x04,
+        Component = 0x08,
+        Backtrace = 0x10
+    };
+
+    yarp::os::Log::LogType type {yarp::os::Log::LogTypeUnknown};
+    std::uint16_t flags {0};
+    double systemtime {0.0};
+    double networktime {0.0};
+    std::string filename;
+    unsigned int line {0};
+    std::string function;
+    std::string hostname;
+    int pid {0};
+    std::string cmd;
+    std::string args;
+    long thread_id {0};
+    std::string component;
+    std::string message;
+    std::string backtrace;
+
+    /**
+     * Append the encoding of a record to a buffer.
+     *
+     * The null pointers are the fields that are not sent.  The buffer is
+     * not cleared, so that it can be reused without allocating.
+     */
+    static void encode(std::string& buffer,
+                       yarp::os::Log::LogType type,
+                       double systemtime,
+                       double networktime,
+                       const char* filename,
+                       unsigned int line,
+                       const char* function,
+                       const char* hostname,
+                       int pid,
+                       const char* cmd,
+                       const char* args,
+                       long thread_id,
+                       const char* component,
+                       const char* message,
+                       const char* backtrace);
+
+    /**
+     * Append the encoding of this record to a buffer.
+     */
+    void encode(std::string& buffer) const;
+
+    /**
+     * Decode a record.
+     *
+     * @return false if the data is not a valid record
+     */
+    bool decode(const char* data, size_t size);
+
+    /**
+     * The record in the textual format (the one of a Property) that is
+     * forwarded when the binary encoding is not enabled.
+     */
+    std::string toString() const;
+};
+
+} // namespace impl
+} // namespace os
+} // namespace yarp
+
+#endif // YARP_OS_IMPL_LOGRECORD_H
@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <yarp/os/impl/NameCache.h>
+
+#include <yarp/os/Bottle.h>
+#include <yarp/os/ConnectionReader.h>
+#include <yarp/os/Network.h>
+#include <yarp/os/Port.h>
+#include <yarp/os/SystemClock.h>
+#include <yarp/os/Vocab.h>
+#include <yarp/os/impl/LogComponent.h>
+
+#include <cstdlib>
+
+using namespace yarp::os::impl;
+using namespace yarp::os;
+
+namespace {
+YARP_OS_LOG_COMPONENT(NAMECACHE, "yarp.os.impl.NameCache")
+
+// Seconds between two attempts to subscribe to the name server
+constexpr double subscription_retry_period = 5.0;
+
+// Seconds between two checks that the name server is still connected
+constexpr double subscription_check_period = 1.0;
+
+double getEnvironmentSeconds(const char* key, double defaultValue)
+{
+    std::string value = NetworkBase::getEnvironment(key);
+    if (value.empty()) {
+        return defaultValue;
+    }
+    double seconds = atof(value.c_str());
+    return (seconds > 0) ? seconds : 0;
+}
+} // namespace
+
+
+NameCache::NameCache() :
+        ttl(getEnvironmentSeconds("YARP_NAME_CACHE_TTL", 0)),
+        negativeTtl(getEnvironmentSeconds("YARP_NAME_CACHE_NEGATIVE_TTL", 1)),
+        epoch(0),
+        subscribed(false),
+        lastAttempt(-subscription_retry_period),
+        lastCheck(0)
+{
+}
+
+NameCache::~NameCache()
+{
+    if (port && !NetworkBase::isNetworkInitialized()) {
+        // The name client of the process may be destroyed after the
+        // network, when the port cannot be closed any more.
+        port.release();
+    }
+    unsubscribe();
+}
+
+void NameCache::setTtl(double ttl, double negativeTtl)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    this->ttl = (ttl > 0) ? ttl : 0;
+    this->negativeTtl = (negativeTtl > 0) ? negativeTtl : 0;
+    entries.clear();
+    epoch++;
+}
+
+bool NameCache::isEnabled() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return ttl > 0;
+}
+
+bool NameCache::isCacheable(const std::string& name)
+{
+    // "/net=..." names choose among the addresses of the port
+    if (name.empty() || name[0] != '/') {
+        return false;
+    }
+    return name.find("/net=") != 0 && name.find("/NET=") != 0;
+}
+
+bool NameCache::lookup(const std::string& name, Contact& contact)
+{
+    double now = SystemClock::nowSystem();
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(name);
+    if (it == entries.end()) {
+        return false;
+    }
+    if (it->second.expiry < now) {
+        entries.erase(it);
+        return false;
+    }
+    contact = it->second.contact;
+    return true;
+}
+
+std::uint64_t NameCache::getEpoch() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return epoch;
+}
+
+void NameCache::store(const std::string& name, const Contact& contact, std::uint64_t epoch)
+{
+    double now = SystemClock::nowSystem();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (ttl <= 0 || epoch != this->epoch) {
+        // the reply may be older than an event received meanwhile
+        return;
+    }
+    double keep = contact.isValid() ? ttl : negativeTtl;
+    if (keep <= 0) {
+        entries.erase(name);
+        return;
+    }
+    Entry& entry = entries[name];
+    entry.contact = contact;
+    entry.expiry = now + keep;
+}
+
+void NameCache::invalidate(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.erase(name);
+    epoch++;
+}
+
+void NameCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    epoch++;
+}
+
+bool NameCache::subscribe(const Contact& server)
+{
+    // Do not make the other lookups wait for a subscription in progress
+    std::unique_lock<std::mutex> lock(subscriptionMutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return false;
+    }
+    double now = SystemClock::nowSystem();
+    if (subscribed) {
+        if (now - lastCheck < subscription_check_period) {
+            return true;
+        }
+        lastCheck = now;
+        if (port->getInputCount() > 0) {
+            return true;
+        }
+        // The name server went away (or was restarted): nothing that was
+        // cached can be trusted any more.
+        yCDebug(NAMECACHE, "lost the connection from the name server");
+        subscribed = false;
+        clear();
+    }
+    if (now - lastAttempt < subscription_retry_period || !server.isValid()) {
+        return false;
+    }
+    lastAttempt = now;
+
+    if (!port) {
+        port.reset(new Port);
+        port->setReader(*this);
+        port->setInputMode(true);
+        port->setOutputMode(false);
+        port->setRpcMode(false);
+        // Anonymous and not registered, so that opening and closing it
+        // never needs the name server.
+        if (!port->open(Contact(), false)) {
+            yCWarning(NAMECACHE, "cannot open the port for the name server events");
+            port.reset();
+            return false;
+        }
+    }
+
+    ContactStyle style;
+    style.quiet = true;
+    style.timeout = 2.0;
+    if (!NetworkBase::connect(server.toURI(), port->getName(), style)) {
+        yCDebug(NAMECACHE, "the name server at %s cannot send its events", server.toURI().c_str());
+        return false;
+    }
+
+    // Something may have changed before the connection was made.
+    clear();
+    subscribed = true;
+    lastCheck = now;
+    yCDebug(NAMECACHE, "receiving the events of the name server at %s", server.toURI().c_str());
+    return true;
+}
+
+void NameCache::unsubscribe()
+{
+    std::lock_guard<std::mutex> lock(subscriptionMutex);
+    if (port) {
+        port->close();
+        port.reset();
+    }
+    subscribed = false;
+}
+
+bool NameCache::isSubscribed() const
+{
+    std::lock_guard<std::mutex> lock(subscriptionMutex);
+    return subscribed;
+}
+
+bool NameCache::read(ConnectionReader& reader)
+{
+    Bottle event;
+    if (!event.read(reader)) {
+        return false;
+    }
+    // [add] /name or [del] /name
+    if (event.size() < 2) {
+        return true;
+    }
+    std::int32_t code = event.get(0).asVocab();
+    if (code == yarp::os::createVocab('a', 'd', 'd') || code == yarp::os::createVocab('d', 'e', 'l')) {
+        std::string name = event.get(1).asString();
+        yCTrace(NAMECACHE, "name server event: %s", event.toString().c_str());
+        invalidate(name);
+    }
+    return true;
+}
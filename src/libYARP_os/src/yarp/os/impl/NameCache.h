@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#ifndef YARP_OS_IMPL_NAMECACHE_H
+#define YARP_OS_IMPL_NAMECACHE_H
+
+#include <yarp/os/Contact.h>
+#include <yarp/os/PortReader.h>
+#include <yarp/os/api.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace yarp {
+namespace os {
+
+class Port;
+
+namespace impl {
+
+/**
+ * The contacts of the ports looked up through a NameClient.
+ *
+ * A contact is kept for a limited time (the "ttl"), and so is the fact that a
+ * port is not registered, for a usually shorter time.
+ *
+ * When subscribed, the cache opens an anonymous input port and asks the name
+ * server to connect to it: the name server then sends an "add" or "del" event
+ * each time a port is registered or unregistered, and the corresponding entry
+ * is dropped immediately, instead of waiting for it to expire.
+ *
+ * The cache is disabled (ttl = 0) unless the YARP_NAME_CACHE_TTL environment
+ * variable says otherwise.  YARP_NAME_CACHE_NEGATIVE_TTL sets the ttl of the
+ * ports not found (1 second by default).
+ */
+class YARP_os_impl_API NameCache : public yarp::os::PortReader
+{
+public:
+    NameCache();
+    ~NameCache() override;
+
+    NameCache(const NameCache&) = delete;
+    NameCache& operator=(const NameCache&) = delete;
+
+    /**
+     * Set how long the entries are kept.
+     *
+     * @param ttl seconds a contact is kept, 0 disables the cache
+     * @param negativeTtl seconds the absence of a port is kept
+     */
+    void setTtl(double ttl, double negativeTtl);
+
+    /**
+     * @return true if the contacts are cached at all
+     */
+    bool isEnabled() const;
+
+    /**
+     * @return true if the entries of this name may be cached (plain port
+     *         names, without network choice)
+     */
+    static bool isCacheable(const std::string& name);
+
+    /**
+     * Look up a name.
+     *
+     * @param name the name of the port
+     * @param[out] contact the cached contact, invalid if the port is known
+     *             not to be registered
+     * @return true if the name was in the cache, and not expired
+     */
+    bool lookup(const std::string& name, Contact& contact);
+
+    /**
+     * @return a counter increased each time an entry is invalidated, to be
+     *         passed to store() so that the reply to a query made before an
+     *         invalidation is not stored.
+     */
+    std::uint64_t getEpoch() const;
+
+    /**
+     * Store the result of a query.
+     *
+     * @param name the name of the port
+     * @param contact its contact, invalid if the port is not registered
+     * @param epoch the value of getEpoch() before the query was made
+     */
+    void store(const std::string& name, const Contact& contact, std::uint64_t epoch);
+
+    /**
+     * Drop the entry of a name.
+     */
+    void invalidate(const std::string& name);
+
+    /**
+     * Drop all the entries.
+     */
+    void clear();
+
+    /**
+     * Ask the name server to send its events to this cache.
+     *
+     * Does nothing if already subscribed, or if a subscription was tried
+     * a short time ago.  Must be called without holding any lock that the
+     * reader of the events may need.
+     *
+     * @param server the contact of the name server
+     * @return true if subscribed
+     */
+    bool subscribe(const Contact& server);
+
+    /**
+     * Close the subscription, if any.
+     */
+    void unsubscribe();
+
+    /**
+     * @return true if the name server is connected to the cache
+     */
+    bool isSubscribed() const;
+
+    /**
+     * Read an event of the name server.
+     */
+    bool read(yarp::os::ConnectionReader& reader) override;
+
+private:
+    struct Entry
+    {
+        Contact contact;
+        double expiry;
+    };
+
+    mutable std::mutex mutex;
+    YARP_SUPPRESS_DLL_INTERFACE_WARNING_ARGS(std::unordered_map<std::string, Entry>) entries;
+    double ttl;
+    double negativeTtl;
+    std::uint64_t epoch;
+
+    mutable std::mutex subscriptionMutex;
+    YARP_SUPPRESS_DLL_INTERFACE_WARNING_ARG(std::unique_ptr<yarp::os::Port>) port;
+    bool subscribed;
+    double lastAttempt;
+    double lastCheck;
+};
+
+} // namespace impl
+} // namespace os
+} // namespace yarp
+
+#endif // YARP_OS_IMPL_NAMECACHE_H
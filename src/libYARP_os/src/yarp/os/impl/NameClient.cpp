@@ -21,6 +21,7 @@
 #include <yarp/os/impl/NameServer.h>
 #include <yarp/os/impl/TcpFace.h>
 
+#include <cstdint>
 #include <cstdio>
 #include <mutex>
 
@@ -100,6 +101,21 @@ public:
         argc = at;
     }
 };
+
+/*
+  Address of a port, as returned by a name server query in bottle mode:
+  port (name /bozo) (ip 5.255.112.225) (port_number 10002) (carrier tcp)
+*/
+Contact extractPortAddress(const Bottle* bot)
+{
+    if (bot == nullptr || bot->get(0).asString() != "port" || bot->check("error")) {
+        return Contact();
+    }
+    return Contact(bot->find("name").asString(),
+                   bot->find("carrier").asString(),
+                   bot->find("ip").asString(),
+                   bot->find("port_number").asInt32());
+}
 } // namespace
 
 
@@ -156,9 +172,75 @@ Contact NameClient::queryName(const std::string& name)
         return c;
     }
 
+    bool cached = useCache(name);
+    Contact c;
+    if (cached && cache.lookup(name, c)) {
+        return c;
+    }
+    std::uint64_t epoch = cache.getEpoch();
+
     std::string q("NAME_SERVER query ");
     q += name;
-    return probe(q);
+    std::string result = send(q);
+    c = extractAddress(result);
+    if (cached && !result.empty()) {
+        cache.store(name, c, epoch);
+    }
+    return c;
+}
+
+std::vector<Contact> NameClient::queryNames(const std::vector<std::string>& names)
+{
+    std::vector<Contact> contacts(names.size());
+    std::vector<size_t> missing;
+    for (size_t i = 0; i < names.size(); i++) {
+        const std::string& name = names[i];
+        if (name.find(':') != std::string::npos || !useCache(name) || !cache.lookup(name, contacts[i])) {
+            missing.push_back(i);
+        }
+    }
+    if (missing.empty()) {
+        return contacts;
+    }
+
+    bool batch = missing.size() > 1 && altStore == nullptr && !isFakeMode() && NetworkBase::getQueryBypass() == nullptr;
+    for (size_t i : missing) {
+        const std::string& name = names[i];
+        if (name.find(':') != std::string::npos || !NameCache::isCacheable(name)) {
+            batch = false;
+        }
+    }
+
+    if (batch) {
+        std::uint64_t epoch = cache.getEpoch();
+        Bottle cmd;
+        Bottle reply;
+        cmd.addString("bot");
+        cmd.addString("query");
+        for (size_t i : missing) {
+            cmd.addString(names[i]);
+        }
+        send(cmd, reply);
+        // ports (port (name ...) (ip ...) (port_number ...) (carrier ...)) (port (error ...)) ...
+        // Older name servers reply only about the first name.
+        if (reply.get(0).asString() == "ports" && reply.size() == missing.size() + 1) {
+            for (size_t j = 0; j < missing.size(); j++) {
+                size_t i = missing[j];
+                Contact c = extractPortAddress(reply.get(j + 1).asList());
+                contacts[i] = c;
+                if (useCache(names[i])) {
+                    cache.store(names[i], c, epoch);
+                }
+            }
+            return contacts;
+        }
+        yCDebug(NAMECLIENT, "the name server does not support queries of several ports");
+    }
+
+    for (size_t i : missing) {
+        contacts[i] = queryName(names[i]);
+    }
+    return contacts;
 }
 
 Contact NameClient::registerName(const std::string& name)
@@ -168,6 +250,8 @@ Contact NameClient::registerName(const std::string& name)
 
 Contact NameClient::registerName(const std::string& name, const Contact& suggest)
 {
+    cache.invalidate(name);
+
     Bottle cmd;
     cmd.addString("register");
     if (!name.empty()) {
@@ -218,6 +302,7 @@ Contact NameClient::registerName(const std::string& name, const Contact& suggest
     Contact address = extractAddress(reply);
     if (address.isValid()) {
         std::string reg = address.getRegName();
+        cache.invalidate(reg);
 
 
         std::string cmdOffers = "set /port offers ";
@@ -254,6 +339,8 @@ Contact NameClient::registerName(const std::string& name, const Contact& suggest
 
 Contact NameClient::unregisterName(const std::string& name)
 {
+    cache.invalidate(name);
+
     std::string q("NAME_SERVER unregister ");
     q += name;
     return probe(q);
@@ -491,6 +578,11 @@ yarp::os::Nodes& NameClient::getNodes()
     return nodes;
 }
 
+NameCache& NameClient::getCache()
+{
+    return cache;
+}
+
 NameServer& NameClient::getServer()
 {
     if (fakeServer == nullptr) {
@@ -500,6 +592,18 @@ NameServer& NameClient::getServer()
     return *fakeServer;
 }
 
+bool NameClient::useCache(const std::string& name)
+{
+    if (!cache.isEnabled() || !NameCache::isCacheable(name)) {
+        return false;
+    }
+    if (isFakeMode() || altStore != nullptr || NetworkBase::getQueryBypass() != nullptr) {
+        return false;
+    }
+    cache.subscribe(getAddress());
+    return true;
+}
+
 void NameClient::setup()
 {
     static std::mutex mutex;
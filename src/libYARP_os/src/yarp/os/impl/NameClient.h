@@ -13,6 +13,10 @@
 #include <yarp/os/Contact.h>
 #include <yarp/os/ContactStyle.h>
 #include <yarp/os/Nodes.h>
+#include <yarp/os/impl/NameCache.h>
+
+#include <string>
+#include <vector>
 
 namespace yarp {
 namespace os {
@@ -67,6 +71,17 @@ public:
      */
     Contact queryName(const std::string& name);
 
+    /**
+     * Look up the addresses of several ports.
+     *
+     * The names that are not in the cache are sent to the name server in a
+     * single query, if it supports it.
+     *
+     * @param names the names of the ports
+     * @return the address associated with each port, in the same order
+     */
+    std::vector<Contact> queryNames(const std::vector<std::string>& names);
+
     /**
      * Register a port with a given name.
      * @param name the name of the port
@@ -197,6 +212,13 @@ public:
 
     yarp::os::Nodes& getNodes();
 
+    /**
+     * The cache of the addresses returned by queryName().
+     *
+     * @return the cache of the name client
+     */
+    NameCache& getCache();
+
 private:
     Contact address;
     YARP_SUPPRESS_DLL_INTERFACE_WARNING_ARG(std::string) host;
@@ -210,9 +232,11 @@ private:
     bool isSetup;
     NameStore* altStore;
     yarp::os::Nodes nodes;
+    NameCache cache;
 
     NameServer& getServer();
     void setup();
+    bool useCache(const std::string& name);
 };
 
 } // namespace impl
@@ -85,6 +85,7 @@ PortCore::PortCore() :
         m_dataOutputCount(0),
         m_flags(PORTCORE_IS_INPUT | PORTCORE_IS_OUTPUT),
         m_logNeeded(false),
+        m_batcher(*this),
         m_timeout(-1),
         m_counter(1),
         m_prop(nullptr),
@@ -332,6 +333,8 @@ bool PortCore::start()
     yCAssert(PORTCORE, !m_closing);
     m_starting = true;
 
+    m_batcher.start();
+
     // Start the server thread.
     bool started = ThreadImpl::start();
     if (!started) {
@@ -360,6 +363,7 @@ bool PortCore::manualStart(const char* sourceName)
     m_interruptible = false;
     m_manual = true;
     setName(sourceName);
+    m_batcher.start();
     return true;
 }
 
@@ -407,6 +411,10 @@ void PortCore::closeMain()
 {
     yCTrace(PORTCORE, "closeMain");
 
+    // Send the messages still waiting in a batch, before closing the
+    // connections.
+    m_batcher.stop();
+
     m_stateSemaphore.wait();
 
     // We may not have anything to do.
@@ -1306,6 +1314,15 @@ bool PortCore::send(const PortWriter& writer,
         m_modifier.outputModifier->modifyOutgoingData(writer);
     }
     m_modifier.outputMutex.unlock();
+    if (m_batcher.isActive()) {
+        // Only the messages that are given back through a callback (e.g.
+        // by a BufferedPort) can wait for the others in their batch.
+        // The other messages are sent after the ones already waiting.
+        if (callback != nullptr && reader == nullptr && m_envelope != "__ADMIN") {
+            return m_batcher.add(writer, *callback, m_envelope);
+        }
+        m_batcher.flush();
+    }
     if (!m_logNeeded) {
         return sendHelper(writer, PORTCORE_SEND_NORMAL, reader, callback);
     }
@@ -1328,10 +1345,12 @@ bool PortCore::sendHelper(const PortWriter& writer,
     int logCount = 0;
     std::string envelopeString = m_envelope;
 
-    // Pass a message to all output units for sending on.  We could
-    // be doing more here to cache the serialization of the message
-    // and reuse it across output connections.  However, one key
-    // optimization is present: external blocks written by
+    // Pass a message to all output units for sending on.  The message
+    // is serialized once, by the first output unit that needs it, and
+    // the bytes are cached in the packet and reused by the other output
+    // connections (see PortCorePacket::getPayload).  Connections that
+    // alter the payload (text mode, portmonitors) still serialize the
+    // message on their own.  Also, external blocks written by
     // yarp::os::ConnectionWriter::appendExternalBlock are never
     // copied.  So for example the core image array in a yarp::sig::Image
     // is untouched by the port communications code.
@@ -1365,6 +1384,20 @@ bool PortCore::sendHelper(const PortWriter& writer,
     packet->setContent(&writer, false, callback);
     m_packetMutex.unlock();
 
+    // A reader in this process may keep the object sent, instead of a copy
+    // of it, only if no other connection reads it (see
+    // PortCoreOutputUnit::sendMessage())
+    size_t carriers = 0;
+    for (auto unit : m_units) {
+        if ((unit != nullptr) && unit->isOutput() && !unit->isFinished()) {
+            bool log = (!unit->getMode().empty());
+            if ((mode == PORTCORE_SEND_NORMAL) ? (!log) : (log)) {
+                carriers++;
+            }
+        }
+    }
+    packet->shareable = (carriers == 1);
+
     // Scan connections, placing message everyhere we can.
     for (auto unit : m_units) {
         if ((unit != nullptr) && unit->isOutput() && !unit->isFinished()) {
@@ -1438,6 +1471,18 @@ bool PortCore::sendHelper(const PortWriter& writer,
 }
 
 
+void PortCore::setBatching(size_t messages, double delay)
+{
+    m_batcher.configure(messages, delay);
+}
+
+
+bool PortCore::flushBatch()
+{
+    return m_batcher.flush();
+}
+
+
 bool PortCore::isWriting()
 {
     bool writing = false;
@@ -1739,6 +1784,7 @@ bool PortCore::adminBlock(ConnectionReader& reader,
         result.addString("[prop] [set] $portname  # set Qos properties of a connection to/from a port");
         result.addString("[prop] [get] $cur_port  # get information about current process (e.g., scheduling priority, pid)");
         result.addString("[prop] [set] $cur_port  # set properties of the current process (e.g., scheduling priority, pid)");
+        result.addString("[prop] [get] stats      # get the counters of the messages sent and received by the port");
         result.addString("[atch] [out] $prop      # attach a portmonitor plug-in to the port's output");
         result.addString("[atch] [in]  $prop      # attach a portmonitor plug-in to the port's input");
         result.addString("[dtch] [out]            # detach portmonitor plug-in from the port's output");
@@ -2311,6 +2357,44 @@ bool PortCore::adminBlock(ConnectionReader& reader,
         return result;
     };
 
+    auto handleAdminPropGetStatsCmd = [this]() {
+        // request: "prop get stats"
+        // reply  : "(port ((in_flight 0))) (buffer ((received 10) ...))
+        //           (out (/r ((messages 10) ...))) (in (/w ((messages 10) ...)))"
+        Bottle result;
+        Bottle& port = result.addList();
+        port.addString("port");
+        Property& port_prop = port.addDict();
+        m_packetMutex.lock();
+        port_prop.put("in_flight", static_cast<int>(m_packets.getCount()));
+        m_packetMutex.unlock();
+
+        Property buffer_prop;
+        if (getReaderStatistics(buffer_prop)) {
+            Bottle& buffer = result.addList();
+            buffer.addString("buffer");
+            buffer.addDict() = buffer_prop;
+        }
+
+        Bottle& out = result.addList();
+        out.addString("out");
+        Bottle& in = result.addList();
+        in.addString("in");
+        m_stateSemaphore.wait();
+        for (auto unit : m_units) {
+            if ((unit != nullptr) && !unit->isFinished() && (unit->isOutput() || unit->isInput())) {
+                Route route = unit->getRoute();
+                Bottle& connection = unit->isOutput() ? out.addList() : in.addList();
+                connection.addString(unit->isOutput() ? route.getToName() : route.getFromName());
+                Property& connection_prop = connection.addDict();
+                connection_prop.put("carrier", route.getCarrierName());
+                unit->getStatistics().report(connection_prop);
+            }
+        }
+        m_stateSemaphore.post();
+        return result;
+    };
+
     auto handleAdminPropSetCmd = [this](const std::string& key,
                                         const Value& value,
                                         const Bottle& process,
@@ -2679,7 +2763,11 @@ bool PortCore::adminBlock(ConnectionReader& reader,
         // Set/get arbitrary properties on a port.
         switch (action) {
         case PortCorePropertyAction::Get:
-            result = handleAdminPropGetCmd(key);
+            if (key == "stats") {
+                result = handleAdminPropGetStatsCmd();
+            } else {
+                result = handleAdminPropGetCmd(key);
+            }
             break;
         case PortCorePropertyAction::Set: {
             const Value& value = cmd.get(3);
@@ -3026,6 +3114,17 @@ yarp::os::PortReaderCreator* PortCore::getReadCreator()
     return m_readableCreator;
 }
 
+bool PortCore::hasNonBlockingReader()
+{
+    return false;
+}
+
+bool PortCore::getReaderStatistics(yarp::os::Property& stats)
+{
+    YARP_UNUSED(stats);
+    return false;
+}
+
 void PortCore::setControlRegistration(bool flag)
 {
     m_controlRegistration = flag;
@@ -23,6 +23,7 @@
 #include <yarp/os/Type.h>
 #include <yarp/os/Vocab.h>
 #include <yarp/os/impl/BufferedConnectionWriter.h>
+#include <yarp/os/impl/PortCoreBatch.h>
 #include <yarp/os/impl/PortCorePackets.h>
 #include <yarp/os/impl/ThreadImpl.h>
 
@@ -363,6 +364,20 @@ public:
         this->m_waitAfterSend = waitAfterSend;
     }
 
+    /**
+     * Group the messages sent with a completion callback in batches.
+     * See Port::setBatching.
+     * @param messages the most messages in a batch, 0 or 1 to stop batching
+     * @param delay the most time, in seconds, that a message waits for
+     *              the others in its batch
+     */
+    void setBatching(size_t messages, double delay);
+
+    /**
+     * Send the messages waiting in the current batch, if any.
+     */
+    bool flushBatch();
+
     /**
      * Callback for data.
      */
@@ -431,6 +446,21 @@ public:
      */
     yarp::os::PortReaderCreator* getReadCreator();
 
+    /**
+     * @return true if messages are read into a buffer that never waits
+     * for the user, and never runs user code to handle them (e.g. a
+     * BufferedPort, see PortReaderBufferBase::isNonBlocking())
+     */
+    virtual bool hasNonBlockingReader();
+
+    /**
+     * Add the counters of the buffer the messages are read into, if any,
+     * to a property (see PortReaderBufferBase::getStatistics()).
+     *
+     * @return true if the messages are read into a buffer
+     */
+    virtual bool getReaderStatistics(yarp::os::Property& stats);
+
     /**
      * Call the right onCompletion() after sending message
      */
@@ -543,6 +573,7 @@ private:
     unsigned int m_flags;      ///< binary flags encoding restrictions on port
     bool m_logNeeded; ///< port needs to monitor message content
     PortCorePackets m_packets; ///< a pool for tracking messages currently being sent
+    PortCoreBatcher m_batcher; ///< groups the messages to send in batches
     std::string m_envelope;///< user-defined wrapping data
     float m_timeout;  ///< a timeout to apply to all network operations
     int m_counter;    ///< port-unique ids for connections
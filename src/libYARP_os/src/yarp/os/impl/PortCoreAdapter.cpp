@@ -10,6 +10,7 @@
 #include <yarp/os/impl/PortCoreAdapter.h>
 
 #include <yarp/os/PortReader.h>
+#include <yarp/os/PortReaderBufferBase.h>
 #include <yarp/os/Time.h>
 #include <yarp/os/impl/LogComponent.h>
 
@@ -305,6 +306,24 @@ yarp::os::PortReader* yarp::os::impl::PortCoreAdapter::checkPortReader()
     return readDelegate;
 }
 
+bool yarp::os::impl::PortCoreAdapter::hasNonBlockingReader()
+{
+    std::lock_guard<std::mutex> lock(stateMutex);
+    auto* buffer = dynamic_cast<PortReaderBufferBase*>(permanentReadDelegate);
+    return buffer != nullptr && buffer->isNonBlocking();
+}
+
+bool yarp::os::impl::PortCoreAdapter::getReaderStatistics(yarp::os::Property& stats)
+{
+    std::lock_guard<std::mutex> lock(stateMutex);
+    auto* buffer = dynamic_cast<PortReaderBufferBase*>(readDelegate);
+    if (buffer == nullptr) {
+        return false;
+    }
+    buffer->getStatistics(stats);
+    return true;
+}
+
 yarp::os::PortReader* yarp::os::impl::PortCoreAdapter::checkAdminPortReader()
 {
     return adminReadDelegate;
@@ -98,6 +98,8 @@ YARP_WARNING_POP
     PortReader* checkPortReader();
     PortReader* checkAdminPortReader();
     PortReaderCreator* checkReadCreator();
+    bool hasNonBlockingReader() override;
+    bool getReaderStatistics(yarp::os::Property& stats) override;
     int checkWaitAfterSend();
     bool isOpened();
     void setOpen(bool opened);
@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <yarp/os/impl/PortCoreBatch.h>
+
+#include <yarp/os/ConnectionReader.h>
+#include <yarp/os/ConnectionWriter.h>
+#include <yarp/os/StringInputStream.h>
+#include <yarp/os/impl/BufferedConnectionWriter.h>
+#include <yarp/os/impl/LogComponent.h>
+#include <yarp/os/impl/PortCore.h>
+#include <yarp/os/impl/StreamConnectionReader.h>
+
+#include <algorithm>
+
+using namespace yarp::os::impl;
+using namespace yarp::os;
+
+namespace {
+YARP_OS_LOG_COMPONENT(PORTCOREBATCH, "yarp.os.impl.PortCoreBatch")
+
+bool expectString(ConnectionReader& reader, std::string& str)
+{
+    std::int32_t len = reader.expectInt32();
+    if (reader.isError() || len < 0 || static_cast<size_t>(len) > reader.getSize()) {
+        return false;
+    }
+    str.resize(static_cast<size_t>(len));
+    return (len == 0) || reader.expectBlock(&str[0], str.size());
+}
+} // namespace
+
+
+PortCoreBatch::PortCoreBatch(std::mutex& mutex, std::condition_variable& completed) :
+        m_mutex(mutex),
+        m_completed(completed)
+{
+}
+
+void PortCoreBatch::add(const PortWriter& writer,
+                        const PortWriter& callback,
+                        const std::string& envelope)
+{
+    m_items.push_back({&writer, &callback, envelope});
+}
+
+const std::vector<PortCoreBatch::Item>& PortCoreBatch::getItems() const
+{
+    return m_items;
+}
+
+bool PortCoreBatch::acquire()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_busy) {
+        return false;
+    }
+    m_busy = true;
+    m_commenced = false;
+    m_items.clear();
+    return true;
+}
+
+bool PortCoreBatch::isBusy() const
+{
+    return m_busy;
+}
+
+bool PortCoreBatch::hasCommenced() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_commenced;
+}
+
+bool PortCoreBatch::write(ConnectionWriter& connection) const
+{
+    BufferedConnectionWriter message(connection.isTextMode(), connection.isBareMode());
+    connection.appendInt32(static_cast<std::int32_t>(m_items.size()));
+    for (const auto& item : m_items) {
+        message.restart();
+        if (!item.writer->write(message)) {
+            return false;
+        }
+        connection.appendInt32(static_cast<std::int32_t>(item.envelope.length()));
+        connection.appendBlock(item.envelope.data(), item.envelope.length());
+        connection.appendInt32(static_cast<std::int32_t>(message.dataSize()));
+        for (size_t i = 0; i < message.length(); i++) {
+            connection.appendBlock(message.data(i), message.length(i));
+        }
+    }
+    return !connection.isError();
+}
+
+void PortCoreBatch::onCommencement() const
+{
+    for (const auto& item : m_items) {
+        item.writer->onCommencement();
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_commenced = true;
+}
+
+void PortCoreBatch::onCompletion() const
+{
+    for (const auto& item : m_items) {
+        item.callback->onCompletion();
+    }
+    // the batch can be reused from now on
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_busy = false;
+    }
+    m_completed.notify_all();
+}
+
+bool PortCoreBatch::read(ConnectionReader& reader,
+                         const Route& route,
+                         const std::function<void(const std::string& envelope, ConnectionReader& message)>& deliver)
+{
+    std::int32_t count = reader.expectInt32();
+    if (reader.isError() || count < 0) {
+        return false;
+    }
+    std::string envelope;
+    std::string data;
+    StringInputStream sis;
+    StreamConnectionReader sbr;
+    for (std::int32_t i = 0; i < count; i++) {
+        if (!expectString(reader, envelope) || !expectString(reader, data)) {
+            yCError(PORTCOREBATCH, "Malformed batch of messages from %s", route.getFromName().c_str());
+            return false;
+        }
+        sis.reset(data);
+        sbr.reset(sis, nullptr, route, data.size(), false);
+        sbr.setParentConnectionReader(&reader);
+        deliver(envelope, sbr);
+    }
+    return true;
+}
+
+
+PortCoreBatcher::PortCoreBatcher(PortCore& owner) :
+        m_owner(owner)
+{
+}
+
+PortCoreBatcher::~PortCoreBatcher()
+{
+    stop();
+}
+
+void PortCoreBatcher::configure(size_t messages, double delay)
+{
+    flush();
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_messages = messages;
+    m_delay = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(std::max(delay, 0.0)));
+    if (!m_stopping && messages > 1 && delay > 0 && !m_thread.joinable()) {
+        m_thread = std::thread(&PortCoreBatcher::run, this);
+    }
+    m_changed.notify_all();
+}
+
+void PortCoreBatcher::start()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_stopping = false;
+    if (m_messages.load() > 1 && m_delay != std::chrono::steady_clock::duration::zero() && !m_thread.joinable()) {
+        m_thread = std::thread(&PortCoreBatcher::run, this);
+    }
+}
+
+bool PortCoreBatcher::isActive() const
+{
+    return m_messages.load() > 1;
+}
+
+bool PortCoreBatcher::add(const PortWriter& writer,
+                          const PortWriter& callback,
+                          const std::string& envelope)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_stopping) {
+        lock.unlock();
+        return m_owner.sendHelper(writer, PORTCORE_SEND_NORMAL, nullptr, &callback);
+    }
+    if (m_current == nullptr) {
+        for (auto& batch : m_batches) {
+            if (batch->acquire()) {
+                m_current = batch.get();
+                break;
+            }
+        }
+        if (m_current == nullptr) {
+            m_batches.emplace_back(new PortCoreBatch(m_completionMutex, m_completed));
+            m_current = m_batches.back().get();
+            m_current->acquire();
+        }
+        m_started = std::chrono::steady_clock::now();
+        m_changed.notify_all();
+    }
+    m_current->add(writer, callback, envelope);
+    if (m_current->getItems().size() >= m_messages.load()) {
+        return sendCurrent();
+    }
+    return true;
+}
+
+bool PortCoreBatcher::flush()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return sendCurrent();
+}
+
+void PortCoreBatcher::stop()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        sendCurrent();
+        m_stopping = true;
+        m_changed.notify_all();
+    }
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+bool PortCoreBatcher::sendCurrent()
+{
+    // called with m_mutex locked, so that the batches are sent in order
+    if (m_current == nullptr) {
+        return true;
+    }
+    PortCoreBatch* batch = m_current;
+    m_current = nullptr;
+
+    // Wait for the previous batch, unless it is the one being sent again
+    // (that means it was already sent), so that the connections are not
+    // busy with it.
+    if (m_last != nullptr && m_last != batch) {
+        std::unique_lock<std::mutex> lock(m_completionMutex);
+        m_completed.wait(lock, [this]() { return !m_last->isBusy(); });
+    }
+    m_last = batch;
+
+    bool ok = m_owner.sendHelper(*batch, PORTCORE_SEND_NORMAL, nullptr, batch);
+    if (!batch->hasCommenced()) {
+        // the port is closing, give the messages back
+        batch->onCompletion();
+    }
+    return ok;
+}
+
+void PortCoreBatcher::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopping) {
+        if (m_current == nullptr || m_delay == std::chrono::steady_clock::duration::zero()) {
+            m_changed.wait(lock);
+        } else if (m_changed.wait_until(lock, m_started + m_delay) == std::cv_status::timeout) {
+            sendCurrent();
+        }
+    }
+}
@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#ifndef YARP_OS_IMPL_PORTCOREBATCH_H
+#define YARP_OS_IMPL_PORTCOREBATCH_H
+
+#include <yarp/os/PortWriter.h>
+#include <yarp/os/Route.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace yarp {
+namespace os {
+
+class ConnectionReader;
+
+namespace impl {
+
+class PortCore;
+
+/**
+ * Several messages written by a port, sent together as a single message.
+ *
+ * On the connections that support it, the batch is sent after a "b" port
+ * command, and it is unpacked by the input unit of the other side, that
+ * passes each message, with its own envelope, to the reader of the port.
+ * The other connections send the messages of the batch one by one.
+ *
+ * The messages are the objects of the writer (e.g. the buffers of a
+ * BufferedPort), they are given back to it when the whole batch has been
+ * sent.
+ */
+class PortCoreBatch : public yarp::os::PortWriter
+{
+public:
+    /**
+     * @param mutex protects the state of the batches of a port
+     * @param completed notified when a batch has been sent
+     */
+    PortCoreBatch(std::mutex& mutex, std::condition_variable& completed);
+
+    struct Item
+    {
+        const yarp::os::PortWriter* writer;
+        const yarp::os::PortWriter* callback;
+        std::string envelope;
+    };
+
+    /**
+     * Add a message to the batch.
+     *
+     * @param writer the message
+     * @param callback who to call onCompletion() on when the batch is sent
+     * @param envelope the envelope of the message
+     */
+    void add(const yarp::os::PortWriter& writer,
+             const yarp::os::PortWriter& callback,
+             const std::string& envelope);
+
+    /**
+     * @return the messages in the batch
+     */
+    const std::vector<Item>& getItems() const;
+
+    /**
+     * Mark the batch as being sent, and remove its messages.
+     * @return false if the batch is still being sent
+     */
+    bool acquire();
+
+    /**
+     * @return true if the batch is still being sent, call with the mutex
+     *         locked
+     */
+    bool isBusy() const;
+
+    /**
+     * @return true if the port started sending the batch
+     */
+    bool hasCommenced() const;
+
+    // Serialize the messages: their number, then for each of them the
+    // length of the envelope, the envelope, the length of the message and
+    // the message.
+    bool write(yarp::os::ConnectionWriter& connection) const override;
+
+    void onCommencement() const override;
+
+    // Give the messages back to their writers
+    void onCompletion() const override;
+
+    /**
+     * Unpack a batch written by PortCoreBatch::write.
+     *
+     * @param reader the connection, after the "b" port command
+     * @param route the route of the connection
+     * @param deliver called with the envelope and a reader of each message
+     * @return false if the batch was not well formed
+     */
+    static bool read(yarp::os::ConnectionReader& reader,
+                     const yarp::os::Route& route,
+                     const std::function<void(const std::string& envelope, yarp::os::ConnectionReader& message)>& deliver);
+
+private:
+    std::mutex& m_mutex;
+    std::condition_variable& m_completed;
+    std::vector<Item> m_items;
+    mutable bool m_busy {false};
+    mutable bool m_commenced {false};
+};
+
+
+/**
+ * Group the messages written by a port in batches, see Port::setBatching.
+ *
+ * A batch is sent when it contains enough messages, when its first message
+ * has waited long enough, or when it is flushed.  A thread takes care of
+ * the delay, it is started only if a delay is set.
+ *
+ * Unlike single messages, batches are never skipped by the connections
+ * that are still busy: each batch waits for the previous one to be sent.
+ */
+class PortCoreBatcher
+{
+public:
+    explicit PortCoreBatcher(PortCore& owner);
+    ~PortCoreBatcher();
+
+    PortCoreBatcher(const PortCoreBatcher&) = delete;
+    PortCoreBatcher& operator=(const PortCoreBatcher&) = delete;
+
+    /**
+     * @param messages the most messages in a batch, 0 or 1 to stop batching
+     * @param delay the most time, in seconds, that a message waits for the
+     *              others in its batch, 0 to wait for a full batch
+     */
+    void configure(size_t messages, double delay);
+
+    /**
+     * @return true if the messages are batched
+     */
+    bool isActive() const;
+
+    /**
+     * Add a message to the current batch, and send the batch if it is
+     * full.
+     */
+    bool add(const yarp::os::PortWriter& writer,
+             const yarp::os::PortWriter& callback,
+             const std::string& envelope);
+
+    /**
+     * Send the current batch, if any.
+     */
+    bool flush();
+
+    /**
+     * Start batching messages again, when the port is opened.
+     */
+    void start();
+
+    /**
+     * Send the current batch, and stop batching messages until start() is
+     * called, when the port is closed.
+     */
+    void stop();
+
+private:
+    bool sendCurrent();
+    void run();
+
+    PortCore& m_owner;
+    std::mutex m_mutex;
+    std::condition_variable m_changed;
+    std::mutex m_completionMutex;
+    std::condition_variable m_completed;
+    std::atomic<size_t> m_messages {0};
+    std::chrono::steady_clock::duration m_delay {0};
+    std::vector<std::unique_ptr<PortCoreBatch>> m_batches;
+    PortCoreBatch* m_current {nullptr};
+    PortCoreBatch* m_last {nullptr};
+    std::chrono::steady_clock::time_point m_started;
+    std::thread m_thread;
+    bool m_stopping {false};
+};
+
+} // namespace impl
+} // namespace os
+} // namespace yarp
+
+#endif // YARP_OS_IMPL_PORTCOREBATCH_H
@@ -10,15 +10,23 @@
 #include <yarp/os/impl/PortCoreInputUnit.h>
 
 #include <yarp/os/Name.h>
+#include <yarp/os/NetInt32.h>
+#include <yarp/os/NetType.h>
 #include <yarp/os/Os.h>
 #include <yarp/os/PortInfo.h>
 #include <yarp/os/PortReport.h>
+#include <yarp/os/ShiftStream.h>
 #include <yarp/os/Time.h>
 #include <yarp/os/impl/BufferedConnectionWriter.h>
 #include <yarp/os/impl/LogComponent.h>
 #include <yarp/os/impl/PlatformSignal.h>
 #include <yarp/os/impl/PortCommand.h>
+#include <yarp/os/impl/PortCoreBatch.h>
+#include <yarp/os/impl/PortCoreReactor.h>
+#include <yarp/os/impl/Protocol.h>
+#include <yarp/os/impl/SocketTwoWayStream.h>
 
+#include <chrono>
 #include <cstdio>
 
 
@@ -37,12 +45,17 @@ PortCoreInputUnit::PortCoreInputUnit(PortCore& owner,
         ip(ip),
         phase(1),
         access(1),
+        released(0),
         closing(false),
         finished(false),
         running(false),
+        reactive(false),
+        reactorStream(nullptr),
         name(owner.getName()),
         localReader(nullptr),
-        reversed(reversed)
+        reversed(reversed),
+        wasNoticed(false),
+        posted(false)
 {
     yCAssert(PORTCOREINPUTUNIT, ip != nullptr);
 
@@ -87,16 +100,27 @@ void PortCoreInputUnit::run()
     running = true;
     phase.post();
 
-    Route route;
-    bool wasNoticed = false;
-    bool posted = false;
+    bool done = !setup();
 
+    if (!done && attachToReactor()) {
+        // From now on, the reactor takes care of this connection
+        return;
+    }
+
+    while (!done) {
+        done = !step();
+    }
+
+    finish();
+}
+
+
+bool PortCoreInputUnit::setup()
+{
     bool done = false;
 
     yCAssert(PORTCOREINPUTUNIT, ip != nullptr);
 
-    PortCommand cmd;
-
     bool ok = true;
     if (!reversed) {
         ip->open(getName());
@@ -167,225 +191,264 @@ void PortCoreInputUnit::run()
         done = true;
     }
 
-    void* id = (void*)this;
-
     if (ip != nullptr && !ip->getConnection().canEscape()) {
         InputStream* is = &ip->getInputStream();
         is->setReadEnvelopeCallback(envelopeReadCallback, this);
     }
 
-    while (!done) {
-        if (ip == nullptr) {
-            break;
-        }
-        ConnectionReader& br = ip->beginRead();
-
-        if (br.getReference() != nullptr) {
-            //printf("HAVE A REFERENCE\n");
-            if (localReader != nullptr) {
-                bool ok = localReader->read(br);
-                if (!br.isActive()) {
-                    break;
-                }
-                if (!ok) {
-                    continue;
-                }
-            } else {
-                PortCore& man = getOwner();
-                bool ok = man.readBlock(br, id, nullptr);
-                if (!br.isActive()) {
-                    break;
-                }
-                if (!ok) {
-                    continue;
-                }
-            }
-            //printf("DONE WITH A REFERENCE\n");
-            if (ip != nullptr) {
-                ip->endRead();
-            }
-            continue;
-        }
+    return !done;
+}
 
-        if (ip->getConnection().canEscape()) {
-            bool ok = cmd.read(br);
-            if (!br.isActive()) {
-                break;
-            }
-            if (!ok) {
-                continue;
-            }
+
+bool PortCoreInputUnit::step()
+{
+    bool done = false;
+
+    void* id = (void*)this;
+
+    if (ip == nullptr) {
+        return false;
+    }
+    ConnectionReader& br = ip->beginRead();
+
+    if (br.getReference() != nullptr) {
+        //printf("HAVE A REFERENCE\n");
+        auto start = std::chrono::steady_clock::now();
+        if (localReader != nullptr) {
+            localReader->read(br);
         } else {
-            cmd = PortCommand('d', "");
-            if (!ip->isOk()) {
-                break;
-            }
+            PortCore& man = getOwner();
+            man.readBlock(br, id, nullptr);
+        }
+        statistics.addMessage(0, std::chrono::steady_clock::now() - start);
+        //printf("DONE WITH A REFERENCE\n");
+        // The sender waits for this, even if the object was rejected or
+        // the connection is closing, before it can reuse its object.
+        if (ip != nullptr) {
+            ip->endRead();
         }
+        return br.isActive();
+    }
 
-        if (closing || isDoomed()) {
-            break;
+    if (ip->getConnection().canEscape()) {
+        bool ok = cmd.read(br);
+        if (!br.isActive()) {
+            return false;
         }
-        char key = cmd.getKey();
-        //printf("Port command is [%c:%d/%s]\n",
-        //         (key>=32)?key:'?', key, cmd.getText().c_str());
-
-        PortCore& man = getOwner();
-        OutputStream* os = nullptr;
-        if (br.isTextMode()) {
-            os = &(ip->getOutputStream());
+        if (!ok) {
+            return true;
         }
+    } else {
+        cmd = PortCommand('d', "");
+        if (!ip->isOk()) {
+            return false;
+        }
+    }
 
-        switch (key) {
-        case '/':
-            yCDebug(PORTCOREINPUTUNIT,
-                    "Port command (%s): %s should add connection: %s",
-                    route.toString().c_str(),
-                    getOwner().getName().c_str(),
-                    cmd.getText().c_str());
-            man.addOutput(cmd.getText(), id, os);
-            break;
-        case '!':
-            yCDebug(PORTCOREINPUTUNIT,
-                    "Port command (%s): %s should remove output: %s",
-                    route.toString().c_str(),
-                    getOwner().getName().c_str(),
-                    cmd.getText().c_str());
-            man.removeOutput(cmd.getText().substr(1, std::string::npos), id, os);
-            break;
-        case '~':
-            yCDebug(PORTCOREINPUTUNIT,
-                    "Port command (%s): %s should remove input: %s",
-                    route.toString().c_str(),
-                    getOwner().getName().c_str(),
-                    cmd.getText().c_str());
-            man.removeInput(cmd.getText().substr(1, std::string::npos), id, os);
-            break;
-        case '*':
-            man.describe(id, os);
-            break;
-        case 'D':
-        case 'd': {
-            if (key == 'D') {
-                ip->suppressReply();
-            }
+    if (closing || isDoomed()) {
+        return false;
+    }
+    char key = cmd.getKey();
+    //printf("Port command is [%c:%d/%s]\n",
+    //         (key>=32)?key:'?', key, cmd.getText().c_str());
+
+    PortCore& man = getOwner();
+    OutputStream* os = nullptr;
+    if (br.isTextMode()) {
+        os = &(ip->getOutputStream());
+    }
 
-            std::string env = cmd.getText();
-            if (env.length() > 2) {
-                yCTrace(PORTCOREINPUTUNIT, "***** received an envelope! [%s]", env.c_str());
-                std::string env2 = env.substr(2, env.length());
-                man.setEnvelope(env2);
-                ip->setEnvelope(env2);
-            }
-            if (localReader != nullptr) {
-                localReader->read(br);
-                if (!br.isActive()) {
-                    done = true;
-                    break;
-                }
-            } else {
-                if (ip->getReceiver().acceptIncomingData(br)) {
-                    ConnectionReader* cr = &(ip->getReceiver().modifyIncomingData(br));
-                    yarp::os::impl::PortDataModifier& modifier = getOwner().getPortModifier();
-                    modifier.inputMutex.lock();
-                    if (modifier.inputModifier != nullptr) {
-                        if (modifier.inputModifier->acceptIncomingData(*cr)) {
-                            cr = &(modifier.inputModifier->modifyIncomingData(*cr));
-                            modifier.inputMutex.unlock();
-                            man.readBlock(*cr, id, os);
-                        } else {
-                            modifier.inputMutex.unlock();
-                            skipIncomingData(*cr);
-                        }
-                    } else {
-                        modifier.inputMutex.unlock();
-                        man.readBlock(*cr, id, os);
-                    }
-                } else {
-                    skipIncomingData(br);
-                }
-                if (!br.isActive()) {
-                    done = true;
-                    break;
-                }
-            }
-        } break;
-        case 'a': {
-            man.adminBlock(br, id);
-        } break;
-        case 'r':
-            /*
-              In YARP implementation, OP=IP.
-              (This information is used rarely, and when used
-              is tagged with OP=IP keyword)
-              If it were not true, memory alloc would need to
-              reorganized here
-            */
-            {
-                OutputProtocol* op = &(ip->getOutput());
-                ip->endRead();
-                Route r = op->getRoute();
-                // reverse route
-                r.swapNames();
-                op->rename(r);
-
-                getOwner().addOutput(op);
-                ip = nullptr;
-                done = true;
-            }
+    switch (key) {
+    case '/':
+        yCDebug(PORTCOREINPUTUNIT,
+                "Port command (%s): %s should add connection: %s",
+                route.toString().c_str(),
+                getOwner().getName().c_str(),
+                cmd.getText().c_str());
+        man.addOutput(cmd.getText(), id, os);
+        break;
+    case '!':
+        yCDebug(PORTCOREINPUTUNIT,
+                "Port command (%s): %s should remove output: %s",
+                route.toString().c_str(),
+                getOwner().getName().c_str(),
+                cmd.getText().c_str());
+        man.removeOutput(cmd.getText().substr(1, std::string::npos), id, os);
+        break;
+    case '~':
+        yCDebug(PORTCOREINPUTUNIT,
+                "Port command (%s): %s should remove input: %s",
+                route.toString().c_str(),
+                getOwner().getName().c_str(),
+                cmd.getText().c_str());
+        man.removeInput(cmd.getText().substr(1, std::string::npos), id, os);
+        break;
+    case '*':
+        man.describe(id, os);
+        break;
+    case 'D':
+    case 'd': {
+        if (key == 'D') {
+            ip->suppressReply();
+        }
+
+        std::string env = cmd.getText();
+        if (env.length() > 2) {
+            yCTrace(PORTCOREINPUTUNIT, "***** received an envelope! [%s]", env.c_str());
+            std::string env2 = env.substr(2, env.length());
+            man.setEnvelope(env2);
+            ip->setEnvelope(env2);
+        }
+        readData(br, os);
+        if (!br.isActive()) {
+            done = true;
             break;
-        case 'q':
+        }
+    } break;
+    case 'b': {
+        // A batch of messages, each with its own envelope, see
+        // PortCoreBatch.  Batches never expect a reply.
+        ip->suppressReply();
+        bool ok = PortCoreBatch::read(br, route, [&](const std::string& env, ConnectionReader& reader) {
+            if (!env.empty()) {
+                man.setEnvelope(env);
+                ip->setEnvelope(env);
+            }
+            readData(reader, os);
+        });
+        if (!ok || !br.isActive()) {
             done = true;
             break;
+        }
+    } break;
+    case 'a': {
+        man.adminBlock(br, id);
+    } break;
+    case 'r':
+        /*
+          In YARP implementation, OP=IP.
+          (This information is used rarely, and when used
+          is tagged with OP=IP keyword)
+          If it were not true, memory alloc would need to
+          reorganized here
+        */
+        {
+            OutputProtocol* op = &(ip->getOutput());
+            ip->endRead();
+            Route r = op->getRoute();
+            // reverse route
+            r.swapNames();
+            op->rename(r);
+
+            getOwner().addOutput(op);
+            ip = nullptr;
+            done = true;
+        }
+        break;
+    case 'q':
+        done = true;
+        break;
 #if !defined(NDEBUG)
-        case 'i':
-            printf("Interrupt requested\n");
-            //yarp::os::impl::kill(0, 2); // SIGINT
-            //yarp::os::impl::kill(yarp::os::getpid(), 2); // SIGINT
-            yarp::os::impl::kill(yarp::os::getpid(), 15); // SIGTERM
-            break;
+    case 'i':
+        printf("Interrupt requested\n");
+        //yarp::os::impl::kill(0, 2); // SIGINT
+        //yarp::os::impl::kill(yarp::os::getpid(), 2); // SIGINT
+        yarp::os::impl::kill(yarp::os::getpid(), 15); // SIGTERM
+        break;
 #endif
-        case '?':
-        case 'h':
-            if (os != nullptr) {
-                BufferedConnectionWriter bw(true);
-                bw.appendLine("This is a YARP port.  Here are the commands it responds to:");
-                bw.appendLine("*       Gives a description of this port");
-                bw.appendLine("d       Signals the beginning of input for the port's owner");
-                bw.appendLine(R"(do      The same as "d" except replies should be suppressed ("data-only"))");
-                bw.appendLine("q       Disconnects");
+    case '?':
+    case 'h':
+        if (os != nullptr) {
+            BufferedConnectionWriter bw(true);
+            bw.appendLine("This is a YARP port.  Here are the commands it responds to:");
+            bw.appendLine("*       Gives a description of this port");
+            bw.appendLine("d       Signals the beginning of input for the port's owner");
+            bw.appendLine(R"(do      The same as "d" except replies should be suppressed ("data-only"))");
+            bw.appendLine("q       Disconnects");
 #if !defined(NDEBUG)
-                bw.appendLine("i       Interrupt parent process (unix only)");
+            bw.appendLine("i       Interrupt parent process (unix only)");
 #endif
-                bw.appendLine("r       Reverse connection type to be a reader");
-                bw.appendLine("/port   Requests to send output to /port");
-                bw.appendLine("!/port  Requests to stop sending output to /port");
-                bw.appendLine("~/port  Requests to stop receiving input from /port");
-                bw.appendLine("a       Signals the beginning of an administrative message");
-                bw.appendLine("?       Gives this help");
-                bw.write(*os);
-            }
-            break;
-        default:
-            if (os != nullptr) {
-                BufferedConnectionWriter bw(true);
-                bw.appendLine("Port command not understood.");
-                bw.appendLine("Type d to send data to the port's owner.");
-                bw.appendLine("Type ? for help.");
-                bw.write(*os);
-            }
-            break;
+            bw.appendLine("r       Reverse connection type to be a reader");
+            bw.appendLine("/port   Requests to send output to /port");
+            bw.appendLine("!/port  Requests to stop sending output to /port");
+            bw.appendLine("~/port  Requests to stop receiving input from /port");
+            bw.appendLine("a       Signals the beginning of an administrative message");
+            bw.appendLine("b       Signals the beginning of a batch of messages for the port's owner");
+            bw.appendLine("?       Gives this help");
+            bw.write(*os);
         }
-        if (ip != nullptr) {
-            ip->endRead();
-        }
-        if (ip == nullptr) {
-            break;
+        break;
+    default:
+        if (os != nullptr) {
+            BufferedConnectionWriter bw(true);
+            bw.appendLine("Port command not understood.");
+            bw.appendLine("Type d to send data to the port's owner.");
+            bw.appendLine("Type ? for help.");
+            bw.write(*os);
         }
-        if (closing || isDoomed() || (!ip->isOk())) {
-            break;
+        break;
+    }
+    if (ip != nullptr) {
+        ip->endRead();
+    }
+    if (ip == nullptr) {
+        return false;
+    }
+    if (closing || isDoomed() || (!ip->isOk())) {
+        return false;
+    }
+    return !done;
+}
+
+
+void PortCoreInputUnit::readData(ConnectionReader& reader, OutputStream* os)
+{
+    void* id = (void*)this;
+    PortCore& man = getOwner();
+
+    // the time taken to read the message includes the time taken by
+    // the reader (e.g. a callback) to handle it
+    size_t bytes = reader.getSize();
+    auto start = std::chrono::steady_clock::now();
+    if (localReader != nullptr) {
+        localReader->read(reader);
+        statistics.addMessage(bytes, std::chrono::steady_clock::now() - start);
+        return;
+    }
+
+    bool accepted = true;
+    if (ip->getReceiver().acceptIncomingData(reader)) {
+        ConnectionReader* cr = &(ip->getReceiver().modifyIncomingData(reader));
+        yarp::os::impl::PortDataModifier& modifier = getOwner().getPortModifier();
+        modifier.inputMutex.lock();
+        if (modifier.inputModifier != nullptr) {
+            if (modifier.inputModifier->acceptIncomingData(*cr)) {
+                cr = &(modifier.inputModifier->modifyIncomingData(*cr));
+                modifier.inputMutex.unlock();
+                man.readBlock(*cr, id, os);
+            } else {
+                modifier.inputMutex.unlock();
+                skipIncomingData(*cr);
+                accepted = false;
+            }
+        } else {
+            modifier.inputMutex.unlock();
+            man.readBlock(*cr, id, os);
         }
+    } else {
+        skipIncomingData(reader);
+        accepted = false;
+    }
+    if (accepted) {
+        statistics.addMessage(bytes, std::chrono::steady_clock::now() - start);
+    } else {
+        statistics.addSkipped();
     }
+}
+
 
+void PortCoreInputUnit::finish()
+{
     setDoomed();
 
     yCDebug(PORTCOREINPUTUNIT, "Closing ip");
@@ -436,6 +499,100 @@ void PortCoreInputUnit::run()
     // it would be nice to get my entry removed from the port immediately,
     // but it would be a bit dodgy to delete this object and join this
     // thread within and from themselves
+
+    if (reactive) {
+        // let closeMain() know that the reactor is done with us
+        released.post();
+    }
+}
+
+bool PortCoreInputUnit::attachToReactor()
+{
+    // Only data connections read into a buffer that never waits for the
+    // user, nor runs user code, are served by the reactor.  Anything else
+    // (per-connection readers, plain Port reads, RpcServer, replies
+    // handled by the user) keeps its thread.
+    if (ip == nullptr || reversed) {
+        return false;
+    }
+    if (localReader != nullptr || !getOwner().hasNonBlockingReader()) {
+        return false;
+    }
+    if (!PortCoreReactor::isEnabled()) {
+        return false;
+    }
+    std::string carrier = ip->getConnection().getName();
+    if (carrier != "tcp" && carrier != "fast_tcp") {
+        return false;
+    }
+    auto* protocol = dynamic_cast<Protocol*>(ip);
+    if (protocol == nullptr) {
+        return false;
+    }
+    auto* shift = dynamic_cast<ShiftStream*>(&protocol->getStreams());
+    if (shift == nullptr) {
+        return false;
+    }
+    auto* stream = dynamic_cast<SocketTwoWayStream*>(shift->getStream());
+    if (stream == nullptr) {
+        return false;
+    }
+
+    // interrupt() closes the socket, hold the lock while registering it
+    access.wait();
+    if (!closing && stream->isOk()) {
+        reactive = true;
+        reactorStream = stream;
+        if (!PortCoreReactor::add(this, stream->getHandle())) {
+            reactive = false;
+            reactorStream = nullptr;
+        }
+    }
+    access.post();
+
+    if (reactive) {
+        yCDebug(PORTCOREINPUTUNIT, "[%s] served by the input reactor", officialRoute.toString().c_str());
+    }
+    return reactive;
+}
+
+bool PortCoreInputUnit::prefetchMessage()
+{
+    if (reactorStream == nullptr) {
+        return true;
+    }
+
+    // A message of the tcp carriers is made of the index header (8 bytes),
+    // the index (10 bytes, starting with the number of blocks), the
+    // lengths of the blocks, and the blocks (see
+    // AbstractCarrier::defaultSendIndex()).  Wait until all of it is
+    // there, the worker must not block in the middle of a message.
+    constexpr size_t indexLength = 8 + 10;
+    if (!reactorStream->prefetch(indexLength)) {
+        return false;
+    }
+    if (!reactorStream->isOk()) {
+        return true;
+    }
+    const char* index = reactorStream->getPrefetched() + 8;
+    size_t blocks = static_cast<unsigned char>(index[0]) + static_cast<unsigned char>(index[1]);
+    size_t length = indexLength + blocks * sizeof(NetInt32);
+    if (!reactorStream->prefetch(length)) {
+        return false;
+    }
+    if (!reactorStream->isOk()) {
+        return true;
+    }
+    const char* lengths = reactorStream->getPrefetched() + indexLength;
+    for (size_t i = 0; i < blocks; i++) {
+        int len = NetType::netInt(Bytes(const_cast<char*>(lengths) + i * sizeof(NetInt32), sizeof(NetInt32)));
+        if (len < 0) {
+            // broken index, let step() report it
+            return true;
+        }
+        length += static_cast<size_t>(len);
+    }
+    return reactorStream->prefetch(length);
 }
 
 bool PortCoreInputUnit::isInput()
@@ -507,6 +664,14 @@ void PortCoreInputUnit::closeMain()
         yCDebug(PORTCOREINPUTUNIT, "[%s] joined", r.toString().c_str());
     }
 
+    if (reactive) {
+        yCDebug(PORTCOREINPUTUNIT, "[%s] releasing from reactor", r.toString().c_str());
+        PortCoreReactor::remove(this);
+        released.wait();
+        reactive = false;
+        yCDebug(PORTCOREINPUTUNIT, "[%s] released from reactor", r.toString().c_str());
+    }
+
     if (ip != nullptr) {
         ip->close();
         delete ip;
@@ -12,6 +12,7 @@
 
 #include <yarp/os/InputProtocol.h>
 #include <yarp/os/Semaphore.h>
+#include <yarp/os/impl/PortCommand.h>
 #include <yarp/os/impl/PortCore.h>
 #include <yarp/os/impl/PortCoreUnit.h>
 
@@ -19,6 +20,8 @@ namespace yarp {
 namespace os {
 namespace impl {
 
+class SocketTwoWayStream;
+
 /**
  * Manager for a single input to a port.  Associated
  * with a PortCore object.
@@ -58,7 +61,12 @@ public:
      *
      * The body of the thread associated with this input. Accepts
      * and processes administrative input, and makes sure regular
-     * data gets to the user
+     * data gets to the user.
+     *
+     * Once the connection is established, if the input reactor is
+     * enabled and the connection can be served without a dedicated
+     * thread, the connection is handed over to the reactor and the
+     * thread terminates.
      *
      */
     void run() override;
@@ -85,16 +93,42 @@ public:
     bool isBusy() override;
 
 private:
+    friend class PortCoreReactorPrivate;
+
     InputProtocol* ip;
-    yarp::os::Semaphore phase, access;
-    bool closing, finished, running;
+    yarp::os::Semaphore phase, access, released;
+    bool closing, finished, running, reactive;
+    SocketTwoWayStream* reactorStream;
     std::string name;
     yarp::os::PortReader* localReader;
     Route officialRoute;
     bool reversed;
+    Route route;
+    bool wasNoticed;
+    bool posted;
+    PortCommand cmd;
 
     void closeMain();
 
+    // establish the connection, return false if there is nothing to read
+    bool setup();
+
+    // read and process one message, return false when done
+    bool step();
+
+    // pass the data of a message to the reader of the port
+    void readData(yarp::os::ConnectionReader& reader, yarp::os::OutputStream* os);
+
+    // shut down the connection
+    void finish();
+
+    // try to hand the connection over to the input reactor
+    bool attachToReactor();
+
+    // read what has arrived of the next message, without blocking, return
+    // true when step() can read the whole message without blocking
+    bool prefetchMessage();
+
     bool skipIncomingData(yarp::os::ConnectionReader& reader);
 
     static void envelopeReadCallback(void* data, const Bytes& envelope);
@@ -12,11 +12,17 @@
 #include <yarp/os/Name.h>
 #include <yarp/os/PortInfo.h>
 #include <yarp/os/PortReport.h>
+#include <yarp/os/PortWriterBufferBase.h>
 #include <yarp/os/Portable.h>
 #include <yarp/os/Time.h>
 #include <yarp/os/impl/BufferedConnectionWriter.h>
+#include <yarp/os/impl/LocalCarrier.h>
 #include <yarp/os/impl/LogComponent.h>
 #include <yarp/os/impl/PortCommand.h>
+#include <yarp/os/impl/PortCoreBatch.h>
+#include <yarp/os/impl/TcpCarrier.h>
+
+#include <chrono>
 
 namespace {
 YARP_OS_LOG_COMPONENT(PORTCOREOUTPUTUNIT, "yarp.os.impl.PortCoreOutputUnit")
@@ -39,7 +45,8 @@ PortCoreOutputUnit::PortCoreOutputUnit(PortCore& owner, int index, OutputProtoco
         cachedWriter(nullptr),
         cachedReader(nullptr),
         cachedCallback(nullptr),
-        cachedTracker(nullptr)
+        cachedTracker(nullptr),
+        cachedPacket(nullptr)
 {
     yCAssert(PORTCOREOUTPUTUNIT, op != nullptr);
 }
@@ -253,6 +260,42 @@ Route PortCoreOutputUnit::getRoute()
 }
 
 bool PortCoreOutputUnit::sendHelper()
+{
+    // The connections that cannot pass a batch of messages as it is get
+    // its messages one by one, each with its own envelope.
+    const auto* batch = dynamic_cast<const PortCoreBatch*>(cachedWriter);
+    if (batch == nullptr || op == nullptr) {
+        return sendMessage(false);
+    }
+    if (canSendBatch()) {
+        return sendMessage(true);
+    }
+    bool replied = false;
+    for (const auto& item : batch->getItems()) {
+        if (finished) {
+            break;
+        }
+        cachedWriter = item.writer;
+        cachedEnvelope = item.envelope;
+        replied = sendMessage(false);
+    }
+    cachedWriter = batch;
+    return replied;
+}
+
+bool PortCoreOutputUnit::canSendBatch()
+{
+    // Only the tcp receivers tell whether they know the "b" command,
+    // the older ones would not read the batches.
+    Connection& connection = op->getConnection();
+    const auto* tcp = dynamic_cast<const TcpCarrier*>(&connection);
+    if (tcp == nullptr || !tcp->acceptsBatches()) {
+        return false;
+    }
+    return !connection.isTextMode() && !connection.isBareMode() && !op->getSender().modifiesOutgoingData();
+}
+
+bool PortCoreOutputUnit::sendMessage(bool batch)
 {
     bool replied = false;
     if (op != nullptr) {
@@ -262,6 +305,8 @@ bool PortCoreOutputUnit::sendHelper()
         if (cachedReader != nullptr) {
             buf.setReplyHandler(*cachedReader);
         }
+        // refers to the object sent on a local connection, see below
+        LocalCarrierReference localReference;
 
         if (op->getSender().modifiesOutgoingData()) {
             if (op->getSender().acceptOutgoingData(*cachedWriter)) {
@@ -282,12 +327,50 @@ bool PortCoreOutputUnit::sendHelper()
                 yCError(PORTCOREOUTPUTUNIT, "cast failed.");
                 return false;
             }
-            buf.setReference(p);
+            // When the object is reference counted (e.g. it comes from a
+            // BufferedPort), and this is the only connection carrying it,
+            // hand over a handle to it, so that the reader can keep it
+            // instead of copying it.  Otherwise each reader takes its own
+            // copy, while the sender waits.
+            std::shared_ptr<yarp::os::Portable> shared;
+            const auto* wrapper = dynamic_cast<const yarp::os::PortWriterWrapper*>(cachedCallback);
+            if (wrapper != nullptr && cachedPacket != nullptr && cachedPacket->shareable) {
+                shared = wrapper->getShared();
+            }
+            if (shared != nullptr && shared.get() == p) {
+                localReference = LocalCarrierReference(shared);
+                buf.setReference(&localReference);
+            } else {
+                buf.setReference(p);
+            }
         } else {
             yCAssert(PORTCOREOUTPUTUNIT, cachedWriter != nullptr);
-            bool ok = cachedWriter->write(buf);
-            if (!ok) {
-                done = true;
+            // Connections that do not alter the payload share a single
+            // serialization of the message, cached in the packet.
+            // Text mode connections and connections with a portmonitor
+            // need their own.  The encodings computed by the carriers
+            // (e.g. compressed images) are shared unless a portmonitor
+            // changed the content.
+            std::shared_ptr<BufferedConnectionWriter> payload;
+            if (cachedPacket != nullptr && cachedPacket->getContent() == cachedWriter) {
+                buf.setEncodingCache(cachedPacket);
+                if (!buf.isTextMode()) {
+                    payload = cachedPacket->getPayload(buf.isBareMode());
+                }
+            }
+            if (payload != nullptr) {
+                for (size_t i = 0; i < payload->length(); i++) {
+                    buf.appendBlock(Bytes(const_cast<char*>(payload->data(i)), payload->length(i)));
+                }
+                if (payload->dropRequested()) {
+                    buf.requestDrop();
+                }
+            } else {
+                bool ok = cachedWriter->write(buf);
+                if (!ok) {
+                    statistics.addError();
+                    done = true;
+                }
             }
 
             bool suppressReply = (buf.getReplyHandler() == nullptr);
@@ -300,7 +383,11 @@ bool PortCoreOutputUnit::sendHelper()
                 } else {
                     buf.addToHeader();
 
-                    if (!cachedEnvelope.empty()) {
+                    if (batch) {
+                        // the envelopes are in the batch
+                        PortCommand pc('b', "");
+                        pc.write(buf);
+                    } else if (!cachedEnvelope.empty()) {
                         if (cachedEnvelope == "__ADMIN") {
                             PortCommand pc('a', "");
                             pc.write(buf);
@@ -318,12 +405,17 @@ bool PortCoreOutputUnit::sendHelper()
 
         if (!done) {
             if (op->getConnection().isActive()) {
+                auto start = std::chrono::steady_clock::now();
                 replied = op->write(buf);
+                if (op->isOk()) {
+                    statistics.addMessage(buf.dataSize(), std::chrono::steady_clock::now() - start);
+                }
                 if (replied && op->getSender().modifiesReply() && cachedReader != nullptr) {
                     cachedReader = &op->getSender().modifyReply(*cachedReader);
                 }
             }
             if (!op->isOk()) {
+                statistics.addError();
                 done = true;
             }
         }
@@ -378,6 +470,7 @@ void* PortCoreOutputUnit::send(const yarp::os::PortWriter& writer,
         cachedReader = reader;
         cachedCallback = callback;
         cachedEnvelope = envelopeString;
+        cachedPacket = static_cast<PortCorePacket*>(tracker);
 
         sending = true;
         if (waitAfter) {
@@ -393,6 +486,7 @@ void* PortCoreOutputUnit::send(const yarp::os::PortWriter& writer,
         }
     } else {
         yCDebug(PORTCOREOUTPUTUNIT, "skipping connection tagged as sending something");
+        statistics.addSkipped();
     }
 
     if (waitAfter) {
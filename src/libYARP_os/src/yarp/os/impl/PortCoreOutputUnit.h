@@ -121,13 +121,26 @@ private:
     const yarp::os::PortWriter* cachedCallback; ///< where to sent commencement and
                                           ///< completion events
     void *cachedTracker;        ///< memory tracker for current message
+    PortCorePacket* cachedPacket; ///< packet being sent, holds the shared serialization
     std::string cachedEnvelope;      ///< some text to pass along with the message
 
     /**
-     * The core logic for sending a message.
+     * The core logic for sending a message, or the messages of a batch.
      */
     bool sendHelper();
 
+    /**
+     * Send a single message.
+     * @param batch true if the message is a batch of messages (see
+     *              PortCoreBatch) to be unpacked by the other side
+     */
+    bool sendMessage(bool batch);
+
+    /**
+     * @return true if the other side can unpack a batch of messages
+     */
+    bool canSendBatch();
+
     /**
      * Try to close the connection, but not very hard.
      */
@@ -12,6 +12,15 @@
 
 #include <yarp/os/NetType.h>
 #include <yarp/os/PortWriter.h>
+#include <yarp/os/impl/BufferedConnectionWriter.h>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace yarp {
 namespace os {
@@ -32,6 +41,14 @@ public:
     bool owned;                           ///< should we memory-manage the content object
     bool ownedCallback;                   ///< should we memory-manage the callback object
     bool completed;                       ///< has a notification of completion been sent
+    bool shareable;                       ///< can the content be handed over to a local reader
+
+    std::mutex payloadMutex;                           ///< protect the serialization cache
+    std::shared_ptr<BufferedConnectionWriter> payload; ///< content serialized once, shared by connections
+    bool payloadReady;                                 ///< has the content been serialized into payload
+    bool payloadOk;                                    ///< did serialization of the content succeed
+    std::mutex encodingsMutex;                         ///< protect the encodings cache
+    std::map<std::string, std::shared_ptr<const std::vector<unsigned char>>> encodings; ///< content encoded by carriers, shared by connections
 
     /**
      * Constructor.
@@ -44,7 +61,14 @@ public:
             ct(0),
             owned(false),
             ownedCallback(false),
-            completed(false)
+            completed(false),
+            shareable(false),
+            payloadMutex(),
+            payload(nullptr),
+            payloadReady(false),
+            payloadOk(false),
+            encodingsMutex(),
+            encodings()
     {
         reset();
     }
@@ -117,6 +141,70 @@ public:
         this->owned = owned;
         this->ownedCallback = ownedCallback;
         completed = false;
+        shareable = false;
+        payloadReady = false;
+        payloadOk = false;
+        encodings.clear();
+    }
+
+    /**
+     * Get the binary serialization of the content, shared among all the
+     * connections carrying this message.  The content is serialized the
+     * first time this is called, later calls reuse the cached bytes.
+     * Only connections that do not alter the payload (i.e. no text mode,
+     * no portmonitor) should use this.
+     *
+     * @param bareMode the bare mode flag of the requesting connection
+     * @return the cached serialization, or nullptr if the content could not
+     *         be serialized or was serialized for a different bare mode
+     */
+    std::shared_ptr<BufferedConnectionWriter> getPayload(bool bareMode)
+    {
+        std::lock_guard<std::mutex> lock(payloadMutex);
+        if (!payloadReady) {
+            if (content == nullptr) {
+                return nullptr;
+            }
+            // Buffers are kept across messages, unless someone is still
+            // holding on to the previous serialization.
+            if (payload == nullptr || payload.use_count() > 1 || payload->isBareMode() != bareMode || payload->dropRequested()) {
+                payload = std::make_shared<BufferedConnectionWriter>(false, bareMode);
+            } else {
+                payload->restart();
+            }
+            payloadOk = content->write(*payload);
+            payloadReady = true;
+        }
+        if (!payloadOk || payload->isBareMode() != bareMode) {
+            return nullptr;
+        }
+        return payload;
+    }
+
+    /**
+     * Get an encoding of the content computed by a carrier (e.g. a
+     * compressed image), shared among all the connections carrying this
+     * message.  The encoding is computed the first time a key is asked for,
+     * later calls with the same key reuse it.
+     * Only connections that do not alter the payload should use this.
+     *
+     * @param key identifies the encoding and its parameters
+     * @param encode computes the encoding, returns false on failure
+     * @return the encoding, or nullptr if it could not be computed
+     */
+    std::shared_ptr<const std::vector<unsigned char>> getEncoding(const std::string& key,
+                                                                  const std::function<bool(std::vector<unsigned char>&)>& encode)
+    {
+        std::lock_guard<std::mutex> lock(encodingsMutex);
+        auto it = encodings.find(key);
+        if (it == encodings.end()) {
+            auto encoding = std::make_shared<std::vector<unsigned char>>();
+            if (!encode(*encoding)) {
+                encoding.reset();
+            }
+            it = encodings.emplace(key, std::move(encoding)).first;
+        }
+        return it->second;
     }
 
     /**
@@ -136,6 +224,10 @@ public:
         owned = false;
         ownedCallback = false;
         completed = false;
+        shareable = false;
+        payloadReady = false;
+        payloadOk = false;
+        encodings.clear();
     }
 
     /**
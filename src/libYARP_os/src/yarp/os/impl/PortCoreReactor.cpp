@@ -0,0 +1,344 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <yarp/os/impl/PortCoreReactor.h>
+
+#include <yarp/os/Network.h>
+#include <yarp/os/impl/LogComponent.h>
+#include <yarp/os/impl/PortCoreInputUnit.h>
+#include <yarp/os/impl/ThreadImpl.h>
+
+#include <cstdlib>
+#include <string>
+
+#if defined(__linux__)
+#    include <cerrno>
+#    include <cstdint>
+#    include <mutex>
+#    include <unordered_map>
+#    include <vector>
+#    include <sys/epoll.h>
+#    include <sys/eventfd.h>
+#    include <unistd.h>
+#endif
+
+using namespace yarp::os::impl;
+using namespace yarp::os;
+
+namespace {
+YARP_OS_LOG_COMPONENT(PORTCOREREACTOR, "yarp.os.impl.PortCoreReactor")
+
+int getThreadCount()
+{
+    std::string threads = NetworkBase::getEnvironment("YARP_PORT_INPUT_THREADS");
+    if (threads.empty()) {
+        return 0;
+    }
+    return std::atoi(threads.c_str());
+}
+} // namespace
+
+
+#if defined(__linux__)
+
+namespace yarp {
+namespace os {
+namespace impl {
+
+class PortCoreReactorPrivate
+{
+public:
+    class Worker :
+            public ThreadImpl
+    {
+    public:
+        explicit Worker(PortCoreReactorPrivate& owner) :
+                owner(owner)
+        {
+        }
+
+        void run() override
+        {
+            owner.serve();
+        }
+
+    private:
+        PortCoreReactorPrivate& owner;
+    };
+
+    struct Entry
+    {
+        PortCoreInputUnit* unit;
+        int handle;
+        bool busy;
+        bool closing;
+    };
+
+    // id of the events that stop the workers
+    static constexpr std::uint64_t stopId = 0;
+
+    explicit PortCoreReactorPrivate(int threads);
+    ~PortCoreReactorPrivate();
+
+    bool add(PortCoreInputUnit* unit, int handle);
+    void remove(PortCoreInputUnit* unit);
+    size_t size();
+
+private:
+    void serve();
+    void dispatch(std::uint64_t id);
+    bool rearm(PortCoreInputUnit* unit, int handle, std::uint64_t id);
+
+    int epfd;
+    int wakefd;
+    std::mutex mutex;
+    std::uint64_t lastId;
+    std::unordered_map<std::uint64_t, Entry> entries;
+    std::unordered_map<PortCoreInputUnit*, std::uint64_t> ids;
+    std::vector<Worker*> workers;
+};
+
+PortCoreReactorPrivate::PortCoreReactorPrivate(int threads) :
+        epfd(epoll_create1(EPOLL_CLOEXEC)),
+        wakefd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)),
+        lastId(stopId)
+{
+    if (epfd < 0 || wakefd < 0) {
+        yCError(PORTCOREREACTOR, "Cannot create the input reactor");
+        return;
+    }
+
+    // The stop event is level triggered and never consumed, so that
+    // once signalled it wakes up all the workers
+    epoll_event ev {};
+    ev.events = EPOLLIN;
+    ev.data.u64 = stopId;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, wakefd, &ev);
+
+    for (int i = 0; i < threads; i++) {
+        auto* worker = new Worker(*this);
+        if (!worker->start()) {
+            delete worker;
+            break;
+        }
+        workers.push_back(worker);
+    }
+    yCDebug(PORTCOREREACTOR, "Input reactor started with %zu threads", workers.size());
+}
+
+PortCoreReactorPrivate::~PortCoreReactorPrivate()
+{
+    if (wakefd >= 0) {
+        std::uint64_t one = 1;
+        if (::write(wakefd, &one, sizeof(one)) < 0) {
+            yCError(PORTCOREREACTOR, "Cannot stop the input reactor");
+        }
+    }
+    for (auto* worker : workers) {
+        worker->join();
+        delete worker;
+    }
+    workers.clear();
+    if (wakefd >= 0) {
+        ::close(wakefd);
+    }
+    if (epfd >= 0) {
+        ::close(epfd);
+    }
+}
+
+bool PortCoreReactorPrivate::add(PortCoreInputUnit* unit, int handle)
+{
+    if (workers.empty()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::uint64_t id = ++lastId;
+
+    // Each connection is served by a single worker at a time, and it is
+    // armed again after the data available has been read.
+    epoll_event ev {};
+    ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+    ev.data.u64 = id;
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, handle, &ev) != 0) {
+        yCDebug(PORTCOREREACTOR, "Cannot watch socket %d, errno %d", handle, errno);
+        return false;
+    }
+    entries[id] = Entry {unit, handle, false, false};
+    ids[unit] = id;
+    return true;
+}
+
+void PortCoreReactorPrivate::remove(PortCoreInputUnit* unit)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    auto it = ids.find(unit);
+    if (it == ids.end()) {
+        // already shut down by a worker
+        return;
+    }
+    Entry& entry = entries[it->second];
+    if (entry.busy) {
+        // the worker reading from the connection will shut it down
+        entry.closing = true;
+        return;
+    }
+    // There is no need to stop watching the socket, closing it is enough.
+    // A notification already picked up by a worker is ignored, since
+    // the id is not known anymore.
+    entries.erase(it->second);
+    ids.erase(it);
+    lock.unlock();
+    unit->finish();
+}
+
+size_t PortCoreReactorPrivate::size()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+void PortCoreReactorPrivate::serve()
+{
+    while (true) {
+        epoll_event ev;
+        int n = epoll_wait(epfd, &ev, 1, -1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            yCError(PORTCOREREACTOR, "epoll_wait failed, errno %d", errno);
+            return;
+        }
+        if (n == 0) {
+            continue;
+        }
+        if (ev.data.u64 == stopId) {
+            return;
+        }
+        dispatch(ev.data.u64);
+    }
+}
+
+void PortCoreReactorPrivate::dispatch(std::uint64_t id)
+{
+    PortCoreInputUnit* unit = nullptr;
+    int handle = -1;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(id);
+        if (it == entries.end() || it->second.closing) {
+            return;
+        }
+        it->second.busy = true;
+        unit = it->second.unit;
+        handle = it->second.handle;
+    }
+
+    // Read what has arrived so far without blocking, and dispatch the
+    // message only when it is complete.  Otherwise wait for the rest.
+    bool more = true;
+    if (unit->prefetchMessage()) {
+        more = unit->step();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Entry& entry = entries[id];
+        entry.busy = false;
+        if (more && !entry.closing && rearm(unit, handle, id)) {
+            return;
+        }
+        entries.erase(id);
+        ids.erase(unit);
+    }
+    unit->finish();
+}
+
+bool PortCoreReactorPrivate::rearm(PortCoreInputUnit* unit, int handle, std::uint64_t id)
+{
+    // interrupt() closes the socket, and the handle could be reused by a
+    // new connection, so check that it is still ours while holding the lock
+    bool ok = false;
+    unit->access.wait();
+    if (!unit->closing && unit->ip != nullptr && unit->ip->isOk()) {
+        epoll_event ev {};
+        ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+        ev.data.u64 = id;
+        ok = (epoll_ctl(epfd, EPOLL_CTL_MOD, handle, &ev) == 0);
+    }
+    unit->access.post();
+    return ok;
+}
+
+} // namespace impl
+} // namespace os
+} // namespace yarp
+
+namespace {
+PortCoreReactorPrivate* getReactor()
+{
+    // created on first use, with the number of threads requested at
+    // that time
+    static PortCoreReactorPrivate reactor(getThreadCount());
+    return &reactor;
+}
+} // namespace
+
+bool PortCoreReactor::isEnabled()
+{
+    return getThreadCount() > 0;
+}
+
+bool PortCoreReactor::add(PortCoreInputUnit* unit, int handle)
+{
+    return getReactor()->add(unit, handle);
+}
+
+void PortCoreReactor::remove(PortCoreInputUnit* unit)
+{
+    getReactor()->remove(unit);
+}
+
+size_t PortCoreReactor::getConnectionCount()
+{
+    if (!isEnabled()) {
+        return 0;
+    }
+    return getReactor()->size();
+}
+
+#else // defined(__linux__)
+
+bool PortCoreReactor::isEnabled()
+{
+    if (getThreadCount() > 0) {
+        yCWarningOnce(PORTCOREREACTOR, "YARP_PORT_INPUT_THREADS is not supported on this platform");
+    }
+    return false;
+}
+
+bool PortCoreReactor::add(PortCoreInputUnit* unit, int handle)
+{
+    YARP_UNUSED(unit);
+    YARP_UNUSED(handle);
+    return false;
+}
+
+void PortCoreReactor::remove(PortCoreInputUnit* unit)
+{
+    YARP_UNUSED(unit);
+}
+
+size_t PortCoreReactor::getConnectionCount()
+{
+    return 0;
+}
+
+#endif // defined(__linux__)
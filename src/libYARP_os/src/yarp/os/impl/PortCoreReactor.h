@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#ifndef YARP_OS_IMPL_PORTCOREREACTOR_H
+#define YARP_OS_IMPL_PORTCOREREACTOR_H
+
+#include <yarp/os/api.h>
+
+#include <cstddef>
+
+namespace yarp {
+namespace os {
+namespace impl {
+
+class PortCoreInputUnit;
+
+/**
+ * A small pool of threads serving the input connections of all the ports
+ * of the process, in place of one thread per connection.
+ *
+ * The reactor is enabled by setting the YARP_PORT_INPUT_THREADS
+ * environment variable to the number of threads to use.  It is currently
+ * available on Linux only, where it is based on epoll.
+ *
+ * A PortCoreInputUnit keeps its own thread while the connection is being
+ * established.  After that, tcp data connections to ports that read their
+ * input into a buffer that never waits for the user (e.g. a BufferedPort
+ * without a replier, see PortReaderBufferBase::isNonBlocking()) are
+ * registered here and the thread of the unit terminates.  When data
+ * arrives on one of these connections, one of the threads of the reactor
+ * reads what is available without blocking, and once a message is
+ * complete hands it over to the port.  Connections whose reader may wait
+ * for the user or run user code (e.g. a plain Port, an RpcServer, or a
+ * DeviceResponder) keep their own thread.
+ */
+class YARP_os_impl_API PortCoreReactor
+{
+public:
+    /**
+     * @return true if input connections should be handed over to the
+     * reactor
+     */
+    static bool isEnabled();
+
+    /**
+     * Start serving an input connection.
+     *
+     * @param unit the input connection
+     * @param handle the socket of the connection
+     * @return true if the reactor is now responsible for reading from the
+     * connection
+     */
+    static bool add(PortCoreInputUnit* unit, int handle);
+
+    /**
+     * Stop serving an input connection.  If the reactor is not reading a
+     * message from the connection, the connection is shut down by the
+     * caller, otherwise by the reactor as soon as the read is over.
+     *
+     * @param unit the input connection
+     */
+    static void remove(PortCoreInputUnit* unit);
+
+    /**
+     * @return the number of connections currently served by the reactor
+     */
+    static size_t getConnectionCount();
+};
+
+} // namespace impl
+} // namespace os
+} // namespace yarp
+
+#endif // YARP_OS_IMPL_PORTCOREREACTOR_H
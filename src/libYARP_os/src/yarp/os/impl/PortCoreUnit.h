@@ -12,6 +12,7 @@
 
 #include <yarp/os/Name.h>
 #include <yarp/os/impl/PortCore.h>
+#include <yarp/os/impl/PortStatistics.h>
 #include <yarp/os/impl/ThreadImpl.h>
 
 #include <string>
@@ -271,6 +272,15 @@ public:
         YARP_UNUSED(params);
     }
 
+    /**
+     * @return the counters of the messages sent or received on this
+     * connection
+     */
+    const ConnectionStatistics& getStatistics() const
+    {
+        return statistics;
+    }
+
 
 protected:
     /**
@@ -281,6 +291,8 @@ protected:
         return owner;
     }
 
+    ConnectionStatistics statistics; ///< the messages sent or received
+
 private:
     PortCore& owner;       ///< the port to which this connection belongs
     bool doomed;           ///< whether the connection should shut down ASAP
@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <yarp/os/impl/PortStatistics.h>
+
+#include <yarp/os/Property.h>
+#include <yarp/os/Value.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace yarp::os::impl;
+using namespace yarp::os;
+
+namespace {
+
+// index of the highest bit set, x must not be 0
+int highestBit(std::uint64_t x)
+{
+    int bit = 0;
+    for (int shift = 32; shift > 0; shift >>= 1) {
+        if ((x >> shift) != 0) {
+            x >>= shift;
+            bit += shift;
+        }
+    }
+    return bit;
+}
+
+double toSeconds(std::uint64_t ns)
+{
+    return static_cast<double>(ns) * 1e-9;
+}
+
+Value* makeCounter(const std::atomic<std::uint64_t>& counter)
+{
+    return Value::makeInt64(static_cast<std::int64_t>(counter.load(std::memory_order_relaxed)));
+}
+
+} // namespace
+
+
+LatencyHistogram::LatencyHistogram() :
+        m_total(0),
+        m_sum(0),
+        m_max(0)
+{
+    for (auto& bucket : m_counts) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+size_t LatencyHistogram::bucketOf(std::uint64_t ns)
+{
+    if (ns < (1U << subBits)) {
+        return static_cast<size_t>(ns);
+    }
+    int exponent = highestBit(ns);
+    if (exponent > maxExponent) {
+        return buckets - 1;
+    }
+    int shift = exponent - subBits;
+    size_t sub = static_cast<size_t>(ns >> shift) & ((1U << subBits) - 1);
+    return (static_cast<size_t>(shift + 1) << subBits) + sub;
+}
+
+std::uint64_t LatencyHistogram::valueOf(size_t bucket)
+{
+    // the middle of the bucket
+    if (bucket < (1U << subBits)) {
+        return bucket;
+    }
+    int shift = static_cast<int>(bucket >> subBits) - 1;
+    std::uint64_t sub = bucket & ((1U << subBits) - 1);
+    std::uint64_t low = ((1U << subBits) + sub) << shift;
+    return low + ((std::uint64_t {1} << shift) >> 1);
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds duration)
+{
+    auto ns = static_cast<std::uint64_t>(std::max(duration.count(), static_cast<std::chrono::nanoseconds::rep>(0)));
+    m_counts[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+    m_total.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(ns, std::memory_order_relaxed);
+    std::uint64_t longest = m_max.load(std::memory_order_relaxed);
+    while (ns > longest && !m_max.compare_exchange_weak(longest, ns, std::memory_order_relaxed)) {
+    }
+}
+
+std::uint64_t LatencyHistogram::count() const
+{
+    return m_total.load(std::memory_order_relaxed);
+}
+
+double LatencyHistogram::percentile(double fraction) const
+{
+    // the buckets may be updated meanwhile, so their sum is used rather
+    // than m_total
+    std::array<std::uint64_t, buckets> counts;
+    std::uint64_t total = 0;
+    for (size_t i = 0; i < buckets; i++) {
+        counts[i] = m_counts[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) {
+        return 0.0;
+    }
+    fraction = std::min(std::max(fraction, 0.0), 1.0);
+    auto rank = static_cast<std::uint64_t>(std::ceil(fraction * static_cast<double>(total)));
+    rank = std::max(rank, std::uint64_t {1});
+    std::uint64_t seen = 0;
+    for (size_t i = 0; i < buckets; i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return toSeconds(std::min(valueOf(i), m_max.load(std::memory_order_relaxed)));
+        }
+    }
+    return max();
+}
+
+double LatencyHistogram::max() const
+{
+    return toSeconds(m_max.load(std::memory_order_relaxed));
+}
+
+void LatencyHistogram::report(Property& stats) const
+{
+    std::uint64_t total = count();
+    std::uint64_t sum = m_sum.load(std::memory_order_relaxed);
+    stats.put("count", Value::makeInt64(static_cast<std::int64_t>(total)));
+    stats.put("mean", (total != 0) ? toSeconds(sum) / static_cast<double>(total) : 0.0);
+    stats.put("p50", percentile(0.5));
+    stats.put("p90", percentile(0.9));
+    stats.put("p99", percentile(0.99));
+    stats.put("p999", percentile(0.999));
+    stats.put("max", max());
+}
+
+
+ConnectionStatistics::ConnectionStatistics() :
+        m_messages(0),
+        m_bytes(0),
+        m_errors(0),
+        m_skipped(0),
+        m_start(std::chrono::steady_clock::now())
+{
+}
+
+void ConnectionStatistics::addMessage(size_t bytes, std::chrono::nanoseconds duration)
+{
+    m_messages.fetch_add(1, std::memory_order_relaxed);
+    m_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    m_time.record(duration);
+}
+
+void ConnectionStatistics::addError()
+{
+    m_errors.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ConnectionStatistics::addSkipped()
+{
+    m_skipped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ConnectionStatistics::report(Property& stats) const
+{
+    std::chrono::duration<double> uptime = std::chrono::steady_clock::now() - m_start;
+    stats.put("messages", makeCounter(m_messages));
+    stats.put("bytes", makeCounter(m_bytes));
+    stats.put("errors", makeCounter(m_errors));
+    stats.put("skipped", makeCounter(m_skipped));
+    stats.put("uptime", uptime.count());
+    m_time.report(stats.addGroup("time"));
+}
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#ifndef YARP_OS_IMPL_PORTSTATISTICS_H
+#define YARP_OS_IMPL_PORTSTATISTICS_H
+
+#include <yarp/os/api.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace yarp {
+namespace os {
+
+class Property;
+
+namespace impl {
+
+/**
+ * A histogram of durations, that can be updated by several threads at the
+ * same time without locks.
+ *
+ * The buckets are log-linear, like in HDR histograms: each power of two
+ * is split in 16 buckets, so the percentiles are within 1/16 of the
+ * actual values, from 1 nanosecond up to 2^41 nanoseconds (about 36
+ * minutes).  Longer durations are counted in the last bucket.
+ *
+ * Recording a duration costs a few relaxed atomic increments, the
+ * percentiles are computed only when the histogram is reported.
+ */
+class YARP_os_impl_API LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    /**
+     * Record a duration.
+     */
+    void record(std::chrono::nanoseconds duration);
+
+    /**
+     * @return the number of durations recorded
+     */
+    std::uint64_t count() const;
+
+    /**
+     * @param fraction the fraction of the durations, between 0 and 1
+     *
+     * @return the duration, in seconds, that is longer than that fraction
+     * of the durations recorded, or 0 if none was recorded
+     */
+    double percentile(double fraction) const;
+
+    /**
+     * @return the longest duration recorded, in seconds
+     */
+    double max() const;
+
+    /**
+     * Add the count, the mean, the maximum and the 50th, 90th, 99th and
+     * 99.9th percentiles (count, mean, max, p50, p90, p99, p999) of the
+     * durations, in seconds.
+     */
+    void report(yarp::os::Property& stats) const;
+
+private:
+    static constexpr int subBits = 4;
+    static constexpr int maxExponent = 40;
+    static constexpr size_t buckets = (maxExponent - subBits + 2) << subBits;
+
+    static size_t bucketOf(std::uint64_t ns);
+    static std::uint64_t valueOf(size_t bucket);
+
+    std::array<std::atomic<std::uint64_t>, buckets> m_counts;
+    std::atomic<std::uint64_t> m_total;
+    std::atomic<std::uint64_t> m_sum;
+    std::atomic<std::uint64_t> m_max;
+};
+
+
+/**
+ * Counters of the messages passing through a connection, updated by the
+ * thread serving it and read by the administrative interface of the port.
+ */
+class YARP_os_impl_API ConnectionStatistics
+{
+public:
+    ConnectionStatistics();
+
+    /**
+     * Count a message.
+     *
+     * @param bytes the size of the message
+     * @param duration how long it took to send or to handle the message
+     */
+    void addMessage(size_t bytes, std::chrono::nanoseconds duration);
+
+    /**
+     * Count a message that could not be sent or received.
+     */
+    void addError();
+
+    /**
+     * Count a message that was not sent, because the connection was
+     * still busy with the previous one, or that was rejected when
+     * received.
+     */
+    void addSkipped();
+
+    /**
+     * Add the counters (messages, bytes, errors, skipped), the time since
+     * the connection was made (uptime) and the histogram of the durations
+     * (time) to a property.
+     */
+    void report(yarp::os::Property& stats) const;
+
+private:
+    std::atomic<std::uint64_t> m_messages;
+    std::atomic<std::uint64_t> m_bytes;
+    std::atomic<std::uint64_t> m_errors;
+    std::atomic<std::uint64_t> m_skipped;
+    std::chrono::steady_clock::time_point m_start;
+    LatencyHistogram m_time;
+};
+
+} // namespace impl
+} // namespace os
+} // namespace yarp
+
+#endif // YARP_OS_IMPL_PORTSTATISTICS_H
@@ -16,6 +16,11 @@
 #include <yarp/os/impl/TcpConnector.h>
 #include <yarp/os/impl/TcpStream.h>
 
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+
 #ifdef YARP_HAS_ACE
 #    include <ace/INET_Addr.h>
 #    include <ace/os_include/netinet/os_tcp.h>
@@ -27,11 +32,28 @@
 #    include <netinet/tcp.h>
 #endif
 
+#if defined(__linux__)
+#    include <sys/socket.h>
+#endif
+
 using namespace yarp::os;
 using namespace yarp::os::impl;
 
 YARP_OS_LOG_COMPONENT(SOCKETTWOWAYSTREAM, "yarp.os.impl.PortCoreOutputUnit")
 
+namespace {
+// While a packet is being written, writes up to this size (e.g. the
+// message index) are gathered and sent together with the next block.
+constexpr size_t coalesceLimit = 512;
+
+// Maximum number of blocks passed to a single system call.
+#if defined(IOV_MAX) && (IOV_MAX < 64)
+constexpr size_t maxBlocksPerCall = IOV_MAX;
+#else
+constexpr size_t maxBlocksPerCall = 64;
+#endif
+} // namespace
+
 int SocketTwoWayStream::open(const Contact& address)
 {
     if (address.getPort() == -1) {
@@ -153,3 +175,111 @@ int SocketTwoWayStream::getTypeOfService()
     stream.get_option(IPPROTO_IP, IP_TOS, (int*)&tos, &optlen);
     return tos;
 }
+
+void SocketTwoWayStream::write(const Bytes& b)
+{
+    if (!isOk()) {
+        return;
+    }
+    if (inPacket && b.length() <= coalesceLimit) {
+        pending.insert(pending.end(), b.get(), b.get() + b.length());
+        return;
+    }
+    sendv(&b, 1);
+}
+
+void SocketTwoWayStream::writev(const Bytes* blocks, size_t count)
+{
+    if (!isOk()) {
+        return;
+    }
+    sendv(blocks, count);
+}
+
+void SocketTwoWayStream::sendPending()
+{
+    if (!pending.empty() && isOk()) {
+        sendv(nullptr, 0);
+    }
+}
+
+void SocketTwoWayStream::sendv(const Bytes* blocks, size_t count)
+{
+    // Whatever was gathered goes first, in the same system call.
+    iovecs.clear();
+    if (!pending.empty()) {
+        iovec v;
+        v.iov_base = pending.data();
+        v.iov_len = pending.size();
+        iovecs.push_back(v);
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (blocks[i].length() > 0) {
+            iovec v;
+            v.iov_base = const_cast<char*>(blocks[i].get());
+            v.iov_len = blocks[i].length();
+            iovecs.push_back(v);
+        }
+    }
+
+    for (size_t first = 0; first < iovecs.size() && happy; first += maxBlocksPerCall) {
+        int n = static_cast<int>(std::min(maxBlocksPerCall, iovecs.size() - first));
+        yarp::conf::ssize_t result;
+        if (haveWriteTimeout) {
+            result = stream.sendv_n(&iovecs[first], n, &writeTimeout);
+        } else {
+            result = stream.sendv_n(&iovecs[first], n);
+        }
+        if (result < 0) {
+            happy = false;
+            yCDebug(SOCKETTWOWAYSTREAM, "bad socket write");
+        }
+    }
+    pending.clear();
+}
+
+bool SocketTwoWayStream::prefetch(size_t len)
+{
+#if defined(__linux__)
+    size_t available = prefetched.size() - prefetchedOffset;
+    if (available >= len || !isOk()) {
+        return true;
+    }
+    if (prefetchedOffset == prefetched.size()) {
+        prefetched.clear();
+        prefetchedOffset = 0;
+    }
+    size_t have = prefetched.size();
+    size_t missing = len - available;
+    prefetched.resize(have + missing);
+    yarp::conf::ssize_t result;
+    do {
+        result = ::recv(stream.get_handle(), prefetched.data() + have, missing, MSG_DONTWAIT);
+    } while (result < 0 && errno == EINTR);
+    if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        result = 0;
+    } else if (result <= 0) {
+        happy = false;
+        yCDebug(SOCKETTWOWAYSTREAM, "bad socket read");
+        result = 0;
+    }
+    prefetched.resize(have + static_cast<size_t>(result));
+    return static_cast<size_t>(result) == missing || !isOk();
+#else
+    // Not supported, the reads will block
+    YARP_UNUSED(len);
+    return true;
+#endif
+}
+
+yarp::conf::ssize_t SocketTwoWayStream::takePrefetched(Bytes& b)
+{
+    size_t len = std::min(b.length(), prefetched.size() - prefetchedOffset);
+    std::memcpy(b.get(), prefetched.data() + prefetchedOffset, len);
+    prefetchedOffset += len;
+    if (prefetchedOffset == prefetched.size()) {
+        prefetched.clear();
+        prefetchedOffset = 0;
+    }
+    return static_cast<yarp::conf::ssize_t>(len);
+}
@@ -29,6 +29,8 @@
 #    include <netinet/tcp.h>
 #endif
 
+#include <vector>
+
 YARP_DECLARE_LOG_COMPONENT(SOCKETTWOWAYSTREAM)
 
 namespace yarp {
@@ -47,7 +49,10 @@ public:
     SocketTwoWayStream() :
             haveWriteTimeout(false),
             haveReadTimeout(false),
-            happy(false)
+            happy(false),
+            inPacket(false),
+            corked(false),
+            prefetchedOffset(0)
     {
     }
 
@@ -96,6 +101,7 @@ public:
 
     void close() override
     {
+        sendPending();
         stream.close();
         happy = false;
     }
@@ -106,6 +112,10 @@ public:
         if (!isOk()) {
             return -1;
         }
+        sendPending();
+        if (prefetchedOffset < prefetched.size()) {
+            return takePrefetched(b);
+        }
         yarp::conf::ssize_t result;
         if (haveReadTimeout) {
             result = stream.recv_n(b.get(), b.length(), &readTimeout);
@@ -127,6 +137,10 @@ public:
         if (!isOk()) {
             return -1;
         }
+        sendPending();
+        if (prefetchedOffset < prefetched.size()) {
+            return takePrefetched(b);
+        }
         yarp::conf::ssize_t result;
         if (haveReadTimeout) {
             result = stream.recv(b.get(), b.length(), &readTimeout);
@@ -144,30 +158,15 @@ public:
     }
 
     using yarp::os::OutputStream::write;
-    void write(const Bytes& b) override
-    {
-        if (!isOk()) {
-            return;
-        }
-        yarp::conf::ssize_t result;
-        if (haveWriteTimeout) {
-            result = stream.send_n(b.get(), b.length(), &writeTimeout);
-        } else {
-            result = stream.send_n(b.get(), b.length());
-        }
-        if (result < 0) {
-            happy = false;
-            yCDebug(SOCKETTWOWAYSTREAM, "bad socket write");
-        }
-    }
+    void write(const Bytes& b) override;
+
+    void writev(const Bytes* blocks, size_t count) override;
 
     void flush() override
     {
+        sendPending();
 #ifdef TCP_CORK
-        int status = 0;
-        int sizeInt = sizeof(int);
-        stream.get_option(IPPROTO_TCP, TCP_CORK, &status, &sizeInt);
-        if (status == 1) {
+        if (corked) {
             // Remove CORK
             int zero = 0;
             stream.set_option(IPPROTO_TCP, TCP_CORK, &zero, sizeof(int));
@@ -189,19 +188,24 @@ public:
 
     void beginPacket() override
     {
+        inPacket = true;
 #ifdef TCP_CORK
         // Set CORK
         int one = 1;
         stream.set_option(IPPROTO_TCP, TCP_CORK, &one, sizeof(int));
+        corked = true;
 #endif
     }
 
     void endPacket() override
     {
+        sendPending();
+        inPacket = false;
 #ifdef TCP_CORK
         // Remove CORK
         int zero = 0;
         stream.set_option(IPPROTO_TCP, TCP_CORK, &zero, sizeof(int));
+        corked = false;
 #endif
     }
 
@@ -230,7 +234,39 @@ public:
     bool setTypeOfService(int tos) override;
     int getTypeOfService() override;
 
+    /**
+     * @return the handle of the underlying socket, for use with event
+     * notification mechanisms such as epoll
+     */
+    auto getHandle()
+    {
+        return stream.get_handle();
+    }
+
+    /**
+     * Read from the socket, without blocking, until at least `len` bytes
+     * are waiting to be consumed by the next reads.  Nothing more than
+     * that is taken from the socket.
+     *
+     * @param len the number of bytes needed
+     * @return true if they are available, or if the stream failed (the
+     * next read will report it), false if more data must arrive first
+     */
+    bool prefetch(size_t len);
+
+    /**
+     * @return the bytes read by prefetch() and not consumed yet
+     */
+    const char* getPrefetched() const
+    {
+        return prefetched.data() + prefetchedOffset;
+    }
+
 private:
+    void sendPending();
+    void sendv(const Bytes* blocks, size_t count);
+    yarp::conf::ssize_t takePrefetched(Bytes& b);
+
     yarp::os::impl::TcpStream stream;
     bool haveWriteTimeout;
     bool haveReadTimeout;
@@ -238,6 +274,12 @@ private:
     YARP_timeval readTimeout;
     Contact localAddress, remoteAddress;
     bool happy;
+    bool inPacket;
+    bool corked;
+    std::vector<char> pending;   ///< small writes gathered while in a packet
+    std::vector<iovec> iovecs;   ///< scratch space for sendv()
+    std::vector<char> prefetched; ///< bytes read ahead by prefetch()
+    size_t prefetchedOffset;      ///< bytes of prefetched already consumed
     void updateAddresses();
 };
 
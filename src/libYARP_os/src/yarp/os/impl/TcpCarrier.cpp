@@ -16,8 +16,15 @@
 
 using namespace yarp::os;
 
-
-yarp::os::impl::TcpCarrier::TcpCarrier(bool requireAckFlag)
+namespace {
+// The receivers that accept batches of messages add this flag, above any
+// port number, to the port number of their reply to the header.  The older
+// senders ignore the reply.
+constexpr int acceptsBatchesFlag = 0x10000;
+} // namespace
+
+yarp::os::impl::TcpCarrier::TcpCarrier(bool requireAckFlag) :
+        batchesAccepted(false)
 {
     this->requireAckFlag = requireAckFlag;
 }
@@ -74,12 +81,19 @@ bool yarp::os::impl::TcpCarrier::isConnectionless() const
 bool yarp::os::impl::TcpCarrier::respondToHeader(ConnectionState& proto)
 {
     int cport = proto.getStreams().getLocalAddress().getPort();
-    writeYarpInt(cport, proto);
+    writeYarpInt(cport | acceptsBatchesFlag, proto);
     return proto.checkStreams();
 }
 
 bool yarp::os::impl::TcpCarrier::expectReplyToHeader(ConnectionState& proto)
 {
-    readYarpInt(proto); // ignore result
+    // only the flags of the port number are used
+    int reply = readYarpInt(proto);
+    batchesAccepted = (reply >= 0 && (reply & acceptsBatchesFlag) != 0);
     return proto.checkStreams();
 }
+
+bool yarp::os::impl::TcpCarrier::acceptsBatches() const
+{
+    return batchesAccepted;
+}
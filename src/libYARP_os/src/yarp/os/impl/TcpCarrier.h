@@ -39,8 +39,15 @@ public:
     bool respondToHeader(yarp::os::ConnectionState& proto) override;
     bool expectReplyToHeader(yarp::os::ConnectionState& proto) override;
 
+    /**
+     * @return true if the receiver told, in its reply to the header, that
+     * it accepts batches of messages (the "b" port command)
+     */
+    bool acceptsBatches() const;
+
 private:
     bool requireAckFlag;
+    bool batchesAccepted;
 };
 
 } // namespace impl
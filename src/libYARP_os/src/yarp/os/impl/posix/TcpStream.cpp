@@ -13,6 +13,7 @@
 
 // General files
 #include <sys/socket.h>
+#include <cerrno>
 #include <cstdio>
 
 #include <yarp/os/impl/TcpStream.h>
@@ -57,5 +58,50 @@ int TcpStream::get_remote_addr (sockaddr & sa) {
     return 0;
 }
 
+ssize_t TcpStream::sendv_n(const struct iovec* iov, int iovcnt) {
+    ssize_t total = 0;
+    while (iovcnt > 0) {
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = const_cast<struct iovec*>(iov);
+        msg.msg_iovlen = iovcnt;
+        ssize_t n = ::sendmsg(sd, &msg, 0);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        total += n;
+
+        // Skip what was sent completely
+        while (iovcnt > 0 && static_cast<size_t>(n) >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+
+        // Finish a block that was sent partially, then go on with the others
+        if (iovcnt > 0 && n > 0) {
+            const char* rest = static_cast<const char*>(iov->iov_base) + n;
+            size_t len = iov->iov_len - n;
+            while (len > 0) {
+                ssize_t m = ::send(sd, rest, len, 0);
+                if (m < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    return -1;
+                }
+                rest += m;
+                len -= m;
+                total += m;
+            }
+            iov++;
+            iovcnt--;
+        }
+    }
+    return total;
+}
 
 #endif
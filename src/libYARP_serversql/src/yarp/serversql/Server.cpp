@@ -73,6 +73,8 @@ int yarp::serversql::Server::run(int argc, char** argv)
         yCInfo(SERVER, "  --subdb subs.db          Store subscription information in named database.\n");
         yCInfo(SERVER, "                           Must not be on an NFS file system.\n");
         yCInfo(SERVER, "                           Set to :memory: to store in memory (faster).\n");
+        yCInfo(SERVER, "  --cautious               Wait for the databases to reach the disk on each change.\n");
+        yCInfo(SERVER, "  --wal                    Use a write-ahead log for the database files.\n");
         yCInfo(SERVER, "  --ip IP.AD.DR.ESS        Set IP address of server.\n");
         yCInfo(SERVER, "  --socket NNNNN           Set port number of server.\n");
         yCInfo(SERVER, "  --web dir                Serve web resources from given directory.\n");
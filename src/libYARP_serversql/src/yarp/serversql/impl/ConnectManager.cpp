@@ -9,14 +9,56 @@
 
 #include <yarp/serversql/impl/ConnectManager.h>
 #include <yarp/serversql/impl/LogComponent.h>
+#include <yarp/serversql/impl/ParseName.h>
+
+#include <yarp/os/Bottle.h>
+#include <yarp/os/ContactStyle.h>
+#include <yarp/os/Network.h>
+#include <yarp/os/Port.h>
+#include <yarp/os/Vocab.h>
+
+#include <algorithm>
 
 using yarp::serversql::impl::ConnectManager;
+using yarp::serversql::impl::ParseName;
 
 namespace {
 YARP_SERVERSQL_LOG_COMPONENT(CONNECTMANAGER, "yarp.serversql.impl.ConnectManager")
+
+// Ask the source port to connect to the destination, in the admin session
+// of the worker
+bool addOutput(yarp::os::Port& session,
+               const yarp::os::Contact& contact,
+               const ConnectManager::Request& request)
+{
+    // Only the tcp connections between plain port names, the other ones
+    // may need the connection to be reversed, or the name server.
+    if (request.src != contact.getName() || contact.getCarrier() != "tcp") {
+        return false;
+    }
+    yarp::os::Contact dest = yarp::os::NetworkBase::queryName(request.dest);
+    if (!dest.isValid() || dest.getName() != request.dest || dest.getCarrier() != "tcp") {
+        return false;
+    }
+    yarp::os::Bottle cmd;
+    yarp::os::Bottle reply;
+    cmd.addVocab(yarp::os::createVocab('a', 'd', 'd'));
+    dest = yarp::os::Contact::fromString(request.dest);
+    dest.setCarrier("tcp");
+    cmd.addString(dest.toString());
+    if (!session.write(cmd, reply)) {
+        return false;
+    }
+    return reply.get(0).isInt32() && reply.get(0).asInt32() == 0;
+}
 } // namespace
 
-ConnectManager::ConnectManager() = default;
+ConnectManager::ConnectManager(size_t maxWorkers) :
+        maxWorkers(std::max<size_t>(maxWorkers, 1)),
+        idle(0),
+        closing(false)
+{
+}
 
 ConnectManager::~ConnectManager()
 {
@@ -24,13 +66,22 @@ ConnectManager::~ConnectManager()
 }
 
 void ConnectManager::clear() {
-    for (std::list<ConnectThread *>::iterator it = con.begin();
-         it != con.end(); it++) {
-        if ((*it) != nullptr) {
-            delete (*it);
-        }
+    std::vector<std::thread> stopped;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.clear();
+        ready.clear();
+        closing = true;
+        stopped.swap(workers);
+    }
+    changed.notify_all();
+    done.notify_all();
+    for (auto& worker : stopped) {
+        worker.join();
     }
-    con.clear();
+    std::lock_guard<std::mutex> lock(mutex);
+    idle = 0;
+    closing = false;
 }
 
 void ConnectManager::disconnect(const std::string& src,
@@ -45,52 +96,138 @@ void ConnectManager::connect(const std::string& src,
                              bool positive)
 {
     yCTrace(CONNECTMANAGER, "  ??? %s %s", src.c_str(), dest.c_str());
-    ConnectThread *t = nullptr;
-    yCTrace(CONNECTMANAGER, "***** %zd threads", con.size());
-    std::list<ConnectThread *>::iterator it = con.begin();
-    bool already = false;
-    while (it != con.end()) {
-        if ((*it) != nullptr) {
-            if (!(*it)->needed) {
-                if (t == nullptr) {
-                    yCTrace(CONNECTMANAGER, "***** reusing a thread");
-                    t = (*it);
-                    t->stop();
-                } else {
-                    yCTrace(CONNECTMANAGER, "***** deleting a thread");
-                    (*it)->stop();
-                    delete (*it);
-                    it = con.erase(it);
-                    continue;
-                }
-            } else {
-                if ((*it)->src == src && (*it)->dest == dest) {
-                    mutex.lock();
-                    yCTrace(CONNECTMANAGER,
-                            "??? prethread %d %d",
-                            (*it)->needed,
-                            (*it)->ct);
-                    if ((*it)->needed) {
-                        (*it)->positive = positive;
-                        (*it)->ct++;
-                        already = true;
-                    }
-                    mutex.unlock();
+    ParseName parser;
+    parser.apply(src);
+    std::string port = parser.getPortName();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = pending.find(port);
+    bool queued = (it != pending.end());
+    std::vector<Request>& requests = pending[port];
+    auto same = std::find_if(requests.begin(),
+                             requests.end(),
+                             [&](const Request& r) { return r.src == src && r.dest == dest; });
+    if (same != requests.end()) {
+        // the latest request wins
+        same->positive = positive;
+        return;
+    }
+    requests.push_back({src, dest, positive});
+
+    // the port being served is queued again when its worker is done
+    if (!queued && active.find(port) == active.end()) {
+        ready.push_back(port);
+    }
+    yCTrace(CONNECTMANAGER,
+            "***** %zu ports waiting, %zu workers (%zu idle)",
+            ready.size(),
+            workers.size(),
+            idle);
+    if (idle == 0 && workers.size() < maxWorkers) {
+        workers.emplace_back(&ConnectManager::work, this);
+    } else {
+        changed.notify_one();
+    }
+}
+
+void ConnectManager::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this]() { return pending.empty() && active.empty(); });
+}
+
+void ConnectManager::work()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!closing) {
+        if (ready.empty()) {
+            idle++;
+            changed.wait(lock, [this]() { return closing || !ready.empty(); });
+            idle--;
+            continue;
+        }
+        std::string port = ready.front();
+        ready.pop_front();
+        auto it = pending.find(port);
+        if (it == pending.end()) {
+            continue;
+        }
+        std::vector<Request> requests;
+        requests.swap(it->second);
+        pending.erase(it);
+        active.insert(port);
+        lock.unlock();
+
+        apply(port, requests);
+
+        lock.lock();
+        active.erase(port);
+        if (pending.find(port) != pending.end()) {
+            ready.push_back(port);
+            changed.notify_one();
+        }
+        done.notify_all();
+    }
+}
+
+void ConnectManager::apply(const std::string& port,
+                           const std::vector<Request>& requests)
+{
+    // A single admin session to the source port tells which of the
+    // destinations are already connected, and adds the missing ones that
+    // use the default carrier.
+    yarp::os::Bottle cmd;
+    yarp::os::Bottle reply;
+    cmd.addVocab(yarp::os::createVocab('l', 'i', 's', 't'));
+    cmd.addVocab(yarp::os::createVocab('o', 'u', 't'));
+    yarp::os::Port session;
+    session.setAdminMode(true);
+    session.openFake("connect_manager");
+    bool listed = false;
+    yarp::os::Contact contact = yarp::os::NetworkBase::queryName(port);
+    if (contact.isValid() && contact.getCarrier() != "topic" && session.addOutput(contact)) {
+        listed = session.write(cmd, reply);
+    }
+    yCTrace(CONNECTMANAGER,
+            " ]]] %s has %zu requests, outputs: %s",
+            port.c_str(),
+            requests.size(),
+            listed ? reply.toString().c_str() : "unknown");
+
+    for (const auto& request : requests) {
+        ParseName parser;
+        parser.apply(request.dest);
+        bool connected = false;
+        if (listed && parser.getCarrier().empty()) {
+            for (size_t i = 0; i < reply.size(); i++) {
+                if (reply.get(i).asString() == parser.getPortName()) {
+                    connected = true;
+                    break;
                 }
             }
+        } else {
+            // the carrier of the connection matters, ask about this one
+            connected = yarp::os::NetworkBase::isConnected(request.src, request.dest);
         }
-        it++;
-    }
-    if (!already) {
-        if (t == nullptr) {
-            t = new ConnectThread(mutex);
-            con.push_back(t);
+
+        if (request.positive) {
+            if (!connected) {
+                yCTrace(CONNECTMANAGER,
+                        "   (((Trying to connect %s and %s)))",
+                        request.src.c_str(),
+                        request.dest.c_str());
+                if (!listed || !addOutput(session, contact, request)) {
+                    yarp::os::NetworkBase::connect(request.src, request.dest);
+                }
+            }
+        } else {
+            if (connected) {
+                yCTrace(CONNECTMANAGER,
+                        "   (((Trying to disconnect %s and %s)))",
+                        request.src.c_str(),
+                        request.dest.c_str());
+                yarp::os::NetworkBase::disconnect(request.src, request.dest);
+            }
         }
-        t->src = src;
-        t->dest = dest;
-        t->ct = 1;
-        t->needed = true;
-        t->positive = positive;
-        t->start();
     }
 }
@@ -7,29 +7,57 @@
  * BSD-3-Clause license. See the accompanying LICENSE file for details.
  */
 
-#include <yarp/serversql/impl/ConnectThread.h>
+#ifndef YARP_SERVERSQL_IMPL_CONNECTMANAGER_H
+#define YARP_SERVERSQL_IMPL_CONNECTMANAGER_H
 
-#include <list>
+#include <condition_variable>
+#include <deque>
+#include <map>
 #include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
 
 namespace yarp {
 namespace serversql {
 namespace impl {
 
-#ifndef YARP_SERVERSQL_IMPL_CONNECTMANAGER_H
-#define YARP_SERVERSQL_IMPL_CONNECTMANAGER_H
-
+/**
+ * Make (or break) the connections of the persistent subscriptions, in the
+ * background.
+ *
+ * The requests are queued by source port, and served by a small pool of
+ * worker threads.  A worker takes all the requests of a source port at once,
+ * asks the port for its output connections a single time, and only connects
+ * or disconnects the destinations that need it.  The tcp connections are
+ * added in the same admin session, the other ones are left to
+ * NetworkBase::connect().
+ *
+ * A request for a pair of ports that is already queued replaces the queued
+ * one, and the requests for a source port that is being served are kept for
+ * the next round, so that each port is handled by one worker at a time.
+ */
 class ConnectManager
 {
-private:
-    std::list<ConnectThread*> con;
-    std::mutex mutex;
 public:
+    struct Request
+    {
+        std::string src;
+        std::string dest;
+        bool positive;
+    };
 
-    ConnectManager();
+    /**
+     * @param maxWorkers the maximum number of worker threads
+     */
+    explicit ConnectManager(size_t maxWorkers = 4);
 
     virtual ~ConnectManager();
 
+    /**
+     * Drop the requests not served yet, and stop the workers.
+     */
     void clear();
 
     void disconnect(const std::string& src,
@@ -39,6 +67,36 @@ public:
     void connect(const std::string& src,
                  const std::string& dest,
                  bool positive = true);
+
+    /**
+     * Wait until all the requests have been served.
+     */
+    void wait();
+
+protected:
+    /**
+     * Serve the requests of a source port.
+     *
+     * @param port the name of the source port
+     * @param requests the requests, all with that source port, at most one
+     *        for each pair of ports
+     */
+    virtual void apply(const std::string& port,
+                       const std::vector<Request>& requests);
+
+private:
+    void work();
+
+    size_t maxWorkers;
+    std::mutex mutex;
+    std::condition_variable changed; ///< a port is ready, or closing
+    std::condition_variable done;    ///< a port has been served
+    std::map<std::string, std::vector<Request>> pending;
+    std::deque<std::string> ready;
+    std::set<std::string> active;
+    std::vector<std::thread> workers;
+    size_t idle;
+    bool closing;
 };
 
 } // namespace impl
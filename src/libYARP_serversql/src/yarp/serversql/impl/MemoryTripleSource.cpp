@@ -0,0 +1,274 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <yarp/serversql/impl/MemoryTripleSource.h>
+
+#include <yarp/serversql/impl/LogComponent.h>
+#include <yarp/serversql/impl/SqliteTripleSource.h>
+
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+using yarp::serversql::impl::MemoryTripleSource;
+using yarp::serversql::impl::Triple;
+using yarp::serversql::impl::TripleContext;
+
+namespace {
+YARP_SERVERSQL_LOG_COMPONENT(MEMORYTRIPLESOURCE, "yarp.serversql.impl.MemoryTripleSource")
+
+int ridOf(TripleContext *context)
+{
+    return (context != nullptr) ? context->rid : -1;
+}
+
+// The same as the conditions of SqliteTripleSource::condition()
+bool fieldMatches(bool has, const std::string& field, bool patternHas, const std::string& pattern)
+{
+    if (!patternHas) {
+        return !has;
+    }
+    return (pattern == "*") || (has && field == pattern);
+}
+} // namespace
+
+
+MemoryTripleSource::MemoryTripleSource(SqliteTripleSource* store) :
+        store(store)
+{
+    if (store != nullptr) {
+        store->readAll([this](int id, int rid, const Triple& t) {
+            add(id, rid, t);
+        });
+        yCDebug(MEMORYTRIPLESOURCE, "Read %zu triples", rows.size());
+    }
+}
+
+std::string MemoryTripleSource::key(int rid, const Triple& t, bool withValue)
+{
+    // the lengths keep the keys of different fields apart
+    std::string k = std::to_string(rid);
+    k += t.hasName ? "|" + std::to_string(t.name.length()) + ":" + t.name : "|-";
+    if (withValue) {
+        k += t.hasValue ? "|" + std::to_string(t.value.length()) + ":" + t.value : "|-";
+    }
+    return k;
+}
+
+bool MemoryTripleSource::matches(const Row& row, const Triple& t, int rid)
+{
+    const Triple& r = row.triple;
+    return row.rid == rid &&
+           fieldMatches(r.hasNs, r.ns, t.hasNs, t.ns) &&
+           fieldMatches(r.hasName, r.name, t.hasName, t.name) &&
+           fieldMatches(r.hasValue, r.value, t.hasValue, t.value);
+}
+
+const std::set<int>* MemoryTripleSource::candidates(const Triple& t, int rid) const
+{
+    if (t.hasName && t.name == "*") {
+        auto it = byRid.find(rid);
+        return (it != byRid.end()) ? &it->second : nullptr;
+    }
+    if (t.hasValue && t.value == "*") {
+        auto it = byName.find(key(rid, t, false));
+        return (it != byName.end()) ? &it->second : nullptr;
+    }
+    auto it = byValue.find(key(rid, t, true));
+    return (it != byValue.end()) ? &it->second : nullptr;
+}
+
+void MemoryTripleSource::add(int id, int rid, const Triple& t)
+{
+    rows[id] = Row{rid, t};
+    byRid[rid].insert(id);
+    byName[key(rid, t, false)].insert(id);
+    byValue[key(rid, t, true)].insert(id);
+    if (id >= nextId) {
+        nextId = id + 1;
+    }
+}
+
+void MemoryTripleSource::erase(std::map<int, Row>::iterator it)
+{
+    int id = it->first;
+    const Row& row = it->second;
+    auto r = byRid.find(row.rid);
+    r->second.erase(id);
+    if (r->second.empty()) {
+        byRid.erase(r);
+    }
+    auto n = byName.find(key(row.rid, row.triple, false));
+    n->second.erase(id);
+    if (n->second.empty()) {
+        byName.erase(n);
+    }
+    auto v = byValue.find(key(row.rid, row.triple, true));
+    v->second.erase(id);
+    if (v->second.empty()) {
+        byValue.erase(v);
+    }
+    rows.erase(it);
+}
+
+void MemoryTripleSource::setValue(int id, Row& row, const Triple& t)
+{
+    auto v = byValue.find(key(row.rid, row.triple, true));
+    v->second.erase(id);
+    if (v->second.empty()) {
+        byValue.erase(v);
+    }
+    row.triple.hasValue = t.hasValue;
+    row.triple.value = t.value;
+    byValue[key(row.rid, row.triple, true)].insert(id);
+}
+
+int MemoryTripleSource::find(Triple& t, TripleContext *context)
+{
+    int rid = ridOf(context);
+    int out = -1;
+    const std::set<int>* ids = candidates(t, rid);
+    if (ids != nullptr) {
+        for (int id : *ids) {
+            if (matches(rows.at(id), t, rid)) {
+                if (out!=-1) {
+                    yCWarning(MEMORYTRIPLESOURCE, "WARNING: multiple matches ignored");
+                }
+                out = id;
+            }
+        }
+    }
+    return out;
+}
+
+void MemoryTripleSource::remove_query(Triple& ti, TripleContext *context)
+{
+    int rid = ridOf(context);
+    const std::set<int>* ids = candidates(ti, rid);
+    if (ids == nullptr) {
+        return;
+    }
+    std::vector<int> removed;
+    for (int id : *ids) {
+        if (matches(rows.at(id), ti, rid)) {
+            removed.push_back(id);
+        }
+    }
+    for (int id : removed) {
+        erase(rows.find(id));
+    }
+    if (store != nullptr && !removed.empty()) {
+        store->remove_query(ti, context);
+    }
+}
+
+void MemoryTripleSource::prune(TripleContext *context)
+{
+    // the triples that belong to a triple that does not exist (anymore)
+    std::vector<int> removed;
+    for (const auto& it : byRid) {
+        if (it.first != -1 && rows.find(it.first) == rows.end()) {
+            removed.insert(removed.end(), it.second.begin(), it.second.end());
+        }
+    }
+    for (int id : removed) {
+        erase(rows.find(id));
+    }
+    if (store != nullptr && !removed.empty()) {
+        store->prune(context);
+    }
+}
+
+std::list<Triple> MemoryTripleSource::query(Triple& ti, TripleContext *context)
+{
+    int rid = ridOf(context);
+    std::vector<const Triple*> found;
+    const std::set<int>* ids = candidates(ti, rid);
+    if (ids != nullptr) {
+        for (int id : *ids) {
+            const Row& row = rows.at(id);
+            if (matches(row, ti, rid)) {
+                found.push_back(&row.triple);
+            }
+        }
+    }
+    // The same order as the index of the Sqlite database, the name server
+    // lists the ports in this order
+    std::stable_sort(found.begin(), found.end(), [](const Triple* a, const Triple* b) {
+        return std::tie(a->hasName, a->name, a->hasValue, a->value) < std::tie(b->hasName, b->name, b->hasValue, b->value);
+    });
+    std::list<Triple> q;
+    for (const Triple* t : found) {
+        q.push_back(*t);
+    }
+    return q;
+}
+
+void MemoryTripleSource::insert(Triple& t, TripleContext *context)
+{
+    int id = nextId;
+    add(id, ridOf(context), t);
+    if (store != nullptr) {
+        store->insert(t, context, id);
+    }
+}
+
+void MemoryTripleSource::update(Triple& t, TripleContext *context)
+{
+    int rid = ridOf(context);
+    size_t ct = 0;
+    if (t.hasName||t.hasNs) {
+        Triple t2(t);
+        t2.value = "*";
+        // setValue() changes the index the candidates may come from
+        std::vector<int> matching;
+        const std::set<int>* ids = candidates(t2, rid);
+        if (ids != nullptr) {
+            for (int id : *ids) {
+                if (matches(rows.at(id), t2, rid)) {
+                    matching.push_back(id);
+                }
+            }
+        }
+        for (int id : matching) {
+            setValue(id, rows.at(id), t);
+        }
+        ct = matching.size();
+    } else {
+        // the triple with the id of the context
+        auto it = rows.find(rid);
+        if (rid != -1 && it != rows.end()) {
+            setValue(rid, it->second, t);
+            ct++;
+        }
+    }
+    if (ct==0 && (t.hasName||t.hasNs)) {
+        insert(t,context);
+    } else if (ct!=0 && store != nullptr) {
+        store->update(t, context);
+    }
+}
+
+void MemoryTripleSource::begin(TripleContext *context)
+{
+    if (store != nullptr) {
+        store->begin(context);
+    }
+}
+
+void MemoryTripleSource::end(TripleContext *context)
+{
+    if (store != nullptr) {
+        store->end(context);
+    }
+}
+
+size_t MemoryTripleSource::size() const
+{
+    return rows.size();
+}
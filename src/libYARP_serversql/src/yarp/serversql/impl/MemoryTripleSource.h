@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#ifndef YARP_SERVERSQL_IMPL_MEMORYTRIPLESOURCE_H
+#define YARP_SERVERSQL_IMPL_MEMORYTRIPLESOURCE_H
+
+#include <yarp/serversql/impl/TripleSource.h>
+#include <yarp/serversql/impl/Triple.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+namespace yarp {
+namespace serversql {
+namespace impl {
+
+class SqliteTripleSource;
+
+/**
+ * Triples kept in memory, and indexed by hash tables on the triple they
+ * belong to, on their name and on their value, so that the name server
+ * does not need a SQL query to look up or to register a port.
+ *
+ * The triples can also be written through to a Sqlite database, that is
+ * then read only once, when this is created, and that keeps the same ids
+ * as the triples in memory.
+ */
+class MemoryTripleSource : public TripleSource
+{
+public:
+    /**
+     * @param store the database that keeps a copy of the triples, or
+     *              nullptr to keep them only in memory
+     */
+    explicit MemoryTripleSource(SqliteTripleSource* store = nullptr);
+
+    int find(Triple& t, TripleContext *context) override;
+    void remove_query(Triple& ti, TripleContext *context) override;
+    void prune(TripleContext *context) override;
+    std::list<Triple> query(Triple& ti, TripleContext *context) override;
+    void insert(Triple& t, TripleContext *context) override;
+    void update(Triple& t, TripleContext *context) override;
+    void begin(TripleContext *context) override;
+    void end(TripleContext *context) override;
+
+    /**
+     * @return the number of triples
+     */
+    size_t size() const;
+
+private:
+    struct Row
+    {
+        int rid;
+        Triple triple;
+    };
+
+    static bool matches(const Row& row, const Triple& t, int rid);
+    static std::string key(int rid, const Triple& t, bool withValue);
+
+    // The ids of the triples that may match t, in increasing order
+    const std::set<int>* candidates(const Triple& t, int rid) const;
+
+    void add(int id, int rid, const Triple& t);
+    void erase(std::map<int, Row>::iterator it);
+    void setValue(int id, Row& row, const Triple& t);
+
+    SqliteTripleSource* store;
+    std::map<int, Row> rows;
+    // the ids of the triples with a given rid
+    std::unordered_map<int, std::set<int>> byRid;
+    // the ids of the triples with a given rid and name, see key()
+    std::unordered_map<std::string, std::set<int>> byName;
+    // the ids of the triples with a given rid, name and value
+    std::unordered_map<std::string, std::set<int>> byValue;
+    int nextId {1};
+};
+
+} // namespace impl
+} // namespace serversql
+} // namespace yarp
+
+
+#endif // YARP_SERVERSQL_IMPL_MEMORYTRIPLESOURCE_H
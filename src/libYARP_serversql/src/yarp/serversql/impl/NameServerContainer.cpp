@@ -90,6 +90,7 @@ bool NameServerContainer::open(Searchable& options)
     std::string ip = options.check("ip",Value("...")).asString();
     int sock = options.check("socket",Value(Network::getDefaultPortRange())).asInt32();
     bool cautious = options.check("cautious");
+    bool wal = options.check("wal");
 
     yCInfo(NAMESERVERCONTAINER, "Using port database: %s", dbFilename.c_str());
     yCInfo(NAMESERVERCONTAINER, "Using subscription database: %s", subdbFilename.c_str());
@@ -105,13 +106,13 @@ bool NameServerContainer::open(Searchable& options)
         reset = true;
     }
 
-    TripleSource *pmem = db.open(dbFilename.c_str(),cautious,reset);
+    TripleSource *pmem = db.open(dbFilename.c_str(),cautious,reset,wal);
     if (pmem == nullptr) {
         yCError(NAMESERVERCONTAINER, "Aborting, ports database failed to open.");
         return false;
     }
 
-    if (!subscriber.open(subdbFilename)) {
+    if (!subscriber.open(subdbFilename,false,cautious,wal)) {
         yCError(NAMESERVERCONTAINER, "Aborting, subscription database failed to open.");
         return false;
     }
@@ -109,6 +109,29 @@ yarp::os::Contact NameServiceOnTriples::query(const std::string& port) {
 
 
 bool NameServiceOnTriples::cmdQuery(NameTripleState& act, bool nested) {
+    if (act.bottleMode && !act.nestedMode && act.cmd.size()>2) {
+        // query $port1 $port2 ... : one "port" list per name, in order
+        Bottle names = act.cmd.tail();
+        bool several = true;
+        for (size_t i=0; i<names.size(); i++) {
+            if (names.get(i).asString().find('/')!=0) {
+                several = false;
+            }
+        }
+        if (several) {
+            act.reply.addString("ports");
+            act.nestedMode = true;
+            for (size_t i=0; i<names.size(); i++) {
+                act.cmd.clear();
+                act.cmd.addString("query");
+                act.cmd.add(names.get(i));
+                act.mem.reset();
+                cmdQuery(act, nested);
+            }
+            return true;
+        }
+    }
+
     std::string port = act.cmd.get(1).asString();
 
     ParseName parser;
@@ -620,6 +643,7 @@ bool NameServiceOnTriples::cmdHelp(NameTripleState& act) {
     bot.addString("  (if you want a field set automatically, write '...')");
     bot.addString("+ unregister $portname");
     bot.addString("+ query $portname");
+    bot.addString("+ bot query $portname1 $portname2 ...");
     bot.addString("+ set $portname $property $value");
     bot.addString("+ get $portname $property");
     bot.addString("+ check $portname $property");
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <yarp/serversql/impl/SqliteStatementCache.h>
+
+#include <yarp/serversql/impl/LogComponent.h>
+
+using yarp::serversql::impl::SqliteStatement;
+using yarp::serversql::impl::SqliteStatementCache;
+
+namespace {
+YARP_SERVERSQL_LOG_COMPONENT(SQLITESTATEMENTCACHE, "yarp.serversql.impl.SqliteStatementCache")
+} // namespace
+
+
+SqliteStatement::SqliteStatement(sqlite3_stmt* statement) :
+        statement(statement)
+{
+}
+
+SqliteStatement::SqliteStatement(SqliteStatement&& other) noexcept :
+        statement(other.statement)
+{
+    other.statement = nullptr;
+}
+
+SqliteStatement& SqliteStatement::operator=(SqliteStatement&& other) noexcept
+{
+    if (this != &other) {
+        release();
+        statement = other.statement;
+        other.statement = nullptr;
+    }
+    return *this;
+}
+
+SqliteStatement::~SqliteStatement()
+{
+    release();
+}
+
+void SqliteStatement::release()
+{
+    if (statement != nullptr) {
+        sqlite3_reset(statement);
+        sqlite3_clear_bindings(statement);
+        statement = nullptr;
+    }
+}
+
+bool SqliteStatement::isValid() const
+{
+    return statement != nullptr;
+}
+
+void SqliteStatement::bind(int index, const char* text)
+{
+    if (text == nullptr) {
+        sqlite3_bind_null(statement, index);
+    } else {
+        sqlite3_bind_text(statement, index, text, -1, SQLITE_TRANSIENT);
+    }
+}
+
+void SqliteStatement::bind(int index, const std::string& text)
+{
+    sqlite3_bind_text(statement, index, text.c_str(), static_cast<int>(text.length()), SQLITE_TRANSIENT);
+}
+
+void SqliteStatement::bind(int index, int value)
+{
+    sqlite3_bind_int(statement, index, value);
+}
+
+void SqliteStatement::bind(const char* name, const char* text)
+{
+    int index = (statement != nullptr) ? sqlite3_bind_parameter_index(statement, name) : 0;
+    if (index > 0) {
+        bind(index, text);
+    }
+}
+
+void SqliteStatement::bind(const char* name, int value)
+{
+    int index = (statement != nullptr) ? sqlite3_bind_parameter_index(statement, name) : 0;
+    if (index > 0) {
+        bind(index, value);
+    }
+}
+
+bool SqliteStatement::step()
+{
+    if (statement == nullptr) {
+        return false;
+    }
+    int result = sqlite3_step(statement);
+    if (result != SQLITE_ROW && result != SQLITE_DONE) {
+        yCError(SQLITESTATEMENTCACHE, "%s", sqlite3_errmsg(sqlite3_db_handle(statement)));
+    }
+    return result == SQLITE_ROW;
+}
+
+bool SqliteStatement::run()
+{
+    if (statement == nullptr) {
+        return false;
+    }
+    int result = sqlite3_step(statement);
+    if (result != SQLITE_DONE) {
+        yCError(SQLITESTATEMENTCACHE, "%s", sqlite3_errmsg(sqlite3_db_handle(statement)));
+        yCError(SQLITESTATEMENTCACHE, "(Query was): %s", sqlite3_sql(statement));
+        return false;
+    }
+    return true;
+}
+
+const char* SqliteStatement::text(int column)
+{
+    return reinterpret_cast<const char*>(sqlite3_column_text(statement, column));
+}
+
+int SqliteStatement::integer(int column)
+{
+    return sqlite3_column_int(statement, column);
+}
+
+
+SqliteStatementCache::~SqliteStatementCache()
+{
+    close();
+}
+
+void SqliteStatementCache::open(sqlite3* db)
+{
+    close();
+    this->db = db;
+}
+
+void SqliteStatementCache::close()
+{
+    for (auto& it : statements) {
+        sqlite3_finalize(it.second);
+    }
+    statements.clear();
+    db = nullptr;
+}
+
+SqliteStatement SqliteStatementCache::get(const std::string& query)
+{
+    auto it = statements.find(query);
+    if (it != statements.end()) {
+        return SqliteStatement(it->second);
+    }
+    yCDebug(SQLITESTATEMENTCACHE, "Preparing: %s", query.c_str());
+    sqlite3_stmt* statement = nullptr;
+    int result = sqlite3_prepare_v2(db, query.c_str(), -1, &statement, nullptr);
+    if (result != SQLITE_OK) {
+        yCError(SQLITESTATEMENTCACHE, "Error in query: %s", sqlite3_errmsg(db));
+        yCError(SQLITESTATEMENTCACHE, "(Query was): %s", query.c_str());
+        sqlite3_finalize(statement);
+        return SqliteStatement();
+    }
+    statements.emplace(query, statement);
+    return SqliteStatement(statement);
+}
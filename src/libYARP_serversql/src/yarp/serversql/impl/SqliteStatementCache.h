@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#ifndef YARP_SERVERSQL_IMPL_SQLITESTATEMENTCACHE_H
+#define YARP_SERVERSQL_IMPL_SQLITESTATEMENTCACHE_H
+
+#include <string>
+#include <unordered_map>
+
+#include <sqlite3.h>
+
+namespace yarp {
+namespace serversql {
+namespace impl {
+
+/**
+ * A prepared statement of a SqliteStatementCache, with its parameters
+ * bound.  The statement is reset when this goes out of scope, so that it
+ * can be used again.
+ */
+class SqliteStatement
+{
+public:
+    explicit SqliteStatement(sqlite3_stmt* statement = nullptr);
+    ~SqliteStatement();
+
+    SqliteStatement(SqliteStatement&& other) noexcept;
+    SqliteStatement(const SqliteStatement&) = delete;
+    SqliteStatement& operator=(const SqliteStatement&) = delete;
+    SqliteStatement& operator=(SqliteStatement&& other) noexcept;
+
+    /**
+     * @return true if the statement was prepared
+     */
+    bool isValid() const;
+
+    /**
+     * Bind a parameter, starting from 1.  A nullptr text is bound as NULL.
+     */
+    void bind(int index, const char* text);
+    void bind(int index, const std::string& text);
+    void bind(int index, int value);
+
+    /**
+     * Bind a named parameter (e.g. ":name"), if the statement has it.
+     */
+    void bind(const char* name, const char* text);
+    void bind(const char* name, int value);
+
+    /**
+     * Get the next row of the results.
+     * @return true if there is a row, false when there are no more
+     */
+    bool step();
+
+    /**
+     * Execute a statement that returns no rows.
+     * @return true on success
+     */
+    bool run();
+
+    /**
+     * @return a column of the current row, nullptr if it is NULL
+     */
+    const char* text(int column);
+
+    /**
+     * @return a column of the current row, as an integer
+     */
+    int integer(int column);
+
+private:
+    void release();
+
+    sqlite3_stmt* statement;
+};
+
+
+/**
+ * The statements used on a Sqlite database, prepared the first time they
+ * are needed and kept for the next ones, instead of being parsed and
+ * planned again each time.
+ * The parameters of the statements are bound, rather than formatted in
+ * the query.
+ */
+class SqliteStatementCache
+{
+public:
+    SqliteStatementCache() = default;
+    ~SqliteStatementCache();
+
+    SqliteStatementCache(const SqliteStatementCache&) = delete;
+    SqliteStatementCache& operator=(const SqliteStatementCache&) = delete;
+
+    /**
+     * Set the database of the statements.
+     */
+    void open(sqlite3* db);
+
+    /**
+     * Finalize all the statements, this must be done before closing the
+     * database.
+     */
+    void close();
+
+    /**
+     * Get the prepared statement for a query.
+     * @param query the SQL of the statement, with "?" for the parameters
+     * @return the statement, not valid if it cannot be prepared
+     */
+    SqliteStatement get(const std::string& query);
+
+private:
+    sqlite3* db {nullptr};
+    std::unordered_map<std::string, sqlite3_stmt*> statements;
+};
+
+} // namespace impl
+} // namespace serversql
+} // namespace yarp
+
+
+#endif // YARP_SERVERSQL_IMPL_SQLITESTATEMENTCACHE_H
@@ -14,6 +14,7 @@
 #include <cstdlib>
 #include <cstdio>
 
+using yarp::serversql::impl::SqliteStatement;
 using yarp::serversql::impl::SqliteTripleSource;
 using yarp::serversql::impl::Triple;
 using yarp::serversql::impl::TripleContext;
@@ -24,6 +25,12 @@ YARP_SERVERSQL_LOG_COMPONENT(SQLITETRIPLESOURCE, "yarp.serversql.impl.SqliteTrip
 
 SqliteTripleSource::SqliteTripleSource(sqlite3 *db) : db(db)
 {
+    statements.open(db);
+}
+
+SqliteTripleSource::~SqliteTripleSource()
+{
+    statements.close();
 }
 
 std::string SqliteTripleSource::condition(Triple& t, TripleContext *context)
@@ -33,34 +40,25 @@ std::string SqliteTripleSource::condition(Triple& t, TripleContext *context)
     if (rid==-1) {
         cond = "rid IS NULL";
     } else {
-        cond = "rid = " + expressContext(context);
+        cond = "rid = :rid";
     }
     if (t.hasNs) {
         if (t.ns!="*") {
-            char *query = nullptr;
-            query = sqlite3_mprintf(" AND ns = %Q",t.getNs());
-            cond = cond + query;
-            sqlite3_free(query);
+            cond += " AND ns = :ns";
         }
     } else {
         cond += " AND ns IS NULL";
     }
     if (t.hasName) {
         if (t.name!="*") {
-            char *query = nullptr;
-            query = sqlite3_mprintf(" AND name = %Q",t.getName());
-            cond = cond + query;
-            sqlite3_free(query);
+            cond += " AND name = :name";
         }
     } else {
         cond += " AND name IS NULL";
     }
     if (t.hasValue) {
         if (t.value!="*") {
-            char *query = nullptr;
-            query = sqlite3_mprintf(" AND value = %Q",t.getValue());
-            cond = cond + query;
-            sqlite3_free(query);
+            cond += " AND value = :value";
         }
     } else {
         cond += " AND value IS NULL";
@@ -68,71 +66,63 @@ std::string SqliteTripleSource::condition(Triple& t, TripleContext *context)
     return cond;
 }
 
+SqliteStatement SqliteTripleSource::prepare(const std::string& query,
+                                            Triple& t,
+                                            TripleContext *context)
+{
+    yCDebug(SQLITETRIPLESOURCE, "Query: %s", query.c_str());
+    SqliteStatement statement = statements.get(query);
+    if (statement.isValid()) {
+        int rid = (context != nullptr) ? context->rid : -1;
+        if (rid != -1) {
+            statement.bind(":rid", rid);
+        }
+        statement.bind(":ns", t.getNs());
+        statement.bind(":name", t.getName());
+        statement.bind(":value", t.getValue());
+    }
+    return statement;
+}
+
 int SqliteTripleSource::find(Triple& t, TripleContext *context)
 {
     int out = -1;
-    sqlite3_stmt *statement = nullptr;
-    char *query = nullptr;
-    query = sqlite3_mprintf("SELECT id FROM tags WHERE %s",
-                            condition(t,context).c_str());
-    yCDebug(SQLITETRIPLESOURCE, "Query: %s", query);
-    int result = sqlite3_prepare_v2(db, query, -1, &statement, nullptr);
-    if (result!=SQLITE_OK) {
-        yCWarning(SQLITETRIPLESOURCE, "Error in query");
-    }
-    while (result == SQLITE_OK && sqlite3_step(statement) == SQLITE_ROW) {
+    SqliteStatement statement = prepare("SELECT id FROM tags WHERE " + condition(t, context), t, context);
+    while (statement.step()) {
         if (out!=-1) {
             yCWarning(SQLITETRIPLESOURCE, "WARNING: multiple matches ignored");
         }
-        out = sqlite3_column_int(statement,0);
+        out = statement.integer(0);
         yCTrace(SQLITETRIPLESOURCE, "Match %d", out);
     }
-
-    sqlite3_finalize(statement);
-    sqlite3_free(query);
     return out;
 }
 
 void SqliteTripleSource::remove_query(Triple& ti, TripleContext *context)
 {
-    char *query = nullptr;
-    query = sqlite3_mprintf("DELETE FROM tags WHERE %s",condition(ti,context).c_str());
-    yCDebug(SQLITETRIPLESOURCE, "Query: %s", query);
-    int result = sqlite3_exec(db, query, nullptr, nullptr, nullptr);
-    if (result!=SQLITE_OK) {
+    SqliteStatement statement = prepare("DELETE FROM tags WHERE " + condition(ti, context), ti, context);
+    if (!statement.run()) {
         yCWarning(SQLITETRIPLESOURCE, "Error in query");
     }
-    sqlite3_free(query);
 }
 
 void SqliteTripleSource::prune(TripleContext *context)
 {
-    char *query = nullptr;
-    query = sqlite3_mprintf("DELETE FROM tags WHERE rid IS NOT NULL AND rid  NOT IN (SELECT id FROM tags)");
-    yCDebug(SQLITETRIPLESOURCE, "Query: %s", query);
-    int result = sqlite3_exec(db, query, nullptr, nullptr, nullptr);
-    if (result!=SQLITE_OK) {
+    Triple t;
+    SqliteStatement statement = prepare("DELETE FROM tags WHERE rid IS NOT NULL AND rid  NOT IN (SELECT id FROM tags)", t, nullptr);
+    if (!statement.run()) {
         yCWarning(SQLITETRIPLESOURCE, "Error in query");
     }
-    sqlite3_free(query);
 }
 
 std::list<Triple> SqliteTripleSource::query(Triple& ti, TripleContext *context)
 {
     std::list<Triple> q;
-    sqlite3_stmt *statement = nullptr;
-    char *query = nullptr;
-    query = sqlite3_mprintf("SELECT id, ns, name, value FROM tags WHERE %s",condition(ti,context).c_str());
-    yCDebug(SQLITETRIPLESOURCE, "Query: %s", query);
-    int result = sqlite3_prepare_v2(db, query, -1, &statement, nullptr);
-    if (result!=SQLITE_OK) {
-        yCWarning(SQLITETRIPLESOURCE, "Error in query");
-    }
-    while (result == SQLITE_OK && sqlite3_step(statement) == SQLITE_ROW) {
-        //int id = sqlite3_column_int(statement,0);
-        char *ns = (char *)sqlite3_column_text(statement,1);
-        char *name = (char *)sqlite3_column_text(statement,2);
-        char *value = (char *)sqlite3_column_text(statement,3);
+    SqliteStatement statement = prepare("SELECT id, ns, name, value FROM tags WHERE " + condition(ti, context), ti, context);
+    while (statement.step()) {
+        const char *ns = statement.text(1);
+        const char *name = statement.text(2);
+        const char *value = statement.text(3);
         Triple t;
         if (ns != nullptr) {
             t.ns = ns;
@@ -148,68 +138,56 @@ std::list<Triple> SqliteTripleSource::query(Triple& ti, TripleContext *context)
         }
         q.push_back(t);
     }
-    sqlite3_finalize(statement);
-    sqlite3_free(query);
     return q;
 }
 
-std::string SqliteTripleSource::expressContext(TripleContext *context)
+void SqliteTripleSource::insert(Triple& t, TripleContext *context)
 {
-    int rid = (context != nullptr)?context->rid:-1;
-    char buf[100] = "NULL";
-    if (rid!=-1) {
-        std::snprintf(buf, 100, "%d", rid);
+    int rid = (context != nullptr) ? context->rid : -1;
+    SqliteStatement statement = prepare((rid == -1) ? "INSERT INTO tags (rid,ns,name,value) VALUES(NULL,:ns,:name,:value)"
+                                                    : "INSERT INTO tags (rid,ns,name,value) VALUES(:rid,:ns,:name,:value)",
+                                        t,
+                                        context);
+    if (!statement.run()) {
+        yCError(SQLITETRIPLESOURCE, "(Location): %s:%d", __FILE__, __LINE__);
     }
-    return buf;
 }
 
-void SqliteTripleSource::insert(Triple& t, TripleContext *context)
+void SqliteTripleSource::insert(Triple& t, TripleContext *context, int id)
 {
-    char *msg = nullptr;
-    char *query = sqlite3_mprintf("INSERT INTO tags (rid,ns,name,value) VALUES(%s,%Q,%Q,%Q)",
-                                  expressContext(context).c_str(),
-                                  t.getNs(),t.getName(),t.getValue());
-    yCDebug(SQLITETRIPLESOURCE, "Query: %s", query);
-    int result = sqlite3_exec(db, query, nullptr, nullptr, &msg);
-    if (result!=SQLITE_OK) {
-        if (msg != nullptr) {
-            yCError(SQLITETRIPLESOURCE, "Error: %s", msg);
-            yCError(SQLITETRIPLESOURCE, "(Query was): %s", query);
-            yCError(SQLITETRIPLESOURCE, "(Location): %s:%d", __FILE__, __LINE__);
-            sqlite3_free(msg);
-        }
+    int rid = (context != nullptr) ? context->rid : -1;
+    SqliteStatement statement = prepare((rid == -1) ? "INSERT INTO tags (id,rid,ns,name,value) VALUES(:id,NULL,:ns,:name,:value)"
+                                                    : "INSERT INTO tags (id,rid,ns,name,value) VALUES(:id,:rid,:ns,:name,:value)",
+                                        t,
+                                        context);
+    statement.bind(":id", id);
+    if (!statement.run()) {
+        yCError(SQLITETRIPLESOURCE, "(Location): %s:%d", __FILE__, __LINE__);
     }
-    sqlite3_free(query);
 }
 
 void SqliteTripleSource::update(Triple& t, TripleContext *context)
 {
-    char *msg = nullptr;
-    char *query = nullptr;
+    bool ok = false;
     if (t.hasName||t.hasNs) {
         Triple t2(t);
         t2.value = "*";
-        query = sqlite3_mprintf("UPDATE tags SET value = %Q WHERE %s",
-                                t.getValue(),
-                                condition(t2,context).c_str());
+        SqliteStatement statement = prepare("UPDATE tags SET value = :newValue WHERE " + condition(t2, context), t2, context);
+        statement.bind(":newValue", t.getValue());
+        ok = statement.run();
     } else {
-        query = sqlite3_mprintf("UPDATE tags SET value = %Q WHERE id = %Q",
-                                t.getValue(),
-                                expressContext(context).c_str());
-    }
-    yCDebug(SQLITETRIPLESOURCE, "Query: %s", query);
-    int result = sqlite3_exec(db, query, nullptr, nullptr, &msg);
-    if (result!=SQLITE_OK) {
-        if (msg != nullptr) {
-            yCError(SQLITETRIPLESOURCE, "Error: %s", msg);
-            sqlite3_free(msg);
+        int rid = (context != nullptr) ? context->rid : -1;
+        // no triple has a NULL id, so there is nothing to update
+        if (rid != -1) {
+            SqliteStatement statement = prepare("UPDATE tags SET value = :newValue WHERE id = :rid", t, context);
+            statement.bind(":newValue", t.getValue());
+            ok = statement.run();
         }
     }
-    int ct = sqlite3_changes(db);
+    int ct = ok ? sqlite3_changes(db) : 0;
     if (ct==0 && (t.hasName||t.hasNs)) {
         insert(t,context);
     }
-    sqlite3_free(query);
 }
 
 void SqliteTripleSource::begin(TripleContext *context)
@@ -229,3 +207,30 @@ void SqliteTripleSource::end(TripleContext *context)
         yCWarning(SQLITETRIPLESOURCE, "Error in END query");
     }
 }
+
+void SqliteTripleSource::readAll(const std::function<void(int id, int rid, const Triple& t)>& callback)
+{
+    Triple pattern;
+    SqliteStatement statement = prepare("SELECT id, rid, ns, name, value FROM tags ORDER BY id", pattern, nullptr);
+    while (statement.step()) {
+        int id = statement.integer(0);
+        int rid = (statement.text(1) != nullptr) ? statement.integer(1) : -1;
+        const char *ns = statement.text(2);
+        const char *name = statement.text(3);
+        const char *value = statement.text(4);
+        Triple t;
+        if (ns != nullptr) {
+            t.ns = ns;
+            t.hasNs = true;
+        }
+        if (name != nullptr) {
+            t.name = name;
+            t.hasName = true;
+        }
+        if (value != nullptr) {
+            t.value = value;
+            t.hasValue = true;
+        }
+        callback(id, rid, t);
+    }
+}
@@ -12,6 +12,9 @@
 
 #include <yarp/serversql/impl/TripleSource.h>
 #include <yarp/serversql/impl/Triple.h>
+#include <yarp/serversql/impl/SqliteStatementCache.h>
+
+#include <functional>
 
 #include <sqlite3.h>
 
@@ -23,26 +26,50 @@ namespace impl {
  * Sqlite database, viewed as a collection of triples.  These are the
  * minimum functions needed by the name server to use a Sqlite
  * database.
+ * The queries are prepared once, and then reused with different
+ * parameters.
  */
 class SqliteTripleSource : public TripleSource
 {
 public:
     SqliteTripleSource(sqlite3 *db);
+    ~SqliteTripleSource() override;
 
+    /**
+     * The WHERE clause matching a triple, with the :rid, :ns, :name and
+     * :value parameters, when needed.
+     */
     std::string condition(Triple& t, TripleContext *context);
 
     int find(Triple& t, TripleContext *context) override;
     void remove_query(Triple& ti, TripleContext *context) override;
     void prune(TripleContext *context) override;
     std::list<Triple> query(Triple& ti, TripleContext *context) override;
-    std::string expressContext(TripleContext *context);
     void insert(Triple& t, TripleContext *context) override;
     void update(Triple& t, TripleContext *context) override;
     void begin(TripleContext *context) override;
     void end(TripleContext *context) override;
 
+    /**
+     * Insert a triple with the given id.
+     */
+    void insert(Triple& t, TripleContext *context, int id);
+
+    /**
+     * Call a function with each triple in the database, with its id and
+     * the id of the triple it belongs to (-1 if none).
+     */
+    void readAll(const std::function<void(int id, int rid, const Triple& t)>& callback);
+
 private:
+    // The statement for a query, with the parameters bound to the fields
+    // of the triple and to the context
+    SqliteStatement prepare(const std::string& query,
+                            Triple& t,
+                            TripleContext *context);
+
     sqlite3 *db;
+    SqliteStatementCache statements;
 };
 
 } // namespace impl
@@ -42,7 +42,10 @@ YARP_SERVERSQL_LOG_COMPONENT(SUBSCRIBERONSQL, "yarp.serversql.impl.SubscriberOnS
 } // namespace
 
 
-bool SubscriberOnSql::open(const std::string& filename, bool fresh) {
+bool SubscriberOnSql::open(const std::string& filename,
+                           bool fresh,
+                           bool cautious,
+                           bool wal) {
     sqlite3 *db = nullptr;
     if (fresh) {
         int result = access(filename.c_str(),F_OK);
@@ -166,13 +169,37 @@ bool SubscriberOnSql::open(const std::string& filename, bool fresh) {
         std::exit(1);
     }
 
+    // the queries run each time a port is registered look up the
+    // subscriptions and the topics by port name
+    const char *create_indexes = "CREATE INDEX IF NOT EXISTS subscriptionsSrc ON subscriptions(src);\n\
+    CREATE INDEX IF NOT EXISTS subscriptionsDest ON subscriptions(dest);\n\
+    CREATE INDEX IF NOT EXISTS topicsTopic ON topics(topic);";
+
+    result = sqlite3_exec(db, create_indexes, nullptr, nullptr, nullptr);
+    if (result!=SQLITE_OK) {
+        sqlite3_close(db);
+        yCError(SUBSCRIBERONSQL, "Failed to set up indexes");
+        std::exit(1);
+    }
+
+    if (filename != ":memory:") {
+        std::string pragmas = std::string(wal ? "PRAGMA journal_mode=WAL;" : "") +
+                              "PRAGMA synchronous=" + (cautious ? "FULL" : "OFF") + ";";
+        result = sqlite3_exec(db, pragmas.c_str(), nullptr, nullptr, nullptr);
+        if (result!=SQLITE_OK) {
+            yCWarning(SUBSCRIBERONSQL, "Failed to set up %s: %s", filename.c_str(), sqlite3_errmsg(db));
+        }
+    }
+
     implementation = db;
+    statements.open(db);
     return true;
 }
 
 
 bool SubscriberOnSql::close() {
     if (implementation != nullptr) {
+        statements.close();
         auto* db = (sqlite3 *)implementation;
         sqlite3_close(db);
         implementation = nullptr;
@@ -193,27 +220,15 @@ bool SubscriberOnSql::addSubscription(const std::string& src,
     if (pdest.getCarrier()=="topic") {
         setTopic(pdest.getPortName(),"",true);
     }
-    char *msg = nullptr;
     const char *zmode = mode.c_str();
     if (mode == "") zmode = nullptr;
-    char *query = sqlite3_mprintf("INSERT INTO subscriptions (src,dest,srcFull,destFull,mode) VALUES(%Q,%Q,%Q,%Q,%Q)",
-                                  psrc.getPortName().c_str(),
-                                  pdest.getPortName().c_str(),
-                                  src.c_str(),
-                                  dest.c_str(),
-                                  zmode);
-    yCDebug(SUBSCRIBERONSQL, "Query: %s", query);
-
-    bool ok = true;
-    int result = sqlite3_exec(SQLDB(implementation), query, nullptr, nullptr, &msg);
-    if (result!=SQLITE_OK) {
-        ok = false;
-        if (msg != nullptr) {
-            yCError(SUBSCRIBERONSQL, "%s", msg);
-            sqlite3_free(msg);
-        }
-    }
-    sqlite3_free(query);
+    SqliteStatement statement = statements.get("INSERT INTO subscriptions (src,dest,srcFull,destFull,mode) VALUES(?,?,?,?,?)");
+    statement.bind(1, psrc.getPortName());
+    statement.bind(2, pdest.getPortName());
+    statement.bind(3, src);
+    statement.bind(4, dest);
+    statement.bind(5, zmode);
+    bool ok = statement.run();
     if (ok) {
         if (psrc.getCarrier()!="topic") {
             if (pdest.getCarrier()!="topic") {
@@ -239,20 +254,10 @@ bool SubscriberOnSql::removeSubscription(const std::string& src,
     ParseName psrc, pdest;
     psrc.apply(src);
     pdest.apply(dest);
-    char *query = sqlite3_mprintf("DELETE FROM subscriptions WHERE src = %Q AND dest = %Q",
-                                  psrc.getPortName().c_str(),
-                                  pdest.getPortName().c_str());
-    yCDebug(SUBSCRIBERONSQL, "Query: %s", query);
-
-    int result = sqlite3_exec(SQLDB(implementation), query, nullptr, nullptr, nullptr);
-    bool ok = true;
-    if (result!=SQLITE_OK) {
-        yCError(SUBSCRIBERONSQL, "Error in query");
-        ok = false;
-    }
-    sqlite3_free(query);
-
-    return ok;
+    SqliteStatement statement = statements.get("DELETE FROM subscriptions WHERE src = ? AND dest = ?");
+    statement.bind(1, psrc.getPortName());
+    statement.bind(2, pdest.getPortName());
+    return statement.run();
 }
 
 
@@ -278,34 +283,26 @@ bool SubscriberOnSql::welcome(const std::string& port, int activity) {
         }
     }
 
-    char *msg = nullptr;
-    char *query;
+    const char *query;
     if (activity>0) {
-        query = sqlite3_mprintf("INSERT OR IGNORE INTO live (name,stamp) VALUES(%Q,DATETIME('now'))",
-                                port.c_str());
+        query = "INSERT OR IGNORE INTO live (name,stamp) VALUES(?,DATETIME('now'))";
     } else {
         // Port not responding.  Mark as non-live.
         if  (activity==0) {
-            query = sqlite3_mprintf("DELETE FROM live WHERE name=%Q AND stamp < DATETIME('now','-30 seconds')",
-                                    port.c_str());
+            query = "DELETE FROM live WHERE name=? AND stamp < DATETIME('now','-30 seconds')";
         } else {
             // activity = -1 -- definite dodo
-            query = sqlite3_mprintf("DELETE FROM live WHERE name=%Q",
-                                    port.c_str());
+            query = "DELETE FROM live WHERE name=?";
         }
     }
-    yCDebug(SUBSCRIBERONSQL, "Query: %s", query);
+    yCDebug(SUBSCRIBERONSQL, "Query: %s (%s)", query, port.c_str());
 
-    bool ok = true;
-    int result = sqlite3_exec(SQLDB(implementation), query, nullptr, nullptr, &msg);
-    if (result!=SQLITE_OK) {
-        ok = false;
-        if (msg != nullptr) {
-            yCError(SUBSCRIBERONSQL, "%s", msg);
-            sqlite3_free(msg);
-        }
+    bool ok;
+    {
+        SqliteStatement statement = statements.get(query);
+        statement.bind(1, port);
+        ok = statement.run();
     }
-    sqlite3_free(query);
     mutex.unlock();
 
     if (activity>0) {
@@ -324,30 +321,18 @@ bool SubscriberOnSql::hookup(const std::string& port) {
         }
     }
     mutex.lock();
-    sqlite3_stmt *statement = nullptr;
-    char *query = nullptr;
-    //query = sqlite3_mprintf("SELECT * FROM subscriptions WHERE src = %Q OR dest= %Q",port, port);
-    query = sqlite3_mprintf("SELECT src,dest,srcFull,destFull FROM subscriptions WHERE (src = %Q OR dest= %Q) AND EXISTS (SELECT NULL FROM live WHERE name=src) AND EXISTS (SELECT NULL FROM live WHERE name=dest) UNION SELECT s1.src, s2.dest, s1.srcFull, s2.destFull FROM subscriptions s1, subscriptions s2, topics t WHERE (s1.dest = t.topic AND s2.src = t.topic) AND (s1.src = %Q OR s2.dest = %Q) AND EXISTS (SELECT NULL FROM live WHERE name=s1.src) AND EXISTS (SELECT NULL FROM live WHERE name=s2.dest)",port.c_str(), port.c_str(), port.c_str(), port.c_str());
-    //
-    yCDebug(SUBSCRIBERONSQL, "Query: %s", query);
-
-    int result = sqlite3_prepare_v2(SQLDB(implementation), query, -1, &statement, nullptr);
-    if (result!=SQLITE_OK) {
-        const char *msg = sqlite3_errmsg(SQLDB(implementation));
-        if (msg != nullptr) {
-            yCError(SUBSCRIBERONSQL, "%s", msg);
+    {
+        SqliteStatement statement = statements.get("SELECT src,dest,srcFull,destFull FROM subscriptions WHERE (src = ?1 OR dest= ?1) AND EXISTS (SELECT NULL FROM live WHERE name=src) AND EXISTS (SELECT NULL FROM live WHERE name=dest) UNION SELECT s1.src, s2.dest, s1.srcFull, s2.destFull FROM subscriptions s1, subscriptions s2, topics t WHERE (s1.dest = t.topic AND s2.src = t.topic) AND (s1.src = ?1 OR s2.dest = ?1) AND EXISTS (SELECT NULL FROM live WHERE name=s1.src) AND EXISTS (SELECT NULL FROM live WHERE name=s2.dest)");
+        yCDebug(SUBSCRIBERONSQL, "Query: hookup %s", port.c_str());
+        statement.bind(1, port);
+        while (statement.step()) {
+            const char *src = statement.text(0);
+            const char *dest = statement.text(1);
+            const char *srcFull = statement.text(2);
+            const char *destFull = statement.text(3);
+            checkSubscription(src,dest,srcFull,destFull,"");
         }
     }
-    while (result == SQLITE_OK && sqlite3_step(statement) == SQLITE_ROW) {
-        char *src = (char *)sqlite3_column_text(statement,0);
-        char *dest = (char *)sqlite3_column_text(statement,1);
-        char *srcFull = (char *)sqlite3_column_text(statement,2);
-        char *destFull = (char *)sqlite3_column_text(statement,3);
-        char *mode = (char *)sqlite3_column_text(statement,4);
-        checkSubscription(src,dest,srcFull,destFull,mode?mode:"");
-    }
-    sqlite3_finalize(statement);
-    sqlite3_free(query);
     mutex.unlock();
 
     return false;
@@ -362,29 +347,19 @@ bool SubscriberOnSql::breakdown(const std::string& port) {
         }
     }
     mutex.lock();
-    sqlite3_stmt *statement = nullptr;
-    char *query = nullptr;
-    // query = sqlite3_mprintf("SELECT src,dest,srcFull,destFull,mode FROM subscriptions WHERE ((src = %Q AND EXISTS (SELECT NULL FROM live WHERE name=dest)) OR (dest = %Q AND EXISTS (SELECT NULL FROM live WHERE name=src))) UNION SELECT s1.src, s2.dest, s1.srcFull, s2.destFull, NULL FROM subscriptions s1, subscriptions s2, topics t WHERE (s1.dest = t.topic AND s2.src = t.topic AND ((s1.src = %Q AND EXISTS (SELECT NULL FROM live WHERE name=s2.dest)) OR (s2.dest = %Q AND EXISTS (SELECT NULL FROM live WHERE name=s1.src))))",port, port, port, port);
-    query = sqlite3_mprintf("SELECT src,dest,srcFull,destFull,mode FROM subscriptions WHERE ((src = %Q AND (mode IS NOT NULL OR EXISTS (SELECT NULL FROM live WHERE name=dest))) OR (dest = %Q AND (mode IS NOT NULL OR EXISTS (SELECT NULL FROM live WHERE name=src)))) UNION SELECT s1.src, s2.dest, s1.srcFull, s2.destFull, NULL FROM subscriptions s1, subscriptions s2, topics t WHERE (s1.dest = t.topic AND s2.src = t.topic AND ((s1.src = %Q AND EXISTS (SELECT NULL FROM live WHERE name=s2.dest)) OR (s2.dest = %Q AND EXISTS (SELECT NULL FROM live WHERE name=s1.src))))",port.c_str(), port.c_str(), port.c_str(), port.c_str());
-    yCDebug(SUBSCRIBERONSQL, "Query: %s", query);
-
-    int result = sqlite3_prepare_v2(SQLDB(implementation), query, -1, &statement, nullptr);
-    if (result!=SQLITE_OK) {
-        const char *msg = sqlite3_errmsg(SQLDB(implementation));
-        if (msg != nullptr) {
-            yCError(SUBSCRIBERONSQL, "%s", msg);
+    {
+        SqliteStatement statement = statements.get("SELECT src,dest,srcFull,destFull,mode FROM subscriptions WHERE ((src = ?1 AND (mode IS NOT NULL OR EXISTS (SELECT NULL FROM live WHERE name=dest))) OR (dest = ?1 AND (mode IS NOT NULL OR EXISTS (SELECT NULL FROM live WHERE name=src)))) UNION SELECT s1.src, s2.dest, s1.srcFull, s2.destFull, NULL FROM subscriptions s1, subscriptions s2, topics t WHERE (s1.dest = t.topic AND s2.src = t.topic AND ((s1.src = ?1 AND EXISTS (SELECT NULL FROM live WHERE name=s2.dest)) OR (s2.dest = ?1 AND EXISTS (SELECT NULL FROM live WHERE name=s1.src))))");
+        yCDebug(SUBSCRIBERONSQL, "Query: breakdown %s", port.c_str());
+        statement.bind(1, port);
+        while (statement.step()) {
+            const char *src = statement.text(0);
+            const char *dest = statement.text(1);
+            const char *srcFull = statement.text(2);
+            const char *destFull = statement.text(3);
+            const char *mode = statement.text(4);
+            breakSubscription(port,src,dest,srcFull,destFull,mode?mode:"");
         }
     }
-    while (result == SQLITE_OK && sqlite3_step(statement) == SQLITE_ROW) {
-        char *src = (char *)sqlite3_column_text(statement,0);
-        char *dest = (char *)sqlite3_column_text(statement,1);
-        char *srcFull = (char *)sqlite3_column_text(statement,2);
-        char *destFull = (char *)sqlite3_column_text(statement,3);
-        char *mode = (char *)sqlite3_column_text(statement,4);
-        breakSubscription(port,src,dest,srcFull,destFull,mode?mode:"");
-    }
-    sqlite3_finalize(statement);
-    sqlite3_free(query);
     mutex.unlock();
 
     return false;
@@ -500,29 +475,22 @@ bool SubscriberOnSql::breakSubscription(const std::string& dropper,
 bool SubscriberOnSql::listSubscriptions(const std::string& port,
                                         yarp::os::Bottle& reply) {
     mutex.lock();
-    sqlite3_stmt *statement = nullptr;
-    char *query = nullptr;
+    SqliteStatement statement;
     if (std::string(port)!="") {
-        query = sqlite3_mprintf("SELECT s.srcFull, s.DestFull, EXISTS(SELECT topic FROM topics WHERE topic = s.src), EXISTS(SELECT topic FROM topics WHERE topic = s.dest), s.mode FROM subscriptions s WHERE s.src = %Q OR s.dest= %Q ORDER BY s.src, s.dest",port.c_str(),port.c_str());
+        statement = statements.get("SELECT s.srcFull, s.DestFull, EXISTS(SELECT topic FROM topics WHERE topic = s.src), EXISTS(SELECT topic FROM topics WHERE topic = s.dest), s.mode FROM subscriptions s WHERE s.src = ?1 OR s.dest= ?1 ORDER BY s.src, s.dest");
+        statement.bind(1, port);
     } else {
-        query = sqlite3_mprintf("SELECT s.srcFull, s.destFull, EXISTS(SELECT topic FROM topics WHERE topic = s.src), EXISTS(SELECT topic FROM topics WHERE topic = s.dest), s.mode FROM subscriptions s ORDER BY s.src, s.dest");
+        statement = statements.get("SELECT s.srcFull, s.destFull, EXISTS(SELECT topic FROM topics WHERE topic = s.src), EXISTS(SELECT topic FROM topics WHERE topic = s.dest), s.mode FROM subscriptions s ORDER BY s.src, s.dest");
     }
-    yCDebug(SUBSCRIBERONSQL, "Query: %s", query);
+    yCDebug(SUBSCRIBERONSQL, "Query: subscriptions of '%s'", port.c_str());
 
-    int result = sqlite3_prepare_v2(SQLDB(implementation), query, -1, &statement, nullptr);
-   if (result!=SQLITE_OK) {
-        const char *msg = sqlite3_errmsg(SQLDB(implementation));
-        if (msg != nullptr) {
-            yCError(SUBSCRIBERONSQL, "%s", msg);
-        }
-    }
     reply.addString("subscriptions");
-    while (result == SQLITE_OK && sqlite3_step(statement) == SQLITE_ROW) {
-        char *src = (char *)sqlite3_column_text(statement,0);
-        char *dest = (char *)sqlite3_column_text(statement,1);
-        int srcTopic = sqlite3_column_int(statement,2);
-        int destTopic = sqlite3_column_int(statement,3);
-        char *mode = (char *)sqlite3_column_text(statement,4);
+    while (statement.step()) {
+        const char *src = statement.text(0);
+        const char *dest = statement.text(1);
+        int srcTopic = statement.integer(2);
+        int destTopic = statement.integer(3);
+        const char *mode = statement.text(4);
         Bottle& b = reply.addList();
         b.addString("subscription");
         Bottle bsrc;
@@ -549,8 +517,7 @@ bool SubscriberOnSql::listSubscriptions(const std::string& port,
             b.addList() = btopic;
         }
     }
-    sqlite3_finalize(statement);
-    sqlite3_free(query);
+    statement = SqliteStatement();
     mutex.unlock();
 
     return true;
@@ -561,17 +528,12 @@ bool SubscriberOnSql::setTopic(const std::string& port, const std::string& struc
                                bool active) {
     if (structure!="" || !active) {
         mutex.lock();
-        char *query = sqlite3_mprintf("DELETE FROM topics WHERE topic = %Q",
-                                      port.c_str());
-        yCDebug(SUBSCRIBERONSQL, "Query: %s", query);
-
-        int result = sqlite3_exec(SQLDB(implementation), query, nullptr, nullptr, nullptr);
-        bool ok = true;
-        if (result!=SQLITE_OK) {
-            yCError(SUBSCRIBERONSQL, "Error in query");
-            ok = false;
+        bool ok;
+        {
+            SqliteStatement statement = statements.get("DELETE FROM topics WHERE topic = ?");
+            statement.bind(1, port);
+            ok = statement.run();
         }
-        sqlite3_free(query);
         mutex.unlock();
         if (!ok) return false;
         if (!active) return true;
@@ -580,43 +542,25 @@ bool SubscriberOnSql::setTopic(const std::string& port, const std::string& struc
     bool have_topic = false;
     if (structure=="") {
         mutex.lock();
-        sqlite3_stmt *statement = nullptr;
-        char *query = nullptr;
-        query = sqlite3_mprintf("SELECT topic FROM topics WHERE topic = %Q",
-                                port.c_str());
-        yCDebug(SUBSCRIBERONSQL, "Query: %s", query);
-
-        int result = sqlite3_prepare_v2(SQLDB(implementation), query, -1, &statement, nullptr);
-        if (result!=SQLITE_OK) {
-            yCError(SUBSCRIBERONSQL, "Error in query");
-        }
-        if (result == SQLITE_OK && sqlite3_step(statement) == SQLITE_ROW) {
-            have_topic = true;
+        {
+            SqliteStatement statement = statements.get("SELECT topic FROM topics WHERE topic = ?");
+            statement.bind(1, port);
+            have_topic = statement.step();
         }
-        sqlite3_finalize(statement);
-        sqlite3_free(query);
         mutex.unlock();
     }
 
     if (structure!="" || !have_topic) {
         mutex.lock();
-        char *msg = nullptr;
         const char *pstructure = structure.c_str();
         if (structure=="") pstructure = nullptr;
-        char *query = sqlite3_mprintf("INSERT INTO topics (topic,structure) VALUES(%Q,%Q)",
-                                      port.c_str(),pstructure);
-        yCDebug(SUBSCRIBERONSQL, "Query: %s", query);
-
-        bool ok = true;
-        int result = sqlite3_exec(SQLDB(implementation), query, nullptr, nullptr, &msg);
-        if (result!=SQLITE_OK) {
-            ok = false;
-            if (msg != nullptr) {
-                yCError(SUBSCRIBERONSQL, "%s", msg);
-                sqlite3_free(msg);
-            }
+        bool ok;
+        {
+            SqliteStatement statement = statements.get("INSERT INTO topics (topic,structure) VALUES(?,?)");
+            statement.bind(1, port);
+            statement.bind(2, pstructure);
+            ok = statement.run();
         }
-        sqlite3_free(query);
         mutex.unlock();
         if (!ok) return false;
     }
@@ -625,34 +569,19 @@ bool SubscriberOnSql::setTopic(const std::string& port, const std::string& struc
 
     // go ahead and connect anything needed
     mutex.lock();
-    sqlite3_stmt *statement = nullptr;
-    char *query = sqlite3_mprintf("SELECT s1.src, s2.dest, s1.srcFull, s2.destFull FROM subscriptions s1, subscriptions s2, topics t WHERE (t.topic = %Q AND s1.dest = t.topic AND s2.src = t.topic)", port.c_str());
-    yCDebug(SUBSCRIBERONSQL, "Query: %s", query);
-
-    int result = sqlite3_prepare_v2(SQLDB(implementation), query, -1, &statement, nullptr);
-    if (result!=SQLITE_OK) {
-        const char *msg = sqlite3_errmsg(SQLDB(implementation));
-        if (msg != nullptr) {
-            yCError(SUBSCRIBERONSQL, "%s", msg);
+    {
+        SqliteStatement statement = statements.get("SELECT s1.src, s2.dest, s1.srcFull, s2.destFull FROM subscriptions s1, subscriptions s2, topics t WHERE (t.topic = ? AND s1.dest = t.topic AND s2.src = t.topic)");
+        statement.bind(1, port);
+        while (statement.step()) {
+            vector<std::string> sub;
+            sub.emplace_back(statement.text(0));
+            sub.emplace_back(statement.text(1));
+            sub.emplace_back(statement.text(2));
+            sub.emplace_back(statement.text(3));
+            sub.emplace_back("");
+            subs.push_back(sub);
         }
     }
-    while (result == SQLITE_OK &&
-           sqlite3_step(statement) == SQLITE_ROW) {
-        char *src = (char *)sqlite3_column_text(statement,0);
-        char *dest = (char *)sqlite3_column_text(statement,1);
-        char *srcFull = (char *)sqlite3_column_text(statement,2);
-        char *destFull = (char *)sqlite3_column_text(statement,3);
-        char *mode = (char *)sqlite3_column_text(statement,4);
-        vector<std::string> sub;
-        sub.emplace_back(src);
-        sub.emplace_back(dest);
-        sub.emplace_back(srcFull);
-        sub.emplace_back(destFull);
-        sub.emplace_back(mode?mode:"");
-        subs.push_back(sub);
-    }
-    sqlite3_finalize(statement);
-    sqlite3_free(query);
     mutex.unlock();
 
     for (auto& sub : subs) {
@@ -665,21 +594,12 @@ bool SubscriberOnSql::setTopic(const std::string& port, const std::string& struc
 
 bool SubscriberOnSql::listTopics(yarp::os::Bottle& topics) {
     mutex.lock();
-    sqlite3_stmt *statement = nullptr;
-    char *query = nullptr;
-    query = sqlite3_mprintf("SELECT topic FROM topics");
-    yCDebug(SUBSCRIBERONSQL, "Query: %s", query);
-
-    int result = sqlite3_prepare_v2(SQLDB(implementation), query, -1, &statement, nullptr);
-    if (result!=SQLITE_OK) {
-        yCError(SUBSCRIBERONSQL, "Error in query");
-    }
-    while (result == SQLITE_OK && sqlite3_step(statement) == SQLITE_ROW) {
-        char *topic = (char *)sqlite3_column_text(statement,0);
-        topics.addString(topic);
+    {
+        SqliteStatement statement = statements.get("SELECT topic FROM topics");
+        while (statement.step()) {
+            topics.addString(statement.text(0));
+        }
     }
-    sqlite3_finalize(statement);
-    sqlite3_free(query);
     mutex.unlock();
 
     return true;
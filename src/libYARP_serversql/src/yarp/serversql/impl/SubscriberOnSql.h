@@ -11,6 +11,7 @@
 #define YARP_SERVERSQL_IMPL_SUBSCRIBERONSQL_H
 
 #include <yarp/serversql/impl/Subscriber.h>
+#include <yarp/serversql/impl/SqliteStatementCache.h>
 
 #include <mutex>
 
@@ -37,7 +38,17 @@ public:
         }
     }
 
-    bool open(const std::string& filename, bool fresh = false);
+    /**
+     * @param filename the database file, or ":memory:"
+     * @param fresh fail if the file already exists
+     * @param cautious wait for each change to reach the disk
+     * @param wal use a write-ahead log for the database file, rather than
+     *            a rollback journal
+     */
+    bool open(const std::string& filename,
+              bool fresh = false,
+              bool cautious = false,
+              bool wal = false);
 
     bool close();
 
@@ -90,6 +101,7 @@ public:
 
 private:
     void *implementation {nullptr};
+    SqliteStatementCache statements;
     std::mutex mutex;
 };
 
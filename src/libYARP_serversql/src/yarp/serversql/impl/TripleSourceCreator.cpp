@@ -10,6 +10,7 @@
 #include <yarp/serversql/impl/TripleSourceCreator.h>
 
 #include <yarp/conf/compiler.h>
+#include <yarp/serversql/impl/MemoryTripleSource.h>
 #include <yarp/serversql/impl/SqliteTripleSource.h>
 
 #if !defined(_WIN32)
@@ -46,7 +47,14 @@ static bool sql_enact(sqlite3 *db, const char *cmd) {
 
 TripleSource *TripleSourceCreator::open(const char *filename,
                                         bool cautious,
-                                        bool fresh) {
+                                        bool fresh,
+                                        bool wal) {
+    if (string(filename) == ":memory:") {
+        // nothing to keep, no need for a database at all
+        accessor = new MemoryTripleSource();
+        return accessor;
+    }
+
     sqlite3 *db = nullptr;
     if (fresh) {
         int result = access(filename,F_OK);
@@ -88,13 +96,18 @@ TripleSource *TripleSourceCreator::open(const char *filename,
         std::exit(1);
     }
 
+    if (wal) {
+        sql_enact(db,"PRAGMA journal_mode=WAL;");
+    }
     string cmd_synch = string("PRAGMA synchronous=") + (cautious?"FULL":"OFF") + ";";
     sql_enact(db,cmd_synch.c_str());
 
     sql_enact(db,"CREATE INDEX IF NOT EXISTS tagsRidNameValue on tags(rid,name,value);");
 
     implementation = db;
-    accessor = new SqliteTripleSource(db);
+    auto* sqlStore = new SqliteTripleSource(db);
+    store = sqlStore;
+    accessor = new MemoryTripleSource(sqlStore);
     return accessor;
 }
 
@@ -104,6 +117,10 @@ bool TripleSourceCreator::close() {
         delete accessor;
         accessor = nullptr;
     }
+    if (store != nullptr) {
+        delete store;
+        store = nullptr;
+    }
     if (implementation != nullptr) {
         auto* db = (sqlite3 *)implementation;
         sqlite3_close(db);
@@ -20,6 +20,9 @@ namespace impl {
 
 /**
  * Open and close a database, viewed as a collection of triples.
+ * The triples are kept in memory, a database named ":memory:" is not
+ * created at all, the others keep a copy of the triples in a Sqlite
+ * database file.
  */
 class TripleSourceCreator
 {
@@ -28,19 +31,28 @@ public:
 
     virtual ~TripleSourceCreator()
     {
-        if (implementation != nullptr) {
+        if (accessor != nullptr) {
             close();
         }
     }
 
+    /**
+     * @param filename the database file, or ":memory:"
+     * @param cautious wait for each change to reach the disk
+     * @param fresh fail if the file already exists
+     * @param wal use a write-ahead log for the database file, rather than
+     *            a rollback journal
+     */
     TripleSource *open(const char *filename,
                        bool cautious = false,
-                       bool fresh = false);
+                       bool fresh = false,
+                       bool wal = false);
 
     bool close();
 
 private:
     void* implementation {nullptr};
+    TripleSource* store {nullptr};
     TripleSource* accessor {nullptr};
 };
 
@@ -10,6 +10,7 @@
 #include <yarp/os/Log.h>
 #include <yarp/sig/Image.h>
 #include <yarp/sig/impl/IplImage.h>
+#include <yarp/sig/impl/PixelKernels.h>
 
 #include <cstring>
 #include <cstdio>
@@ -1172,7 +1173,8 @@ static inline void CopyPixel(const PixelInt* src, PixelInt* dest)
 template <class T1, class T2>
 static void CopyPixels(const T1 *osrc, int q1, T2 *odest, int q2,
                        int w, int h,
-                       bool flip)
+                       bool flip,
+                       yarp::sig::impl::PixelRowKernel kernel)
 {
     const T1 *src = osrc;
     T2 *dest = odest;
@@ -1189,7 +1191,16 @@ static void CopyPixels(const T1 *osrc, int q1, T2 *odest, int q2,
 
     for (int i=0; i<h; i++) {
         DBG printf("x,y = %d,%d\n", 0,i);
-        for (int j = 0; j < w; j++) {
+        int j = 0;
+        if (kernel != nullptr) {
+            // vectorized conversion of most of the row
+            j = static_cast<int>(kernel(reinterpret_cast<const unsigned char*>(src),
+                                        reinterpret_cast<unsigned char*>(dest),
+                                        w));
+            src += j;
+            dest += j;
+        }
+        for (; j < w; j++) {
             CopyPixel(src,dest);
             src++;
             dest++;
@@ -1218,7 +1229,7 @@ using Def_VOCAB_PIXEL_INT = PixelInt;
 using Def_VOCAB_PIXEL_RGB_INT = PixelRgbInt;
 
 #define HASH(id1, id2) ((int)(((int)(id1%65537))*11 + ((long int)(id2))))
-#define HANDLE_CASE(len, x1, T1, q1, o1, x2, T2, q2, o2) CopyPixels(reinterpret_cast<const T1*>(x1), q1, reinterpret_cast<T2*>(x2), q2, w, h, o1!=o2);
+#define HANDLE_CASE(len, x1, T1, q1, o1, x2, T2, q2, o2) CopyPixels(reinterpret_cast<const T1*>(x1), q1, reinterpret_cast<T2*>(x2), q2, w, h, o1!=o2, kernel);
 #define MAKE_CASE(id1, id2) case HASH(id1, id2): HANDLE_CASE(len, src, Def_##id1, quantum1, topIsLow1, dest, Def_##id2, quantum2, topIsLow2); break;
 
 // More elegant ways to do this, but needs to be efficient at pixel level
@@ -1235,6 +1246,8 @@ void Image::copyPixels(const unsigned char *src, size_t id1,
     }
 
 
+    yarp::sig::impl::PixelRowKernel kernel = yarp::sig::impl::getPixelRowKernel(static_cast<int>(id1), static_cast<int>(id2));
+
     switch(HASH(id1,id2)) {
         // Macros rely on len, x1, x2 variable names
 
@@ -0,0 +1,359 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <yarp/sig/Image.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+using namespace yarp::sig;
+
+namespace {
+
+/*
+ * The scaling is separable: each row of the destination is a weighted sum
+ * of some rows of the source, and each column a weighted sum of some
+ * columns.  The source pixels used for each destination pixel along an
+ * axis, and their weights, are computed once, before scaling the image.
+ */
+struct Taps
+{
+    // the taps of pixel i are the ones from first[i] to first[i + 1]
+    std::vector<size_t> first{0};
+    std::vector<size_t> index;
+    std::vector<float> weight;
+
+    void add(size_t i, double w)
+    {
+        index.push_back(i);
+        weight.push_back(static_cast<float>(w));
+    }
+
+    void next()
+    {
+        first.push_back(index.size());
+    }
+};
+
+Taps nearestTaps(size_t srcLength, size_t destLength)
+{
+    // the sampling that Image::copy(alt, w, h) has always used
+    Taps taps;
+    float step = static_cast<float>(srcLength) / destLength;
+    for (size_t i = 0; i < destLength; i++) {
+        taps.add(static_cast<size_t>(step * i), 1.0);
+        taps.next();
+    }
+    return taps;
+}
+
+Taps bilinearTaps(size_t srcLength, size_t destLength)
+{
+    // the centers of the pixels of the two images are aligned
+    Taps taps;
+    double step = static_cast<double>(srcLength) / destLength;
+    for (size_t i = 0; i < destLength; i++) {
+        double x = std::max((i + 0.5) * step - 0.5, 0.0);
+        auto x0 = static_cast<size_t>(x);
+        double f = x - x0;
+        if (x0 + 1 >= srcLength) {
+            taps.add(srcLength - 1, 1.0);
+        } else if (f == 0) {
+            taps.add(x0, 1.0);
+        } else {
+            taps.add(x0, 1.0 - f);
+            taps.add(x0 + 1, f);
+        }
+        taps.next();
+    }
+    return taps;
+}
+
+Taps areaTaps(size_t srcLength, size_t destLength)
+{
+    // each pixel is weighted by the part of it covered by the destination
+    // pixel
+    Taps taps;
+    double step = static_cast<double>(srcLength) / destLength;
+    for (size_t i = 0; i < destLength; i++) {
+        double begin = i * step;
+        double end = std::min((i + 1) * step, static_cast<double>(srcLength));
+        for (auto x = static_cast<size_t>(begin); x < end; x++) {
+            double covered = std::min(end, x + 1.0) - std::max(begin, static_cast<double>(x));
+            if (covered > 0) {
+                taps.add(x, covered / (end - begin));
+            }
+        }
+        taps.next();
+    }
+    return taps;
+}
+
+// the sums of int32 channels need the precision of a double
+template <typename T>
+using Accumulator = typename std::conditional<std::is_integral<T>::value && sizeof(T) >= 4, double, float>::type;
+
+template <typename T, typename A>
+inline typename std::enable_if<std::is_floating_point<T>::value, T>::type toChannel(A value)
+{
+    return static_cast<T>(value);
+}
+
+template <typename T, typename A>
+inline typename std::enable_if<std::is_integral<T>::value, T>::type toChannel(A value)
+{
+    value = std::floor(value + A(0.5));
+    if (value <= static_cast<A>(std::numeric_limits<T>::min())) {
+        return std::numeric_limits<T>::min();
+    }
+    if (value >= static_cast<A>(std::numeric_limits<T>::max())) {
+        return std::numeric_limits<T>::max();
+    }
+    return static_cast<T>(value);
+}
+
+/*
+ * Scales the rows from begin to end of an image with channels of type T,
+ * C for each pixel, and passes each row to output(row, pixels).
+ *
+ * Each source row is first scaled horizontally, and kept while the
+ * following destination rows use it.  The vertical pass works on whole
+ * rows, in loops that the compiler can vectorize.
+ */
+template <typename T, size_t C, typename Output>
+void scaleRows(const Image& src, const Taps& xTaps, const Taps& yTaps, size_t begin, size_t end, Output output)
+{
+    using A = Accumulator<T>;
+    const size_t width = xTaps.first.size() - 1;
+    const size_t length = width * C;
+    const size_t none = std::numeric_limits<size_t>::max();
+
+    std::vector<A> cache[2] = {std::vector<A>(length), std::vector<A>(length)};
+    size_t cached[2] = {none, none};
+    std::vector<A> sum(length);
+    std::vector<T> row(length);
+
+    for (size_t i = begin; i < end; i++) {
+        std::fill(sum.begin(), sum.end(), A(0));
+        for (size_t k = yTaps.first[i]; k < yTaps.first[i + 1]; k++) {
+            size_t r = yTaps.index[k];
+            A* line = cache[r & 1].data();
+            if (cached[r & 1] != r) {
+                const T* in = reinterpret_cast<const T*>(src.getRow(r));
+                for (size_t j = 0; j < width; j++) {
+                    A pixel[C] = {};
+                    for (size_t t = xTaps.first[j]; t < xTaps.first[j + 1]; t++) {
+                        const T* p = in + xTaps.index[t] * C;
+                        A w = xTaps.weight[t];
+                        for (size_t c = 0; c < C; c++) {
+                            pixel[c] += w * p[c];
+                        }
+                    }
+                    for (size_t c = 0; c < C; c++) {
+                        line[j * C + c] = pixel[c];
+                    }
+                }
+                cached[r & 1] = r;
+            }
+            A w = yTaps.weight[k];
+            A* s = sum.data();
+            for (size_t n = 0; n < length; n++) {
+                s[n] += w * line[n];
+            }
+        }
+        for (size_t n = 0; n < length; n++) {
+            row[n] = toChannel<T>(sum[n]);
+        }
+        output(i, reinterpret_cast<const unsigned char*>(row.data()));
+    }
+}
+
+// Copies the pixels picked by the taps, without interpolating them
+template <size_t N, typename Output>
+void pickRows(const Image& src, const Taps& xTaps, const Taps& yTaps, size_t size, size_t begin, size_t end, Output output)
+{
+    const size_t width = xTaps.first.size() - 1;
+    const size_t pixelSize = (N != 0) ? N : size;
+    std::vector<size_t> offsets(width);
+    for (size_t j = 0; j < width; j++) {
+        offsets[j] = xTaps.index[xTaps.first[j]] * pixelSize;
+    }
+    std::vector<unsigned char> row(width * pixelSize);
+    for (size_t i = begin; i < end; i++) {
+        const unsigned char* in = src.getRow(yTaps.index[yTaps.first[i]]);
+        unsigned char* out = row.data();
+        for (size_t j = 0; j < width; j++) {
+            memcpy(out, in + offsets[j], pixelSize);
+            out += pixelSize;
+        }
+        output(i, row.data());
+    }
+}
+
+template <typename Output>
+void pickRows(const Image& src, const Taps& xTaps, const Taps& yTaps, size_t begin, size_t end, Output output)
+{
+    switch (src.getPixelSize()) {
+    case 1: pickRows<1>(src, xTaps, yTaps, 1, begin, end, output); break;
+    case 2: pickRows<2>(src, xTaps, yTaps, 2, begin, end, output); break;
+    case 3: pickRows<3>(src, xTaps, yTaps, 3, begin, end, output); break;
+    case 4: pickRows<4>(src, xTaps, yTaps, 4, begin, end, output); break;
+    case 12: pickRows<12>(src, xTaps, yTaps, 12, begin, end, output); break;
+    default: pickRows<0>(src, xTaps, yTaps, src.getPixelSize(), begin, end, output); break;
+    }
+}
+
+template <typename T, typename Output>
+bool scaleRows(const Image& src, size_t channels, const Taps& xTaps, const Taps& yTaps, size_t begin, size_t end, Output output)
+{
+    switch (channels) {
+    case 1: scaleRows<T, 1>(src, xTaps, yTaps, begin, end, output); return true;
+    case 3: scaleRows<T, 3>(src, xTaps, yTaps, begin, end, output); return true;
+    case 4: scaleRows<T, 4>(src, xTaps, yTaps, begin, end, output); return true;
+    default: return false;
+    }
+}
+
+bool isInterpolable(int code)
+{
+    switch (code) {
+    case VOCAB_PIXEL_MONO:
+    case VOCAB_PIXEL_RGB:
+    case VOCAB_PIXEL_HSV:
+    case VOCAB_PIXEL_BGR:
+    case VOCAB_PIXEL_RGBA:
+    case VOCAB_PIXEL_BGRA:
+    case VOCAB_PIXEL_MONO_SIGNED:
+    case VOCAB_PIXEL_RGB_SIGNED:
+    case VOCAB_PIXEL_MONO16:
+    case VOCAB_PIXEL_INT:
+    case VOCAB_PIXEL_RGB_INT:
+    case VOCAB_PIXEL_MONO_FLOAT:
+    case VOCAB_PIXEL_RGB_FLOAT:
+    case VOCAB_PIXEL_HSV_FLOAT:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Scales the rows with the interpolation of the taps, for the pixel types
+// accepted by isInterpolable()
+template <typename Output>
+bool scaleRows(const Image& src, const Taps& xTaps, const Taps& yTaps, size_t begin, size_t end, Output output)
+{
+    switch (src.getPixelCode()) {
+    case VOCAB_PIXEL_MONO:
+    case VOCAB_PIXEL_RGB:
+    case VOCAB_PIXEL_HSV:
+    case VOCAB_PIXEL_BGR:
+    case VOCAB_PIXEL_RGBA:
+    case VOCAB_PIXEL_BGRA:
+        return scaleRows<std::uint8_t>(src, src.getPixelSize(), xTaps, yTaps, begin, end, output);
+    case VOCAB_PIXEL_MONO_SIGNED:
+    case VOCAB_PIXEL_RGB_SIGNED:
+        return scaleRows<std::int8_t>(src, src.getPixelSize(), xTaps, yTaps, begin, end, output);
+    case VOCAB_PIXEL_MONO16:
+        return scaleRows<std::uint16_t>(src, 1, xTaps, yTaps, begin, end, output);
+    case VOCAB_PIXEL_INT:
+    case VOCAB_PIXEL_RGB_INT:
+        return scaleRows<std::int32_t>(src, src.getPixelSize() / sizeof(std::int32_t), xTaps, yTaps, begin, end, output);
+    case VOCAB_PIXEL_MONO_FLOAT:
+    case VOCAB_PIXEL_RGB_FLOAT:
+    case VOCAB_PIXEL_HSV_FLOAT:
+        return scaleRows<float>(src, src.getPixelSize() / sizeof(float), xTaps, yTaps, begin, end, output);
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+
+bool Image::copy(const Image& alt, size_t w, size_t h, Interpolation interpolation, size_t threads)
+{
+    if (getPixelCode()==0) {
+        setPixelCode(alt.getPixelCode());
+        setQuantum(alt.getQuantum());
+    }
+    if (&alt==this) {
+        FlexImage img;
+        img.copy(alt);
+        return copy(img, w, h, interpolation, threads);
+    }
+
+    resize(w,h);
+    if (w == 0 || h == 0) {
+        return true;
+    }
+    if (alt.width() == 0 || alt.height() == 0) {
+        return false;
+    }
+
+    if (!isInterpolable(alt.getPixelCode())) {
+        interpolation = INTERPOLATION_NEAREST;
+    }
+    Taps xTaps;
+    Taps yTaps;
+    switch (interpolation) {
+    case INTERPOLATION_BILINEAR:
+        xTaps = bilinearTaps(alt.width(), w);
+        yTaps = bilinearTaps(alt.height(), h);
+        break;
+    case INTERPOLATION_AREA:
+        xTaps = areaTaps(alt.width(), w);
+        yTaps = areaTaps(alt.height(), h);
+        break;
+    case INTERPOLATION_NEAREST:
+    default:
+        xTaps = nearestTaps(alt.width(), w);
+        yTaps = nearestTaps(alt.height(), h);
+        break;
+    }
+
+    // the rows are converted to the pixel type of this image as soon as
+    // they are scaled
+    const int srcCode = alt.getPixelCode();
+    const int destCode = getPixelCode();
+    const size_t rowLength = w * getPixelSize();
+    auto output = [&](size_t i, const unsigned char* pixels) {
+        if (srcCode == destCode) {
+            memcpy(getRow(i), pixels, rowLength);
+        } else {
+            copyPixels(pixels, srcCode, getRow(i), destCode, w, 1, rowLength, 1, 1, false, false);
+        }
+    };
+
+    auto run = [&](size_t begin, size_t end) {
+        if (interpolation == INTERPOLATION_NEAREST) {
+            pickRows(alt, xTaps, yTaps, begin, end, output);
+        } else {
+            scaleRows(alt, xTaps, yTaps, begin, end, output);
+        }
+    };
+
+    if (threads == 0) {
+        threads = std::max(std::thread::hardware_concurrency(), 1U);
+    }
+    threads = std::min(threads, h);
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < threads; t++) {
+        workers.emplace_back(run, h * t / threads, h * (t + 1) / threads);
+    }
+    run(0, h / threads);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    return true;
+}
@@ -877,45 +877,5 @@ void Image::setExternal(const void *data, size_t imgWidth, size_t imgHeight) {
 
 
 bool Image::copy(const Image& alt, size_t w, size_t h) {
-    if (getPixelCode()==0) {
-        setPixelCode(alt.getPixelCode());
-        setQuantum(alt.getQuantum());
-    }
-    if (&alt==this) {
-        FlexImage img;
-        img.copy(alt);
-        return copy(img,w,h);
-    }
-
-    if (getPixelCode()!=alt.getPixelCode()) {
-        FlexImage img;
-        img.setPixelCode(getPixelCode());
-        img.setQuantum(getQuantum());
-        img.copy(alt);
-        return copy(img,w,h);
-    }
-
-    resize(w,h);
-    size_t d = getPixelSize();
-
-    size_t nw = w;
-    size_t nh = h;
-    w = alt.width();
-    h = alt.height();
-
-    float di = ((float)h)/nh;
-    float dj = ((float)w)/nw;
-
-    for (size_t i=0; i<nh; i++)
-        {
-            auto i0 = (size_t)(di*i);
-            for (size_t j=0; j<nw; j++)
-                {
-                    auto j0 = (size_t)(dj*j);
-                    memcpy(getPixelAddress(j,i),
-                           alt.getPixelAddress(j0,i0),
-                           d);
-                }
-        }
-    return true;
+    return copy(alt, w, h, INTERPOLATION_NEAREST);
 }
@@ -138,7 +138,7 @@ public:
     /**
      * Scaled copy.
      * Clones the content of another image, and resizes in a fast but
-     * low-quality way.
+     * low-quality way (as INTERPOLATION_NEAREST).
      * @param alt the image to copy
      * @param w target width for image
      * @param h target height for image
@@ -146,6 +146,39 @@ public:
     bool copy(const Image& alt, size_t w, size_t h);
 
 
+    /**
+     * How the pixels are computed in a scaled copy.
+     */
+    enum Interpolation
+    {
+        /// Copy the nearest pixel, fast but low quality
+        INTERPOLATION_NEAREST,
+        /// Interpolate the four nearest pixels, good to enlarge images
+        INTERPOLATION_BILINEAR,
+        /// Average the pixels covered by each pixel, good to shrink images
+        INTERPOLATION_AREA
+    };
+
+    /**
+     * Scaled copy.
+     * Clones the content of another image, and resizes it, converting the
+     * pixels to the type of this image in the same pass.
+     *
+     * The interpolation is done on each channel of the pixels, and it is
+     * possible for all the pixel types except the Bayer and YUV
+     * encodings, that are always copied as with INTERPOLATION_NEAREST.
+     *
+     * @param alt the image to copy
+     * @param w target width for image
+     * @param h target height for image
+     * @param interpolation how the pixels are computed
+     * @param threads the number of threads sharing the rows of the image,
+     * or 0 to use one thread for each processor
+     * @return true on success
+     */
+    bool copy(const Image& alt, size_t w, size_t h, Interpolation interpolation, size_t threads = 1);
+
+
     /**
      * Gets width of image in pixels.
      * @return the width of the image in pixels (0 if no image present)
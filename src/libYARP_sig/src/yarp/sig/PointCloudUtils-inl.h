@@ -23,8 +23,8 @@ yarp::sig::PointCloud<T1> yarp::sig::utils::depthRgbToPC(const yarp::sig::ImageO
     yarp::sig::PointCloud<T1> pointCloud;
     pointCloud.resize(w, h);
 
-    for (size_t u = 0; u < w; ++u) {
-        for (size_t v = 0; v < h; ++v) {
+    for (size_t v = 0; v < h; ++v) {
+        for (size_t u = 0; u < w; ++u) {
             // Depth
             // De-projection equation (pinhole model):
             //                          x = (u - ppx)/ fx * z
@@ -6,36 +6,87 @@
  * BSD-3-Clause license. See the accompanying LICENSE file for details.
  */
 
+#define _USE_MATH_DEFINES
+
 #include <yarp/sig/PointCloudUtils.h>
+
+#include <algorithm>
+#include <cmath>
 #include <cstring>
+#include <thread>
+#include <vector>
 
 using namespace yarp::sig;
 
 namespace {
 YARP_LOG_COMPONENT(POINTCLOUDUTILS, "yarp.sig.PointCloudUtils")
+
+// Calls band(begin, end) on consecutive bands of [0, count), each one in its
+// own thread. The current thread computes the first band.
+template <typename F>
+void forEachBand(size_t count, size_t threads, F band)
+{
+    threads = std::max<size_t>(1, std::min(threads, count));
+    if (threads == 1) {
+        band(0, count);
+        return;
+    }
+
+    size_t chunk = (count + threads - 1) / threads;
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (size_t t = 1; t < threads; ++t) {
+        size_t begin = std::min(count, t * chunk);
+        size_t end = std::min(count, begin + chunk);
+        workers.emplace_back([&band, begin, end]() { band(begin, end); });
+    }
+    band(0, std::min(count, chunk));
+    for (auto& worker : workers) {
+        worker.join();
+    }
 }
 
+void scanBand(const PointCloud<DataXYZ>& pointCloud,
+              size_t begin,
+              size_t end,
+              float min_z,
+              float max_z,
+              double resolution,
+              double* ranges,
+              size_t size)
+{
+    constexpr double rad2deg = 180.0 / M_PI;
+    for (size_t i = begin; i < end; ++i) {
+        const DataXYZ& p = pointCloud(i);
+        // we check if the point is in the volume that we want to consider as possible obstacle
+        if (!(p.z > min_z && p.z < max_z)) {
+            continue;
+        }
+        // by removing z, we project the 3d point on the 2D plane on which the laser works
+        double theta = std::atan2(p.y, p.x) * rad2deg;
+        if (theta < 0) {
+            theta += 360;
+        }
+        auto elem = static_cast<size_t>(theta / resolution);
+        if (elem >= size) {
+            continue;
+        }
+        double distance = std::sqrt(static_cast<double>(p.x) * p.x + static_cast<double>(p.y) * p.y);
+        if (distance < ranges[elem]) {
+            ranges[elem] = distance;
+        }
+    }
+}
+
+} // namespace
+
 PointCloud<DataXYZ> utils::depthToPC(const yarp::sig::ImageOf<PixelFloat> &depth,
                                      const yarp::sig::IntrinsicParams &intrinsic)
 {
     yCAssert(POINTCLOUDUTILS, depth.width()  != 0);
     yCAssert(POINTCLOUDUTILS, depth.height() != 0);
-    size_t w = depth.width();
-    size_t h = depth.height();
     PointCloud<DataXYZ> pointCloud;
-    pointCloud.resize(w, h);
-
-    for (size_t u = 0; u < w; ++u) {
-        for (size_t v = 0; v < h; ++v) {
-            // De-projection equation (pinhole model):
-            //                          x = (u - ppx)/ fx * z
-            //                          y = (v - ppy)/ fy * z
-            //                          z = z
-            pointCloud(u,v).x = (u - intrinsic.principalPointX)/intrinsic.focalLengthX*depth.pixel(u,v);
-            pointCloud(u,v).y = (v - intrinsic.principalPointY)/intrinsic.focalLengthY*depth.pixel(u,v);
-            pointCloud(u,v).z = depth.pixel(u,v);
-        }
-    }
+    depthToPC(depth, intrinsic, PCL_ROI(), 1, 1, pointCloud);
     return pointCloud;
 }
 
@@ -47,27 +98,124 @@ PointCloud<DataXYZ> utils::depthToPC(const yarp::sig::ImageOf<PixelFloat>& depth
 {
     yCAssert(POINTCLOUDUTILS, depth.width() != 0);
     yCAssert(POINTCLOUDUTILS, depth.height() != 0);
+    PointCloud<DataXYZ> pointCloud;
+    depthToPC(depth, intrinsic, roi, step_x, step_y, pointCloud);
+    return pointCloud;
+}
+
+void utils::depthToPC(const yarp::sig::ImageOf<PixelFloat>& depth,
+                      const yarp::sig::IntrinsicParams& intrinsic,
+                      const PCL_ROI& roi,
+                      size_t step_x,
+                      size_t step_y,
+                      PointCloud<DataXYZ>& pointCloud,
+                      size_t threads)
+{
+    step_x = std::max<size_t>(step_x, 1);
+    step_y = std::max<size_t>(step_y, 1);
+    size_t max_x = (roi.max_x == 0) ? depth.width() : std::min(roi.max_x, depth.width());
+    size_t max_y = (roi.max_y == 0) ? depth.height() : std::min(roi.max_y, depth.height());
+    size_t w = (roi.min_x < max_x) ? (max_x - roi.min_x + step_x - 1) / step_x : 0;
+    size_t h = (roi.min_y < max_y) ? (max_y - roi.min_y + step_y - 1) / step_y : 0;
+    if (pointCloud.width() != w || pointCloud.height() != h) {
+        pointCloud.resize(w, h);
+    }
+    if (w == 0 || h == 0) {
+        return;
+    }
 
-    size_t max_x = 0;
-    size_t max_y = 0;
-    if (roi.max_x == 0) max_x = depth.width();
-    if (roi.max_y == 0) max_y = depth.height();
-    max_x = max_x < depth.width()  ? max_x : depth.width();
-    max_y = max_y < depth.height() ? max_y : depth.height();
+    // De-projection equation (pinhole model):
+    //                          x = (u - ppx)/ fx * z
+    //                          y = (v - ppy)/ fy * z
+    //                          z = z
+    // The divisions are replaced by multiplications, and the rows of the
+    // image are read in memory order.
+    const auto inv_fx = static_cast<float>(1.0 / intrinsic.focalLengthX);
+    const auto inv_fy = static_cast<float>(1.0 / intrinsic.focalLengthY);
+    const auto ppx = static_cast<float>(intrinsic.principalPointX);
+    const auto ppy = static_cast<float>(intrinsic.principalPointY);
 
-    PointCloud<DataXYZ> pointCloud;
-    pointCloud.resize(max_x-roi.min_x, max_y-roi.min_y);
-
-    for (    size_t u = roi.min_x; u < max_x; u += step_x) {
-        for (size_t v = roi.min_y; v < max_y; v += step_y) {
-            // De-projection equation (pinhole model):
-            //                          x = (u - ppx)/ fx * z
-            //                          y = (v - ppy)/ fy * z
-            //                          z = z
-            pointCloud(u, v).x = (u - intrinsic.principalPointX) / intrinsic.focalLengthX * depth.pixel(u, v);
-            pointCloud(u, v).y = (v - intrinsic.principalPointY) / intrinsic.focalLengthY * depth.pixel(u, v);
-            pointCloud(u, v).z = depth.pixel(u, v);
+    forEachBand(h, threads, [&](size_t begin, size_t end) {
+        for (size_t j = begin; j < end; ++j) {
+            size_t v = roi.min_y + j * step_y;
+            const auto* row = reinterpret_cast<const float*>(depth.getRow(v)) + roi.min_x;
+            DataXYZ* out = &pointCloud(0, j);
+            const float ky = (static_cast<float>(v) - ppy) * inv_fy;
+            for (size_t i = 0; i < w; ++i) {
+                const float z = row[i * step_x];
+                const float kx = (static_cast<float>(roi.min_x + i * step_x) - ppx) * inv_fx;
+                out[i].x = kx * z;
+                out[i].y = ky * z;
+                out[i].z = z;
+            }
+        }
+    });
+}
+
+void utils::transformPC(PointCloud<DataXYZ>& pointCloud,
+                        const yarp::sig::Matrix& transform,
+                        size_t threads)
+{
+    yCAssert(POINTCLOUDUTILS, transform.rows() == 4 && transform.cols() == 4);
+
+    // The coefficients are copied, so that the loop does not read the matrix
+    const auto r00 = static_cast<float>(transform(0, 0));
+    const auto r01 = static_cast<float>(transform(0, 1));
+    const auto r02 = static_cast<float>(transform(0, 2));
+    const auto r10 = static_cast<float>(transform(1, 0));
+    const auto r11 = static_cast<float>(transform(1, 1));
+    const auto r12 = static_cast<float>(transform(1, 2));
+    const auto r20 = static_cast<float>(transform(2, 0));
+    const auto r21 = static_cast<float>(transform(2, 1));
+    const auto r22 = static_cast<float>(transform(2, 2));
+    const auto tx = static_cast<float>(transform(0, 3));
+    const auto ty = static_cast<float>(transform(1, 3));
+    const auto tz = static_cast<float>(transform(2, 3));
+
+    forEachBand(pointCloud.size(), threads, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            DataXYZ& p = pointCloud(i);
+            const float x = p.x;
+            const float y = p.y;
+            const float z = p.z;
+            p.x = r00 * x + r01 * y + r02 * z + tx;
+            p.y = r10 * x + r11 * y + r12 * z + ty;
+            p.z = r20 * x + r21 * y + r22 * z + tz;
+        }
+    });
+}
+
+void utils::pcToScan(const PointCloud<DataXYZ>& pointCloud,
+                     double min_z,
+                     double max_z,
+                     double resolution,
+                     yarp::sig::Vector& ranges,
+                     size_t threads)
+{
+    yCAssert(POINTCLOUDUTILS, resolution > 0);
+
+    const size_t size = ranges.size();
+    const auto fmin_z = static_cast<float>(min_z);
+    const auto fmax_z = static_cast<float>(max_z);
+    threads = std::max<size_t>(1, std::min(threads, pointCloud.size()));
+    if (threads == 1) {
+        scanBand(pointCloud, 0, pointCloud.size(), fmin_z, fmax_z, resolution, ranges.data(), size);
+        return;
+    }
+
+    // Each band fills its own copy of the scan, then the copies are merged
+    std::vector<double> partial((threads - 1) * size);
+    for (size_t t = 0; t < threads - 1; ++t) {
+        std::copy(ranges.begin(), ranges.end(), partial.begin() + t * size);
+    }
+    size_t chunk = (pointCloud.size() + threads - 1) / threads;
+    forEachBand(pointCloud.size(), threads, [&](size_t begin, size_t end) {
+        double* out = (begin == 0) ? ranges.data() : partial.data() + (begin / chunk - 1) * size;
+        scanBand(pointCloud, begin, end, fmin_z, fmax_z, resolution, out, size);
+    });
+    for (size_t t = 0; t < threads - 1; ++t) {
+        for (size_t e = 0; e < size; ++e) {
+            ranges[e] = std::min(ranges[e], partial[t * size + e]);
         }
     }
-    return pointCloud;
 }
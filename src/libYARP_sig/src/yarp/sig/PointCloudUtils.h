@@ -11,7 +11,9 @@
 
 #include <yarp/sig/Image.h>
 #include <yarp/sig/IntrinsicParams.h>
+#include <yarp/sig/Matrix.h>
 #include <yarp/sig/PointCloud.h>
+#include <yarp/sig/Vector.h>
 
 namespace yarp {
 namespace sig{
@@ -53,10 +55,10 @@ YARP_sig_API yarp::sig::PointCloud<yarp::sig::DataXYZ> depthToPC(const yarp::sig
  * @param[in] intrinsic, intrinsic parameter of the camera.
  * @param[in] roi, the Region Of Interest intrinsic of the depth image that we want to convert.
  * @param[in] step_x, the depth image size can be decimated, by selecting a column every step_x;
- * @param[in] step_t, the depth image size can be decimated, by selecting a row every step_y;
+ * @param[in] step_y, the depth image size can be decimated, by selecting a row every step_y;
  * @note the intrinsic parameters are the one of the depth sensor if the depth frame IS NOT aligned with the
  * colored one. On the other hand use the intrinsic parameters of the RGB camera if the frames are aligned.
- * @return the pointcloud obtained by the de-projection.
+ * @return the pointcloud obtained by the de-projection, with a point for each selected pixel.
  */
 YARP_sig_API yarp::sig::PointCloud<yarp::sig::DataXYZ> depthToPC(const yarp::sig::ImageOf<yarp::sig::PixelFloat>& depth,
                                                                  const yarp::sig::IntrinsicParams& intrinsic,
@@ -64,6 +66,54 @@ YARP_sig_API yarp::sig::PointCloud<yarp::sig::DataXYZ> depthToPC(const yarp::sig
                                                                  size_t step_x,
                                                                  size_t step_y);
 
+/**
+ * @brief depthToPC, compute the PointCloud given depth image, the intrinsic parameters of the camera and a Region Of Interest,
+ * reusing the memory of an existing PointCloud.
+ * @param[in] depth, the input depth image.
+ * @param[in] intrinsic, intrinsic parameter of the camera.
+ * @param[in] roi, the Region Of Interest intrinsic of the depth image that we want to convert (max_x and max_y equal to 0 mean the whole image).
+ * @param[in] step_x, the depth image size can be decimated, by selecting a column every step_x;
+ * @param[in] step_y, the depth image size can be decimated, by selecting a row every step_y;
+ * @param[out] pointCloud, the pointcloud obtained by the de-projection, with a point for each selected pixel.
+ * It is not reallocated if it has already the right size.
+ * @param[in] threads, the number of threads sharing the rows of the image.
+ */
+YARP_sig_API void depthToPC(const yarp::sig::ImageOf<yarp::sig::PixelFloat>& depth,
+                            const yarp::sig::IntrinsicParams& intrinsic,
+                            const yarp::sig::utils::PCL_ROI& roi,
+                            size_t step_x,
+                            size_t step_y,
+                            yarp::sig::PointCloud<yarp::sig::DataXYZ>& pointCloud,
+                            size_t threads = 1);
+
+/**
+ * @brief transformPC, apply a rigid transformation to all the points of a PointCloud, in place.
+ * @param[in,out] pointCloud, the pointcloud to transform.
+ * @param[in] transform, the 4x4 homogeneous transformation matrix.
+ * @param[in] threads, the number of threads sharing the points.
+ */
+YARP_sig_API void transformPC(yarp::sig::PointCloud<yarp::sig::DataXYZ>& pointCloud,
+                              const yarp::sig::Matrix& transform,
+                              size_t threads = 1);
+
+/**
+ * @brief pcToScan, project the points of a PointCloud between two heights on the xy plane, and keep the nearest
+ * point for each angle, as measured by a 2D laser scanner placed in the origin.
+ * @param[in] pointCloud, the pointcloud, in the frame of the scanner.
+ * @param[in] min_z, the points lower than or equal to this height are discarded.
+ * @param[in] max_z, the points higher than or equal to this height are discarded.
+ * @param[in] resolution, the angle between two elements of the scan [deg], starting from the x axis and counterclockwise.
+ * @param[in,out] ranges, the scan. Each element is replaced by the distance of the nearest point, if it is lower:
+ * it must be resized and initialized (e.g. to infinity) by the caller. The points beyond the last element are discarded.
+ * @param[in] threads, the number of threads sharing the points.
+ */
+YARP_sig_API void pcToScan(const yarp::sig::PointCloud<yarp::sig::DataXYZ>& pointCloud,
+                           double min_z,
+                           double max_z,
+                           double resolution,
+                           yarp::sig::Vector& ranges,
+                           size_t threads = 1);
+
 /**
  * @brief depthRgbToPC, compute the colored PointCloud given depth image, color image and the intrinsic
  * parameters of the camera.
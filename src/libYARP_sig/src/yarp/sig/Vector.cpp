@@ -17,22 +17,77 @@
 #include <yarp/os/LogComponent.h>
 #include <yarp/os/NetInt32.h>
 #include <yarp/os/NetFloat64.h>
+#include <yarp/os/Network.h>
 
 #include <yarp/sig/Matrix.h>
 
+#include <atomic>
 #include <vector>
 #include <cinttypes>
 #include <cstdio>
 #include <cstdlib>
 #include <map>
+#include <new>
 
 using namespace yarp::sig;
 using namespace yarp::os;
 
 namespace {
 YARP_LOG_COMPONENT(VECTOR, "yarp.sig.Vector")
+
+/*
+ * The blocks are rounded up to a power of 2, from 128 bytes (the smaller
+ * vectors are stored inline) to 64 KiB, so that a block released by a vector
+ * can be reused by any vector of the same size class.  The larger blocks are
+ * not pooled.
+ */
+constexpr size_t minBlockShift = 7;
+constexpr size_t maxBlockShift = 16;
+constexpr size_t sizeClasses = maxBlockShift - minBlockShift + 1;
+constexpr size_t maxPooledBlocks = 16;
+
+size_t sizeClass(size_t size)
+{
+    size_t c = 0;
+    while (c < sizeClasses && (size_t{1} << (minBlockShift + c)) < size) {
+        c++;
+    }
+    return c;
 }
 
+// -1 until read from the environment
+std::atomic<int> poolEnabled{-1};
+
+// The free blocks of each thread, never destroyed so that the vectors released
+// after the thread cleanup can still check it
+struct Pool
+{
+    void* blocks[sizeClasses][maxPooledBlocks];
+    size_t count[sizeClasses];
+    bool closed;
+};
+thread_local Pool pool;
+
+// Releases the blocks of the pool when the thread exits
+struct PoolCleaner
+{
+    bool active{false};
+
+    ~PoolCleaner()
+    {
+        for (size_t c = 0; c < sizeClasses; c++) {
+            for (size_t i = 0; i < pool.count[c]; i++) {
+                ::operator delete(pool.blocks[c][i]);
+            }
+            pool.count[c] = 0;
+        }
+        pool.closed = true;
+    }
+};
+thread_local PoolCleaner poolCleaner;
+
+} // namespace
+
 ///////////////////
 
 YARP_BEGIN_PACK
@@ -107,3 +162,49 @@ std::string VectorBase::getFormatStr(int tag) const
 
     return ret;
 }
+
+void VectorBase::setPoolEnabled(bool enabled)
+{
+    poolEnabled = enabled ? 1 : 0;
+}
+
+bool VectorBase::isPoolEnabled()
+{
+    int enabled = poolEnabled.load(std::memory_order_relaxed);
+    if (enabled < 0) {
+        std::string value = yarp::os::NetworkBase::getEnvironment("YARP_VECTOR_POOL");
+        int fromEnvironment = (value == "1" || value == "true" || value == "on") ? 1 : 0;
+        poolEnabled.compare_exchange_strong(enabled, fromEnvironment);
+        enabled = poolEnabled.load(std::memory_order_relaxed);
+    }
+    return enabled == 1;
+}
+
+void* VectorBase::allocateStorage(size_t size)
+{
+    size_t c = sizeClass(size);
+    if (c == sizeClasses) {
+        return ::operator new(size);
+    }
+    if (isPoolEnabled() && !pool.closed && pool.count[c] > 0) {
+        return pool.blocks[c][--pool.count[c]];
+    }
+    // Rounded up even when the pool is disabled, since the block might be
+    // released after enabling it
+    return ::operator new(size_t{1} << (minBlockShift + c));
+}
+
+void VectorBase::deallocateStorage(void* block, size_t size)
+{
+    if (block == nullptr) {
+        return;
+    }
+    size_t c = sizeClass(size);
+    if (c < sizeClasses && isPoolEnabled() && !pool.closed && pool.count[c] < maxPooledBlocks) {
+        // Registers the cleanup of the pool of this thread
+        poolCleaner.active = true;
+        pool.blocks[c][pool.count[c]++] = block;
+        return;
+    }
+    ::operator delete(block);
+}
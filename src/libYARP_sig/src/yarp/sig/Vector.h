@@ -10,10 +10,15 @@
 #ifndef YARP_SIG_VECTOR_H
 #define YARP_SIG_VECTOR_H
 
+#include <algorithm>
 #include <cstring>
 #include <cstddef> //defines size_t
+#include <iterator>
 #include <memory>
+#include <new>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include <yarp/os/Portable.h>
@@ -74,9 +79,44 @@ public:
     */
     bool write(yarp::os::ConnectionWriter& connection) const override;
 
+    /**
+     * Enable or disable the pool of the memory blocks of the vectors.
+     *
+     * The vectors that do not fit in their inline storage take their memory
+     * from per-thread lists of free blocks, instead of allocating it each
+     * time, so that the vectors created and destroyed at each cycle of a
+     * control loop do not call malloc.  The pool is disabled by default,
+     * unless the YARP_VECTOR_POOL environment variable is set to 1.
+     *
+     * @param enabled true to enable the pool
+     */
+    static void setPoolEnabled(bool enabled);
+
+    /**
+     * @return true if the pool of the memory blocks of the vectors is enabled
+     */
+    static bool isPoolEnabled();
+
 protected:
     virtual std::string getFormatStr(int tag) const;
 
+    /**
+     * Allocate a block of memory for the elements of a vector, from the pool
+     * if it is enabled.
+     *
+     * @param size the size of the block in bytes
+     * @return the block, aligned as std::max_align_t
+     */
+    static void* allocateStorage(size_t size);
+
+    /**
+     * Release a block allocated by allocateStorage(), keeping it in the pool
+     * if it is enabled.
+     *
+     * @param block the block
+     * @param size the size given to allocateStorage()
+     */
+    static void deallocateStorage(void* block, size_t size);
 };
 
 /*
@@ -112,6 +152,9 @@ inline int BottleTagMap <int> () {
 * - use size() to get the current size of the Vector
 * - use operator= to copy Vectors
 * - read/write network methods
+* The elements of small vectors (up to 64 bytes, i.e. 8 doubles) are stored
+* inside the object, without allocating memory; the larger ones are allocated
+* from the pool when it is enabled (see VectorBase::setPoolEnabled()).
 * Warning: the class is designed to work with simple types (i.e. types
 * that do not allocate internal memory). Template instantiation needs to
 * be checked to avoid unresolved externals. Network communication assumes
@@ -121,22 +164,213 @@ template<class T>
 class yarp::sig::VectorOf : public VectorBase
 {
 private:
-    std::vector<T> bytes;
+    static constexpr size_t inlineBytes = 64;
+    static constexpr size_t inlineCapacity = inlineBytes / sizeof(T);
+    static constexpr bool pooled = (alignof(T) <= alignof(std::max_align_t));
+
+    typename std::aligned_storage<(inlineCapacity > 0 ? inlineCapacity * sizeof(T) : 1), alignof(T)>::type inlineStorage;
+    T* first {reinterpret_cast<T*>(&inlineStorage)};
+    size_t len {0};
+    size_t cap {inlineCapacity};
+    // The capacity reserved while the elements are inline
+    size_t reserved {0};
+
+    bool isInline() const
+    {
+        return first == reinterpret_cast<const T*>(&inlineStorage);
+    }
+
+    static T* allocate(size_t n)
+    {
+        if (pooled) {
+            return static_cast<T*>(allocateStorage(n * sizeof(T)));
+        }
+        return std::allocator<T>().allocate(n);
+    }
+
+    static void deallocate(T* p, size_t n)
+    {
+        if (pooled) {
+            deallocateStorage(p, n * sizeof(T));
+        } else {
+            std::allocator<T>().deallocate(p, n);
+        }
+    }
+
+    static void destroy(T* p, size_t n)
+    {
+        for (size_t i = 0; i < n; i++) {
+            p[i].~T();
+        }
+    }
+
+    // Move n elements to uninitialized memory, and destroy the old ones
+    static void relocate(T* from, size_t n, T* to)
+    {
+        if (std::is_trivially_copyable<T>::value) {
+            if (n > 0) {
+                std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), n * sizeof(T));
+            }
+        } else {
+            for (size_t i = 0; i < n; i++) {
+                new (to + i) T(std::move(from[i]));
+                from[i].~T();
+            }
+        }
+    }
+
+    // Release the memory, and go back to the inline storage
+    void release()
+    {
+        destroy(first, len);
+        if (!isInline()) {
+            deallocate(first, cap);
+        }
+        first = reinterpret_cast<T*>(&inlineStorage);
+        len = 0;
+        cap = inlineCapacity;
+        reserved = 0;
+    }
+
+    // Make room for n elements at least, keeping the current ones
+    void grow(size_t n)
+    {
+        if (n <= cap) {
+            return;
+        }
+        T* p = allocate(n);
+        relocate(first, len, p);
+        if (!isInline()) {
+            deallocate(first, cap);
+        }
+        first = p;
+        cap = n;
+    }
+
+    void copyFrom(const T* p, size_t n)
+    {
+        if (n > cap) {
+            release();
+            grow(n);
+        }
+        size_t common = std::min(len, n);
+        std::copy(p, p + common, first);
+        for (size_t i = common; i < n; i++) {
+            new (first + i) T(p[i]);
+        }
+        if (len > n) {
+            shrink(n);
+        }
+        len = n;
+    }
+
+    // Destroy the elements after the first n
+    void shrink(size_t n)
+    {
+        // the reported capacity does not decrease, as for std::vector
+        reserved = std::max(reserved, len);
+        destroy(first + n, len - n);
+        len = n;
+    }
+
+    void moveFrom(VectorOf<T>& other)
+    {
+        if (other.isInline()) {
+            relocate(other.first, other.len, first);
+            len = other.len;
+            reserved = other.reserved;
+            other.len = 0;
+            other.reserved = 0;
+        } else {
+            first = other.first;
+            len = other.len;
+            cap = other.cap;
+            other.first = reinterpret_cast<T*>(&other.inlineStorage);
+            other.len = 0;
+            other.cap = inlineCapacity;
+        }
+    }
+
+    void fill(const T& value)
+    {
+        std::fill(first, first + len, value);
+    }
 
 public:
-    using iterator       =  typename std::vector<T>::iterator;
-    using const_iterator =  typename std::vector<T>::const_iterator;
+    /**
+     * Random access iterator on the elements of a VectorOf, \p U being either
+     * T or const T.
+     */
+    template <typename U>
+    class Iterator
+    {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = typename std::remove_const<U>::type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = U*;
+        using reference = U&;
+
+        Iterator() = default;
+
+        explicit Iterator(U* p) : p(p) {
+        }
+
+        // An iterator converts to a const_iterator
+        template <typename V, typename = typename std::enable_if<std::is_convertible<V*, U*>::value>::type>
+        Iterator(const Iterator<V>& other) : p(other.base()) {
+        }
+
+        U* base() const { return p; }
+
+        reference operator*() const { return *p; }
+        pointer operator->() const { return p; }
+        reference operator[](difference_type n) const { return p[n]; }
+
+        Iterator& operator++() { ++p; return *this; }
+        Iterator operator++(int) { return Iterator(p++); }
+        Iterator& operator--() { --p; return *this; }
+        Iterator operator--(int) { return Iterator(p--); }
+        Iterator& operator+=(difference_type n) { p += n; return *this; }
+        Iterator& operator-=(difference_type n) { p -= n; return *this; }
+        Iterator operator+(difference_type n) const { return Iterator(p + n); }
+        Iterator operator-(difference_type n) const { return Iterator(p - n); }
+        friend Iterator operator+(difference_type n, const Iterator& it) { return it + n; }
+
+        template <typename V>
+        difference_type operator-(const Iterator<V>& other) const { return p - other.base(); }
+        template <typename V>
+        bool operator==(const Iterator<V>& other) const { return p == other.base(); }
+        template <typename V>
+        bool operator!=(const Iterator<V>& other) const { return p != other.base(); }
+        template <typename V>
+        bool operator<(const Iterator<V>& other) const { return p < other.base(); }
+        template <typename V>
+        bool operator>(const Iterator<V>& other) const { return p > other.base(); }
+        template <typename V>
+        bool operator<=(const Iterator<V>& other) const { return p <= other.base(); }
+        template <typename V>
+        bool operator>=(const Iterator<V>& other) const { return p >= other.base(); }
+
+    private:
+        U* p {nullptr};
+    };
+
+    using iterator       =  Iterator<T>;
+    using const_iterator =  Iterator<const T>;
 
     VectorOf() = default;
 
-    VectorOf(size_t size) : bytes(size) {
+    VectorOf(size_t size) {
+        this->resize(size);
     }
 
     /**
      * @brief Initializer list constructor.
      * @param[in] values, list of values with which initialize the Vector.
      */
-    VectorOf(std::initializer_list<T> values) : bytes(values) {
+    VectorOf(std::initializer_list<T> values) {
+        copyFrom(values.begin(), values.size());
     }
 
     /**
@@ -144,7 +378,12 @@ public:
     * @param s the size
     * @param def a default value used to fill the vector
     */
-    VectorOf(size_t s, const T& def) : bytes(s, def) {
+    VectorOf(size_t s, const T& def) {
+        grow(s);
+        for (size_t i = 0; i < s; i++) {
+            new (first + i) T(def);
+        }
+        len = s;
     }
 
     /**
@@ -159,7 +398,8 @@ public:
         memcpy(this->data(), p, sizeof(T)*s);
     }
 
-    VectorOf(const VectorOf& r) : VectorBase(), bytes(r.bytes) {
+    VectorOf(const VectorOf& r) : VectorBase() {
+        copyFrom(r.first, r.len);
     }
 
     /**
@@ -169,7 +409,7 @@ public:
     {
 
         if (this == &r) return *this;
-        bytes = r.bytes;
+        copyFrom(r.first, r.len);
         return *this;
     }
 
@@ -178,7 +418,8 @@ public:
      *
      * @param other the VectorOf to be moved
      */
-    VectorOf(VectorOf<T>&& other) noexcept : bytes(std::move(other.bytes)) {
+    VectorOf(VectorOf<T>&& other) noexcept {
+        moveFrom(other);
     }
 
     /**
@@ -189,10 +430,16 @@ public:
      */
     VectorOf& operator=(VectorOf<T>&& other) noexcept
     {
-        bytes = std::move(other.bytes);
+        if (this == &other) return *this;
+        release();
+        moveFrom(other);
         return *this;
     }
 
+    ~VectorOf() override {
+        release();
+    }
+
 
     size_t getElementSize() const override {
         return sizeof(T);
@@ -204,7 +451,7 @@ public:
 
     size_t getListSize() const override
     {
-        return bytes.size();
+        return len;
     }
 
     const char* getMemoryBlock() const override
@@ -237,7 +484,7 @@ public:
     * @return a pointer to double (or nullptr if the vector is of zero length)
     */
     inline T *data()
-    { return bytes.empty() ? nullptr : &(bytes.at(0)); }
+    { return (len == 0) ? nullptr : first; }
 
     /**
     * Return a pointer to the first element of the vector,
@@ -245,7 +492,7 @@ public:
     * @return a (const) pointer to double (or nullptr if the vector is of zero length)
     */
     inline const T *data() const
-    { return bytes.empty() ? nullptr : &(bytes.at(0)); }
+    { return (len == 0) ? nullptr : first; }
 
     /**
     * Resize the vector.
@@ -253,7 +500,15 @@ public:
     */
     void resize(size_t size) override
     {
-        bytes.resize(size);
+        if (size > len) {
+            grow(std::max(size, 2 * len));
+            for (size_t i = len; i < size; i++) {
+                new (first + i) T();
+            }
+            len = size;
+        } else {
+            shrink(size);
+        }
     }
 
     /**
@@ -264,7 +519,7 @@ public:
     void resize(size_t size, const T&def)
     {
         this->resize(size);
-        std::fill(bytes.begin(), bytes.end(), def);
+        fill(def);
     }
 
     /**
@@ -273,7 +528,10 @@ public:
      * @param size, new size of the vector.
      */
     void reserve(size_t size) {
-        bytes.reserve(size);
+        grow(size);
+        if (isInline()) {
+            reserved = std::max(reserved, size);
+        }
     }
 
     /**
@@ -281,7 +539,7 @@ public:
     */
     inline void push_back (const T &elem)
     {
-        bytes.push_back(elem);
+        emplace_back(elem);
     }
 
     /**
@@ -290,7 +548,7 @@ public:
      */
     inline void push_back (T&& elem)
     {
-        bytes.push_back(std::move(elem));
+        emplace_back(std::move(elem));
     }
 
     /**
@@ -301,7 +559,16 @@ public:
     template<typename... _Args>
     inline T& emplace_back(_Args&&... args)
     {
-        bytes.emplace_back(std::forward<_Args>(args)...);
+        if (len == cap) {
+            // The new element is built before moving the current ones, since
+            // the arguments might refer to them
+            T elem(std::forward<_Args>(args)...);
+            grow(std::max<size_t>(2 * cap, 1));
+            new (first + len) T(std::move(elem));
+        } else {
+            new (first + len) T(std::forward<_Args>(args)...);
+        }
+        return first[len++];
     }
 
     /**
@@ -309,7 +576,7 @@ public:
     */
     inline void pop_back (void)
     {
-        bytes.pop_back();
+        shrink(len - 1);
     }
 
     /**
@@ -319,7 +586,7 @@ public:
     */
     inline T &operator[](size_t i)
     {
-        return bytes[i];
+        return first[i];
     }
 
     /**
@@ -329,7 +596,7 @@ public:
     */
     inline const T &operator[](size_t i) const
     {
-        return bytes[i];
+        return first[i];
     }
 
     /**
@@ -353,7 +620,7 @@ public:
     }
 
     inline size_t size() const {
-        return bytes.size();
+        return len;
     }
 
     /**
@@ -368,7 +635,8 @@ public:
      * @return the number of elements that the container has currently allocated space for.
      */
     inline size_t capacity() const {
-        return bytes.capacity();
+        // as std::vector, the inline storage is not reported
+        return isInline() ? std::max(len, reserved) : cap;
     }
 
     /**
@@ -376,7 +644,7 @@ public:
     */
     void zero()
     {
-        std::fill(bytes.begin(), bytes.end(), 0);
+        fill(0);
     }
 
     /**
@@ -465,7 +733,7 @@ public:
     */
     const VectorOf<T> &operator=(T v)
     {
-        std::fill(bytes.begin(), bytes.end(), v);
+        fill(v);
         return *this;
     }
 
@@ -474,52 +742,52 @@ public:
     */
     bool operator==(const VectorOf<T> &r) const
     {
-        return bytes == r.bytes;
+        return len == r.len && std::equal(first, first + len, r.first);
     }
 
     /**
      * @brief Returns an iterator to the beginning of the VectorOf
      */
     iterator begin() noexcept {
-        return bytes.begin();
+        return iterator(first);
     }
 
     /**
      * @brief Returns an iterator to the end of the VectorOf
      */
     iterator end() noexcept {
-        return bytes.end();
+        return iterator(first + len);
     }
 
     /**
      * @brief Returns a const iterator to the beginning of the VectorOf
      */
     const_iterator begin() const noexcept {
-        return bytes.begin();
+        return const_iterator(first);
     }
 
     /**
      * @brief Returns a const iterator to the end of the VectorOf.
      */
     const_iterator end() const noexcept {
-        return bytes.end();
+        return const_iterator(first + len);
     }
 
     /**
      * @brief Returns a const iterator to the beginning of the VectorOf
      */
     const_iterator cbegin() const noexcept {
-        return bytes.cbegin();
+        return const_iterator(first);
     }
 
     /**
      * @brief Returns a const iterator to the end of the VectorOf.
      */
     const_iterator cend() const noexcept {
-        return bytes.cend();
+        return const_iterator(first + len);
     }
     void clear() {
-        bytes.clear();
+        shrink(0);
     }
 
     yarp::os::Type getType() const override {
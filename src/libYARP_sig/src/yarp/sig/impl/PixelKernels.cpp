@@ -0,0 +1,645 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <yarp/sig/impl/PixelKernels.h>
+
+#include <yarp/sig/Image.h>
+
+#include <atomic>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#    define YARP_SIG_PIXELKERNELS_X86
+#    include <immintrin.h>
+#    if defined(_MSC_VER)
+#        include <intrin.h>
+#    endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#    define YARP_SIG_PIXELKERNELS_NEON
+#    include <arm_neon.h>
+#endif
+
+// The x86 kernels are compiled for the instruction set they use, and
+// called only if the processor supports it
+#if defined(__GNUC__)
+#    define PIXELKERNELS_TARGET(x) __attribute__((target(x)))
+#else
+#    define PIXELKERNELS_TARGET(x)
+#endif
+
+using yarp::sig::impl::PixelRowKernel;
+
+namespace {
+
+/*
+ * All the kernels have the same structure: they convert blocks of pixels
+ * and return the number of pixels converted.  Since the loads and the
+ * stores of the blocks of 3 bytes pixels are not a multiple of the pixel
+ * size, they may write a few bytes after the block, that are overwritten
+ * by the following block or by the caller.  They never read or write
+ * after the end of the row.
+ *
+ * In the conversions to mono, the sum of the three channels (at most
+ * 765) is divided by 3 as (sum * 21846) >> 16, that gives the same result
+ * as the integer division for all the values up to 765.
+ */
+constexpr int divideBy3 = 21846;
+
+#if defined(YARP_SIG_PIXELKERNELS_X86)
+
+struct Shuffles
+{
+    // bytes of each channel of 16 RGB pixels, from each of the three blocks
+    // of 16 bytes, moved to their position in the channel
+    alignas(16) signed char channel[3][3][16];
+    // bytes of 16 mono pixels for each of the three blocks of 16 bytes of
+    // the RGB pixels
+    alignas(16) signed char gray[3][16];
+
+    Shuffles()
+    {
+        for (int ch = 0; ch < 3; ch++) {
+            for (int block = 0; block < 3; block++) {
+                for (int i = 0; i < 16; i++) {
+                    int at = 3 * i + ch - 16 * block;
+                    channel[ch][block][i] = static_cast<signed char>((at >= 0 && at < 16) ? at : -1);
+                }
+            }
+        }
+        for (int block = 0; block < 3; block++) {
+            for (int i = 0; i < 16; i++) {
+                gray[block][i] = static_cast<signed char>((16 * block + i) / 3);
+            }
+        }
+    }
+};
+
+const Shuffles& shuffles()
+{
+    static const Shuffles s;
+    return s;
+}
+
+PIXELKERNELS_TARGET("sse2")
+inline __m128i load(const signed char* mask)
+{
+    return _mm_load_si128(reinterpret_cast<const __m128i*>(mask));
+}
+
+// RGB <-> BGR
+PIXELKERNELS_TARGET("ssse3")
+size_t swap3_ssse3(const unsigned char* src, unsigned char* dest, size_t count)
+{
+    const __m128i mask = _mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 14, 13, 12, 15);
+    size_t i = 0;
+    for (; i + 6 <= count; i += 5) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 3 * i), _mm_shuffle_epi8(x, mask));
+    }
+    return i;
+}
+
+// RGB -> RGBA, BGR -> BGRA, and with Swap RGB -> BGRA, BGR -> RGBA
+template <bool Swap>
+PIXELKERNELS_TARGET("ssse3")
+size_t expand3_ssse3(const unsigned char* src, unsigned char* dest, size_t count)
+{
+    const __m128i mask = Swap ? _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1)
+                              : _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+    size_t i = 0;
+    for (; i + 6 <= count; i += 4) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * i));
+        x = _mm_or_si128(_mm_shuffle_epi8(x, mask), alpha);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 4 * i), x);
+    }
+    return i;
+}
+
+// RGBA -> RGB, BGRA -> BGR, and with Swap RGBA -> BGR, BGRA -> RGB
+template <bool Swap>
+PIXELKERNELS_TARGET("ssse3")
+size_t contract4_ssse3(const unsigned char* src, unsigned char* dest, size_t count)
+{
+    const __m128i mask = Swap ? _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1)
+                              : _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    size_t i = 0;
+    for (; i + 6 <= count; i += 4) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4 * i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 3 * i), _mm_shuffle_epi8(x, mask));
+    }
+    return i;
+}
+
+// RGBA <-> BGRA
+PIXELKERNELS_TARGET("ssse3")
+size_t swap4_ssse3(const unsigned char* src, unsigned char* dest, size_t count)
+{
+    const __m128i mask = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4 * i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 4 * i), _mm_shuffle_epi8(x, mask));
+    }
+    return i;
+}
+
+PIXELKERNELS_TARGET("avx2")
+size_t swap4_avx2(const unsigned char* src, unsigned char* dest, size_t count)
+{
+    const __m256i mask = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                          2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 4 * i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + 4 * i), _mm256_shuffle_epi8(x, mask));
+    }
+    return i;
+}
+
+// RGB -> mono, BGR -> mono
+PIXELKERNELS_TARGET("ssse3")
+size_t average3_ssse3(const unsigned char* src, unsigned char* dest, size_t count)
+{
+    const Shuffles& s = shuffles();
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i third = _mm_set1_epi16(divideBy3);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const auto* in = reinterpret_cast<const __m128i*>(src + 3 * i);
+        __m128i a = _mm_loadu_si128(in);
+        __m128i b = _mm_loadu_si128(in + 1);
+        __m128i c = _mm_loadu_si128(in + 2);
+        __m128i lo = zero;
+        __m128i hi = zero;
+        for (int ch = 0; ch < 3; ch++) {
+            __m128i x = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, load(s.channel[ch][0])),
+                                                  _mm_shuffle_epi8(b, load(s.channel[ch][1]))),
+                                     _mm_shuffle_epi8(c, load(s.channel[ch][2])));
+            lo = _mm_add_epi16(lo, _mm_unpacklo_epi8(x, zero));
+            hi = _mm_add_epi16(hi, _mm_unpackhi_epi8(x, zero));
+        }
+        lo = _mm_mulhi_epu16(lo, third);
+        hi = _mm_mulhi_epu16(hi, third);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_packus_epi16(lo, hi));
+    }
+    return i;
+}
+
+// RGBA -> mono, BGRA -> mono
+PIXELKERNELS_TARGET("sse2")
+size_t average4_sse2(const unsigned char* src, unsigned char* dest, size_t count)
+{
+    const __m128i low = _mm_set1_epi32(0xFF);
+    const __m128i third = _mm_set1_epi16(divideBy3);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const auto* in = reinterpret_cast<const __m128i*>(src + 4 * i);
+        __m128i sums[4];
+        for (int k = 0; k < 4; k++) {
+            __m128i x = _mm_loadu_si128(in + k);
+            sums[k] = _mm_add_epi32(_mm_add_epi32(_mm_and_si128(x, low),
+                                                  _mm_and_si128(_mm_srli_epi32(x, 8), low)),
+                                    _mm_and_si128(_mm_srli_epi32(x, 16), low));
+        }
+        __m128i lo = _mm_mulhi_epu16(_mm_packs_epi32(sums[0], sums[1]), third);
+        __m128i hi = _mm_mulhi_epu16(_mm_packs_epi32(sums[2], sums[3]), third);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_packus_epi16(lo, hi));
+    }
+    return i;
+}
+
+// mono -> RGB, mono -> BGR
+PIXELKERNELS_TARGET("ssse3")
+size_t gray3_ssse3(const unsigned char* src, unsigned char* dest, size_t count)
+{
+    const Shuffles& s = shuffles();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        auto* out = reinterpret_cast<__m128i*>(dest + 3 * i);
+        _mm_storeu_si128(out, _mm_shuffle_epi8(x, load(s.gray[0])));
+        _mm_storeu_si128(out + 1, _mm_shuffle_epi8(x, load(s.gray[1])));
+        _mm_storeu_si128(out + 2, _mm_shuffle_epi8(x, load(s.gray[2])));
+    }
+    return i;
+}
+
+// mono -> RGBA, mono -> BGRA
+PIXELKERNELS_TARGET("sse2")
+size_t gray4_sse2(const unsigned char* src, unsigned char* dest, size_t count)
+{
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i lo = _mm_unpacklo_epi8(x, x);
+        __m128i hi = _mm_unpackhi_epi8(x, x);
+        auto* out = reinterpret_cast<__m128i*>(dest + 4 * i);
+        _mm_storeu_si128(out, _mm_or_si128(_mm_unpacklo_epi16(lo, lo), alpha));
+        _mm_storeu_si128(out + 1, _mm_or_si128(_mm_unpackhi_epi16(lo, lo), alpha));
+        _mm_storeu_si128(out + 2, _mm_or_si128(_mm_unpacklo_epi16(hi, hi), alpha));
+        _mm_storeu_si128(out + 3, _mm_or_si128(_mm_unpackhi_epi16(hi, hi), alpha));
+    }
+    return i;
+}
+
+// mono16 -> mono (the most significant byte is dropped)
+PIXELKERNELS_TARGET("sse2")
+size_t narrow16_sse2(const unsigned char* src, unsigned char* dest, size_t count)
+{
+    const __m128i low = _mm_set1_epi16(0xFF);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const auto* in = reinterpret_cast<const __m128i*>(src + 2 * i);
+        __m128i a = _mm_and_si128(_mm_loadu_si128(in), low);
+        __m128i b = _mm_and_si128(_mm_loadu_si128(in + 1), low);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_packus_epi16(a, b));
+    }
+    return i;
+}
+
+PIXELKERNELS_TARGET("avx2")
+size_t narrow16_avx2(const unsigned char* src, unsigned char* dest, size_t count)
+{
+    const __m256i low = _mm256_set1_epi16(0xFF);
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        const auto* in = reinterpret_cast<const __m256i*>(src + 2 * i);
+        __m256i a = _mm256_and_si256(_mm256_loadu_si256(in), low);
+        __m256i b = _mm256_and_si256(_mm256_loadu_si256(in + 1), low);
+        // the packing works on each half separately
+        __m256i x = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), x);
+    }
+    return i;
+}
+
+// mono -> mono16
+PIXELKERNELS_TARGET("sse2")
+size_t widen16_sse2(const unsigned char* src, unsigned char* dest, size_t count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        auto* out = reinterpret_cast<__m128i*>(dest + 2 * i);
+        _mm_storeu_si128(out, _mm_unpacklo_epi8(x, zero));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi8(x, zero));
+    }
+    return i;
+}
+
+// mono -> float
+PIXELKERNELS_TARGET("sse2")
+size_t toFloat_sse2(const unsigned char* src, unsigned char* dest, size_t count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i lo = _mm_unpacklo_epi8(x, zero);
+        __m128i hi = _mm_unpackhi_epi8(x, zero);
+        auto* out = reinterpret_cast<float*>(dest + 4 * i);
+        _mm_storeu_ps(out, _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)));
+        _mm_storeu_ps(out + 4, _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)));
+        _mm_storeu_ps(out + 8, _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)));
+        _mm_storeu_ps(out + 12, _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)));
+    }
+    return i;
+}
+
+PIXELKERNELS_TARGET("avx2")
+size_t toFloat_avx2(const unsigned char* src, unsigned char* dest, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i x = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i));
+        __m256 y = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(x));
+        _mm256_storeu_ps(reinterpret_cast<float*>(dest + 4 * i), y);
+    }
+    return i;
+}
+
+struct Features
+{
+    bool sse2 {false};
+    bool ssse3 {false};
+    bool avx2 {false};
+
+    Features()
+    {
+#    if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        int levels = info[0];
+        __cpuid(info, 1);
+        sse2 = (info[3] & (1 << 26)) != 0;
+        ssse3 = (info[2] & (1 << 9)) != 0;
+        bool osAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+        if (levels >= 7 && osAvx) {
+            __cpuidex(info, 7, 0);
+            avx2 = (info[1] & (1 << 5)) != 0;
+        }
+#    else
+        __builtin_cpu_init();
+        sse2 = __builtin_cpu_supports("sse2") != 0;
+        ssse3 = __builtin_cpu_supports("ssse3") != 0;
+        avx2 = __builtin_cpu_supports("avx2") != 0;
+#    endif
+    }
+};
+
+#elif defined(YARP_SIG_PIXELKERNELS_NEON)
+
+size_t swap3_neon(const unsigned char* src, unsigned char* dest, size_t count)
+{
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x3_t x = vld3q_u8(src + 3 * i);
+        uint8x16_t t = x.val[0];
+        x.val[0] = x.val[2];
+        x.val[2] = t;
+        vst3q_u8(dest + 3 * i, x);
+    }
+    return i;
+}
+
+template <bool Swap>
+size_t expand3_neon(const unsigned char* src, unsigned char* dest, size_t count)
+{
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x3_t x = vld3q_u8(src + 3 * i);
+        uint8x16x4_t y;
+        y.val[0] = Swap ? x.val[2] : x.val[0];
+        y.val[1] = x.val[1];
+        y.val[2] = Swap ? x.val[0] : x.val[2];
+        y.val[3] = vdupq_n_u8(255);
+        vst4q_u8(dest + 4 * i, y);
+    }
+    return i;
+}
+
+template <bool Swap>
+size_t contract4_neon(const unsigned char* src, unsigned char* dest, size_t count)
+{
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x4_t x = vld4q_u8(src + 4 * i);
+        uint8x16x3_t y;
+        y.val[0] = Swap ? x.val[2] : x.val[0];
+        y.val[1] = x.val[1];
+        y.val[2] = Swap ? x.val[0] : x.val[2];
+        vst3q_u8(dest + 3 * i, y);
+    }
+    return i;
+}
+
+size_t swap4_neon(const unsigned char* src, unsigned char* dest, size_t count)
+{
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x4_t x = vld4q_u8(src + 4 * i);
+        uint8x16_t t = x.val[0];
+        x.val[0] = x.val[2];
+        x.val[2] = t;
+        vst4q_u8(dest + 4 * i, x);
+    }
+    return i;
+}
+
+inline uint8x8_t average(uint8x8_t a, uint8x8_t b, uint8x8_t c)
+{
+    uint16x8_t sum = vaddw_u8(vaddl_u8(a, b), c);
+    uint32x4_t lo = vmull_n_u16(vget_low_u16(sum), divideBy3);
+    uint32x4_t hi = vmull_n_u16(vget_high_u16(sum), divideBy3);
+    return vmovn_u16(vcombine_u16(vshrn_n_u32(lo, 16), vshrn_n_u32(hi, 16)));
+}
+
+size_t average3_neon(const unsigned char* src, unsigned char* dest, size_t count)
+{
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x3_t x = vld3q_u8(src + 3 * i);
+        uint8x8_t lo = average(vget_low_u8(x.val[0]), vget_low_u8(x.val[1]), vget_low_u8(x.val[2]));
+        uint8x8_t hi = average(vget_high_u8(x.val[0]), vget_high_u8(x.val[1]), vget_high_u8(x.val[2]));
+        vst1q_u8(dest + i, vcombine_u8(lo, hi));
+    }
+    return i;
+}
+
+size_t average4_neon(const unsigned char* src, unsigned char* dest, size_t count)
+{
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x4_t x = vld4q_u8(src + 4 * i);
+        uint8x8_t lo = average(vget_low_u8(x.val[0]), vget_low_u8(x.val[1]), vget_low_u8(x.val[2]));
+        uint8x8_t hi = average(vget_high_u8(x.val[0]), vget_high_u8(x.val[1]), vget_high_u8(x.val[2]));
+        vst1q_u8(dest + i, vcombine_u8(lo, hi));
+    }
+    return i;
+}
+
+size_t gray3_neon(const unsigned char* src, unsigned char* dest, size_t count)
+{
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16_t g = vld1q_u8(src + i);
+        uint8x16x3_t y;
+        y.val[0] = g;
+        y.val[1] = g;
+        y.val[2] = g;
+        vst3q_u8(dest + 3 * i, y);
+    }
+    return i;
+}
+
+size_t gray4_neon(const unsigned char* src, unsigned char* dest, size_t count)
+{
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16_t g = vld1q_u8(src + i);
+        uint8x16x4_t y;
+        y.val[0] = g;
+        y.val[1] = g;
+        y.val[2] = g;
+        y.val[3] = vdupq_n_u8(255);
+        vst4q_u8(dest + 4 * i, y);
+    }
+    return i;
+}
+
+size_t narrow16_neon(const unsigned char* src, unsigned char* dest, size_t count)
+{
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const auto* in = reinterpret_cast<const uint16_t*>(src + 2 * i);
+        uint8x8_t lo = vmovn_u16(vld1q_u16(in));
+        uint8x8_t hi = vmovn_u16(vld1q_u16(in + 8));
+        vst1q_u8(dest + i, vcombine_u8(lo, hi));
+    }
+    return i;
+}
+
+size_t widen16_neon(const unsigned char* src, unsigned char* dest, size_t count)
+{
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16_t x = vld1q_u8(src + i);
+        auto* out = reinterpret_cast<uint16_t*>(dest + 2 * i);
+        vst1q_u16(out, vmovl_u8(vget_low_u8(x)));
+        vst1q_u16(out + 8, vmovl_u8(vget_high_u8(x)));
+    }
+    return i;
+}
+
+size_t toFloat_neon(const unsigned char* src, unsigned char* dest, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint16x8_t x = vmovl_u8(vld1_u8(src + i));
+        auto* out = reinterpret_cast<float*>(dest + 4 * i);
+        vst1q_f32(out, vcvtq_f32_u32(vmovl_u16(vget_low_u16(x))));
+        vst1q_f32(out + 4, vcvtq_f32_u32(vmovl_u16(vget_high_u16(x))));
+    }
+    return i;
+}
+
+#endif
+
+
+class Kernels
+{
+public:
+    Kernels()
+    {
+#if defined(YARP_SIG_PIXELKERNELS_X86)
+        Features cpu;
+        if (cpu.avx2) {
+            add(VOCAB_PIXEL_RGBA, VOCAB_PIXEL_BGRA, swap4_avx2);
+            add(VOCAB_PIXEL_BGRA, VOCAB_PIXEL_RGBA, swap4_avx2);
+            add(VOCAB_PIXEL_MONO16, VOCAB_PIXEL_MONO, narrow16_avx2);
+            add(VOCAB_PIXEL_MONO, VOCAB_PIXEL_MONO_FLOAT, toFloat_avx2);
+        }
+        if (cpu.ssse3) {
+            add(VOCAB_PIXEL_RGB, VOCAB_PIXEL_BGR, swap3_ssse3);
+            add(VOCAB_PIXEL_BGR, VOCAB_PIXEL_RGB, swap3_ssse3);
+            add(VOCAB_PIXEL_RGB, VOCAB_PIXEL_RGBA, expand3_ssse3<false>);
+            add(VOCAB_PIXEL_BGR, VOCAB_PIXEL_BGRA, expand3_ssse3<false>);
+            add(VOCAB_PIXEL_RGB, VOCAB_PIXEL_BGRA, expand3_ssse3<true>);
+            add(VOCAB_PIXEL_BGR, VOCAB_PIXEL_RGBA, expand3_ssse3<true>);
+            add(VOCAB_PIXEL_RGBA, VOCAB_PIXEL_RGB, contract4_ssse3<false>);
+            add(VOCAB_PIXEL_BGRA, VOCAB_PIXEL_BGR, contract4_ssse3<false>);
+            add(VOCAB_PIXEL_RGBA, VOCAB_PIXEL_BGR, contract4_ssse3<true>);
+            add(VOCAB_PIXEL_BGRA, VOCAB_PIXEL_RGB, contract4_ssse3<true>);
+            add(VOCAB_PIXEL_RGBA, VOCAB_PIXEL_BGRA, swap4_ssse3);
+            add(VOCAB_PIXEL_BGRA, VOCAB_PIXEL_RGBA, swap4_ssse3);
+            add(VOCAB_PIXEL_RGB, VOCAB_PIXEL_MONO, average3_ssse3);
+            add(VOCAB_PIXEL_BGR, VOCAB_PIXEL_MONO, average3_ssse3);
+            add(VOCAB_PIXEL_MONO, VOCAB_PIXEL_RGB, gray3_ssse3);
+            add(VOCAB_PIXEL_MONO, VOCAB_PIXEL_BGR, gray3_ssse3);
+        }
+        if (cpu.sse2) {
+            add(VOCAB_PIXEL_RGBA, VOCAB_PIXEL_MONO, average4_sse2);
+            add(VOCAB_PIXEL_BGRA, VOCAB_PIXEL_MONO, average4_sse2);
+            add(VOCAB_PIXEL_MONO, VOCAB_PIXEL_RGBA, gray4_sse2);
+            add(VOCAB_PIXEL_MONO, VOCAB_PIXEL_BGRA, gray4_sse2);
+            add(VOCAB_PIXEL_MONO16, VOCAB_PIXEL_MONO, narrow16_sse2);
+            add(VOCAB_PIXEL_MONO, VOCAB_PIXEL_MONO16, widen16_sse2);
+            add(VOCAB_PIXEL_MONO, VOCAB_PIXEL_MONO_FLOAT, toFloat_sse2);
+        }
+        instructionSets = std::string(cpu.sse2 ? "sse2 " : "") + (cpu.ssse3 ? "ssse3 " : "") + (cpu.avx2 ? "avx2 " : "");
+        if (!instructionSets.empty()) {
+            instructionSets.pop_back();
+        }
+#elif defined(YARP_SIG_PIXELKERNELS_NEON)
+        add(VOCAB_PIXEL_RGB, VOCAB_PIXEL_BGR, swap3_neon);
+        add(VOCAB_PIXEL_BGR, VOCAB_PIXEL_RGB, swap3_neon);
+        add(VOCAB_PIXEL_RGB, VOCAB_PIXEL_RGBA, expand3_neon<false>);
+        add(VOCAB_PIXEL_BGR, VOCAB_PIXEL_BGRA, expand3_neon<false>);
+        add(VOCAB_PIXEL_RGB, VOCAB_PIXEL_BGRA, expand3_neon<true>);
+        add(VOCAB_PIXEL_BGR, VOCAB_PIXEL_RGBA, expand3_neon<true>);
+        add(VOCAB_PIXEL_RGBA, VOCAB_PIXEL_RGB, contract4_neon<false>);
+        add(VOCAB_PIXEL_BGRA, VOCAB_PIXEL_BGR, contract4_neon<false>);
+        add(VOCAB_PIXEL_RGBA, VOCAB_PIXEL_BGR, contract4_neon<true>);
+        add(VOCAB_PIXEL_BGRA, VOCAB_PIXEL_RGB, contract4_neon<true>);
+        add(VOCAB_PIXEL_RGBA, VOCAB_PIXEL_BGRA, swap4_neon);
+        add(VOCAB_PIXEL_BGRA, VOCAB_PIXEL_RGBA, swap4_neon);
+        add(VOCAB_PIXEL_RGB, VOCAB_PIXEL_MONO, average3_neon);
+        add(VOCAB_PIXEL_BGR, VOCAB_PIXEL_MONO, average3_neon);
+        add(VOCAB_PIXEL_RGBA, VOCAB_PIXEL_MONO, average4_neon);
+        add(VOCAB_PIXEL_BGRA, VOCAB_PIXEL_MONO, average4_neon);
+        add(VOCAB_PIXEL_MONO, VOCAB_PIXEL_RGB, gray3_neon);
+        add(VOCAB_PIXEL_MONO, VOCAB_PIXEL_BGR, gray3_neon);
+        add(VOCAB_PIXEL_MONO, VOCAB_PIXEL_RGBA, gray4_neon);
+        add(VOCAB_PIXEL_MONO, VOCAB_PIXEL_BGRA, gray4_neon);
+        add(VOCAB_PIXEL_MONO16, VOCAB_PIXEL_MONO, narrow16_neon);
+        add(VOCAB_PIXEL_MONO, VOCAB_PIXEL_MONO16, widen16_neon);
+        add(VOCAB_PIXEL_MONO, VOCAB_PIXEL_MONO_FLOAT, toFloat_neon);
+        instructionSets = "neon";
+#endif
+    }
+
+    PixelRowKernel find(int srcCode, int destCode) const
+    {
+        // the first kernel added for a conversion is the fastest one
+        for (const auto& entry : entries) {
+            if (entry.srcCode == srcCode && entry.destCode == destCode) {
+                return entry.kernel;
+            }
+        }
+        return nullptr;
+    }
+
+    std::string instructionSets;
+
+private:
+    struct Entry
+    {
+        int srcCode;
+        int destCode;
+        PixelRowKernel kernel;
+    };
+
+    void add(int srcCode, int destCode, PixelRowKernel kernel)
+    {
+        entries.push_back(Entry {srcCode, destCode, kernel});
+    }
+
+    std::vector<Entry> entries;
+};
+
+const Kernels& kernels()
+{
+    static const Kernels k;
+    return k;
+}
+
+std::atomic<bool> kernelsEnabled {true};
+
+} // namespace
+
+
+PixelRowKernel yarp::sig::impl::getPixelRowKernel(int srcCode, int destCode)
+{
+    if (!kernelsEnabled.load()) {
+        return nullptr;
+    }
+    return kernels().find(srcCode, destCode);
+}
+
+void yarp::sig::impl::setPixelKernelsEnabled(bool enabled)
+{
+    kernelsEnabled.store(enabled);
+}
+
+std::string yarp::sig::impl::getPixelKernelsInstructionSets()
+{
+    return kernels().instructionSets;
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+/**
+ * Vectorized kernels converting a row of pixels between the most common
+ * pixel types, used by Image::copyPixels().
+ *
+ * The kernels use SSE2/SSSE3/AVX2 on x86 processors, chosen at run time
+ * according to the features of the processor, and NEON on ARM processors
+ * that support it.  Their results are the same, bit by bit, as the ones of
+ * the pixel by pixel conversion.
+ */
+
+#ifndef YARP_SIG_IMPL_PIXELKERNELS_H
+#define YARP_SIG_IMPL_PIXELKERNELS_H
+
+#include <yarp/sig/api.h>
+
+#include <cstddef>
+#include <string>
+
+namespace yarp {
+namespace sig {
+namespace impl {
+
+/**
+ * Converts the pixels at the beginning of a row.
+ *
+ * @param src the first pixel of the source row
+ * @param dest the first pixel of the destination row
+ * @param count the number of pixels in the row
+ * @return the number of pixels converted, the remaining ones (less than
+ * the number of pixels handled in a single step) are left to the caller
+ */
+typedef size_t (*PixelRowKernel)(const unsigned char* src, unsigned char* dest, size_t count);
+
+/**
+ * @param srcCode the pixel code of the source image
+ * @param destCode the pixel code of the destination image
+ * @return the kernel converting between the two types, or nullptr if
+ * there is none for this processor
+ */
+YARP_sig_API PixelRowKernel getPixelRowKernel(int srcCode, int destCode);
+
+/**
+ * Enable or disable the kernels (they are enabled by default), e.g. to
+ * compare them with the pixel by pixel conversion.
+ */
+YARP_sig_API void setPixelKernelsEnabled(bool enabled);
+
+/**
+ * @return the instruction sets used by the kernels on this processor
+ * (e.g. "sse2 ssse3 avx2"), or an empty string if none is available
+ */
+YARP_sig_API std::string getPixelKernelsInstructionSets();
+
+} // namespace impl
+} // namespace sig
+} // namespace yarp
+
+#endif // YARP_SIG_IMPL_PIXELKERNELS_H
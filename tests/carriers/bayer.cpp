@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <yarp/os/all.h>
+#include <yarp/os/Network.h>
+#include <yarp/sig/all.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+#include <catch.hpp>
+#include <harness.h>
+
+using namespace yarp::os;
+using namespace yarp::sig;
+
+namespace {
+
+// A mosaic of random samples, with the padding of the rows (if any) filled
+// with samples that would spoil the result if they were read
+void fillBayer(ImageOf<PixelMono>& img)
+{
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> sample(0, 255);
+    for (size_t y = 0; y < img.height(); y++) {
+        memset(img.getRow(y), 255, img.getRowSize());
+        for (size_t x = 0; x < img.width(); x++) {
+            img(x, y) = static_cast<unsigned char>(sample(generator));
+        }
+    }
+}
+
+// The sample at (x, y), mirrored inside the image on the borders
+int mirrored(const ImageOf<PixelMono>& img, long x, long y)
+{
+    const auto width = static_cast<long>(img.width());
+    const auto height = static_cast<long>(img.height());
+    if (x < 0) {
+        x = 1;
+    } else if (x >= width) {
+        x = width - 2;
+    }
+    if (y < 0) {
+        y = 1;
+    } else if (y >= height) {
+        y = height - 2;
+    }
+    return img(static_cast<size_t>(x), static_cast<size_t>(y));
+}
+
+// Debayers an image one pixel at a time, as described in BayerKernels.h.
+// goff is the x offset of green on the even rows, and roff the y offset of
+// the rows with red samples.
+ImageOf<PixelRgb> reference(const ImageOf<PixelMono>& bayer, int goff, int roff, bool edge)
+{
+    ImageOf<PixelRgb> out;
+    out.resize(bayer.width(), bayer.height());
+    for (long y = 0; y < static_cast<long>(bayer.height()); y++) {
+        for (long x = 0; x < static_cast<long>(bayer.width()); x++) {
+            auto at = [&](long dx, long dy) { return mirrored(bayer, x + dx, y + dy); };
+            int h = (at(-1, 0) + at(1, 0) + 1) / 2;
+            int v = (at(0, -1) + at(0, 1) + 1) / 2;
+            int own;
+            int green;
+            int other;
+            if ((x + y) % 2 == goff) {
+                own = h;
+                green = at(0, 0);
+                other = v;
+            } else {
+                green = (at(-1, 0) + at(1, 0) + at(0, -1) + at(0, 1) + 2) / 4;
+                if (edge) {
+                    int dh = std::abs(at(-1, 0) - at(1, 0));
+                    int dv = std::abs(at(0, -1) - at(0, 1));
+                    if (dh < dv) {
+                        green = h;
+                    } else if (dv < dh) {
+                        green = v;
+                    }
+                }
+                own = at(0, 0);
+                other = (at(-1, -1) + at(1, -1) + at(-1, 1) + at(1, 1) + 2) / 4;
+            }
+            bool redRow = (y % 2 == roff);
+            PixelRgb& p = out(static_cast<size_t>(x), static_cast<size_t>(y));
+            p.r = static_cast<unsigned char>(redRow ? own : other);
+            p.g = static_cast<unsigned char>(green);
+            p.b = static_cast<unsigned char>(redRow ? other : own);
+        }
+    }
+    return out;
+}
+
+// Each pixel of a 2x2 block of samples, with the average of its two greens
+ImageOf<PixelRgb> referenceHalf(const ImageOf<PixelMono>& bayer, int goff, int roff)
+{
+    ImageOf<PixelRgb> out;
+    out.resize(bayer.width() / 2, bayer.height() / 2);
+    for (size_t y = 0; y < out.height(); y++) {
+        for (size_t x = 0; x < out.width(); x++) {
+            size_t x0 = 2 * x;
+            size_t y0 = 2 * y;
+            int green = (bayer(x0 + goff, y0) + bayer(x0 + 1 - goff, y0 + 1) + 1) / 2;
+            unsigned char first = bayer(x0 + 1 - goff, y0);
+            unsigned char second = bayer(x0 + goff, y0 + 1);
+            PixelRgb& p = out(x, y);
+            p.r = (roff == 0) ? first : second;
+            p.g = static_cast<unsigned char>(green);
+            p.b = (roff == 0) ? second : first;
+        }
+    }
+    return out;
+}
+
+// Sends an image through a connection, and returns how many pixels of the
+// received image differ from the ones expected
+size_t debayer(const ImageOf<PixelMono>& bayer,
+               const std::string& carrier,
+               const ImageOf<PixelRgb>& expected)
+{
+    BufferedPort<ImageOf<PixelMono>> out;
+    BufferedPort<ImageOf<PixelRgb>> in;
+    REQUIRE(out.open("/bayer/out"));
+    REQUIRE(in.open("/bayer/in"));
+    REQUIRE(Network::connect(out.getName(), in.getName(), carrier));
+
+    ImageOf<PixelMono>& outImg = out.prepare();
+    outImg.setQuantum(bayer.getQuantum());
+    outImg = bayer;
+    out.write();
+
+    ImageOf<PixelRgb>* img = in.read();
+    REQUIRE(img != nullptr);
+    REQUIRE(img->width() == expected.width());
+    REQUIRE(img->height() == expected.height());
+    size_t wrong = 0;
+    for (size_t y = 0; y < img->height(); y++) {
+        for (size_t x = 0; x < img->width(); x++) {
+            const PixelRgb& p = (*img)(x, y);
+            const PixelRgb& e = expected(x, y);
+            if (p.r != e.r || p.g != e.g || p.b != e.b) {
+                wrong++;
+            }
+        }
+    }
+
+    in.interrupt();
+    in.close();
+    out.interrupt();
+    out.close();
+    return wrong;
+}
+
+} // namespace
+
+TEST_CASE("carriers::bayer", "[carriers]")
+{
+    YARP_REQUIRE_PLUGIN("bayer", "carrier");
+
+    Network::setLocalMode(true);
+
+    // widths that are not multiples of the pixels processed at a time, and
+    // enough rows for two bands of rows, each one debayered by its thread,
+    // even at half size
+    const size_t width {37};
+    const size_t height {131};
+    ImageOf<PixelMono> bayer;
+    bayer.resize(width, height);
+    fillBayer(bayer);
+    const ImageOf<PixelRgb> bilinear = reference(bayer, 0, 0, false);
+    const ImageOf<PixelRgb> edgesense = reference(bayer, 0, 0, true);
+    const ImageOf<PixelRgb> half = referenceHalf(bayer, 0, 0);
+
+    SECTION("test bilinear debayering")
+    {
+        CHECK(debayer(bayer, "tcp+recv.bayer", bilinear) == 0);
+        CHECK(debayer(bayer, "tcp+recv.bayer+method.bilinear+threads.2", bilinear) == 0);
+    }
+
+    SECTION("test edgesense debayering")
+    {
+        CHECK(debayer(bayer, "tcp+recv.bayer+method.edgesense", edgesense) == 0);
+        CHECK(debayer(bayer, "tcp+recv.bayer+method.edgesense+threads.0", edgesense) == 0);
+    }
+
+    SECTION("test half size debayering")
+    {
+        CHECK(debayer(bayer, "tcp+recv.bayer+size.half", half) == 0);
+        CHECK(debayer(bayer, "tcp+recv.bayer+size.half+threads.2", half) == 0);
+    }
+
+    SECTION("test images with padded rows")
+    {
+        // rows of 37 samples padded to 48, that the built in methods read
+        // as they are
+        ImageOf<PixelMono> padded;
+        padded.setQuantum(16);
+        padded.resize(width, height);
+        REQUIRE(padded.getRowSize() == 48);
+        fillBayer(padded);
+        CHECK(debayer(padded, "tcp+recv.bayer", reference(padded, 0, 0, false)) == 0);
+        CHECK(debayer(padded, "tcp+recv.bayer+method.edgesense+threads.0", reference(padded, 0, 0, true)) == 0);
+        CHECK(debayer(padded, "tcp+recv.bayer+size.half", referenceHalf(padded, 0, 0)) == 0);
+    }
+
+    SECTION("test other bayer orders")
+    {
+        // the same image is bggr from the second row
+        ImageOf<PixelMono> shifted;
+        shifted.resize(width, height - 1);
+        for (size_t y = 0; y < height - 1; y++) {
+            memcpy(shifted.getRow(y), bayer.getRow(y + 1), width);
+        }
+        CHECK(debayer(shifted, "tcp+recv.bayer+order.bggr", reference(shifted, 1, 1, false)) == 0);
+        CHECK(debayer(shifted, "tcp+recv.bayer+order.bggr+size.half", referenceHalf(shifted, 1, 1)) == 0);
+    }
+
+    Network::setLocalMode(false);
+}
@@ -10,6 +10,8 @@
 #include <yarp/os/Network.h>
 #include <yarp/sig/all.h>
 
+#include <cstdlib>
+
 #include <catch.hpp>
 #include <harness.h>
 
@@ -53,5 +55,122 @@ TEST_CASE("carriers::mjpeg", "[carriers]")
         out.close();
     }
 
+    SECTION("test compression settings with several readers")
+    {
+        BufferedPort<ImageOf<PixelRgb>> in1;
+        BufferedPort<ImageOf<PixelRgb>> in2;
+        BufferedPort<ImageOf<PixelRgb>> out;
+
+        REQUIRE(in1.open("/mjpeg/in1"));
+        REQUIRE(in2.open("/mjpeg/in2"));
+        REQUIRE(out.open("/mjpeg/out"));
+        REQUIRE(Network::connect(out.getName(), in1.getName(), "mjpeg+quality.98+subsampling.444"));
+        REQUIRE(Network::connect(out.getName(), in2.getName(), "mjpeg"));
+
+        size_t width {64};
+        size_t height {48};
+        ImageOf<PixelRgb>& outImg = out.prepare();
+        outImg.resize(width, height);
+        for (size_t x = 0; x < width; x++) {
+            for (size_t y = 0; y < height; y++) {
+                outImg(x, y) = PixelRgb(static_cast<unsigned char>(4 * x), static_cast<unsigned char>(4 * y), 128);
+            }
+        }
+        PixelRgb expected = outImg(30, 20);
+
+        out.write();
+        yarp::os::Time::delay(0.4);
+
+        ImageOf<PixelRgb>* inImg1 = in1.read();
+        ImageOf<PixelRgb>* inImg2 = in2.read();
+        REQUIRE(inImg1 != nullptr);
+        REQUIRE(inImg2 != nullptr);
+        CHECK(inImg1->width() == width);
+        CHECK(inImg2->width() == width);
+        CHECK(std::abs((*inImg1)(30, 20).r - expected.r) <= 4);
+        CHECK(std::abs((*inImg1)(30, 20).g - expected.g) <= 4);
+
+        in1.interrupt();
+        in1.close();
+        in2.interrupt();
+        in2.close();
+        out.interrupt();
+        out.close();
+    }
+
+    SECTION("test quality and subsampling parameters")
+    {
+        // one reader for each setting, the image is compressed once for each
+        // of them
+        BufferedPort<ImageOf<PixelRgb>> best;
+        BufferedPort<ImageOf<PixelRgb>> subsampled;
+        BufferedPort<ImageOf<PixelRgb>> worst;
+        BufferedPort<ImageOf<PixelRgb>> invalid;
+        BufferedPort<ImageOf<PixelRgb>> out;
+
+        REQUIRE(best.open("/mjpeg/best"));
+        REQUIRE(subsampled.open("/mjpeg/subsampled"));
+        REQUIRE(worst.open("/mjpeg/worst"));
+        REQUIRE(invalid.open("/mjpeg/invalid"));
+        REQUIRE(out.open("/mjpeg/out"));
+        REQUIRE(Network::connect(out.getName(), best.getName(), "mjpeg+quality.100+subsampling.444"));
+        REQUIRE(Network::connect(out.getName(), subsampled.getName(), "mjpeg+quality.100+subsampling.420"));
+        REQUIRE(Network::connect(out.getName(), worst.getName(), "mjpeg+quality.1+subsampling.444"));
+        // invalid values are ignored, the defaults are used
+        REQUIRE(Network::connect(out.getName(), invalid.getName(), "mjpeg+quality.500+subsampling.411"));
+
+        // the colors alternate from one pixel to the next, the chroma
+        // subsampling averages them
+        size_t width {64};
+        size_t height {48};
+        ImageOf<PixelRgb>& outImg = out.prepare();
+        outImg.resize(width, height);
+        for (size_t x = 0; x < width; x++) {
+            for (size_t y = 0; y < height; y++) {
+                outImg(x, y) = ((x + y) % 2 == 0) ? PixelRgb(200, 60, 60) : PixelRgb(60, 60, 200);
+            }
+        }
+        ImageOf<PixelRgb> expected = outImg;
+
+        out.write();
+        yarp::os::Time::delay(0.4);
+
+        auto error = [&](BufferedPort<ImageOf<PixelRgb>>& port) {
+            ImageOf<PixelRgb>* img = port.read();
+            REQUIRE(img != nullptr);
+            REQUIRE(img->width() == width);
+            REQUIRE(img->height() == height);
+            double sum = 0;
+            for (size_t x = 0; x < width; x++) {
+                for (size_t y = 0; y < height; y++) {
+                    sum += std::abs((*img)(x, y).r - expected(x, y).r);
+                    sum += std::abs((*img)(x, y).b - expected(x, y).b);
+                }
+            }
+            return sum / (2 * width * height);
+        };
+
+        double bestError = error(best);
+        double subsampledError = error(subsampled);
+        double worstError = error(worst);
+        double invalidError = error(invalid);
+        INFO("mean errors: best " << bestError << ", subsampled " << subsampledError << ", worst " << worstError << ", invalid " << invalidError);
+        CHECK(bestError < 4);
+        CHECK(subsampledError > bestError + 20);
+        CHECK(worstError > bestError + 20);
+        CHECK(invalidError > bestError + 20);
+
+        best.interrupt();
+        best.close();
+        subsampled.interrupt();
+        subsampled.close();
+        worst.interrupt();
+        worst.close();
+        invalid.interrupt();
+        invalid.close();
+        out.interrupt();
+        out.close();
+    }
+
     Network::setLocalMode(false);
 }
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <yarp/os/all.h>
+#include <yarp/os/Network.h>
+#include <yarp/sig/all.h>
+
+#include <catch.hpp>
+#include <harness.h>
+
+#include <thread>
+
+using namespace yarp::os;
+using namespace yarp::sig;
+
+TEST_CASE("carriers::shmem2", "[carriers]")
+{
+    YARP_REQUIRE_PLUGIN("shmem2", "carrier");
+
+    Network::setLocalMode(true);
+
+    SECTION("test streaming")
+    {
+        BufferedPort<Bottle> in;
+        Port out;
+
+        REQUIRE(in.open("/shmem2/in"));
+        REQUIRE(out.open("/shmem2/out"));
+        REQUIRE(Network::connect(out.getName(), in.getName(), "shmem2"));
+
+        in.setStrict();
+        for (int i = 0; i < 20; i++) {
+            Bottle b;
+            b.addInt32(i);
+            b.addString("hello");
+            out.write(b);
+        }
+        for (int i = 0; i < 20; i++) {
+            Bottle* b = in.read();
+            REQUIRE(b != nullptr);
+            CHECK(b->get(0).asInt32() == i);
+            CHECK(b->get(1).asString() == "hello");
+        }
+
+        out.close();
+        in.close();
+    }
+
+    SECTION("test messages larger than the ring")
+    {
+        BufferedPort<ImageOf<PixelRgb>> in;
+        BufferedPort<ImageOf<PixelRgb>> out;
+
+        REQUIRE(in.open("/shmem2/in"));
+        REQUIRE(out.open("/shmem2/out"));
+        REQUIRE(Network::connect(out.getName(), in.getName(), "shmem2+slots.2+slot_size.4096"));
+
+        ImageOf<PixelRgb>& outImg = out.prepare();
+        outImg.resize(320, 240);
+        for (size_t y = 0; y < outImg.height(); y++) {
+            for (size_t x = 0; x < outImg.width(); x++) {
+                outImg.pixel(x, y) = PixelRgb(x % 256, y % 256, (x + y) % 256);
+            }
+        }
+        out.write();
+
+        ImageOf<PixelRgb>* inImg = in.read();
+        REQUIRE(inImg != nullptr);
+        CHECK(inImg->width() == 320);
+        CHECK(inImg->height() == 240);
+        CHECK(inImg->pixel(100, 200).r == 100);
+        CHECK(inImg->pixel(100, 200).g == 200);
+        CHECK(inImg->pixel(100, 200).b == 44);
+
+        out.close();
+        in.close();
+    }
+
+    SECTION("test replies")
+    {
+        Port server;
+        Port client;
+
+        REQUIRE(server.open("/shmem2/server"));
+        REQUIRE(client.open("/shmem2/client"));
+        REQUIRE(Network::connect(client.getName(), server.getName(), "shmem2"));
+
+        std::thread worker([&server]() {
+            Bottle cmd;
+            Bottle reply;
+            server.read(cmd, true);
+            reply.addInt32(cmd.get(0).asInt32() * 2);
+            server.reply(reply);
+        });
+
+        Bottle cmd;
+        Bottle reply;
+        cmd.addInt32(21);
+        REQUIRE(client.write(cmd, reply));
+        CHECK(reply.get(0).asInt32() == 42);
+
+        worker.join();
+        client.close();
+        server.close();
+    }
+
+    Network::setLocalMode(false);
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <yarp/os/all.h>
+#include <yarp/os/Network.h>
+#include <yarp/sig/all.h>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+extern "C" {
+    #include "zfp.h"
+}
+
+#include <catch.hpp>
+#include <harness.h>
+
+using namespace yarp::os;
+using namespace yarp::sig;
+
+namespace {
+
+// Sends an image through a zfp connection with some modifiers, and checks
+// the image received
+void checkRoundTrip(const std::string& modifiers,
+                    size_t width,
+                    size_t height,
+                    size_t quantum,
+                    double tolerance)
+{
+    BufferedPort<ImageOf<PixelFloat>> in;
+    BufferedPort<ImageOf<PixelFloat>> out;
+
+    REQUIRE(in.open("/zfp/in"));
+    REQUIRE(out.open("/zfp/out"));
+    REQUIRE(Network::connect(out.getName(), in.getName(), "tcp+send.portmonitor+file.zfp+recv.portmonitor+file.zfp+type.dll" + modifiers));
+
+    ImageOf<PixelFloat>& outImg = out.prepare();
+    outImg.setQuantum(quantum);
+    outImg.resize(width, height);
+    for (size_t x = 0; x < width; x++) {
+        for (size_t y = 0; y < height; y++) {
+            outImg(x, y) = 1.0f + 0.01f * x + 0.02f * y + ((x * 7 + y * 3) % 5) * 0.001f;
+        }
+    }
+    ImageOf<PixelFloat> expected = outImg;
+
+    out.write();
+    ImageOf<PixelFloat>* inImg = in.read();
+    REQUIRE(inImg != nullptr);
+    REQUIRE(inImg->width() == width);
+    REQUIRE(inImg->height() == height);
+
+    double maxError = 0;
+    for (size_t x = 0; x < width; x++) {
+        for (size_t y = 0; y < height; y++) {
+            maxError = std::max(maxError, std::fabs(static_cast<double>((*inImg)(x, y)) - expected(x, y)));
+        }
+    }
+    INFO("modifiers: " << modifiers << ", size: " << width << "x" << height << ", quantum: " << quantum);
+    CHECK(maxError <= tolerance);
+
+    in.close();
+    out.close();
+}
+
+} // namespace
+
+TEST_CASE("carriers::zfp", "[carriers]")
+{
+    YARP_REQUIRE_PLUGIN("portmonitor", "carrier");
+    YARP_REQUIRE_PLUGIN("zfp", "portmonitor");
+
+    Network::setLocalMode(true);
+
+    SECTION("test the default settings")
+    {
+        checkRoundTrip("", 64, 48, 0, 1e-3);
+    }
+
+    SECTION("test the images read by the older receivers")
+    {
+        // the older receivers read the compressed image as a Bottle, and
+        // cannot read the tiles
+        BufferedPort<Bottle> in;
+        BufferedPort<ImageOf<PixelFloat>> out;
+        REQUIRE(in.open("/zfp/in"));
+        REQUIRE(out.open("/zfp/out"));
+
+        for (const std::string modifiers : {"", "+threads.2"}) {
+            REQUIRE(Network::connect(out.getName(), in.getName(), "tcp+send.portmonitor+file.zfp+type.dll" + modifiers));
+            ImageOf<PixelFloat>& outImg = out.prepare();
+            outImg.resize(16, 16);
+            outImg.zero();
+            out.write();
+            Bottle* b = in.read();
+            REQUIRE(b != nullptr);
+            INFO("modifiers: " << modifiers);
+            CHECK(b->size() == (modifiers.empty() ? 4 : 5));
+            CHECK(b->get(0).asInt32() == 16);
+            CHECK(b->get(1).asInt32() == 16);
+            CHECK(b->get(3).isBlob());
+            CHECK(static_cast<size_t>(b->get(2).asInt32()) == b->get(3).asBlobLength());
+            REQUIRE(Network::disconnect(out.getName(), in.getName()));
+        }
+
+        in.close();
+        out.close();
+    }
+
+    SECTION("test several tile sizes")
+    {
+        // the tiles are made of whole 4x4 blocks, the last one can be
+        // shorter
+        checkRoundTrip("+threads.2", 64, 48, 0, 1e-3);
+        checkRoundTrip("+threads.3", 61, 47, 0, 1e-3);
+        checkRoundTrip("+threads.4", 16, 5, 0, 1e-3);
+        checkRoundTrip("+threads.8", 7, 1, 0, 1e-3);
+        checkRoundTrip("+threads.0", 128, 97, 0, 1e-3);
+    }
+
+    SECTION("test the precision mode")
+    {
+        checkRoundTrip("+mode.precision+precision.24+threads.2", 64, 48, 0, 1e-3);
+    }
+
+    SECTION("test the rate mode with padded rows")
+    {
+        // rows of 13 values padded to 16
+        checkRoundTrip("+mode.rate+rate.16", 13, 21, 64, 1e-2);
+        checkRoundTrip("+mode.rate+rate.16+threads.3", 13, 21, 64, 1e-2);
+    }
+
+#if defined(ZFP_VERSION) && ZFP_VERSION >= 0x0055
+    SECTION("test the lossless mode")
+    {
+        checkRoundTrip("+mode.lossless+threads.2", 61, 47, 0, 0.0);
+        checkRoundTrip("+mode.lossless", 13, 21, 64, 0.0);
+    }
+#endif
+
+    Network::setLocalMode(false);
+}
@@ -391,6 +391,32 @@ TEST_CASE("dev::FrameTransformClientTest", "[yarp::dev]")
             // itf->setTransformStatic still working after duplicate transform
         }
 
+        //test 13
+        {
+            itf->clear();
+            CHECK(itf->setTransform("frame2", "frame1", m1));
+            CHECK(itf->setTransform("frame3", "frame2", m2));
+            CHECK(itf->setTransform("frame3b", "frame2", m4));
+            yarp::os::Time::delay(0.050);
+
+            yarp::sig::Matrix mt1;
+            yarp::sig::Matrix mt2;
+            CHECK(itf->getTransform("frame3", "frame1", mt1));
+            CHECK(itf->getTransform("frame3", "frame3b", mt2));
+            CHECK(isEqual(mt1, m1 * m2, precision));
+            CHECK(isEqual(mt2, SE3inv(m4) * m2, precision));
+
+            // the chains computed before are updated with the link
+            CHECK(itf->setTransform("frame2", "frame1", m2));
+            CHECK(itf->setTransform("frame3", "frame2", m1));
+            yarp::os::Time::delay(0.050);
+            CHECK(itf->getTransform("frame3", "frame1", mt1));
+            CHECK(itf->getTransform("frame3", "frame3b", mt2));
+            CHECK(isEqual(mt1, m2 * m1, precision));
+            CHECK(isEqual(mt2, SE3inv(m4) * m1, precision));
+            // itf->getTransform successfully updated the chained transforms
+        }
+
         // Close devices
         CHECK(ddtransformclient.close()); // ddtransformclient successfully closed
         CHECK(ddtransformserver.close()); // ddtransformserver successfully closed
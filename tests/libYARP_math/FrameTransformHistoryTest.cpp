@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <yarp/math/FrameTransformHistory.h>
+
+#if defined(_MSC_VER)
+# define _USE_MATH_DEFINES
+#endif
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+#include <catch.hpp>
+#include <harness.h>
+
+using namespace yarp::math;
+
+namespace {
+
+FrameTransform makeTransform(double timestamp, double x, double yaw)
+{
+    FrameTransform t;
+    t.timestamp = timestamp;
+    t.transFromVec(x, 2 * x, 0);
+    t.rotFromRPY(0, 0, yaw);
+    return t;
+}
+
+} // namespace
+
+TEST_CASE("math::FrameTransformHistoryTest", "[yarp::math]")
+{
+    SECTION("Check an empty history")
+    {
+        FrameTransformHistory history(4);
+        FrameTransform t;
+        CHECK(history.size() == 0);
+        CHECK(history.capacity() == 4);
+        CHECK_FALSE(history.getLatest(t));
+        CHECK_FALSE(history.getAt(1.0, t));
+    }
+
+    SECTION("Check a single value is valid at any time")
+    {
+        FrameTransformHistory history(4);
+        CHECK(history.add(makeTransform(10.0, 1.0, 0.0)));
+        FrameTransform t;
+        REQUIRE(history.getAt(5.0, t));
+        CHECK(t.translation.tX == Approx(1.0));
+        REQUIRE(history.getAt(15.0, t));
+        CHECK(t.translation.tX == Approx(1.0));
+        CHECK(t.timestamp == 15.0);
+    }
+
+    SECTION("Check the interpolation")
+    {
+        FrameTransformHistory history(4);
+        CHECK(history.add(makeTransform(1.0, 0.0, 0.0)));
+        CHECK(history.add(makeTransform(2.0, 1.0, M_PI / 2)));
+        CHECK(history.add(makeTransform(3.0, 3.0, M_PI / 2)));
+
+        FrameTransform t;
+        REQUIRE(history.getAt(1.5, t));
+        CHECK(t.translation.tX == Approx(0.5));
+        CHECK(t.translation.tY == Approx(1.0));
+        CHECK(t.getRPYRot()[2] == Approx(M_PI / 4));
+
+        REQUIRE(history.getAt(2.25, t));
+        CHECK(t.translation.tX == Approx(1.5));
+        CHECK(t.getRPYRot()[2] == Approx(M_PI / 2));
+
+        // exactly on a sample
+        REQUIRE(history.getAt(2.0, t));
+        CHECK(t.translation.tX == Approx(1.0));
+
+        // after the newest value, within the tolerance only
+        CHECK_FALSE(history.getAt(10.0, t));
+        REQUIRE(history.getAt(3.0, t));
+        CHECK(t.translation.tX == Approx(3.0));
+        REQUIRE(history.getAt(3.1, t, 0.2));
+        CHECK(t.translation.tX == Approx(3.0));
+        CHECK(t.timestamp == 3.1);
+        CHECK_FALSE(history.getAt(3.3, t, 0.2));
+
+        // before the oldest value
+        CHECK_FALSE(history.getAt(0.5, t));
+    }
+
+    SECTION("Check the rotation takes the shortest path")
+    {
+        FrameTransform a = makeTransform(0.0, 0.0, M_PI * 0.9);
+        FrameTransform b = makeTransform(1.0, 0.0, -M_PI * 0.9);
+        FrameTransform t;
+        FrameTransformHistory::interpolate(a, b, 0.5, t);
+        CHECK(std::fabs(t.getRPYRot()[2]) == Approx(M_PI));
+    }
+
+    SECTION("Check the oldest values are dropped")
+    {
+        FrameTransformHistory history(3);
+        for (int i = 0; i < 5; i++) {
+            CHECK(history.add(makeTransform(i, i, 0.0)));
+        }
+        CHECK(history.size() == 3);
+        FrameTransform t;
+        CHECK_FALSE(history.getAt(1.5, t));
+        REQUIRE(history.getAt(2.5, t));
+        CHECK(t.translation.tX == Approx(2.5));
+        REQUIRE(history.getLatest(t));
+        CHECK(t.translation.tX == Approx(4.0));
+    }
+
+    SECTION("Check older and repeated values")
+    {
+        FrameTransformHistory history(3);
+        CHECK(history.add(makeTransform(2.0, 1.0, 0.0)));
+        CHECK_FALSE(history.add(makeTransform(1.0, 2.0, 0.0)));
+        CHECK(history.add(makeTransform(2.0, 3.0, 0.0)));
+        CHECK(history.size() == 1);
+        FrameTransform t;
+        REQUIRE(history.getLatest(t));
+        CHECK(t.translation.tX == Approx(3.0));
+
+        history.clear();
+        CHECK(history.size() == 0);
+        CHECK_FALSE(history.getLatest(t));
+    }
+
+    SECTION("Check the readers see consistent values")
+    {
+        FrameTransformHistory history(8);
+        std::atomic<bool> done {false};
+        std::thread writer([&]() {
+            for (int i = 0; i < 20000; i++) {
+                // translation and timestamp always equal
+                history.add(makeTransform(i, i, 0.0));
+            }
+            done = true;
+        });
+
+        bool consistent = true;
+        FrameTransform t;
+        while (!done) {
+            if (history.getLatest(t) && t.translation.tX != t.timestamp) {
+                consistent = false;
+            }
+        }
+        writer.join();
+        CHECK(consistent);
+    }
+}
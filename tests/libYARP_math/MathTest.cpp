@@ -756,4 +756,117 @@ TEST_CASE("math::MathTest", "[yarp::math]")
         f[4] = 5.0;
         CHECK_EQUAL(cat(1.0, 2.0, 3.0, 4.0, 5.0), f); // cat(n1, n2, n3, n4, n5) = [n1, n2, n3, n4, n5]
     }
+
+    SECTION("check allocation-free variants.")
+    {
+        for (size_t n : {3, 4, 5, 6}) {
+            Matrix A = Rand::matrix(n, n);
+            Matrix B = Rand::matrix(n, n);
+            Vector v = Rand::vector(n);
+
+            // reference products, computed element by element
+            Matrix AB(n, n);
+            Vector Av(n);
+            Vector vA(n);
+            for (size_t r = 0; r < n; r++) {
+                Av[r] = 0.0;
+                vA[r] = 0.0;
+                for (size_t c = 0; c < n; c++) {
+                    AB(r, c) = 0.0;
+                    for (size_t k = 0; k < n; k++) {
+                        AB(r, c) += A(r, k) * B(k, c);
+                    }
+                    Av[r] += A(r, c) * v[c];
+                    vA[r] += v[c] * A(c, r);
+                }
+            }
+
+            Matrix C;
+            mul_into(C, A, B);
+            CHECK_EQUAL(C, AB); // mul_into(matrix, matrix)
+            const double* data = C.data();
+            mul_into(C, A, B);
+            CHECK(C.data() == data); // the output is reused
+
+            Vector w;
+            mul_into(w, A, v);
+            CHECK_EQUAL(w, Av); // mul_into(matrix, vector)
+            mul_into(w, v, A);
+            CHECK_EQUAL(w, vA); // mul_into(vector, matrix)
+
+            Matrix D(A);
+            D *= B;
+            CHECK_EQUAL(D, AB); // in place product
+            Vector u(v);
+            u *= A;
+            CHECK_EQUAL(u, vA); // in place product
+
+            add_into(C, A, B);
+            CHECK_EQUAL(C, A + B);
+            sub_into(C, A, B);
+            CHECK_EQUAL(C, A - B);
+            mul_into(C, A, 2.0);
+            CHECK_EQUAL(C, 2.0 * A);
+            add_into(w, v, Av);
+            CHECK_EQUAL(w, v + Av);
+            sub_into(w, v, Av);
+            CHECK_EQUAL(w, v - Av);
+            mul_into(w, v, -3.0);
+            CHECK_EQUAL(w, -3.0 * v);
+        }
+
+        Vector rpy(3);
+        rpy[0] = 0.3;
+        rpy[1] = -0.7;
+        rpy[2] = 1.9;
+        Vector ax(4, 0.0);
+        Matrix Rz, Ry, Rx;
+        ax[2] = 1.0; ax[3] = rpy[2]; axis2dcm_into(Rz, ax);
+        ax[2] = 0.0; ax[1] = 1.0; ax[3] = rpy[1]; axis2dcm_into(Ry, ax);
+        ax[1] = 0.0; ax[0] = 1.0; ax[3] = rpy[0]; axis2dcm_into(Rx, ax);
+        Matrix R;
+        rpy2dcm_into(R, rpy);
+        CHECK_EQUAL(R, Rz * Ry * Rx); // rpy2dcm_into = Rz*Ry*Rx
+        Vector angles;
+        angles.resize(3);
+        angles[0] = rpy[2];
+        angles[1] = rpy[1];
+        angles[2] = rpy[0];
+        ypr2dcm_into(R, angles);
+        CHECK_EQUAL(R, Rx * Ry * Rz); // ypr2dcm_into = Rx*Ry*Rz
+
+        Vector axis;
+        dcm2axis_into(axis, Rz);
+        CHECK_EQUAL(axis[2], 1.0);
+        CHECK_EQUAL(axis[3], rpy[2]);
+
+        Matrix H;
+        rpy2dcm_into(H, rpy);
+        H(0, 3) = 1.0;
+        H(1, 3) = -2.0;
+        H(2, 3) = 0.5;
+        Matrix invH;
+        SE3inv_into(invH, H);
+        CHECK_EQUAL(invH * H, eye(4)); // SE3inv_into
+        Matrix adj, adjInv;
+        adjoint_into(adj, H);
+        adjointInv_into(adjInv, H);
+        CHECK_EQUAL(adj * adjInv, eye(6)); // adjoint_into and adjointInv_into
+
+        Vector a(3), b(3), c;
+        a[0] = 1.0;
+        b[1] = 1.0;
+        a[1] = a[2] = b[0] = b[2] = 0.0;
+        cross_into(c, a, b);
+        CHECK_EQUAL(c, cat(0.0, 0.0, 1.0)); // x cross y = z
+
+        Vector ab;
+        cat_into(ab, a, b);
+        CHECK_EQUAL(ab, cat(cat(1.0, 0.0, 0.0), cat(0.0, 1.0, 0.0)));
+        Matrix M;
+        cat_into(M, Rx, Ry);
+        CHECK_EQUAL(M, cat(Rx, Ry));
+        pile_into(M, Rx, Ry);
+        CHECK_EQUAL(M, pile(Rx, Ry));
+    }
 }
@@ -429,6 +429,52 @@ TEST_CASE("os::BottleTest", "[yarp::os]")
         CHECK(b2.get(0).asFloat64() == Approx(3.14)); // copy from bottle succeeded
     }
 
+    SECTION("test refilling a bottle after clear")
+    {
+        Bottle src("1 \"hello\" (2.5 (3 4) \"nested\") [ok] {1 2 3}");
+        Bottle dest;
+        Portable::copyPortable(src, dest);
+        CHECK(dest.toString() == src.toString());
+
+        // same shape: the items are reused
+        const Value* item = &dest.get(1);
+        const Bottle* list = dest.get(2).asList();
+        Bottle same("2 \"a string too long to fit in a small buffer\" (3.5 (5 6) \"x\") [no] {4 5}");
+        Portable::copyPortable(same, dest);
+        CHECK(dest.toString() == same.toString());
+        CHECK(&dest.get(1) == item);
+        CHECK(dest.get(2).asList() == list);
+
+        // different shape
+        Bottle src2("\"first\" (1 2 3) (4.0 5.0) 6");
+        Portable::copyPortable(src2, dest);
+        CHECK(dest.toString() == src2.toString());
+        CHECK(dest.get(1).asList()->get(2).asInt32() == 3);
+        CHECK(dest.get(2).asList()->get(1).asFloat64() == 5.0);
+        Portable::copyPortable(src, dest);
+        CHECK(dest.toString() == src.toString());
+
+        // adding items after a clear
+        dest.clear();
+        CHECK(dest.size() == 0);
+        dest.addInt32(10);
+        dest.addString("world");
+        Bottle& lst = dest.addList();
+        CHECK(lst.size() == 0);
+        lst.addFloat64(1.5);
+        dest.addVocab(yarp::os::createVocab('o', 'k'));
+        CHECK(dest.toString() == "10 world (1.5) [ok]");
+        Bottle copy;
+        Portable::copyPortable(dest, copy);
+        CHECK(copy.toString() == dest.toString());
+
+        // copying a bottle
+        dest = src2;
+        CHECK(dest.toString() == src2.toString());
+        dest = src;
+        CHECK(dest.toString() == src.toString());
+    }
+
     SECTION("test string with null")
     {
         char buf1[] = "hello world";
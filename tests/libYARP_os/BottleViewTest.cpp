@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <yarp/os/BottleView.h>
+
+#include <yarp/os/Bottle.h>
+#include <yarp/os/BufferedPort.h>
+#include <yarp/os/Network.h>
+#include <yarp/os/Port.h>
+#include <yarp/os/Property.h>
+#include <yarp/os/Vocab.h>
+
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include <catch.hpp>
+#include <harness.h>
+
+using namespace yarp::os;
+
+TEST_CASE("os::BottleViewTest", "[yarp::os]")
+{
+    SECTION("accessing the items")
+    {
+        Bottle b("10 3.5 \"hello world\" [set] (1 2 (3 \"x\")) {1 2 3} (4.5 5.5)");
+        b.addInt8(-8);
+        b.addInt64(1LL << 40);
+        b.addFloat32(2.5f);
+        BottleView view(b);
+
+        REQUIRE(view.size() == b.size());
+        CHECK(view.toString() == b.toString());
+
+        // the items can be accessed in any order
+        CHECK(view.get(9).asFloat32() == 2.5f);
+        CHECK(view.get(0).isInt32());
+        CHECK(view.get(0).asInt32() == 10);
+        CHECK(view.get(0).asFloat64() == 10.0);
+        CHECK(view.get(1).isFloat64());
+        CHECK(view.get(1).asFloat64() == 3.5);
+        CHECK(view.get(2).isString());
+        CHECK(view.get(2).asString() == "hello world");
+        CHECK(view.get(2).asBlobLength() == 11);
+        CHECK(std::memcmp(view.get(2).asBlob(), "hello world", 11) == 0);
+        CHECK(view.get(3).isVocab());
+        CHECK(view.get(3).asVocab() == createVocab('s', 'e', 't'));
+        CHECK(view.get(5).isBlob());
+        CHECK(view.get(5).asBlobLength() == 3);
+        CHECK(view.get(7).isInt8());
+        CHECK(view.get(7).asInt8() == -8);
+        CHECK(view.get(8).isInt64());
+        CHECK(view.get(8).asInt64() == (1LL << 40));
+
+        BottleView lst = view.get(4).asList();
+        REQUIRE(view.get(4).isList());
+        REQUIRE(lst.size() == 3);
+        CHECK(lst.get(1).asInt32() == 2);
+        CHECK(lst.get(2).asList().get(1).asString() == "x");
+        CHECK(view.get(4).toString() == b.get(4).toString());
+
+        // a list of numbers of the same type
+        BottleView typed = view.get(6).asList();
+        REQUIRE(typed.size() == 2);
+        CHECK(typed.get(0).isFloat64());
+        CHECK(typed.get(1).asFloat64() == 5.5);
+
+        CHECK(view.get(10).isNull());
+        CHECK(view.get(0).asList().size() == 0);
+        CHECK(view.get(0).asBlob() == nullptr);
+        CHECK(view.get(1).asString().empty());
+    }
+
+    SECTION("converting to a bottle")
+    {
+        Bottle b("1 (2 3) \"four\"");
+        Property& dict = b.addDict();
+        dict.put("five", 5);
+        BottleView view(b);
+
+        CHECK(view.get(3).isDict());
+        CHECK(view.get(3).asList().toString() == "(five 5)");
+
+        Bottle copy = view.toBottle();
+        CHECK(copy.toString() == b.toString());
+        copy.addInt32(6);
+        CHECK(copy.size() == 5);
+
+        Bottle nested;
+        REQUIRE(view.get(1).asList().toBottle(nested));
+        CHECK(nested.toString() == "2 3");
+
+        BottleView empty;
+        CHECK(empty.size() == 0);
+        CHECK(empty.toBottle().size() == 0);
+    }
+
+    SECTION("copying a view")
+    {
+        BottleView view(Bottle("1 \"two\" (3)"));
+        BottleView copy(view);
+        view = BottleView(Bottle("4"));
+        CHECK(copy.toString() == "1 two (3)");
+        CHECK(copy.get(1).asString() == "two");
+        BottleView moved(std::move(copy));
+        CHECK(moved.get(2).asList().get(0).asInt32() == 3);
+        copy = moved;
+        CHECK(copy.get(1).asString() == "two");
+        CHECK(view.toString() == "4");
+    }
+
+    SECTION("checking the data")
+    {
+        Bottle b("1 2 \"three\"");
+        size_t len = 0;
+        const char* buf = b.toBinary(&len);
+        BottleView view;
+        CHECK(view.fromBinary(buf, len));
+        CHECK(view.size() == 3);
+        CHECK_FALSE(view.fromBinary(buf, len - 1));
+        CHECK(view.size() == 0);
+        std::string longer(buf, len);
+        longer += "x";
+        CHECK_FALSE(view.fromBinary(longer.c_str(), longer.length()));
+    }
+
+    SECTION("reading from a port")
+    {
+        NetworkBase::setLocalMode(true);
+
+        BufferedPort<BottleView> in;
+        Port out;
+        REQUIRE(in.open("/view/in"));
+        REQUIRE(out.open("/view/out"));
+        REQUIRE(Network::connect("/view/out", "/view/in"));
+
+        Bottle b("set (speed 10) \"a message\"");
+        out.write(b);
+        BottleView* view = in.read();
+        REQUIRE(view != nullptr);
+        CHECK(view->get(0).asString() == "set");
+        CHECK(view->get(1).asList().get(1).asInt32() == 10);
+        CHECK(view->toBottle().toString() == b.toString());
+
+        out.close();
+        in.close();
+
+        NetworkBase::setLocalMode(false);
+    }
+}
@@ -13,6 +13,8 @@
 #include <yarp/os/Network.h>
 #include <yarp/os/Time.h>
 
+#include <thread>
+
 #include <catch.hpp>
 #include <harness.h>
 
@@ -111,6 +113,138 @@ TEST_CASE("os::PortReaderBufferTest", "[yarp::os]")
         //p2.close();
     }
 
+    SECTION("checking local carrier copies")
+    {
+        class DerivedBottle : public Bottle
+        {
+        };
+
+        Port p0;
+        BufferedPort<Bottle> p1, p2;
+        p0.open("/p0");
+        p1.open("/p1");
+        p2.open("/p2");
+        p2.setStrict();
+
+        Network::connect("/p0", "/p2", "local");
+        Network::connect("/p1", "/p2", "local");
+        Network::sync("/p0");
+        Network::sync("/p1");
+        Network::sync("/p2");
+
+        // Same type, the object is copied without serialization, and the
+        // reader does not see later changes to the sender's object.
+        Bottle data;
+        data.fromString("hello");
+        p0.write(data);
+        data.fromString("changed");
+
+        Bottle *bot = p2.read();
+        REQUIRE(bot != nullptr); // Port message received
+        CHECK(bot->toString() == "hello"); // value ok
+        CHECK(bot != &data); // reader owns a copy
+
+        // A derived type falls back to serialization.
+        DerivedBottle derived;
+        derived.fromString("derived 42");
+        p0.write(derived);
+
+        bot = p2.read();
+        REQUIRE(bot != nullptr); // Derived message received
+        CHECK(bot->toString() == "derived 42"); // value ok
+
+        // A BufferedPort hands over its object, and prepares the next
+        // messages in other objects.
+        Bottle* sent[5];
+        for (int i = 0; i < 5; i++) {
+            Bottle& b = p1.prepare();
+            b.clear();
+            b.addInt32(i);
+            sent[i] = &b;
+            p1.writeStrict();
+        }
+        for (int i = 0; i < 5; i++) {
+            bot = p2.read();
+            REQUIRE(bot != nullptr); // BufferedPort message received
+            CHECK(bot->get(0).asInt32() == i); // value ok
+            CHECK(bot == sent[i]); // object shared, not copied
+        }
+        Bottle& next = p1.prepare();
+        CHECK(&next != bot); // the reader keeps its object
+        next.clear();
+        next.addString("next");
+        CHECK(bot->get(0).asInt32() == 4); // value untouched
+        p1.unprepare();
+
+        // The sender's object stays valid after the sender is gone.
+        p1.close();
+        CHECK(bot->get(0).asInt32() == 4); // value still ok
+
+        p0.close();
+        p2.close();
+    }
+
+    SECTION("checking local carrier close while writing")
+    {
+        BufferedPort<Bottle> p1, p2;
+        p1.open("/p1");
+        p2.open("/p2");
+        p2.setStrict();
+
+        Network::connect("/p1", "/p2", "local");
+        Network::sync("/p1");
+        Network::sync("/p2");
+
+        // Nobody reads from p2, the sender must not be left waiting for
+        // an acknowledgement when p2 goes away.
+        for (int i = 0; i < 5; i++) {
+            Bottle& b = p1.prepare();
+            b.clear();
+            b.addInt32(i);
+            p1.write();
+        }
+        p2.close();
+        for (int i = 0; i < 50 && p1.isWriting(); i++) {
+            Time::delay(0.1);
+        }
+        CHECK_FALSE(p1.isWriting()); // the sender is not left waiting
+        p1.close();
+    }
+
+    SECTION("checking local readers of the same message")
+    {
+        BufferedPort<Bottle> p1, p2, p3;
+        p1.open("/p1");
+        p2.open("/p2");
+        p3.open("/p3");
+        p2.setStrict();
+        p3.setStrict();
+
+        Network::connect("/p1", "/p2", "local");
+        Network::connect("/p1", "/p3", "local");
+        Network::sync("/p1");
+        Network::sync("/p2");
+        Network::sync("/p3");
+
+        Bottle& sent = p1.prepare();
+        sent.fromString("hello");
+        p1.writeStrict();
+
+        Bottle* bot2 = p2.read();
+        Bottle* bot3 = p3.read();
+        REQUIRE(bot2 != nullptr); // message received by the first reader
+        REQUIRE(bot3 != nullptr); // message received by the second reader
+        CHECK(bot2 != bot3); // each reader has its own object
+        bot2->fromString("changed");
+        CHECK(bot3->toString() == "hello"); // not modified by the other reader
+        bot3->fromString("changed too");
+        CHECK(bot2->toString() == "changed"); // not modified by the other reader
+
+        p1.close();
+        p2.close();
+        p3.close();
+    }
+
     SECTION("checking callback")
     {
         BufferedPort<Bottle> out;
@@ -174,5 +308,116 @@ TEST_CASE("os::PortReaderBufferTest", "[yarp::os]")
         }
     }
 
+    SECTION("checking lock-free ring")
+    {
+        PortReaderBuffer<Bottle> buffer;
+        buffer.setLockFree(true, 4);
+        buffer.setStrict();
+        Bottle data[3];
+        data[0].fromString("one");
+        data[1].fromString("two");
+        data[2].fromString("three");
+
+        for (auto& d : data) {
+            buffer.acceptObject(&d, nullptr);
+        }
+        CHECK(buffer.getPendingReads() == 3); // strict mode keeps everything
+        for (auto& d : data) {
+            Bottle *bot = buffer.read();
+            REQUIRE(bot!=nullptr);
+            CHECK(bot->toString() == d.toString()); // fifo order
+        }
+        CHECK(buffer.read(false) == nullptr);
+
+        buffer.setStrict(false);
+        for (auto& d : data) {
+            buffer.acceptObject(&d, nullptr);
+        }
+        CHECK(buffer.getPendingReads() == 1); // only the latest is kept
+        Bottle *bot = buffer.read();
+        REQUIRE(bot!=nullptr);
+        CHECK(bot->toString() == "three");
+
+        void* key = buffer.acquire();
+        CHECK(key != nullptr);
+        buffer.acceptObject(&data[0], nullptr);
+        bot = buffer.read();
+        REQUIRE(bot!=nullptr);
+        CHECK(bot->toString() == "one");
+        buffer.release(key);
+    }
+
+    SECTION("checking lock-free ring interrupts")
+    {
+        PortReaderBuffer<Bottle> buffer;
+        buffer.setLockFree(true, 4);
+        Bottle data[2];
+        data[0].fromString("one");
+        data[1].fromString("two");
+
+        // an interrupt arriving while a message is queued is consumed by
+        // the read of that message
+        buffer.acceptObject(&data[0], nullptr);
+        buffer.interrupt();
+        Bottle *bot = buffer.read();
+        REQUIRE(bot!=nullptr);
+        CHECK(bot->toString() == "one");
+        std::thread writer([&]() {
+            Time::delay(0.2);
+            buffer.acceptObject(&data[1], nullptr);
+        });
+        bot = buffer.read();
+        writer.join();
+        REQUIRE(bot!=nullptr); // no spurious wake up
+        CHECK(bot->toString() == "two");
+
+        // the pending interrupts are discarded when resuming
+        buffer.interrupt();
+        buffer.resume();
+        writer = std::thread([&]() {
+            Time::delay(0.2);
+            buffer.acceptObject(&data[0], nullptr);
+        });
+        bot = buffer.read();
+        writer.join();
+        REQUIRE(bot!=nullptr);
+        CHECK(bot->toString() == "one");
+    }
+
+    SECTION("checking lock-free ring over tcp")
+    {
+        BufferedPort<Bottle> out;
+        BufferedPort<Bottle> in;
+        // a small ring, so that the writer has to wait for the reader
+        in.setLockFree(true, 4);
+        in.setStrict();
+        out.open("/out");
+        in.open("/in");
+        Network::connect("/out", "/in");
+        Network::sync("/out");
+        Network::sync("/in");
+        const int n = 50;
+        std::thread writer([&]() {
+            for (int i = 0; i < n; i++) {
+                Bottle& b = out.prepare();
+                b.clear();
+                b.addInt32(i);
+                out.writeStrict();
+            }
+        });
+        int received = 0;
+        for (int i = 0; i < n; i++) {
+            Bottle* datum = in.read();
+            if (datum == nullptr || datum->get(0).asInt32() != i) {
+                break;
+            }
+            received++;
+        }
+        writer.join();
+        CHECK(received == n); // nothing lost, in order
+        out.close();
+        in.close();
+    }
+
     NetworkBase::setLocalMode(false);
 }
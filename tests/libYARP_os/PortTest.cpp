@@ -34,6 +34,10 @@
 
 #include <yarp/companion/impl/Companion.h>
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
 #include <catch.hpp>
 #include <harness.h>
 
@@ -172,6 +176,38 @@ public:
     }
 };
 
+class BlockWriter : public Portable
+{
+public:
+    std::vector<std::string> blocks;
+
+    virtual bool write(ConnectionWriter& connection) const override {
+        connection.appendInt32((std::int32_t)blocks.size());
+        for (const auto& block : blocks) {
+            connection.appendInt32((std::int32_t)block.length());
+            connection.appendExternalBlock(block.c_str(), block.length());
+        }
+        return true;
+    }
+
+    virtual bool read(ConnectionReader& connection) override {
+        blocks.clear();
+        std::int32_t count = connection.expectInt32();
+        for (std::int32_t i = 0; i < count; i++) {
+            std::int32_t len = connection.expectInt32();
+            if (len < 0 || connection.isError()) {
+                return false;
+            }
+            std::string block(len, '\0');
+            if (!connection.expectBlock(&block[0], len)) {
+                return false;
+            }
+            blocks.push_back(block);
+        }
+        return !connection.isError();
+    }
+};
+
 class DelegatedReader : public Thread
 {
 public:
@@ -391,6 +427,37 @@ TEST_CASE("os::PortTest", "[yarp::os]")
         out.close();
     }
 
+    SECTION("checking messages made of many blocks over tcp")
+    {
+        Port out, in;
+
+        in.open("/in");
+        out.open("/out");
+        Network::connect("/out", "/in", "tcp");
+
+        BlockWriter sent, received;
+        // 201 blocks, more than what is sent with a single system call,
+        // but within the 255 blocks allowed in a message index.
+        for (int i = 0; i < 100; i++) {
+            // mix small blocks with some large ones
+            sent.blocks.push_back(std::string((i % 25 == 0) ? 4000 : (i % 7) + 1, (char)('a' + i % 26)));
+        }
+
+        out.enableBackgroundWrite(true);
+        for (int k = 0; k < 3; k++) {
+            out.write(sent);
+            in.read(received);
+            REQUIRE(received.blocks.size() == sent.blocks.size()); // same number of blocks
+            CHECK(received.blocks == sent.blocks); // same content
+            while (out.isWriting()) {
+                Time::delay(0.01);
+            }
+        }
+
+        in.close();
+        out.close();
+    }
+
 #if defined(ENABLE_BROKEN_TESTS)
     SECTION("checking read buffering")
     {
@@ -30,4 +30,19 @@ TEST_CASE("os::StringOutputStreamTest", "[yarp::os]")
         sos2.write('o');
         CHECK(sos2.toString() == "yo"); // multiple writes
     }
+
+    SECTION("testing vectored writing")
+    {
+        StringOutputStream sos;
+        char txt1[] = "Hello ";
+        char txt2[] = "my ";
+        char txt3[] = "friend";
+        Bytes blocks[3] = {
+            Bytes(txt1, strlen(txt1)),
+            Bytes(txt2, strlen(txt2)),
+            Bytes(txt3, strlen(txt3))
+        };
+        sos.writev(blocks, 3);
+        CHECK(sos.toString() == "Hello my friend"); // blocks written in order
+    }
 }
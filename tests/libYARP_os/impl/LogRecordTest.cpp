@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <yarp/os/impl/LogRecord.h>
+
+#include <yarp/os/Property.h>
+
+#include <catch.hpp>
+#include <harness.h>
+
+using namespace yarp::os;
+using namespace yarp::os::impl;
+
+TEST_CASE("os::impl::LogRecordTest", "[yarp::os][yarp::os::impl]")
+{
+    SECTION("checking a minimal record")
+    {
+        std::string buffer;
+        LogRecord::encode(buffer, Log::InfoType, 1.5, 2.5, nullptr, 0, nullptr, nullptr, 0, nullptr, nullptr, 0, nullptr, "hello", nullptr);
+
+        LogRecord record;
+        REQUIRE(record.decode(buffer.data(), buffer.size()));
+        CHECK(record.type == Log::InfoType);
+        CHECK(record.flags == 0);
+        CHECK(record.systemtime == 1.5);
+        CHECK(record.networktime == 2.5);
+        CHECK(record.message == "hello");
+        CHECK(record.filename.empty());
+        CHECK(record.component.empty());
+    }
+
+    SECTION("checking a record with all the fields")
+    {
+        std::string buffer;
+        LogRecord::encode(buffer, Log::ErrorType, 1.0, 2.0, "file.cpp", 42, "func", "host", 1234, "cmd", "--arg \"x\"", 0x1234567, "comp", "a \"quoted\" message", "bt");
+
+        LogRecord record;
+        REQUIRE(record.decode(buffer.data(), buffer.size()));
+        CHECK(record.type == Log::ErrorType);
+        CHECK(record.filename == "file.cpp");
+        CHECK(record.line == 42);
+        CHECK(record.function == "func");
+        CHECK(record.hostname == "host");
+        CHECK(record.pid == 1234);
+        CHECK(record.cmd == "cmd");
+        CHECK(record.args == "--arg \"x\"");
+        CHECK(record.thread_id == 0x1234567);
+        CHECK(record.component == "comp");
+        CHECK(record.message == "a \"quoted\" message");
+        CHECK(record.backtrace == "bt");
+
+        // encoding again gives the same bytes
+        std::string again;
+        record.encode(again);
+        CHECK(again == buffer);
+    }
+
+    SECTION("checking the textual format")
+    {
+        std::string buffer;
+        LogRecord::encode(buffer, Log::WarningType, 1.0, 2.0, "file.cpp", 42, "func", nullptr, 0, nullptr, nullptr, 0, "comp", "a \"quoted\" message", nullptr);
+
+        LogRecord record;
+        REQUIRE(record.decode(buffer.data(), buffer.size()));
+        Property p(record.toString().c_str());
+        CHECK(p.find("level").asString() == "WARNING");
+        CHECK(p.find("systemtime").asFloat64() == 1.0);
+        CHECK(p.find("networktime").asFloat64() == 2.0);
+        CHECK(p.find("filename").asString() == "file.cpp");
+        CHECK(p.find("line").asInt32() == 42);
+        CHECK(p.find("function").asString() == "func");
+        CHECK(p.find("component").asString() == "comp");
+        CHECK(p.find("message").asString() == "a \"quoted\" message");
+        CHECK_FALSE(p.check("hostname"));
+        CHECK_FALSE(p.check("pid"));
+        CHECK_FALSE(p.check("backtrace"));
+    }
+
+    SECTION("checking invalid records are refused")
+    {
+        std::string buffer;
+        LogRecord::encode(buffer, Log::DebugType, 1.0, 2.0, "file.cpp", 42, "func", nullptr, 0, nullptr, nullptr, 0, nullptr, "message", nullptr);
+
+        LogRecord record;
+        CHECK_FALSE(record.decode(buffer.data(), 0));
+        CHECK_FALSE(record.decode(buffer.data(), buffer.size() - 1));
+
+        std::string wrongVersion = buffer;
+        wrongVersion[0] = 99;
+        CHECK_FALSE(record.decode(wrongVersion.data(), wrongVersion.size()));
+
+        std::string wrongLevel = buffer;
+        wrongLevel[1] = 42;
+        CHECK_FALSE(record.decode(wrongLevel.data(), wrongLevel.size()));
+    }
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <yarp/os/impl/NameCache.h>
+
+#include <yarp/os/Bottle.h>
+#include <yarp/os/DummyConnector.h>
+#include <yarp/os/SystemClock.h>
+#include <yarp/os/Vocab.h>
+
+#include <catch.hpp>
+#include <harness.h>
+
+using namespace yarp::os;
+using namespace yarp::os::impl;
+
+TEST_CASE("os::impl::NameCacheTest", "[yarp::os][yarp::os::impl]")
+{
+    SECTION("checking the cache is disabled by default")
+    {
+        NameCache cache;
+        cache.setTtl(0, 1);
+        CHECK_FALSE(cache.isEnabled());
+        Contact contact;
+        cache.store("/foo", Contact("/foo", "tcp", "127.0.0.1", 10002), cache.getEpoch());
+        CHECK_FALSE(cache.lookup("/foo", contact));
+    }
+
+    SECTION("checking cacheable names")
+    {
+        CHECK(NameCache::isCacheable("/foo"));
+        CHECK(NameCache::isCacheable("/foo/bar"));
+        CHECK_FALSE(NameCache::isCacheable(""));
+        CHECK_FALSE(NameCache::isCacheable("foo"));
+        CHECK_FALSE(NameCache::isCacheable("/net=192.168/foo"));
+    }
+
+    SECTION("checking positive and negative entries")
+    {
+        NameCache cache;
+        cache.setTtl(60, 60);
+        CHECK(cache.isEnabled());
+
+        Contact contact;
+        CHECK_FALSE(cache.lookup("/foo", contact));
+        cache.store("/foo", Contact("/foo", "tcp", "127.0.0.1", 10002), cache.getEpoch());
+        REQUIRE(cache.lookup("/foo", contact));
+        CHECK(contact.isValid());
+        CHECK(contact.getPort() == 10002);
+
+        cache.store("/bar", Contact(), cache.getEpoch());
+        contact = Contact("/x", "tcp", "127.0.0.1", 1);
+        REQUIRE(cache.lookup("/bar", contact));
+        CHECK_FALSE(contact.isValid());
+
+        cache.invalidate("/foo");
+        CHECK_FALSE(cache.lookup("/foo", contact));
+        REQUIRE(cache.lookup("/bar", contact));
+
+        cache.clear();
+        CHECK_FALSE(cache.lookup("/bar", contact));
+    }
+
+    SECTION("checking entries expire")
+    {
+        NameCache cache;
+        cache.setTtl(60, 0.05);
+        Contact contact;
+        cache.store("/foo", Contact("/foo", "tcp", "127.0.0.1", 10002), cache.getEpoch());
+        cache.store("/bar", Contact(), cache.getEpoch());
+        CHECK(cache.lookup("/bar", contact));
+        SystemClock::delaySystem(0.1);
+        CHECK_FALSE(cache.lookup("/bar", contact));
+        CHECK(cache.lookup("/foo", contact));
+    }
+
+    SECTION("checking replies older than an invalidation are dropped")
+    {
+        NameCache cache;
+        cache.setTtl(60, 60);
+        std::uint64_t epoch = cache.getEpoch();
+        cache.invalidate("/other");
+        cache.store("/foo", Contact("/foo", "tcp", "127.0.0.1", 10002), epoch);
+        Contact contact;
+        CHECK_FALSE(cache.lookup("/foo", contact));
+    }
+
+    SECTION("checking the events of the name server")
+    {
+        NameCache cache;
+        cache.setTtl(60, 60);
+        cache.store("/foo", Contact("/foo", "tcp", "127.0.0.1", 10002), cache.getEpoch());
+        cache.store("/bar", Contact(), cache.getEpoch());
+
+        Bottle del;
+        del.addVocab(createVocab('d', 'e', 'l'));
+        del.addString("/foo");
+        DummyConnector con;
+        del.write(con.getWriter());
+        CHECK(cache.read(con.getReader()));
+
+        Bottle add;
+        add.addVocab(createVocab('a', 'd', 'd'));
+        add.addString("/bar");
+        DummyConnector con2;
+        add.write(con2.getWriter());
+        CHECK(cache.read(con2.getReader()));
+
+        Contact contact;
+        CHECK_FALSE(cache.lookup("/foo", contact));
+        CHECK_FALSE(cache.lookup("/bar", contact));
+    }
+}
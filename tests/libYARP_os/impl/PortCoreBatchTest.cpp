@@ -0,0 +1,277 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <yarp/os/impl/PortCoreBatch.h>
+
+#include <yarp/os/Bottle.h>
+#include <yarp/os/BufferedPort.h>
+#include <yarp/os/NetInt32.h>
+#include <yarp/os/Network.h>
+#include <yarp/os/Stamp.h>
+#include <yarp/os/StringInputStream.h>
+#include <yarp/os/impl/BufferedConnectionWriter.h>
+#include <yarp/os/impl/StreamConnectionReader.h>
+
+#include <cstring>
+#include <string>
+#include <thread>
+
+#if defined(__linux__)
+#    include <arpa/inet.h>
+#    include <netinet/in.h>
+#    include <sys/socket.h>
+#    include <sys/time.h>
+#    include <unistd.h>
+#endif
+
+#include <catch.hpp>
+#include <harness.h>
+
+using namespace yarp::os;
+using namespace yarp::os::impl;
+
+namespace {
+
+void checkBatching(const std::string& carrier, size_t messages, double delay, bool envelopes = true)
+{
+    INFO("carrier " << carrier << ", batches of " << messages << " messages");
+
+    BufferedPort<Bottle> in;
+    BufferedPort<Bottle> out;
+    in.setStrict();
+    out.setBatching(messages, delay);
+    REQUIRE(in.open("/in"));
+    REQUIRE(out.open("/out"));
+    REQUIRE(Network::connect("/out", "/in", carrier));
+    Network::sync("/in");
+    Network::sync("/out");
+
+    // more than a batch, and not a multiple of it
+    const int count = 10;
+    for (int i = 0; i < count; i++) {
+        Bottle& msg = out.prepare();
+        msg.clear();
+        msg.addInt32(i);
+        Stamp stamp(i, 100.0 + i);
+        out.setEnvelope(stamp);
+        out.write();
+    }
+    // the last messages are sent by the delay, or by waitForWrite
+    out.waitForWrite();
+
+    for (int i = 0; i < count; i++) {
+        Bottle* msg = in.read();
+        REQUIRE(msg != nullptr);
+        CHECK(msg->get(0).asInt32() == i);
+        if (envelopes) {
+            Stamp stamp;
+            CHECK(in.getEnvelope(stamp));
+            CHECK(stamp.getCount() == i);
+            CHECK(stamp.getTime() == Approx(100.0 + i));
+        }
+    }
+
+    out.close();
+    in.close();
+}
+
+#if defined(__linux__)
+// A receiver of an older version of YARP: it replies to the header of a
+// connection with its port number alone, and counts the port commands of
+// the messages received
+class OldReceiver
+{
+public:
+    int port {0};
+    int messages {0};
+    int batches {0};
+
+    bool open()
+    {
+        listener = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(addr);
+        if (bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0
+            || listen(listener, 1) != 0
+            || getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+            return false;
+        }
+        port = ntohs(addr.sin_port);
+        handshake = std::thread([this]() { accept(); });
+        return true;
+    }
+
+    // reads until the expected messages arrive, or for a few seconds
+    void receive(int expected)
+    {
+        handshake.join();
+        if (fd < 0) {
+            return;
+        }
+        timeval timeout {0, 100000};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        std::string data;
+        char buf[1024];
+        for (int i = 0; i < 50 && messages < expected; i++) {
+            ssize_t len = recv(fd, buf, sizeof(buf), 0);
+            if (len > 0) {
+                data.append(buf, static_cast<size_t>(len));
+            }
+            messages = count(data, std::string("~d\0\1", 4)) + count(data, std::string("~D\0\1", 4));
+            batches = count(data, std::string("~b\0\1", 4));
+        }
+    }
+
+    ~OldReceiver()
+    {
+        if (handshake.joinable()) {
+            handshake.join();
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+        if (listener >= 0) {
+            close(listener);
+        }
+    }
+
+private:
+    int listener {-1};
+    int fd {-1};
+    std::thread handshake;
+
+    void accept()
+    {
+        fd = ::accept(listener, nullptr, nullptr);
+        if (fd < 0) {
+            return;
+        }
+        // the header, the name of the sender, then the reply
+        char header[8];
+        NetInt32 len = 0;
+        std::string name;
+        if (recv(fd, header, sizeof(header), MSG_WAITALL) != sizeof(header)
+            || recv(fd, &len, sizeof(len), MSG_WAITALL) != sizeof(len)) {
+            return;
+        }
+        name.resize(static_cast<size_t>(len));
+        recv(fd, &name[0], name.size(), MSG_WAITALL);
+        char reply[8] = {'Y', 'A', 0, 0, 0, 0, 'R', 'P'};
+        NetInt32 number = port;
+        std::memcpy(reply + 2, &number, sizeof(number));
+        send(fd, reply, sizeof(reply), 0);
+    }
+
+    static int count(const std::string& data, const std::string& pattern)
+    {
+        int n = 0;
+        for (size_t at = data.find(pattern); at != std::string::npos; at = data.find(pattern, at + 1)) {
+            n++;
+        }
+        return n;
+    }
+};
+#endif
+
+} // namespace
+
+TEST_CASE("os::impl::PortCoreBatchTest", "[yarp::os][yarp::os::impl]")
+{
+    NetworkBase::setLocalMode(true);
+
+    SECTION("checking batches over connections that carry them")
+    {
+        checkBatching("tcp", 4, 0.01);
+        checkBatching("tcp", 4, 0.0);
+        checkBatching("fast_tcp", 3, 0.01);
+    }
+
+    SECTION("checking batches over connections that do not carry them")
+    {
+        checkBatching("text", 4, 0.01);
+        // the local carrier does not carry the envelopes
+        checkBatching("local", 4, 0.0, false);
+    }
+
+#if defined(__linux__)
+    SECTION("checking batches to receivers that do not accept them")
+    {
+        OldReceiver old;
+        REQUIRE(old.open());
+        REQUIRE(Network::registerContact(Contact("/old", "tcp", "127.0.0.1", old.port)).isValid());
+
+        BufferedPort<Bottle> out;
+        out.setBatching(4, 0.01);
+        REQUIRE(out.open("/out"));
+        REQUIRE(Network::connect("/out", "/old", "fast_tcp"));
+
+        const int count = 10;
+        for (int i = 0; i < count; i++) {
+            Bottle& msg = out.prepare();
+            msg.clear();
+            msg.addInt32(i);
+            out.write();
+        }
+        out.waitForWrite();
+
+        // the messages are sent one by one
+        old.receive(count);
+        CHECK(old.messages == count);
+        CHECK(old.batches == 0);
+
+        out.close();
+        Network::unregisterName("/old");
+    }
+#endif
+
+    SECTION("checking that a batch is sent after the delay")
+    {
+        BufferedPort<Bottle> in;
+        BufferedPort<Bottle> out;
+        out.setBatching(100, 0.01);
+        REQUIRE(in.open("/in"));
+        REQUIRE(out.open("/out"));
+        REQUIRE(Network::connect("/out", "/in"));
+        Network::sync("/in");
+        Network::sync("/out");
+
+        Bottle& msg = out.prepare();
+        msg.clear();
+        msg.addString("alone");
+        out.write();
+
+        Bottle* received = in.read();
+        REQUIRE(received != nullptr);
+        CHECK(received->get(0).asString() == "alone");
+
+        out.close();
+        in.close();
+    }
+
+    SECTION("checking a malformed batch")
+    {
+        // a message longer than the batch
+        BufferedConnectionWriter writer;
+        writer.appendInt32(1);
+        writer.appendInt32(0);
+        writer.appendInt32(1000);
+        std::string data = writer.toString();
+        StringInputStream sis;
+        sis.reset(data);
+        StreamConnectionReader reader;
+        Route route("/out", "/in", "tcp");
+        reader.reset(sis, nullptr, route, data.size(), false);
+        int delivered = 0;
+        CHECK_FALSE(PortCoreBatch::read(reader, route, [&](const std::string&, ConnectionReader&) { delivered++; }));
+        CHECK(delivered == 0);
+    }
+
+    NetworkBase::setLocalMode(false);
+}
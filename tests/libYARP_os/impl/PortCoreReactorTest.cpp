@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <yarp/os/impl/PortCoreReactor.h>
+
+#include <yarp/os/Bottle.h>
+#include <yarp/os/BufferedPort.h>
+#include <yarp/os/Contact.h>
+#include <yarp/os/NetInt32.h>
+#include <yarp/os/Network.h>
+#include <yarp/os/Port.h>
+#include <yarp/os/Time.h>
+
+#include <cstring>
+#include <string>
+
+#if defined(__linux__)
+#    include <arpa/inet.h>
+#    include <netinet/in.h>
+#    include <sys/socket.h>
+#    include <unistd.h>
+#endif
+
+#include <catch.hpp>
+#include <harness.h>
+
+using namespace yarp::os;
+using namespace yarp::os::impl;
+
+namespace {
+bool waitForConnectionCount(size_t count)
+{
+    for (int i = 0; i < 500; i++) {
+        if (PortCoreReactor::getConnectionCount() == count) {
+            return true;
+        }
+        Time::delay(0.01);
+    }
+    return false;
+}
+
+#if defined(__linux__)
+// Open a tcp connection to a port by hand, so that the test can send
+// incomplete messages
+int connectRaw(const Contact& contact, const std::string& name)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(contact.getPort()));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    // tcp carrier header (7777 + 3 + 128), sender name, then the reply
+    char header[8] = {'Y', 'A', 0, 0, 0, 0, 'R', 'P'};
+    NetInt32 code = 7777 + 3 + 128;
+    std::memcpy(header + 2, &code, sizeof(code));
+    NetInt32 len = static_cast<NetInt32>(name.length() + 1);
+    if (send(fd, header, sizeof(header), 0) != sizeof(header)
+        || send(fd, &len, sizeof(len), 0) != sizeof(len)
+        || send(fd, name.c_str(), name.length() + 1, 0) != static_cast<ssize_t>(name.length() + 1)
+        || recv(fd, header, sizeof(header), MSG_WAITALL) != sizeof(header)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+#endif
+} // namespace
+
+TEST_CASE("os::impl::PortCoreReactorTest", "[yarp::os][yarp::os::impl]")
+{
+#if !defined(__linux__)
+    YARP_SKIP_TEST("The input reactor is available on Linux only")
+#endif
+
+    NetworkBase::setLocalMode(true);
+    NetworkBase::setEnvironment("YARP_PORT_INPUT_THREADS", "2");
+
+    SECTION("messages from several connections reach a buffered port")
+    {
+        constexpr int senders = 5;
+        constexpr int messages = 50;
+
+        BufferedPort<Bottle> in;
+        in.setStrict();
+        REQUIRE(in.open("/reactor/in"));
+
+        Port out[senders];
+        for (int i = 0; i < senders; i++) {
+            REQUIRE(out[i].open("/reactor/out" + std::to_string(i)));
+            REQUIRE(Network::connect(out[i].getName(), "/reactor/in", "tcp"));
+        }
+        CHECK(waitForConnectionCount(senders)); // no thread per connection
+
+        for (int k = 0; k < messages; k++) {
+            for (int i = 0; i < senders; i++) {
+                Bottle b;
+                b.addInt32(i);
+                b.addInt32(k);
+                out[i].write(b);
+            }
+        }
+
+        int next[senders] = {0};
+        for (int n = 0; n < senders * messages; n++) {
+            Bottle* b = in.read();
+            REQUIRE(b != nullptr);
+            int i = b->get(0).asInt32();
+            REQUIRE(i >= 0);
+            REQUIRE(i < senders);
+            CHECK(b->get(1).asInt32() == next[i]); // in order
+            next[i]++;
+        }
+
+        for (auto& port : out) {
+            port.close();
+        }
+        CHECK(waitForConnectionCount(0)); // connections removed
+        in.close();
+    }
+
+    SECTION("closing a port served by the reactor")
+    {
+        BufferedPort<Bottle> in;
+        REQUIRE(in.open("/reactor/in"));
+        Port out;
+        REQUIRE(out.open("/reactor/out"));
+        REQUIRE(Network::connect("/reactor/out", "/reactor/in", "tcp"));
+        CHECK(waitForConnectionCount(1));
+
+        Bottle b("1 2 3");
+        out.write(b);
+        Bottle* r = in.read();
+        REQUIRE(r != nullptr);
+        CHECK(r->toString() == "1 2 3");
+
+        in.close();
+        CHECK(PortCoreReactor::getConnectionCount() == 0); // released on close
+        out.close();
+    }
+
+    SECTION("ports that wait for the user keep their threads")
+    {
+        Port in;
+        REQUIRE(in.open("/reactor/in"));
+        Port out;
+        REQUIRE(out.open("/reactor/out"));
+        REQUIRE(Network::connect("/reactor/out", "/reactor/in", "tcp"));
+        CHECK(PortCoreReactor::getConnectionCount() == 0);
+        out.close();
+        in.close();
+    }
+
+    SECTION("ports that run user code keep their threads")
+    {
+        class Replier : public PortReader
+        {
+        public:
+            bool read(ConnectionReader& connection) override
+            {
+                Bottle b;
+                return b.read(connection);
+            }
+        } replier;
+
+        // e.g. an RpcServer
+        Port server;
+        server.setReader(replier);
+        REQUIRE(server.open("/reactor/server"));
+
+        // a BufferedPort that replies through the user's reader
+        BufferedPort<Bottle> in;
+        in.setReplier(replier);
+        REQUIRE(in.open("/reactor/in"));
+
+        Port out;
+        REQUIRE(out.open("/reactor/out"));
+        REQUIRE(Network::connect("/reactor/out", "/reactor/server", "tcp"));
+        REQUIRE(Network::connect("/reactor/out", "/reactor/in", "tcp"));
+        Time::delay(0.2);
+        CHECK(PortCoreReactor::getConnectionCount() == 0);
+        out.close();
+        in.close();
+        server.close();
+    }
+
+#if defined(__linux__)
+    SECTION("incomplete messages do not hold the workers")
+    {
+        BufferedPort<Bottle> in;
+        in.setStrict();
+        REQUIRE(in.open("/reactor/in"));
+
+        // More stalled connections than workers, each with the beginning
+        // of a message only
+        constexpr int stalled = 4;
+        int fds[stalled];
+        for (int i = 0; i < stalled; i++) {
+            fds[i] = connectRaw(in.where(), "/reactor/raw" + std::to_string(i));
+            REQUIRE(fds[i] >= 0);
+        }
+        CHECK(waitForConnectionCount(stalled));
+        for (int fd : fds) {
+            CHECK(send(fd, "YA", 2, 0) == 2);
+        }
+
+        Port out;
+        REQUIRE(out.open("/reactor/out"));
+        REQUIRE(Network::connect("/reactor/out", "/reactor/in", "tcp"));
+        CHECK(waitForConnectionCount(stalled + 1));
+        Bottle b("1 2 3");
+        out.write(b);
+        bool received = false;
+        for (int i = 0; i < 500 && !received; i++) {
+            received = (in.getPendingReads() > 0);
+            Time::delay(0.01);
+        }
+        CHECK(received); // served while the others are incomplete
+        if (received) {
+            Bottle* r = in.read();
+            REQUIRE(r != nullptr);
+            CHECK(r->toString() == "1 2 3");
+        }
+
+        for (int fd : fds) {
+            close(fd);
+        }
+        out.close();
+        CHECK(waitForConnectionCount(0)); // connections removed
+        in.close();
+    }
+#endif
+
+    NetworkBase::unsetEnvironment("YARP_PORT_INPUT_THREADS");
+    NetworkBase::setLocalMode(false);
+}
@@ -20,6 +20,17 @@
 using namespace yarp::os;
 using namespace yarp::os::impl;
 
+class CountingWriter : public PortWriter {
+public:
+    Bottle bot;
+    int writes{0};
+
+    bool write(ConnectionWriter& connection) const override {
+        const_cast<CountingWriter*>(this)->writes++;
+        return bot.write(connection);
+    }
+};
+
 class PortCoreTest : public PortReader {
 public:
     int safePort() { return Network::getDefaultPortRange()+100; }
@@ -162,6 +173,54 @@ public:
         sender.close();
         receiver.close();
     }
+
+
+    void testSharedSerialization() {
+        expectation = "";
+        receives = 0;
+
+        Contact write = NetworkBase::registerContact(Contact("/write", "tcp", "127.0.0.1", safePort()));
+        Contact read1 = NetworkBase::registerContact(Contact("/read1", "tcp", "127.0.0.1", safePort()+1));
+        Contact read2 = NetworkBase::registerContact(Contact("/read2", "tcp", "127.0.0.1", safePort()+2));
+        Contact read3 = NetworkBase::registerContact(Contact("/read3", "tcp", "127.0.0.1", safePort()+3));
+
+        PortCore sender;
+        PortCore receiver1;
+        PortCore receiver2;
+        PortCore receiver3;
+        receiver1.setReadHandler(*this);
+        receiver2.setReadHandler(*this);
+        receiver3.setReadHandler(*this);
+        sender.listen(write);
+        receiver1.listen(read1);
+        receiver2.listen(read2);
+        receiver3.listen(read3);
+        sender.start();
+        receiver1.start();
+        receiver2.start();
+        receiver3.start();
+        NetworkBase::connect("/write", "/read1");
+        NetworkBase::connect("/write", "/read2");
+        NetworkBase::connect("/write", "/read3", "text");
+        Time::delay(0.3);
+
+        CountingWriter writer;
+        writer.bot.addInt32(0);
+        writer.bot.addString("Hello world");
+        expectation = writer.bot.toString();
+        sender.send(writer);
+        for (int i=0; i<1000; i++) {
+            if (receives==3) break;
+            Time::delay(0.3);
+        }
+        CHECK(receives == 3); // "received on all connections"
+        // one serialization shared by the two tcp connections, one for text
+        CHECK(writer.writes == 2);
+        sender.close();
+        receiver1.close();
+        receiver2.close();
+        receiver3.close();
+    }
 };
 
 TEST_CASE("os::impl::PortCoreTest", "[yarp::os][yarp::os::impl]")
@@ -184,5 +243,10 @@ TEST_CASE("os::impl::PortCoreTest", "[yarp::os][yarp::os::impl]")
         thePortCoreTest.testBackground();
     }
 
+    SECTION("shared serialization across connections check")
+    {
+        thePortCoreTest.testSharedSerialization();
+    }
+
     Network::setLocalMode(false);
 }
@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <yarp/os/impl/PortStatistics.h>
+
+#include <yarp/os/Bottle.h>
+#include <yarp/os/BufferedPort.h>
+#include <yarp/os/Network.h>
+#include <yarp/os/Port.h>
+#include <yarp/os/Property.h>
+
+#include <catch.hpp>
+#include <harness.h>
+
+using namespace yarp::os;
+using namespace yarp::os::impl;
+
+TEST_CASE("os::impl::PortStatisticsTest", "[yarp::os][yarp::os::impl]")
+{
+    SECTION("checking latency histogram")
+    {
+        LatencyHistogram histogram;
+        CHECK(histogram.count() == 0);
+        CHECK(histogram.percentile(0.5) == 0.0);
+
+        // 1, 2, ..., 1000 microseconds
+        for (int i = 1; i <= 1000; i++) {
+            histogram.record(std::chrono::microseconds(i));
+        }
+        CHECK(histogram.count() == 1000);
+        CHECK(histogram.max() == Approx(1e-3));
+        // within the resolution of the buckets (1/16)
+        CHECK(histogram.percentile(0.5) == Approx(500e-6).epsilon(1.0 / 16));
+        CHECK(histogram.percentile(0.9) == Approx(900e-6).epsilon(1.0 / 16));
+        CHECK(histogram.percentile(0.99) == Approx(990e-6).epsilon(1.0 / 16));
+        CHECK(histogram.percentile(1.0) <= histogram.max());
+
+        Property stats;
+        histogram.report(stats);
+        CHECK(stats.find("count").asInt64() == 1000);
+        CHECK(stats.find("mean").asFloat64() == Approx(500.5e-6));
+        CHECK(stats.find("p999").asFloat64() <= 1e-3);
+    }
+
+    SECTION("checking very short and very long durations")
+    {
+        LatencyHistogram histogram;
+        histogram.record(std::chrono::nanoseconds(0));
+        histogram.record(std::chrono::nanoseconds(3));
+        histogram.record(std::chrono::hours(2));
+        CHECK(histogram.count() == 3);
+        CHECK(histogram.percentile(0.3) == 0.0);
+        CHECK(histogram.percentile(0.5) == Approx(3e-9));
+        CHECK(histogram.max() == Approx(7200.0));
+        CHECK(histogram.percentile(1.0) <= histogram.max());
+    }
+
+    SECTION("checking port statistics over the admin interface")
+    {
+        NetworkBase::setLocalMode(true);
+
+        BufferedPort<Bottle> in;
+        Port out;
+        in.setStrict();
+        REQUIRE(in.open("/in"));
+        REQUIRE(out.open("/out"));
+        REQUIRE(Network::connect("/out", "/in"));
+        Network::sync("/in");
+        Network::sync("/out");
+
+        const int messages = 5;
+        for (int i = 0; i < messages; i++) {
+            Bottle msg;
+            msg.addInt32(i);
+            out.write(msg);
+        }
+        for (int i = 0; i < messages; i++) {
+            CHECK(in.read() != nullptr);
+        }
+
+        Bottle cmd("prop get stats");
+        Bottle reply;
+        Port admin;
+        REQUIRE(admin.open("/admin"));
+        REQUIRE(Network::connect("/admin", "/out"));
+        admin.setAdminMode();
+        REQUIRE(admin.write(cmd, reply));
+        INFO(reply.toString());
+
+        CHECK(reply.findGroup("port").get(1).find("in_flight").asInt32() == 0);
+        Bottle* outs = reply.findGroup("out").get(1).asList();
+        REQUIRE(outs != nullptr);
+        CHECK(outs->get(0).asString() == "/in");
+        Searchable& sent = outs->get(1);
+        CHECK(sent.find("messages").asInt64() == messages);
+        CHECK(sent.find("bytes").asInt64() > 0);
+        CHECK(sent.find("errors").asInt64() == 0);
+        CHECK(sent.findGroup("time").find("count").asInt64() == messages);
+
+        REQUIRE(Network::disconnect("/admin", "/out"));
+        REQUIRE(Network::connect("/admin", "/in"));
+        admin.setAdminMode();
+        reply.clear();
+        REQUIRE(admin.write(cmd, reply));
+        INFO(reply.toString());
+
+        Searchable& buffer = reply.findGroup("buffer").get(1);
+        CHECK(buffer.find("received").asInt64() == messages);
+        CHECK(buffer.find("dropped").asInt64() == 0);
+        CHECK(buffer.find("depth").asInt32() == 0);
+        CHECK(buffer.find("max_depth").asInt32() >= 1);
+        bool found = false;
+        Bottle& ins = reply.findGroup("in");
+        for (size_t i = 1; i < ins.size(); i++) {
+            Bottle* connection = ins.get(i).asList();
+            REQUIRE(connection != nullptr);
+            if (connection->get(0).asString() == "/out") {
+                found = true;
+                CHECK(connection->get(1).find("messages").asInt64() == messages);
+            }
+        }
+        CHECK(found);
+
+        admin.close();
+        out.close();
+        in.close();
+
+        NetworkBase::setLocalMode(false);
+    }
+
+    SECTION("checking dropped messages")
+    {
+        NetworkBase::setLocalMode(true);
+
+        BufferedPort<Bottle> in;
+        Port out;
+        REQUIRE(in.open("/in"));
+        REQUIRE(out.open("/out"));
+        REQUIRE(Network::connect("/out", "/in"));
+        Network::sync("/in");
+        Network::sync("/out");
+
+        // not strict, only the most recent message is kept
+        const int messages = 5;
+        for (int i = 0; i < messages; i++) {
+            Bottle msg;
+            msg.addInt32(i);
+            out.write(msg);
+        }
+        Network::sync("/in");
+
+        Bottle cmd("prop get stats");
+        Bottle reply;
+        Port admin;
+        REQUIRE(admin.open("/admin"));
+        REQUIRE(Network::connect("/admin", "/in"));
+        admin.setAdminMode();
+        REQUIRE(admin.write(cmd, reply));
+        INFO(reply.toString());
+
+        Searchable& buffer = reply.findGroup("buffer").get(1);
+        CHECK(buffer.find("received").asInt64() == messages);
+        CHECK(buffer.find("dropped").asInt64() == messages - 1);
+        CHECK(buffer.find("depth").asInt32() == 1);
+
+        admin.close();
+        out.close();
+        in.close();
+
+        NetworkBase::setLocalMode(false);
+    }
+}
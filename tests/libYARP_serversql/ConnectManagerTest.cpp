@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <yarp/serversql/impl/ConnectManager.h>
+
+#include <yarp/os/Network.h>
+#include <yarp/os/Port.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <catch.hpp>
+#include <harness.h>
+
+using namespace yarp::os;
+using namespace yarp::serversql::impl;
+
+namespace {
+
+// Records the requests instead of connecting the ports, and can hold the
+// workers until released.
+class RecordingConnectManager : public ConnectManager
+{
+public:
+    struct Batch
+    {
+        std::string port;
+        std::vector<Request> requests;
+    };
+
+    std::mutex mutex;
+    std::condition_variable released;
+    bool hold {false};
+    size_t running {0};
+    size_t maxRunning {0};
+    std::vector<Batch> batches;
+
+    explicit RecordingConnectManager(size_t maxWorkers) :
+            ConnectManager(maxWorkers)
+    {
+    }
+
+    ~RecordingConnectManager() override
+    {
+        release();
+        clear();
+    }
+
+    void release()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        hold = false;
+        released.notify_all();
+    }
+
+protected:
+    void apply(const std::string& port, const std::vector<Request>& requests) override
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        batches.push_back({port, requests});
+        running++;
+        maxRunning = std::max(maxRunning, running);
+        released.wait(lock, [this]() { return !hold; });
+        running--;
+    }
+};
+
+} // namespace
+
+TEST_CASE("serversql::ConnectManagerTest", "[yarp::serversql]")
+{
+    SECTION("requests of the same source port are served together")
+    {
+        RecordingConnectManager manager(4);
+        manager.hold = true;
+        manager.connect("/src", "/dest0");
+        // wait for the first batch to be taken by a worker
+        while (true) {
+            std::lock_guard<std::mutex> lock(manager.mutex);
+            if (manager.running == 1) {
+                break;
+            }
+        }
+        manager.connect("/src", "/dest1");
+        manager.connect("/src", "/dest2");
+        manager.connect("/src", "/dest1", false);
+        manager.connect("tcp://src", "/dest3");
+        manager.release();
+        manager.wait();
+
+        std::lock_guard<std::mutex> lock(manager.mutex);
+        REQUIRE(manager.batches.size() == 2);
+        CHECK(manager.batches[0].port == "/src");
+        CHECK(manager.batches[0].requests.size() == 1);
+        CHECK(manager.batches[1].port == "/src");
+        REQUIRE(manager.batches[1].requests.size() == 3);
+        CHECK(manager.batches[1].requests[0].dest == "/dest1");
+        CHECK_FALSE(manager.batches[1].requests[0].positive);
+        CHECK(manager.batches[1].requests[1].dest == "/dest2");
+        CHECK(manager.batches[1].requests[1].positive);
+        CHECK(manager.batches[1].requests[2].src == "tcp://src");
+        // a source port is served by one worker at a time
+        CHECK(manager.maxRunning == 1);
+    }
+
+    SECTION("the number of workers is bounded")
+    {
+        RecordingConnectManager manager(2);
+        manager.hold = true;
+        for (int i = 0; i < 8; i++) {
+            manager.connect("/src" + std::to_string(i), "/dest");
+        }
+        while (true) {
+            std::lock_guard<std::mutex> lock(manager.mutex);
+            if (manager.running == 2) {
+                break;
+            }
+        }
+        manager.release();
+        manager.wait();
+
+        std::lock_guard<std::mutex> lock(manager.mutex);
+        CHECK(manager.batches.size() == 8);
+        CHECK(manager.maxRunning == 2);
+    }
+
+    SECTION("the connections of a source port are made")
+    {
+        Network::setLocalMode(true);
+        Port src;
+        Port dest[4];
+        REQUIRE(src.open("/src"));
+        for (int i = 0; i < 4; i++) {
+            REQUIRE(dest[i].open("/dest" + std::to_string(i)));
+        }
+        ConnectManager manager(1);
+        manager.connect("/src", "/dest0");
+        manager.connect("/src", "/dest1");
+        manager.connect("/src", "/dest2");
+        manager.wait();
+        CHECK(Network::isConnected("/src", "/dest0"));
+        CHECK(Network::isConnected("/src", "/dest1"));
+        CHECK(Network::isConnected("/src", "/dest2"));
+
+        // the other carriers are left to Network::connect()
+        manager.connect("/src", "udp://dest3");
+        manager.connect("/src", "/dest1", false);
+        manager.wait();
+        CHECK(Network::isConnected("/src", "udp://dest3"));
+        CHECK_FALSE(Network::isConnected("/src", "/dest1"));
+        CHECK(Network::isConnected("/src", "/dest2"));
+
+        manager.clear();
+        src.close();
+        for (auto& port : dest) {
+            port.close();
+        }
+        Network::setLocalMode(false);
+    }
+}
@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include <yarp/serversql/impl/Triple.h>
+#include <yarp/serversql/impl/TripleSource.h>
+#include <yarp/serversql/impl/TripleSourceCreator.h>
+
+#include <cstdio>
+#include <list>
+#include <string>
+
+#include <catch.hpp>
+#include <harness.h>
+
+using namespace yarp::serversql::impl;
+
+namespace {
+
+const char* dbFilename = "_yarp_triple_source_test.db";
+
+// Register a port as the name server does
+int registerPort(TripleSource& db, const std::string& name, int socket)
+{
+    Triple t;
+    t.setNameValue("port", name.c_str());
+    db.remove_query(t, nullptr);
+    db.insert(t, nullptr);
+    int id = db.find(t, nullptr);
+    TripleContext context;
+    context.setRid(id);
+    t.setNameValue("host", "localhost");
+    db.update(t, &context);
+    t.setNameValue("socket", std::to_string(socket).c_str());
+    db.update(t, &context);
+    t.setNameValue("ips", "127.0.0.1");
+    db.insert(t, &context);
+    t.setNameValue("ips", "10.0.0.1");
+    db.insert(t, &context);
+    return id;
+}
+
+std::string lookup(TripleSource& db, const std::string& name, const char* property)
+{
+    Triple t;
+    t.setNameValue("port", name.c_str());
+    TripleContext context;
+    context.setRid(db.find(t, nullptr));
+    if (context.rid == -1) {
+        return "";
+    }
+    t.setNameValue(property, "*");
+    std::list<Triple> lst = db.query(t, &context);
+    return lst.empty() ? "" : lst.begin()->value;
+}
+
+void checkTriples(TripleSource& db)
+{
+    int id1 = registerPort(db, "/a", 10002);
+    int id2 = registerPort(db, "/b", 10003);
+    CHECK(id1 != -1);
+    CHECK(id2 != -1);
+    CHECK(id1 != id2);
+
+    CHECK(lookup(db, "/a", "socket") == "10002");
+    CHECK(lookup(db, "/b", "socket") == "10003");
+    CHECK(lookup(db, "/a", "host") == "localhost");
+    CHECK(lookup(db, "/c", "socket").empty());
+
+    // update an existing value
+    TripleContext context;
+    context.setRid(id1);
+    Triple t;
+    t.setNameValue("socket", "10010");
+    db.update(t, &context);
+    CHECK(lookup(db, "/a", "socket") == "10010");
+    CHECK(lookup(db, "/b", "socket") == "10003");
+
+    // wildcards
+    t.setNameValue("ips", "*");
+    CHECK(db.query(t, &context).size() == 2);
+    t.setNameValue("*", "*");
+    CHECK(db.query(t, &context).size() == 4);
+    t.setNameValue("port", "*");
+    CHECK(db.query(t, nullptr).size() == 2);
+
+    // a namespace
+    t.setNsNameValue("prop", "color", "red");
+    db.update(t, &context);
+    t.setNsNameValue("prop", "color", "*");
+    std::list<Triple> lst = db.query(t, &context);
+    REQUIRE(lst.size() == 1);
+    CHECK(lst.begin()->value == "red");
+    CHECK(lst.begin()->ns == "prop");
+    t.setNameValue("color", "*");
+    CHECK(db.query(t, &context).empty());
+
+    // properties without a value
+    t.reset();
+    t.hasName = true;
+    t.name = "flag";
+    db.insert(t, &context);
+    db.insert(t, &context);
+    db.update(t, &context);
+    CHECK(db.query(t, &context).size() == 2);
+    t.setNameValue("flag", "on");
+    db.update(t, &context);
+    CHECK(lookup(db, "/a", "flag") == "on");
+    t.setNameValue("flag", "*");
+    CHECK(db.query(t, &context).size() == 2);
+    db.remove_query(t, &context);
+    CHECK(db.query(t, &context).empty());
+
+    // the value of the triple of the context
+    t.reset();
+    t.hasValue = true;
+    t.value = "renamed";
+    db.update(t, &context);
+    t.setNameValue("port", "renamed");
+    CHECK(db.find(t, nullptr) == id1);
+    t.reset();
+    t.hasValue = true;
+    t.value = "/a";
+    db.update(t, &context);
+    t.setNameValue("port", "/a");
+    CHECK(db.find(t, nullptr) == id1);
+
+    // remove a port, then its properties
+    t.setNameValue("port", "/b");
+    db.remove_query(t, nullptr);
+    CHECK(db.find(t, nullptr) == -1);
+    db.prune(nullptr);
+    context.setRid(id2);
+    t.setNameValue("*", "*");
+    CHECK(db.query(t, &context).empty());
+    CHECK(lookup(db, "/a", "socket") == "10010");
+
+    // the same port registered again
+    int id3 = registerPort(db, "/a", 10020);
+    CHECK(id3 != id1);
+    db.prune(nullptr);
+    CHECK(lookup(db, "/a", "socket") == "10020");
+    context.setRid(id3);
+    CHECK(db.query(t, &context).size() == 4);
+}
+
+} // namespace
+
+TEST_CASE("serversql::TripleSourceTest", "[yarp::serversql]")
+{
+    SECTION("check triples in memory")
+    {
+        TripleSourceCreator creator;
+        TripleSource* db = creator.open(":memory:");
+        REQUIRE(db != nullptr);
+        checkTriples(*db);
+        creator.close();
+    }
+
+    SECTION("check triples in a database file")
+    {
+        std::remove(dbFilename);
+        {
+            TripleSourceCreator creator;
+            TripleSource* db = creator.open(dbFilename, false, true, true);
+            REQUIRE(db != nullptr);
+            checkTriples(*db);
+            creator.close();
+        }
+
+        // the triples are read back from the file
+        TripleSourceCreator creator;
+        TripleSource* db = creator.open(dbFilename);
+        REQUIRE(db != nullptr);
+        CHECK(lookup(*db, "/a", "socket") == "10020");
+        CHECK(lookup(*db, "/a", "host") == "localhost");
+        CHECK(lookup(*db, "/b", "socket").empty());
+        Triple t;
+        t.setNameValue("port", "*");
+        CHECK(db->query(t, nullptr).size() == 1);
+
+        // new triples do not reuse the ids of the old ones
+        int id = registerPort(*db, "/c", 10030);
+        CHECK(lookup(*db, "/c", "socket") == "10030");
+        CHECK(db->query(t, nullptr).size() == 2);
+        t.setNameValue("port", "/a");
+        CHECK(db->find(t, nullptr) != id);
+        creator.close();
+
+        std::remove(dbFilename);
+        std::remove((std::string(dbFilename) + "-wal").c_str());
+        std::remove((std::string(dbFilename) + "-shm").c_str());
+    }
+}
@@ -19,6 +19,10 @@
 #include <yarp/os/Time.h>
 #include <yarp/os/Log.h>
 #include <yarp/os/PeriodicThread.h>
+#include <yarp/sig/impl/PixelKernels.h>
+
+#include <cstring>
+#include <string>
 
 #include <catch.hpp>
 #include <harness.h>
@@ -67,6 +71,65 @@ void passImage(ImageOf<PixelRgb> img)
     yInfo("passed a blank image ok");
 }
 
+namespace {
+const int convertiblePixelCodes[] = {
+    VOCAB_PIXEL_MONO,
+    VOCAB_PIXEL_MONO16,
+    VOCAB_PIXEL_RGB,
+    VOCAB_PIXEL_RGBA,
+    VOCAB_PIXEL_BGRA,
+    VOCAB_PIXEL_HSV,
+    VOCAB_PIXEL_BGR,
+    VOCAB_PIXEL_MONO_SIGNED,
+    VOCAB_PIXEL_MONO_FLOAT,
+    VOCAB_PIXEL_RGB_FLOAT,
+    VOCAB_PIXEL_INT,
+    VOCAB_PIXEL_RGB_INT
+};
+
+void fillPixels(FlexImage& img, unsigned int seed)
+{
+    bool isFloat = (img.getPixelCode() == VOCAB_PIXEL_MONO_FLOAT ||
+                    img.getPixelCode() == VOCAB_PIXEL_RGB_FLOAT);
+    for (size_t r = 0; r < img.height(); r++) {
+        unsigned char* row = img.getRow(r);
+        size_t len = img.width() * img.getPixelSize();
+        for (size_t i = 0; i < len; i++) {
+            seed = seed * 1103515245 + 12345;
+            row[i] = static_cast<unsigned char>(seed >> 16);
+        }
+        if (isFloat) {
+            // keep the values in the range of the integer types
+            auto* values = reinterpret_cast<float*>(row);
+            for (size_t i = 0; i < len / sizeof(float); i++) {
+                seed = seed * 1103515245 + 12345;
+                values[i] = static_cast<float>((seed >> 16) % 25600) / 100.0f;
+            }
+        }
+    }
+}
+
+void convertPixels(const FlexImage& src, int code, size_t quantum, FlexImage& dest)
+{
+    dest.setPixelCode(code);
+    dest.setQuantum(quantum);
+    dest.copy(src);
+}
+
+bool samePixels(const FlexImage& a, const FlexImage& b)
+{
+    if (a.width() != b.width() || a.height() != b.height() || a.getPixelSize() != b.getPixelSize()) {
+        return false;
+    }
+    for (size_t r = 0; r < a.height(); r++) {
+        if (std::memcmp(a.getRow(r), b.getRow(r), a.width() * a.getPixelSize()) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+} // namespace
+
 TEST_CASE("sig::ImageTest", "[yarp::sig]")
 {
     NetworkBase::setLocalMode(true);
@@ -388,6 +451,87 @@ TEST_CASE("sig::ImageTest", "[yarp::sig]")
         CHECK(img.width() == (size_t) 4); // dimension check
     }
 
+    SECTION("check scaling with interpolation.")
+    {
+        ImageOf<PixelMono> line;
+        line.resize(2,1);
+        line(0,0) = 0;
+        line(1,0) = 100;
+        ImageOf<PixelMono> wide;
+        wide.copy(line, 4, 1, Image::INTERPOLATION_BILINEAR);
+        REQUIRE(wide.width() == (size_t) 4);
+        CHECK(wide(0,0) == 0);
+        CHECK(wide(1,0) == 25);
+        CHECK(wide(2,0) == 75);
+        CHECK(wide(3,0) == 100);
+
+        // the area average of blocks of 2x2 pixels
+        ImageOf<PixelRgb> img;
+        img.resize(4,4);
+        for (size_t x=0; x<img.width(); x++) {
+            for (size_t y=0; y<img.height(); y++) {
+                img(x,y) = PixelRgb(static_cast<unsigned char>(10*x + 2*y), 0, 200);
+            }
+        }
+        ImageOf<PixelRgb> small;
+        small.copy(img, 2, 2, Image::INTERPOLATION_AREA);
+        REQUIRE(small.width() == (size_t) 2);
+        CHECK(small(0,0).r == 6);  // (0 + 2 + 10 + 12) / 4
+        CHECK(small(1,0).r == 26); // (20 + 22 + 30 + 32) / 4
+        CHECK(small(1,1).r == 30); // (24 + 26 + 34 + 36) / 4
+        CHECK(small(1,1).b == 200);
+
+        // the conversion of the pixels is done in the same pass
+        ImageOf<PixelMono> mono;
+        mono.copy(img, 2, 2, Image::INTERPOLATION_AREA);
+        ImageOf<PixelMono> converted;
+        converted.copy(small);
+        for (size_t x=0; x<mono.width(); x++) {
+            for (size_t y=0; y<mono.height(); y++) {
+                CHECK(mono(x,y) == converted(x,y));
+            }
+        }
+
+        // the same result with any number of threads, and the same
+        // result as before for the nearest pixel
+        ImageOf<PixelRgb> big;
+        big.resize(64,48);
+        for (size_t x=0; x<big.width(); x++) {
+            for (size_t y=0; y<big.height(); y++) {
+                big(x,y) = PixelRgb(static_cast<unsigned char>(x*y), static_cast<unsigned char>(x), static_cast<unsigned char>(y));
+            }
+        }
+        for (auto interpolation : {Image::INTERPOLATION_NEAREST, Image::INTERPOLATION_BILINEAR, Image::INTERPOLATION_AREA}) {
+            ImageOf<PixelRgb> single;
+            ImageOf<PixelRgb> multi;
+            single.copy(big, 25, 17, interpolation, 1);
+            multi.copy(big, 25, 17, interpolation, 4);
+            for (size_t y=0; y<single.height(); y++) {
+                CHECK(memcmp(single.getRow(y), multi.getRow(y), single.width() * single.getPixelSize()) == 0);
+            }
+        }
+        ImageOf<PixelRgb> nearest;
+        nearest.copy(big, 25, 17);
+        for (size_t x=0; x<nearest.width(); x++) {
+            for (size_t y=0; y<nearest.height(); y++) {
+                PixelRgb& expected = big((size_t)((64.0f/25)*x), (size_t)((48.0f/17)*y));
+                CHECK(nearest(x,y).r == expected.r);
+                CHECK(nearest(x,y).g == expected.g);
+                CHECK(nearest(x,y).b == expected.b);
+            }
+        }
+
+        // the pixels of a Bayer image are just picked
+        FlexImage bayer;
+        bayer.setPixelCode(VOCAB_PIXEL_ENCODING_BAYER_GRBG8);
+        bayer.resize(4,4);
+        memset(bayer.getRawImage(), 7, bayer.getRawImageSize());
+        FlexImage bayerSmall;
+        bayerSmall.setPixelCode(VOCAB_PIXEL_ENCODING_BAYER_GRBG8);
+        CHECK(bayerSmall.copy(bayer, 2, 2, Image::INTERPOLATION_BILINEAR));
+        CHECK(bayerSmall.getRawImage()[0] == 7);
+    }
+
     // test row pointer access (getRow())
     // this function only tests if getRow(r)[c] is consistent with the operator ()
     SECTION("check row pointer.")
@@ -743,5 +887,83 @@ TEST_CASE("sig::ImageTest", "[yarp::sig]")
         CHECK(ok); // Checking data consistency bottom split
     }
 
+
+    SECTION("check vectorized pixel conversions")
+    {
+        INFO("Using " << yarp::sig::impl::getPixelKernelsInstructionSets());
+        const size_t widths[] = {1, 5, 6, 7, 15, 16, 17, 33, 63, 100};
+        bool ok = true;
+        for (int code1 : convertiblePixelCodes) {
+            for (int code2 : convertiblePixelCodes) {
+                if (yarp::sig::impl::getPixelRowKernel(code1, code2) == nullptr) {
+                    continue;
+                }
+                for (size_t w : widths) {
+                    FlexImage src;
+                    src.setPixelCode(code1);
+                    src.setQuantum(1);
+                    src.resize(w, 3);
+                    fillPixels(src, static_cast<unsigned int>(code1 + code2 + w));
+
+                    for (size_t quantum : {1, 8}) {
+                        FlexImage vectorized;
+                        FlexImage scalar;
+                        yarp::sig::impl::setPixelKernelsEnabled(true);
+                        convertPixels(src, code2, quantum, vectorized);
+                        yarp::sig::impl::setPixelKernelsEnabled(false);
+                        convertPixels(src, code2, quantum, scalar);
+                        yarp::sig::impl::setPixelKernelsEnabled(true);
+                        if (!samePixels(vectorized, scalar)) {
+                            UNSCOPED_INFO("Different result converting " << Vocab::decode(code1) << " to "
+                                          << Vocab::decode(code2) << " with width " << w
+                                          << " and quantum " << quantum);
+                            ok = false;
+                        }
+                    }
+                }
+            }
+        }
+        CHECK(ok);
+    }
+
     NetworkBase::setLocalMode(false);
 }
+
+TEST_CASE("sig::ImageTest::copyPixelsBenchmark", "[.][benchmark][yarp::sig]")
+{
+    // Run explicitly with: harness_sig "[benchmark]"
+    yInfo("Pixel conversion kernels: %s", yarp::sig::impl::getPixelKernelsInstructionSets().c_str());
+    const int repetitions = 100;
+    for (int code1 : convertiblePixelCodes) {
+        for (int code2 : convertiblePixelCodes) {
+            if (yarp::sig::impl::getPixelRowKernel(code1, code2) == nullptr) {
+                continue;
+            }
+            FlexImage src;
+            src.setPixelCode(code1);
+            src.resize(640, 480);
+            fillPixels(src, 42);
+            FlexImage vectorized;
+            FlexImage scalar;
+            double elapsed[2];
+            for (int k = 0; k < 2; k++) {
+                yarp::sig::impl::setPixelKernelsEnabled(k == 0);
+                FlexImage& dest = (k == 0) ? vectorized : scalar;
+                convertPixels(src, code2, 8, dest);
+                double start = Time::now();
+                for (int i = 0; i < repetitions; i++) {
+                    dest.copy(src);
+                }
+                elapsed[k] = (Time::now() - start) / repetitions;
+            }
+            yarp::sig::impl::setPixelKernelsEnabled(true);
+            CHECK(samePixels(vectorized, scalar));
+            yInfo("%-8s -> %-8s  scalar %8.3f ms  vectorized %8.3f ms  speedup %5.1fx",
+                  Vocab::decode(code1).c_str(),
+                  Vocab::decode(code2).c_str(),
+                  elapsed[1] * 1000,
+                  elapsed[0] * 1000,
+                  elapsed[1] / elapsed[0]);
+        }
+    }
+}
@@ -18,6 +18,9 @@
 #include <yarp/os/Time.h>
 #include <yarp/sig/Image.h>
 
+#include <cmath>
+#include <limits>
+
 #include <catch.hpp>
 #include <harness.h>
 
@@ -932,6 +935,88 @@ TEST_CASE("sig::PointCloudTest", "[yarp::sig]")
 
     }
 
+    SECTION("Testing depthToPC with ROI and steps, transformPC and pcToScan")
+    {
+        ImageOf<PixelFloat> depth;
+        size_t width{8};
+        size_t height{6};
+        depth.resize(width, height);
+        for (size_t v = 0; v < height; v++) {
+            for (size_t u = 0; u < width; u++) {
+                depth.pixel(u, v) = 1.0f + u + 10 * v;
+            }
+        }
+        IntrinsicParams intp;
+        intp.focalLengthX = 2.0;
+        intp.focalLengthY = 4.0;
+        intp.principalPointX = 3.0;
+        intp.principalPointY = 2.0;
+
+        utils::PCL_ROI roi;
+        roi.min_x = 1;
+        roi.max_x = 7;
+        roi.min_y = 2;
+        roi.max_y = 0;
+        PointCloud<DataXYZ> pc;
+        utils::depthToPC(depth, intp, roi, 2, 3, pc, 2);
+        CHECK(pc.width() == 3); // columns 1, 3, 5
+        CHECK(pc.height() == 2); // rows 2, 5
+        bool ok = true;
+        for (size_t j = 0; j < pc.height(); j++) {
+            for (size_t i = 0; i < pc.width(); i++) {
+                size_t u = 1 + 2 * i;
+                size_t v = 2 + 3 * j;
+                float z = depth.pixel(u, v);
+                ok &= std::fabs(pc(i, j).x - (u - 3.0f) / 2.0f * z) < acceptedDiff * 100;
+                ok &= std::fabs(pc(i, j).y - (v - 2.0f) / 4.0f * z) < acceptedDiff * 100;
+                ok &= pc(i, j).z == z;
+            }
+        }
+        CHECK(ok); // Checking the de-projected points
+
+        PointCloud<DataXYZ> pcThreads;
+        utils::depthToPC(depth, intp, utils::PCL_ROI(), 1, 1, pcThreads, 4);
+        auto pcOld = utils::depthToPC(depth, intp);
+        CHECK(pcThreads.width() == pcOld.width());
+        CHECK(pcThreads.height() == pcOld.height());
+        ok = true;
+        for (size_t i = 0; i < pcOld.size(); i++) {
+            ok &= std::fabs(pcThreads(i).x - pcOld(i).x) < acceptedDiff;
+            ok &= std::fabs(pcThreads(i).y - pcOld(i).y) < acceptedDiff;
+            ok &= pcThreads(i).z == pcOld(i).z;
+        }
+        CHECK(ok); // Checking that the threads do not change the result
+
+        // rotation of 90 degrees around z, and translation
+        PointCloud<DataXYZ> pts;
+        pts.resize(3);
+        pts(0).x = 1; pts(0).y = -0.5; pts(0).z = 0;
+        pts(1).x = -0.5; pts(1).y = 2; pts(1).z = 1;
+        pts(2).x = -1; pts(2).y = 0; pts(2).z = 5;
+        Matrix m(4, 4);
+        m.zero();
+        m(0, 1) = -1;
+        m(1, 0) = 1;
+        m(2, 2) = 1;
+        m(3, 3) = 1;
+        m(2, 3) = 0.5;
+        utils::transformPC(pts, m, 2);
+        CHECK(std::fabs(pts(0).x - 0.5) < acceptedDiff);
+        CHECK(std::fabs(pts(0).y - 1) < acceptedDiff);
+        CHECK(std::fabs(pts(0).z - 0.5) < acceptedDiff);
+        CHECK(std::fabs(pts(1).x + 2) < acceptedDiff);
+        CHECK(std::fabs(pts(1).y + 0.5) < acceptedDiff);
+        CHECK(std::fabs(pts(1).z - 1.5) < acceptedDiff);
+
+        // (0.5,1,0.5) is at 63 deg, (-2,-0.5,1.5) at 194 deg, (0,-1,5.5) is too high
+        Vector scan(4, std::numeric_limits<double>::infinity());
+        utils::pcToScan(pts, 0.1, 5.0, 90.0, scan, 2);
+        CHECK(std::fabs(scan[0] - std::sqrt(1.25)) < acceptedDiff);
+        CHECK(std::isinf(scan[1]));
+        CHECK(std::fabs(scan[2] - std::sqrt(4.25)) < acceptedDiff);
+        CHECK(std::isinf(scan[3]));
+    }
+
     SECTION("Testing move semantics")
     {
         INFO("Testing the copy constructor with PC of the same type");
@@ -220,5 +220,71 @@ TEST_CASE("sig::VectorOfTest", "[yarp::sig]")
         CHECK(v.capacity() >= (size_t) 11); // Checking capacity() after push_back
     }
 
+    SECTION("Checking inline storage and pool")
+    {
+        VectorOf<double> small {1.0, 2.0, 3.0, 4.0, 5.0, 6.0};
+        const char* object = reinterpret_cast<const char*>(&small);
+        const char* elements = reinterpret_cast<const char*>(small.data());
+        CHECK((elements >= object && elements < object + sizeof(small))); // Checking the inline storage
+        CHECK(small.capacity() == (size_t) 6); // Checking the capacity of the inline storage
+        small.reserve(8);
+        CHECK(small.capacity() == (size_t) 8);
+        CHECK(small.data() == reinterpret_cast<const double*>(elements)); // The reserved elements fit inline
+        small.clear();
+        CHECK(small.capacity() == (size_t) 8); // Checking capacity() after clear()
+        small = VectorOf<double> {1.0, 2.0, 3.0, 4.0, 5.0, 6.0};
+
+        VectorOf<double> moved(std::move(small));
+        CHECK(moved.size() == (size_t) 6); // Checking the moved inline vector
+        CHECK(moved[5] == 6.0);
+        CHECK(small.size() == (size_t) 0);
+
+        for (size_t i = 6; i < 20; i++) {
+            moved.push_back(static_cast<double>(i + 1));
+        }
+        CHECK(moved.size() == (size_t) 20); // Checking the growth out of the inline storage
+        CHECK(moved.capacity() >= (size_t) 20);
+        CHECK(moved[0] == 1.0);
+        CHECK(moved[19] == 20.0);
+
+        VectorOf<double> copy(moved);
+        CHECK(copy == moved); // Checking the copy of a large vector
+        copy.resize(4);
+        CHECK(copy.size() == (size_t) 4);
+        moved = copy;
+        CHECK(moved.size() == (size_t) 4); // Checking the copy of a small vector into a large one
+        CHECK(moved[3] == 4.0);
+
+        bool wasEnabled = VectorBase::isPoolEnabled();
+        VectorBase::setPoolEnabled(true);
+        const double* released = nullptr;
+        {
+            VectorOf<double> large(50);
+            released = large.data();
+        }
+        VectorOf<double> reused(60);
+        CHECK(reused.data() == released); // Checking that the released block is reused
+        CHECK(reused[59] == 0.0);
+        VectorBase::setPoolEnabled(wasEnabled);
+    }
+
+    SECTION("Checking iterators")
+    {
+        VectorOf<int> v {3, 1, 2};
+        VectorOf<int>::iterator it = v.begin();
+        VectorOf<int>::const_iterator cit = it; // Checking the conversion to const_iterator
+        CHECK(cit == v.cbegin());
+        CHECK(v.end() - v.begin() == 3);
+        CHECK(v.cend() - it == 3);
+        CHECK(*(it + 2) == 2);
+        CHECK(it[1] == 1);
+        CHECK(2 + it == v.end() - 1);
+        CHECK(it < v.end());
+        std::sort(v.begin(), v.end());
+        CHECK(v[0] == 1);
+        CHECK(v[2] == 3);
+        CHECK(std::distance(v.cbegin(), v.cend()) == 3);
+    }
+
     NetworkBase::setLocalMode(false);
 }